@@ -209,6 +209,44 @@ UaStatus Client::read(std::vector<std::string> sNodeNames, UaVariant *data)
     return result;
 }
 
+UaStatus Client::read(const std::vector<std::string> &sNodeNames, UaVariant *data, std::vector<UaStatus> &itemStatuses)
+{
+    UaStatus          result;
+
+    UaDataValues      values;
+    UaClientSdk::ServiceSettings   serviceSettings;
+    UaReadValueIds    nodesToRead;
+    UaDiagnosticInfos diagnosticInfos;
+
+    OpcUa_UInt32 size = sNodeNames.size();
+    itemStatuses.assign(size, UaStatus(OpcUa_BadNoData));
+
+    nodesToRead.create(size);
+    for (OpcUa_UInt32 i = 0; i < size; i++) {
+        UaNodeId::fromXmlString(UaString(sNodeNames.at(i).c_str())).copyTo(&nodesToRead[i].NodeId);
+        nodesToRead[i].AttributeId = OpcUa_Attributes_Value;
+    }
+
+    serviceSettings.callTimeout = 2000; // 2000 ms
+    result = m_pSession->read(serviceSettings, 0, OpcUa_TimestampsToReturn_Both,
+                                                   nodesToRead, values, diagnosticInfos);
+
+    if (result.isGood()) {
+        for (OpcUa_UInt32 i = 0; i < values.length() && i < size; i++) {
+            itemStatuses[i] = UaStatus(values[i].StatusCode);
+            if (OpcUa_IsGood(values[i].StatusCode)) {
+                data[i] = UaVariant(values[i].Value);
+            }
+        }
+    }
+    else {
+        // Service call failed
+        printf("Read failed with status %s\n", result.toString().toUtf8());
+    }
+
+    return result;
+}
+
 UaStatus Client::write(std::vector<std::string> sNodeNames, const UaVariant *values)
 {
     UaStatus          result;
@@ -335,15 +373,24 @@ UaStatus Client::callMethodAsync(const std::string &sNodeName, const UaString &s
     callRequest.methodId = nodes[1];
     callRequest.inputArguments = args;
 
-    status = m_pSession->beginCall(serviceSettings, callRequest, m_TransactionId);
+    // registered before the call, as it may complete before beginCall() returns
+    OpcUa_UInt32 transactionId;
+    {
+        std::lock_guard<std::mutex> lock(m_AsyncCallsMutex);
+        transactionId = m_TransactionId++;
+        m_AsyncCalls[transactionId] = std::make_pair(std::string(name), std::chrono::steady_clock::now());
+    }
+
+    status = m_pSession->beginCall(serviceSettings, callRequest, transactionId);
 
-    if ( status.isBad() )
-        printf("** Error: Client at %s: UaSession::beginCall with transactionId=%d failed [ret=%s] **\n", m_Address.toUtf8(), m_TransactionId, status.toString().toUtf8());
+    if ( status.isBad() ) {
+        printf("** Error: Client at %s: UaSession::beginCall with transactionId=%d failed [ret=%s] **\n", m_Address.toUtf8(), transactionId, status.toString().toUtf8());
+        std::lock_guard<std::mutex> lock(m_AsyncCallsMutex);
+        m_AsyncCalls.erase(transactionId);
+    }
     else {
         if(_DEBUG_)
-            printf("** Client at %s: UaSession::beginCall with transactionId=%d suceeded!\n", m_Address.toUtf8(), m_TransactionId);
-
-        ++m_TransactionId;
+            printf("** Client at %s: UaSession::beginCall with transactionId=%d suceeded!\n", m_Address.toUtf8(), transactionId);
     }
 
     return status;
@@ -355,7 +402,26 @@ void Client::callComplete(OpcUa_UInt32 transactionId, const UaStatus &result, co
         //printf("\ttransactionId %d \n", transactionId);
         //printf("\tresultStatus %s \n", result.toString().toUtf8());
         // this should duplicate the behavior of the synchronous callMethod() after the method
-        // call succeeds. But we're not doing anything there for now, so this too is empty
+        // call succeeds. But we're not doing anything there for now, except for logging the round trip
+        std::string method;
+        std::chrono::steady_clock::time_point start;
+        {
+            std::lock_guard<std::mutex> lock(m_AsyncCallsMutex);
+            auto it = m_AsyncCalls.find(transactionId);
+            if (it == m_AsyncCalls.end())
+                return;
+            method = it->second.first;
+            start = it->second.second;
+            m_AsyncCalls.erase(it);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        UaStatus status = result.isGood() ? callResponse.callResult : result;
+        if (status.isBad())
+            spdlog::warn("Client at {} : {} failed after {:.1f} ms [{}]", m_Address.toUtf8(), method, ms,
+                         status.toString().toUtf8());
+        else
+            spdlog::debug("Client at {} : {} completed in {:.1f} ms", m_Address.toUtf8(), method, ms);
 }
 
 UaStatus Client::browseAndAddDevices()
@@ -526,6 +592,12 @@ UaStatus Client::unsubscribe()
     return m_pSubscription->deleteSubscription();
 }
 
+UaStatus Client::monitor(const std::string &sNodeName, Subscription::DataChangeHandler handler)
+{
+    return m_pSubscription->monitorNode(m_pSession.get(), UaNodeId::fromXmlString(UaString(sNodeName.c_str())),
+                                        std::move(handler));
+}
+
 void Client::connectDatabase()
 {
     m_pDatabase->connectAndPrepare();
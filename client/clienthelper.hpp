@@ -1,7 +1,10 @@
 #ifndef PASCLIENT_H
 #define PASCLIENT_H
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "uabase/uabase.h"
@@ -38,6 +41,9 @@ public:
     UaStatus browseAndAddDevices();
 
     UaStatus read(std::vector<std::string> sNodeNames, UaVariant *data);
+    // read many nodes in one request without failing on the first bad one: itemStatuses gets the status of each
+    // node, and data is set for the good ones
+    UaStatus read(const std::vector<std::string> &sNodeNames, UaVariant *data, std::vector<UaStatus> &itemStatuses);
     UaStatus write(std::vector<std::string> sNodeName, const UaVariant *values);
 
     // synchronous call
@@ -52,6 +58,8 @@ public:
 
     UaStatus subscribe();
     UaStatus unsubscribe();
+    // call handler with every new value of the node (monitored through a subscription)
+    UaStatus monitor(const std::string &sNodeName, Subscription::DataChangeHandler handler);
     void connectDatabase();
 
     std::string getDeviceNodeId(const Device::Identity &identity) { return m_DeviceNodeIdMap.at(identity); }
@@ -75,8 +83,10 @@ private:
     UaClientSdk::UaClient::ServerStatus m_serverStatus;
     std::unique_ptr<Database> m_pDatabase;
 
-    // keep track of asynchronous calls
+    // keep track of asynchronous calls, with the method and start time of those in flight to log their round trip
     OpcUa_UInt32 m_TransactionId;
+    std::mutex m_AsyncCallsMutex;
+    std::map<OpcUa_UInt32, std::pair<std::string, std::chrono::steady_clock::time_point>> m_AsyncCalls;
 
     std::map<Device::Identity, std::string> m_DeviceNodeIdMap;
 };
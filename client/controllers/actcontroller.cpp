@@ -74,6 +74,9 @@ UaStatus ActController::getData(OpcUa_UInt32 offset, UaVariant &value) {
             case PAS_ACTType_CurrentLength:
                 varName = "CurrentLength";
                 break;
+            case PAS_ACTType_MeasuredLength:
+                varName = "MeasuredLength";
+                break;
             case PAS_ACTType_TargetLength:
                 varName = "TargetLength";
                 break;
@@ -110,6 +113,11 @@ UaStatus ActController::getData(OpcUa_UInt32 offset, UaVariant &value) {
             value.toFloat(currentLength);
             spdlog::trace("{} : Read CurrentLength value => ({})", m_Identity, currentLength);
             break;
+        case PAS_ACTType_MeasuredLength:
+            float measuredLength;
+            value.toFloat(measuredLength);
+            spdlog::trace("{} : Read MeasuredLength value => ({})", m_Identity, measuredLength);
+            break;
         case PAS_ACTType_TargetLength:
             float targetLength;
             value.toFloat(targetLength);
@@ -266,7 +274,7 @@ UaStatus ActController::operate(OpcUa_UInt32 offset, const UaVariantArray &args)
             break;
         case PAS_ACTType_Stop:
             spdlog::info("{} : ActuatorController calling stop()", m_Identity);
-            status = m_pClient->callMethod(m_pClient->getDeviceNodeId(m_Identity), UaString("Stop"));
+            status = m_pClient->callMethodAsync(m_pClient->getDeviceNodeId(m_Identity), UaString("Stop"));
             break;
         default:
             status = OpcUa_BadInvalidArgument;
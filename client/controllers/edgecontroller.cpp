@@ -1,8 +1,10 @@
 #include "client/controllers/edgecontroller.hpp"
 
+#include <algorithm>
 #include <cfloat>
 #include <fstream>
 #include <ios>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -17,6 +19,8 @@
 #include "common/utilities/spdlog/spdlog.h"
 #include "common/utilities/spdlog/fmt/ostr.h"
 
+const int EdgeController::MAX_DESIGN_DRAWS = 100;
+const double EdgeController::MAX_DESIGN_CONDITION = 100.;
 
 EdgeController::EdgeController(Device::Identity identity) : PasCompositeController(std::move(identity),
                                                                                    nullptr, 0),
@@ -105,6 +109,16 @@ UaStatus EdgeController::operate(OpcUa_UInt32 offset, const UaVariantArray &args
                          temp);
             status = findMatrix(args);
             break;
+        case PAS_EdgeType_FindMatrixDesigned: {
+            double stepSize;
+            UaVariant(args[0]).toDouble(stepSize);
+            std::string design = UaString(args[1].Value.String).toUtf8();
+            OpcUa_UInt32 nPatterns = args[2].Value.UInt32;
+            spdlog::info("{} : EdgeController calling findMatrixDesigned() with step size {}, design {}, {} patterns.",
+                         m_Identity, stepSize, design, nPatterns);
+            status = findMatrixDesigned(stepSize, design, nPatterns);
+            break;
+        }
         case PAS_EdgeType_Align: {
             // this is the utilities:
             //      if edge has 2 panels, things are unambiguous -- move the
@@ -223,10 +237,11 @@ UaStatus EdgeController::operate(OpcUa_UInt32 offset, const UaVariantArray &args
             break;
         case PAS_EdgeType_Stop: {
             // stop motion of all panels
-            spdlog::warn("{} : EdgeController::operate() : Calling stop(). Stopping all motion...", m_Identity);
+            // stop requests first (each is sent asynchronously, so all panels stop together), then log
             setState(Device::DeviceState::Off); // Turn state off to stop all methods
             for (const auto &panel : m_pChildren.at(PAS_PanelType))
                 panel->operate(PAS_PanelType_Stop);
+            spdlog::warn("{} : EdgeController::operate() : Calling stop(). Stopping all motion...", m_Identity);
             break;
         }
         default:
@@ -377,6 +392,253 @@ UaStatus EdgeController::findSingleMatrix(unsigned panelIdx, double stepSize) {
     return status;
 }
 
+// NOTE: Like findMatrix(), this performs no safety checks for collision. Consecutive patterns can differ by up to
+// twice the step size on every actuator at once, so the step size should be kept as small as for findMatrix().
+UaStatus EdgeController::findMatrixDesigned(double stepSize, const std::string &design, unsigned nPatterns) {
+    UaStatus status;
+
+    unsigned numPanels = m_pChildren.at(PAS_PanelType).size();
+
+    setState(Device::DeviceState::Busy);
+    for (unsigned i = 0; i < numPanels; i++) {
+        if (m_State != Device::DeviceState::Off) {
+            unsigned nACTs = std::dynamic_pointer_cast<PanelController>(
+                m_pChildren.at(PAS_PanelType).at(i))->getActuatorCount();
+            Eigen::MatrixXd patterns = __perturbationDesign(design, nACTs, nPatterns);
+            if (!patterns.rows()) {
+                spdlog::error("{} : EdgeController::findMatrixDesigned() : Could not make a {} design for {} "
+                              "actuators (valid designs are 'hadamard', 'random'). Method call aborted.", m_Identity,
+                              design, nACTs);
+                setState(Device::DeviceState::On);
+                return OpcUa_BadInvalidArgument;
+            }
+            status = findSingleMatrixDesigned(i, stepSize, patterns);
+            if (!status.isGood()) {
+                spdlog::error(
+                    "{} : EdgeController::findMatrixDesigned() : Encountered error in findSingleMatrixDesigned(). Motion aborted.",
+                    m_Identity);
+                setState(Device::DeviceState::On);
+                return status;
+            }
+        }
+        else {
+            spdlog::warn("{} : EdgeController::findMatrixDesigned() : Edge motion stop detected. Motion aborted.",
+                         m_Identity);
+            break;
+        }
+    }
+    setState(Device::DeviceState::On);
+
+    return status;
+}
+
+/// @details The "hadamard" design takes the columns of a Sylvester Hadamard matrix other than the constant one,
+/// so the actuator columns are orthogonal to each other and to the constant offset of the readings; for six
+/// actuators this is 8 patterns. Asking for more patterns repeats the block. The "random" design draws each entry
+/// as +/-1 with equal probability, with at least nACTs + 2 patterns so that the residuals can be estimated, and
+/// redraws until the patterns together with the constant offset have full column rank.
+Eigen::MatrixXd EdgeController::__perturbationDesign(const std::string &design, unsigned nACTs, unsigned nPatterns) {
+    Eigen::MatrixXd patterns;
+
+    if (design == "hadamard") {
+        unsigned order = 1;
+        while (order < nACTs + 1)
+            order *= 2;
+        Eigen::MatrixXd hadamard = Eigen::MatrixXd::Ones(1, 1);
+        while (hadamard.rows() < order) {
+            Eigen::MatrixXd next(2 * hadamard.rows(), 2 * hadamard.cols());
+            next << hadamard, hadamard, hadamard, -hadamard;
+            hadamard = next;
+        }
+        unsigned nBlocks = std::max(1u, (nPatterns + order - 1) / order);
+        patterns.resize(nBlocks * order, nACTs);
+        for (unsigned i = 0; i < nBlocks; i++)
+            patterns.middleRows(i * order, order) = hadamard.middleCols(1, nACTs);
+    } else if (design == "random") {
+        nPatterns = std::max(nPatterns, nACTs + 2);
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::bernoulli_distribution coin(0.5);
+        Eigen::MatrixXd X = Eigen::MatrixXd::Ones(nPatterns, nACTs + 1);
+        int draws = 0;
+        do {
+            if (draws++ == MAX_DESIGN_DRAWS) {
+                spdlog::error("EdgeController::__perturbationDesign() : No full rank random design of {} patterns "
+                              "after {} draws.", nPatterns, MAX_DESIGN_DRAWS);
+                return Eigen::MatrixXd();
+            }
+            for (unsigned i = 0; i < nPatterns; i++)
+                for (unsigned j = 1; j <= nACTs; j++)
+                    X(i, j) = coin(gen) ? 1. : -1.;
+        } while (Eigen::FullPivLU<Eigen::MatrixXd>(X).rank() < (int)nACTs + 1);
+        patterns = X.rightCols(nACTs);
+    }
+
+    return patterns;
+}
+
+UaStatus EdgeController::__moveDeltaLengthsAndWait(const std::shared_ptr<PanelController> &pPanel,
+                                                   const Eigen::VectorXd &deltas) {
+    UaStatus status;
+
+    UaVariantArray args;
+    args.create(deltas.size());
+    UaVariant var;
+    for (int i = 0; i < (int)deltas.size(); i++) {
+        var.setFloat(deltas(i));
+        var.copyTo(&args[i]);
+    }
+    status = pPanel->__moveDeltaLengths(args);
+    if (!status.isGood()) return status;
+
+    // Stepping is asynchronous, so wait for it to complete before reading the sensors.
+    Device::DeviceState curState;
+    pPanel->getState(curState);
+    while (curState == Device::DeviceState::Busy) {
+        usleep(500 * 1000); // microseconds
+        pPanel->getState(curState);
+    }
+
+    return status;
+}
+
+// helper method for the above -- step the panel through the patterns, read the edge sensors at each one, and fit
+// readings = offset + responseMatrix * (lengths - initial lengths)
+// NOTE: This method performs no safety checks for collision (for speed). It is assumed that a reasonably small step size
+// will be used such that there is no risk of collision.
+UaStatus EdgeController::findSingleMatrixDesigned(unsigned panelIdx, double stepSize, const Eigen::MatrixXd &patterns) {
+    UaStatus status;
+
+    std::shared_ptr<PanelController> pCurPanel = std::dynamic_pointer_cast<PanelController>(
+        m_pChildren.at(PAS_PanelType).at(panelIdx));
+    unsigned nACTs = pCurPanel->getActuatorCount();
+    unsigned nPatterns = patterns.rows();
+
+    spdlog::info("{} : Measuring response matrix for Panel {} with {} patterns of step {} mm...", m_Identity,
+                 pCurPanel->getIdentity(), nPatterns, stepSize);
+
+    Eigen::VectorXd lengths0, lengths;
+    status = pCurPanel->__getActuatorLengths(lengths0);
+    if (!status.isGood()) return status;
+
+    // one row per pattern: a constant for the readings at the initial lengths, then the achieved actuator deltas,
+    // so that missed steps are accounted for
+    Eigen::MatrixXd X(nPatterns, nACTs + 1);
+    Eigen::MatrixXd Y; // readings, one row per pattern
+    Eigen::VectorXd offset = Eigen::VectorXd::Zero(nACTs); // commanded, from the initial lengths
+
+    bool moveFailed = false;
+    for (unsigned i = 0; i < nPatterns; i++) {
+        Eigen::VectorXd target = stepSize * patterns.row(i).transpose();
+        status = __moveDeltaLengthsAndWait(pCurPanel, target - offset);
+        if (!status.isGood()) {
+            moveFailed = true;
+            break;
+        }
+        offset = target;
+        if (m_State == Device::DeviceState::Off) break;
+
+        status = pCurPanel->__getActuatorLengths(lengths);
+        if (!status.isGood()) break;
+        updateAllSensors();
+        Eigen::VectorXd readings = __getCurrentReadings().first;
+        if (m_State == Device::DeviceState::Off) break;
+
+        if (i == 0) {
+            Y.resize(nPatterns, readings.size());
+        } else if (readings.size() != Y.cols()) {
+            spdlog::error("{} : EdgeController::findSingleMatrixDesigned() : Number of visible sensors changed "
+                          "during the measurement. Aborting...", m_Identity);
+            status = OpcUa_BadInvalidState;
+            break;
+        }
+        X(i, 0) = 1.;
+        X.row(i).tail(nACTs) = (lengths - lengths0).head(nACTs).transpose();
+        Y.row(i) = readings.transpose();
+        spdlog::debug("{} : Pattern {}: actuator deltas\n{}\nMPES readings\n{}\n", m_Identity, i + 1,
+                      X.row(i).tail(nACTs), readings.transpose());
+    }
+
+    // an explicit Stop leaves the panel where it is
+    if (m_State == Device::DeviceState::Off) {
+        spdlog::warn("{} : EdgeController::findSingleMatrixDesigned() : Stopped, Panel {} left at its current "
+                     "lengths.", m_Identity, pCurPanel->getIdentity());
+        return status;
+    }
+
+    // move back to the initial lengths, also when the measurement failed. A failed move may have stopped anywhere
+    // between two patterns, so then go by the measured lengths rather than the commanded offset.
+    Eigen::VectorXd back = -offset;
+    if (moveFailed) {
+        Eigen::VectorXd current;
+        if (pCurPanel->__getActuatorLengths(current).isGood())
+            back = (lengths0 - current).head(nACTs);
+        else
+            spdlog::warn("{} : EdgeController::findSingleMatrixDesigned() : Could not measure Panel {} after the "
+                         "failed move, moving back by the commanded offset.", m_Identity, pCurPanel->getIdentity());
+    }
+    UaStatus returnStatus = __moveDeltaLengthsAndWait(pCurPanel, back);
+    if (!returnStatus.isGood())
+        spdlog::error("{} : EdgeController::findSingleMatrixDesigned() : Failed to move Panel {} back to its initial "
+                      "lengths.", m_Identity, pCurPanel->getIdentity());
+    if (!status.isGood()) return status;
+    if (!returnStatus.isGood()) return returnStatus;
+    if (m_State == Device::DeviceState::Off) { return status; }
+
+    // conditioning of the design actually achieved, independent of the units of the columns
+    Eigen::VectorXd colNorms = X.colwise().norm().transpose();
+    if (colNorms.minCoeff() <= 0.) {
+        spdlog::error("{} : EdgeController::findSingleMatrixDesigned() : An actuator did not move at all. Response "
+                      "matrix for Panel {} not determined.", m_Identity, pCurPanel->getIdentity());
+        return OpcUa_Bad;
+    }
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd(X * colNorms.cwiseInverse().asDiagonal(),
+                                          Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const Eigen::VectorXd &sv = svd.singularValues();
+    double conditionNumber = sv(0) / sv(sv.size() - 1);
+    if (X.rows() < X.cols() || !(conditionNumber <= MAX_DESIGN_CONDITION)) {
+        // a singular or ill-conditioned fit would give a meaningless matrix -- don't let it near the file
+        spdlog::error("{} : EdgeController::findSingleMatrixDesigned() : Achieved design is singular or "
+                      "ill-conditioned (condition number {}). Response matrix for Panel {} not determined.",
+                      m_Identity, conditionNumber, pCurPanel->getIdentity());
+        return OpcUa_Bad;
+    }
+
+    // B = [offset; responseMatrix^T], solved on the scaled columns
+    Eigen::MatrixXd B = colNorms.cwiseInverse().asDiagonal() * svd.solve(Y);
+    Eigen::MatrixXd responseMatrix = B.bottomRows(nACTs).transpose();
+
+    spdlog::info("{} : Done calculating response matrix for Panel {}!", m_Identity, pCurPanel->getIdentity());
+    spdlog::info("{} : Response matrix for Edge {} --- Panel {}:\n{}\n", m_Identity, m_Identity,
+                 pCurPanel->getIdentity(),
+                 responseMatrix);
+    spdlog::info("{} : Design condition number: {} (1 is ideal).", m_Identity, conditionNumber);
+    if (conditionNumber > 10.)
+        spdlog::warn("{} : Response matrix for Panel {} is poorly determined; consider more patterns or the "
+                     "hadamard design.", m_Identity, pCurPanel->getIdentity());
+
+    int dof = (int)nPatterns - (int)(nACTs + 1);
+    if (dof > 0) {
+        // residual scatter of each sensor coordinate, and the resulting standard errors of the matrix elements
+        Eigen::VectorXd sigma = ((Y - X * B).colwise().squaredNorm() / dof).cwiseSqrt().transpose();
+        Eigen::VectorXd coeffVar = (svd.matrixV() * sv.cwiseInverse().cwiseAbs2().asDiagonal() *
+                                    svd.matrixV().transpose()).diagonal().cwiseQuotient(colNorms.cwiseAbs2());
+        Eigen::MatrixXd stdErrors = sigma * coeffVar.tail(nACTs).cwiseSqrt().transpose();
+        spdlog::info("{} : Residual RMS per MPES coordinate:\n{}\n", m_Identity, sigma.transpose());
+        spdlog::info("{} : Standard errors of the response matrix:\n{}\n", m_Identity, stdErrors);
+    } else {
+        spdlog::info("{} : No spare patterns, residuals not estimated.", m_Identity);
+    }
+
+    std::string outfilename = "/home/ctauser/PanelAlignmentData/ResponseMatrix_" + m_Identity.eAddress + ".txt";
+    std::ofstream output(outfilename, std::ofstream::in | std::ofstream::out | std::ofstream::app);
+    output << pCurPanel->getIdentity().position << std::endl << responseMatrix << std::endl;
+
+    output.close();
+
+    return status;
+}
+
 UaStatus EdgeController::align(unsigned panel_pos, double alignFrac, bool moveit, std::string command) {
     //UaMutexLocker lock(&m_mutex);
     UaStatus status;
@@ -656,6 +918,7 @@ UaStatus EdgeController::alignSinglePanel(unsigned panelpos, double alignFrac, b
         } else {
             Eigen::VectorXd X = m_Xcalculated * alignFrac;
             std::shared_ptr<PanelController> pCurPanel;
+            std::map<unsigned, Eigen::VectorXd> panelDeltas;
             int j = 0;
             for (const auto &panelPair : m_ChildrenPositionMap.at(PAS_PanelType)) {
                 if ((panelPair.first == panelpos) == moveit) { // clever but not clear...
@@ -665,6 +928,7 @@ UaStatus EdgeController::alignSinglePanel(unsigned panelpos, double alignFrac, b
                     UaVariantArray deltas;
                     deltas.create(nACT);
                     UaVariant var;
+                    panelDeltas[panelPair.first] = X.segment(j, nACT);
                     for (int i = 0; i < (int)nACT; i++) {
                         var.setFloat(X(j++));
                         var.copyTo(&deltas[i]);
@@ -674,15 +938,16 @@ UaStatus EdgeController::alignSinglePanel(unsigned panelpos, double alignFrac, b
                     j++;
                 }
             }
+            __predictSpotShifts(panelDeltas);
         }
-        m_Xcalculated.setZero();
-        m_lastSetAlignFrac = -1.0;
-
-        // arbitrary
+        // arbitrary; judged on the motion just executed, before it is cleared
         if (m_Xcalculated.array().abs().maxCoeff() >= 0.05)
             m_isAligned = false;
         else
             m_isAligned = true;
+
+        m_Xcalculated.setZero();
+        m_lastSetAlignFrac = -1.0;
     } else {
         spdlog::error(
             "{} : Invalid command provided ({}), valid commands are 'calculate', 'setAlignFrac', 'execute'.",
@@ -693,6 +958,36 @@ UaStatus EdgeController::alignSinglePanel(unsigned panelpos, double alignFrac, b
     return status;
 }
 
+// the sensors carry their spot estimates from read to read, so they are told where the spots should go
+// rather than having to find out from the frames
+void EdgeController::__predictSpotShifts(const std::map<unsigned, Eigen::VectorXd> &panelDeltas) {
+    for (const auto &pMPES : m_pChildren.at(PAS_MPESType)) {
+        auto mpes = std::dynamic_pointer_cast<MPESController>(pMPES);
+        Eigen::Vector2d shift = Eigen::Vector2d::Zero();
+        bool affected = false;
+        for (const auto &panelDelta : panelDeltas) {
+            auto panelside = mpes->getPanelSide(panelDelta.first);
+            if (panelside && panelDelta.second.size() == 6) {
+                shift += mpes->getResponseMatrix(panelside) * panelDelta.second;
+                affected = true;
+            }
+        }
+        if (!affected)
+            continue;
+
+        UaVariantArray args;
+        args.create(2);
+        UaVariant var;
+        var.setDouble(shift(0));
+        var.copyTo(&args[0]);
+        var.setDouble(shift(1));
+        var.copyTo(&args[1]);
+        spdlog::debug("{} : EdgeController::__predictSpotShifts() : MPES {} expected to move by ({}, {}).", m_Identity,
+                      mpes->getIdentity(), shift(0), shift(1));
+        mpes->operate(PAS_MPESType_PredictShift, args);
+    }
+}
+
 // Get response matrix for the panel defined by 'panelpos'
 // this is the response of the sensors on this edge to the motion of the requested panel
 Eigen::MatrixXd EdgeController::getResponseMatrix(unsigned panelpos) {
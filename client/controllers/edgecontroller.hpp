@@ -44,8 +44,22 @@ private:
 
     UaStatus findMatrix(UaVariantArray args);
     UaStatus findSingleMatrix(unsigned panelIdx, double stepSize = 0.5);
+    // measure the response matrices by moving all actuators of a panel at once, following a designed
+    // sequence of +/- stepSize patterns ("hadamard" or "random"), and fitting the readings by least squares
+    UaStatus findMatrixDesigned(double stepSize, const std::string &design, unsigned nPatterns = 0);
+    UaStatus findSingleMatrixDesigned(unsigned panelIdx, double stepSize, const Eigen::MatrixXd &patterns);
+    // +/-1 perturbation patterns, one row per pattern, one column per actuator; empty if none could be made
+    static Eigen::MatrixXd __perturbationDesign(const std::string &design, unsigned nACTs, unsigned nPatterns);
+    // random designs drawn before giving up on one that determines every actuator column
+    static const int MAX_DESIGN_DRAWS;
+    // condition number of the achieved design above which no response matrix is fitted
+    static const double MAX_DESIGN_CONDITION;
+    // move the panel's actuators by deltas and wait for the motion to finish
+    UaStatus __moveDeltaLengthsAndWait(const std::shared_ptr<PanelController> &pPanel, const Eigen::VectorXd &deltas);
 
     std::pair<Eigen::VectorXd, Eigen::VectorXd> __getCurrentReadings();
+    // tell each sensor how far its spot should move for the actuator motions of the given panels
+    void __predictSpotShifts(const std::map<unsigned, Eigen::VectorXd> &panelDeltas);
 
     UaStatus updateAllSensors();
 
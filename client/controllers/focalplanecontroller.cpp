@@ -130,6 +130,13 @@ UaStatus FocalPlaneController::getData(OpcUa_UInt32 offset, UaVariant &value) {
             spdlog::trace("{} : Read RingTol value => ({})", m_Identity, valDouble);
             break;
         }
+        case PAS_FocalPlaneType_RingDirection: {
+            OpcUa_Int32 direction;
+            direction = m_pFP->m_RingDirection;
+            value.setInt32(direction);
+            spdlog::trace("{} : Read RingDirection value => ({})", m_Identity, direction);
+            break;
+        }
         case PAS_FocalPlaneType_MinDist: {
             OpcUa_Double valDouble;
             valDouble = m_pFP->m_MinDist;
@@ -258,6 +265,19 @@ UaStatus FocalPlaneController::setData(OpcUa_UInt32 offset, UaVariant value) {
             spdlog::trace("{} : Setting Gain value... value => ({})", m_Identity, val);
             break;
         }
+        case PAS_FocalPlaneType_RingDirection: {
+            // which way the panel numbers go around the ring in the image; a mirrored ring would label the wrong panels
+            OpcUa_Int32 val;
+            value.toInt32(val);
+            if (val != 1 && val != -1) {
+                spdlog::error("{} : RingDirection must be 1 (increasing image angle) or -1 (decreasing), not {}.",
+                              m_Identity, val);
+                return OpcUa_BadInvalidArgument;
+            }
+            m_pFP->m_RingDirection = val;
+            spdlog::trace("{} : Setting RingDirection value... value => ({})", m_Identity, val);
+            break;
+        }
         default:
             return OpcUa_BadNotWritable;
             break;
@@ -280,17 +300,14 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
         case PAS_FocalPlaneType_AnalyzeSinglePanelImage: {
             spdlog::info("FocalPlaneController::operate() :  Calling AnalyzeSinglePanelImage...");
             if (!m_pFP->get_image_file().empty()){
-                std::string command;
-                command = m_pFP->analyzeSinglePanelCommand();
-
-                spdlog::trace("Calling focal plane command:");
-                spdlog::info(command);
-
-                std::string ret;
-                ret = m_pFP->exec(command.c_str());
-                spdlog::info(ret);
-
-                status = OpcUa_Good;
+                std::vector<double> coordinates = m_pFP->analyzeSinglePanel();
+                if (!coordinates.empty()) {
+                    spdlog::info("Panel spot at ({}, {})", coordinates[0], coordinates[1]);
+                    status = OpcUa_Good;
+                }
+                else {
+                    status = OpcUa_Bad;
+                }
             }
             else{
                 spdlog::error("No Image file to analyze");
@@ -300,6 +317,13 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
         }
         case PAS_FocalPlaneType_AnalyzePatternImage: {
             spdlog::info("FocalPlaneController::operate() :  Calling AnalyzePatternImage...");
+            std::string sector = UaString(args[6].Value.String).toUtf8();
+            if (!focalplane::isSector(sector)) {
+                spdlog::error("FocalPlaneController::operate() : Unknown sector {}, must be P1, P2, S1 or S2.", sector);
+                status = OpcUa_BadInvalidArgument;
+                break;
+            }
+            m_pFP->m_Sector = sector;
             m_pFP->m_PatternRadius = args[0].Value.Double;
             m_pFP->m_PhaseOffsetRad = args[1].Value.Double;
             m_pFP->m_RingFrac = args[2].Value.Double;
@@ -309,16 +333,11 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
 
 
             if (!m_pFP->get_image_file().empty()){
-                std::string command;
-                command = m_pFP->analyzePatternCommand();
+                std::map<int, std::vector<double>> coordinates = m_pFP->analyzePattern();
+                for (const auto &panel : coordinates)
+                    spdlog::info("{}: ({}, {})", panel.first, panel.second[0], panel.second[1]);
 
-                spdlog::trace("Calling focal plane command:");
-                spdlog::info(command);
-                std::string ret;
-                ret = m_pFP->exec(command.c_str());
-                spdlog::info(ret);
-
-                status = OpcUa_Good;
+                status = coordinates.empty() ? OpcUa_Bad : OpcUa_Good;
             }
             else{
                 spdlog::error("No Image file to analyze");
@@ -342,16 +361,8 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
             std::string respfile = UaString(args[1].Value.String).toUtf8();
             m_pFP->m_PatternRadius = args[2].Value.Double;
 
-            std::string command;
-            command = m_pFP->CalcMotionPatternToCenter(sector, respfile);
-
-            spdlog::trace("Calling calc motion command:");
-            spdlog::info(command);
-            std::string ret;
-            ret = m_pFP->exec(command.c_str());
-            spdlog::info(ret);
-
-            status = OpcUa_Good;
+            auto motions = m_pFP->CalcMotionPatternToCenter(sector, respfile);
+            status = _allValid(motions) ? OpcUa_Good : OpcUa_Bad;
             break;
         }
         case PAS_FocalPlaneType_Center2Pattern: {
@@ -360,16 +371,8 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
             std::string respfile = UaString(args[1].Value.String).toUtf8();
             m_pFP->m_PatternRadius = args[2].Value.Double;
 
-            std::string command;
-            command = m_pFP->CalcMotionCenterToPattern(sector, respfile);
-
-            spdlog::trace("Calling calc motion command:");
-            spdlog::info(command);
-            std::string ret;
-            ret = m_pFP->exec(command.c_str());
-            spdlog::info(ret);
-
-            status = OpcUa_Good;
+            auto motions = m_pFP->CalcMotionCenterToPattern(sector, respfile);
+            status = _allValid(motions) ? OpcUa_Good : OpcUa_Bad;
             break;
         }
         case PAS_FocalPlaneType_Panel2Center: {
@@ -379,16 +382,8 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
             double y = args[2].Value.Double;
             std::string respFile = UaString(args[3].Value.String).toUtf8();
 
-            std::string command;
-            command = m_pFP->CalcMotionSinglePanel2center(panel, x, y, respFile);
-
-            spdlog::trace("Calling calc motion command:");
-            spdlog::info(command);
-            std::string ret;
-            ret = m_pFP->exec(command.c_str());
-            spdlog::info(ret);
-
-            status = OpcUa_Good;
+            focalplane::PanelMotion motion = m_pFP->CalcMotionSinglePanel2center(panel, x, y, respFile);
+            status = motion.valid ? OpcUa_Good : OpcUa_Bad;
             break;
         }
         case PAS_FocalPlaneType_Panel2Pattern: {
@@ -398,16 +393,8 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
             double y = args[2].Value.Double;
             std::string respFile = UaString(args[3].Value.String).toUtf8();
 
-            std::string command;
-            command = m_pFP->CalcMotionSinglePanel2pattern(panel, x, y, respFile);
-
-            spdlog::trace("Calling calc motion command:");
-            spdlog::info(command);
-            std::string ret;
-            ret = m_pFP->exec(command.c_str());
-            spdlog::info(ret);
-
-            status = OpcUa_Good;
+            focalplane::PanelMotion motion = m_pFP->CalcMotionSinglePanel2pattern(panel, x, y, respFile);
+            status = motion.valid ? OpcUa_Good : OpcUa_Bad;
             break;
         }
         case PAS_FocalPlaneType_SaveImage: {
@@ -417,7 +404,7 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
             imagepath = _captureSingleImage();
             spdlog::info("Focal Plane Image path: {}", imagepath);
 
-            status = OpcUa_Good;
+            status = imagepath.empty() ? OpcUa_Bad : OpcUa_Good;
             break;
         }
         default:
@@ -428,18 +415,15 @@ UaStatus FocalPlaneController::operate(OpcUa_UInt32 offset, const UaVariantArray
 }
 
 std::string FocalPlaneController::_captureSingleImage() {
-    std::string filename;
-    std::string command;
-
-    command = m_pFP->saveImageCommand();
-
-    spdlog::trace("Calling saveImage command:");
-    spdlog::info(command);
-    std::string ret;
-    ret = m_pFP->exec(command.c_str());
-    spdlog::info(ret);
-
-    filename = m_pFP->get_image_file();
-    return filename;
+    return m_pFP->captureImage();
 }
 
+bool FocalPlaneController::_allValid(const std::map<unsigned, focalplane::PanelMotion> &motions) {
+    if (motions.empty())
+        return false;
+    for (const auto &motion : motions) {
+        if (!motion.second.valid)
+            return false;
+    }
+    return true;
+}
@@ -32,6 +32,8 @@ private:
     std::shared_ptr<focalplane> m_pFP ;
 
     std::string _captureSingleImage();
+
+    static bool _allValid(const std::map<unsigned, focalplane::PanelMotion> &motions);
 };
 
 #endif //ALIGNMENT_FOCALPLANECONTROLLER_HPP
@@ -3,7 +3,12 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <deque>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <string>
@@ -27,6 +32,8 @@
 #include "client/controllers/pascontroller.hpp"
 
 #include "client/objects/panelobject.hpp"
+#include "client/utilities/mirrorsnapshot.hpp"
+#include "client/utilities/panelpositionmodel.hpp"
 
 #include "uathread.h"
 
@@ -41,6 +48,8 @@
 MirrorController *MirrorControllerCompute::m_Mirror = nullptr;
 
 const std::string MirrorController::SAVEFILE_DELIMITER = "****************************************";
+const int MirrorController::MAX_CONCURRENT_WEBCAM_CAPTURES = 2;
+const int MirrorController::MAX_EDGE_ALIGN_ITERATIONS = 20;
 
 MirrorController::MirrorController(Device::Identity identity, std::string mode)
     : PasCompositeController(
@@ -229,6 +238,9 @@ bool MirrorController::initialize()
         }
     }
 
+    // the geometry may have changed -- recompute panel transforms as they are needed
+    m_PanelTransforms.clear();
+
     spdlog::info("{}: MirrorController::initialize(): Done.", m_Identity);
 
     return true;
@@ -273,6 +285,8 @@ UaStatus MirrorController::getData(OpcUa_UInt32 offset, UaVariant &value)
             updateCoords(false);
         }
         */
+        std::lock_guard<std::recursive_mutex> lock(m_CoordsMutex);
+        __refreshTrackedCoords();
         int dataoffset = offset - PAS_MirrorType_x;
         value.setDouble(m_curCoords(dataoffset));
     }
@@ -421,7 +435,8 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
     if (offset == PAS_MirrorType_MoveToCoords || offset == PAS_MirrorType_MoveDeltaCoords ||
         offset == PAS_MirrorType_AlignSector || offset == PAS_MirrorType_LoadActuatorLengths ||
         offset == PAS_MirrorType_AlignRing || offset == PAS_MirrorType_LoadDeltaCoords 
-        || offset == PAS_MirrorType_LoadMPESAlignmentOffset || offset == PAS_MirrorType_LoadMPESPositions) {
+        || offset == PAS_MirrorType_LoadMPESAlignmentOffset || offset == PAS_MirrorType_LoadMPESPositions
+        || offset == PAS_MirrorType_LoadSnapshot || offset == PAS_MirrorType_LoadElevationModel) {
 
         std::string command;
 
@@ -454,6 +469,14 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
             spdlog::info("{} : MirrorController::operate() : Calling loadMPESPositions()...", m_Identity);
             command = UaString(args[2].Value.String).toUtf8();
         }
+        else if (offset == PAS_MirrorType_LoadSnapshot) {
+            spdlog::info("{} : MirrorController::operate() : Calling loadSnapshot()...", m_Identity);
+            command = UaString(args[2].Value.String).toUtf8();
+        }
+        else if (offset == PAS_MirrorType_LoadElevationModel) {
+            spdlog::info("{} : MirrorController::operate() : Calling loadElevationModel()...", m_Identity);
+            command = UaString(args[2].Value.String).toUtf8();
+        }
 
         setState(Device::DeviceState::Busy);
         if (command == "calculate") {
@@ -498,6 +521,15 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
                 spdlog::info("Calling calculateLoadMPESPositions...");
                 status = __calculateLoadMPESPositions(saveFilePath);
             }
+            else if (offset == PAS_MirrorType_LoadSnapshot) {
+                std::string saveFilePath = UaString(args[0].Value.String).toUtf8();
+                status = __calculateLoadSnapshot(saveFilePath);
+            }
+            else if (offset == PAS_MirrorType_LoadElevationModel) {
+                std::string modelDirectory = UaString(args[0].Value.String).toUtf8();
+                double el = args[3].Value.Double;
+                status = __calculateLoadElevationModel(modelDirectory, el);
+            }
 
             if (status.isBad()) {
                 spdlog::error("{}: There was an error during the calculation. No motion prepared. Please identify the error and try again.", m_Identity);
@@ -546,6 +578,12 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
                 alignFrac = args[1].Value.Double;
                 spdlog::info("Calling setAlignFrac...");
             }
+            else if (offset == PAS_MirrorType_LoadSnapshot) {
+                alignFrac = args[1].Value.Double;
+            }
+            else if (offset == PAS_MirrorType_LoadElevationModel) {
+                alignFrac = args[1].Value.Double;
+            }
             __setAlignFrac(alignFrac);
             alignFrac = abs(alignFrac);
         } else if (command == "execute") {
@@ -570,6 +608,12 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
             else if (offset == PAS_MirrorType_LoadMPESPositions) {
                 alignFrac = args[1].Value.Double;
             }
+            else if (offset == PAS_MirrorType_LoadSnapshot) {
+                alignFrac = args[1].Value.Double;
+            }
+            else if (offset == PAS_MirrorType_LoadElevationModel) {
+                alignFrac = args[1].Value.Double;
+            }
             alignFrac = abs(alignFrac);
             if (alignFrac > 1.01 || alignFrac <= 0.0) {
                 spdlog::error(
@@ -602,11 +646,15 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
         updateCoords(false);
         std::string saveFilePath = UaString(args[0].Value.String).toUtf8();
 
-        saveActuatorLengths(saveFilePath);
+        // both files from the same readings
+        MirrorSnapshot snapshot;
+        if (__acquireSnapshot(snapshot).isGood()) {
+            __writeSnapshotText(snapshot, MirrorSnapshot::ACTUATOR_LENGTHS, saveFilePath);
 
-        std::string saveFilePath_physicalCoords = saveFilePath + "_physicalCoords";
-        spdlog::info("{}: now calling savePanelPhysicalCoordinates with modified path {}", m_Identity, saveFilePath_physicalCoords);
-        savePanelPhysicalCoords(saveFilePath_physicalCoords);
+            std::string saveFilePath_physicalCoords = saveFilePath + "_physicalCoords";
+            spdlog::info("{}: now saving panel physical coordinates with modified path {}", m_Identity, saveFilePath_physicalCoords);
+            __writeSnapshotText(snapshot, MirrorSnapshot::PANEL_COORDS, saveFilePath_physicalCoords);
+        }
 
         setState(Device::DeviceState::On);
     }
@@ -642,6 +690,15 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
         saveMPESPositions(saveFilePath);
         setState(Device::DeviceState::On);
     }
+    else if (offset == PAS_MirrorType_SaveSnapshot) {
+        setState(Device::DeviceState::Busy);
+        spdlog::info("{} : MirrorController::operate() : Calling saveSnapshot()...", m_Identity);
+        std::string saveFilePath = UaString(args[0].Value.String).toUtf8();
+        bool textExport = args[1].Value.Boolean;
+
+        status = saveSnapshot(saveFilePath, textExport);
+        setState(Device::DeviceState::On);
+    }
     else if (offset == PAS_MirrorType_AlignSequentialRecursive) {
         // make sure the arguments make sense -- we are supposed
         // to get an edge position and a direction. The type has
@@ -659,6 +716,31 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
         updateCoords(false);
         status = alignSequential(startEdge, endEdge, dir);
         setState(Device::DeviceState::On);
+    } else if (offset == PAS_MirrorType_AlignWavefront) {
+        std::string startEdge = UaString(args[0].Value.String).toUtf8();
+        std::string endEdge = UaString(args[1].Value.String).toUtf8();
+        OpcUa_UInt32 dir = args[2].Value.UInt32;
+        OpcUa_UInt32 maxRounds = args[3].Value.UInt32;
+
+        spdlog::info(
+            "{} : MirrorController::operate() : Calling alignWavefront() with start edge {}, end edge {}, direction {}, max rounds {}...",
+            m_Identity, startEdge, endEdge, dir, maxRounds);
+        setState(Device::DeviceState::Busy);
+        updateCoords(false);
+        status = alignWavefront(startEdge, endEdge, dir, maxRounds);
+        setState(Device::DeviceState::On);
+    } else if (offset == PAS_MirrorType_FindMatrices) {
+        double stepSize;
+        UaVariant(args[0]).toDouble(stepSize);
+        std::string design = UaString(args[1].Value.String).toUtf8();
+        OpcUa_UInt32 nPatterns = args[2].Value.UInt32;
+
+        spdlog::info(
+            "{} : MirrorController::operate() : Calling findMatrices() with step size {}, design {}, {} patterns...",
+            m_Identity, stepSize, design, nPatterns);
+        setState(Device::DeviceState::Busy);
+        status = findMatrices(stepSize, design, nPatterns);
+        setState(Device::DeviceState::On);
     } else if (offset == PAS_MirrorType_ReadSensors) {
         spdlog::info("{} : MirrorController::operate() : Calling readSensors()...", m_Identity);
         setState(Device::DeviceState::Busy);
@@ -706,72 +788,52 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
             spdlog::debug("{} : Sensors found in this mirror", m_Identity);
         }
 
-        std::map<std::shared_ptr<PanelController>, std::vector<std::shared_ptr<MPESController>>> MPESordering;
-        for (auto it = getChildren(PAS_PanelType).begin(); it < getChildren(PAS_PanelType).end(); it++) {
-            MPESordering[std::dynamic_pointer_cast<PanelController>(*it)] = std::vector<std::shared_ptr<MPESController>>();
-            if (std::dynamic_pointer_cast<PanelController>(*it)->m_pChildren.find(PAS_MPESType) != std::dynamic_pointer_cast<PanelController>(*it)->m_pChildren.end()) {
-                for (const auto &mpes : std::dynamic_pointer_cast<PanelController>(*it)->getChildren(
-                        PAS_MPESType)) {
-                    if (m_selectedMPES.find(mpes->getIdentity().serialNumber) != m_selectedMPES.end()) {
-                        MPESordering[std::dynamic_pointer_cast<PanelController>(*it)].push_back(std::dynamic_pointer_cast<MPESController>(mpes));
-                    }
+        // every panel server reads all of its webcams at once, so only the panels are waited on here
+        std::vector<std::shared_ptr<PanelController>> panelsToRead;
+        std::vector<std::string> serialsToRead; // selected MPES of each panel, as the ReadSensors argument
+        int totalMPES = 0;
+        for (const auto &panel : getChildren(PAS_PanelType)) {
+            auto pPanel = std::dynamic_pointer_cast<PanelController>(panel);
+            if (pPanel->m_pChildren.find(PAS_MPESType) == pPanel->m_pChildren.end()) {
+                spdlog::warn("{}: No MPES found on this panel", pPanel->getIdentity().position);
+                continue;
+            }
+            int nSelected = 0;
+            std::ostringstream serials;
+            for (const auto &mpes : pPanel->getChildren(PAS_MPESType)) {
+                if (m_selectedMPES.find(mpes->getIdentity().serialNumber) != m_selectedMPES.end()) {
+                    serials << mpes->getIdentity().serialNumber << " ";
+                    nSelected++;
                 }
             }
-            else {
-                spdlog::warn("{}: No MPES found on this panel", std::dynamic_pointer_cast<PanelController>(*it)->getIdentity().position);
+            if (nSelected > 0) {
+                panelsToRead.push_back(pPanel);
+                serialsToRead.push_back(serials.str());
+                totalMPES += nSelected;
             }
         }
 
-        int totalMPES = 0;
-        for (const auto &pair : MPESordering) {
-            totalMPES += pair.second.size();
+        spdlog::info("{}: Total number of MPES requested to read is {}, on {} panels. Starting reads...", m_Identity,
+                     totalMPES, panelsToRead.size());
+        std::vector<UaVariantArray> readArgs(panelsToRead.size());
+        for (unsigned i = 0; i < panelsToRead.size(); i++) {
+            readArgs[i].create(2);
+            UaVariant(MAX_CONCURRENT_WEBCAM_CAPTURES).copyTo(&readArgs[i][0]);
+            UaVariant(UaString(serialsToRead[i].c_str())).copyTo(&readArgs[i][1]);
         }
-
-        spdlog::info("{}: Total number of MPES requested to read is {}. Starting reads...", m_Identity, totalMPES);
-        while (totalMPES > 0) {
-            for (auto &pair : MPESordering) {
-
-                if (totalMPES == 0) {
-                    break;
-                }
-
-                if (!pair.second.empty()) {
-                    bool busy = false;
-                    Device::DeviceState state;
-                    for (const auto &mpes : pair.first->getChildren(PAS_MPESType)) { // Check if all mpes on panel are idle
-                        mpes->getState(state); 
-                        if (state == Device::DeviceState::Busy) {
-                            busy = true;
-                        }
-                        UaThread::msleep(200);
-                    }
-                    
-                    if (!busy) {
-                        totalMPES--;
-                        spdlog::info("{}: Reading MPES {} on Panel {} ({} remaining)...", m_Identity,
-                                     pair.second.back()->getIdentity(), pair.first->getIdentity(), totalMPES);
-                        pair.second.back()->readAsync();
-                        pair.second.pop_back();
-                    }
-                }
-            }
+        std::vector<std::future<UaStatus>> reads;
+        for (unsigned i = 0; i < panelsToRead.size(); i++) {
+            std::shared_ptr<PanelController> pPanel = panelsToRead[i];
+            const UaVariantArray &panelArgs = readArgs[i];
+            reads.push_back(std::async(std::launch::async, [pPanel, &panelArgs]() {
+                return pPanel->operate(PAS_PanelType_ReadSensors, panelArgs);
+            }));
         }
-
-        spdlog::info("{}: Waiting for last reads to finish...", m_Identity);
-
-        bool stillReading = true;
-        while (stillReading) {
-            stillReading = false;
-            Device::DeviceState state;
-            for (auto mpes : getChildren(PAS_MPESType)) {
-                if (m_selectedMPES.find(mpes->getIdentity().serialNumber) != m_selectedMPES.end()) {
-                    mpes->getState(state);
-                    if (state == Device::DeviceState::Busy) {
-                        stillReading = true;
-                    }
-                    UaThread::sleep(0.1);
-                }
-            };
+        for (unsigned i = 0; i < reads.size(); i++) {
+            if (!reads[i].get().isGood()) {
+                spdlog::error("{}: Failed to read the sensors of Panel {}.", m_Identity,
+                              panelsToRead[i]->getIdentity());
+            }
         }
 
         spdlog::info("{}: Done! All webcams read.", m_Identity);
@@ -1179,13 +1241,27 @@ UaStatus MirrorController::operate(OpcUa_UInt32 offset, const UaVariantArray &ar
         spdlog::info("{}: Error/Status Report:\n{}", m_Identity, os.str());
 
     } else if (offset == PAS_MirrorType_Stop) {
-        spdlog::warn(
-            "{} : MirrorController::operate() : Calling stop(). Stopping motion of all edges and child panels...",
-            m_Identity);
-        for (const auto &pEdge : m_pChildren.at(PAS_EdgeType)) {
-            std::dynamic_pointer_cast<EdgeController>(pEdge)->operate(PAS_EdgeType_Stop);
+        // Every panel server gets one stop request, and all of them are sent before any is answered (each panel
+        // controller calls Stop asynchronously), instead of edge by edge with the panels shared by edges stopped
+        // several times over. The edges and the mirror are then turned off to stop the methods running here.
+        auto start = std::chrono::steady_clock::now();
+        unsigned nPanels = 0;
+        if (m_pChildren.find(PAS_PanelType) != m_pChildren.end()) {
+            for (const auto &pPanel : m_pChildren.at(PAS_PanelType)) {
+                pPanel->operate(PAS_PanelType_Stop);
+                nPanels++;
+            }
+        }
+        if (m_pChildren.find(PAS_EdgeType) != m_pChildren.end()) {
+            for (const auto &pEdge : m_pChildren.at(PAS_EdgeType)) {
+                pEdge->setState(Device::DeviceState::Off);
+            }
         }
         setState(Device::DeviceState::Off); // Turn state off to stop all methods
+        spdlog::warn(
+            "{} : MirrorController::operate() : Calling stop(). Stop sent to {} panels in {:.1f} ms, edges turned off.",
+            m_Identity, nPanels,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
     } else {
         return OpcUa_BadNotImplemented;
     }
@@ -1215,7 +1291,7 @@ UaStatus MirrorController::testActuators(float moveDistance, float epsilonLength
             for (const auto &actuator : std::dynamic_pointer_cast<PanelController>(panel)->getChildren(
                     PAS_ACTType)) {
                 UaVariant var;
-                actuator->getData(PAS_ACTType_CurrentLength, var);
+                actuator->getData(PAS_ACTType_MeasuredLength, var);
                 float initialLength;
                 UaVariant(var).toFloat(initialLength);
                 initialLengths[actuator->getIdentity()] = initialLength;
@@ -1268,7 +1344,7 @@ UaStatus MirrorController::testActuators(float moveDistance, float epsilonLength
             UaVariant(var).toInt32(temp);
             auto errorState = static_cast<Device::ErrorState>(temp);
 
-            actuator->getData(PAS_ACTType_CurrentLength, var);
+            actuator->getData(PAS_ACTType_MeasuredLength, var);
             float currentLength;
             UaVariant(var).toFloat(currentLength);
             float distanceFromTarget = fabs(currentLength - (initialLengths.at(actuator->getIdentity()) +  moveDistance));
@@ -1327,7 +1403,7 @@ UaStatus MirrorController::testActuators(float moveDistance, float epsilonLength
             UaVariant(var).toInt32(temp);
             auto errorState = static_cast<Device::ErrorState>(temp);
 
-            actuator->getData(PAS_ACTType_CurrentLength, var);
+            actuator->getData(PAS_ACTType_MeasuredLength, var);
             float currentLength;
             UaVariant(var).toFloat(currentLength);
             float distanceFromInitial = fabs(currentLength - initialLengths.at(actuator->getIdentity()));
@@ -1347,7 +1423,7 @@ UaStatus MirrorController::testActuators(float moveDistance, float epsilonLength
             os.precision(7);
             for (const auto &actuator : failedActuators[panel->getIdentity()]) {
                 UaVariant var;
-                actuator->getData(PAS_ACTType_CurrentLength, var);
+                actuator->getData(PAS_ACTType_MeasuredLength, var);
                 float currentLength;
                 UaVariant(var).toFloat(currentLength);
 
@@ -1375,25 +1451,47 @@ UaStatus MirrorController::testActuators(float moveDistance, float epsilonLength
 UaStatus MirrorController::readPositionAll(bool print) {
     // Prints panel position of all panels (including OT if selectAll was called first). Calculates TelRF position for all but ignores OT if it is in the list.
     UaStatus status;
-    
+    std::lock_guard<std::recursive_mutex> lock(m_CoordsMutex);
+
+    unsigned nPanels = 0;
+    for (unsigned panelPos : m_selectedPanels)
+        if (SCTMath::Ring(panelPos) != 0)
+            nPanels++;
+    m_PadCoordsActsTelRF.resize(3, 3 * nPanels);
+    m_PadCoordsIdealTelRF.resize(3, 3 * nPanels);
+    m_PadCoordsWork.resize(3, 3 * nPanels);
+    m_PanelCoordsCols.clear();
+    m_PanelCoordsVersions.clear();
+
+    int col = 0;
     for (unsigned panelPos : m_selectedPanels) {
         auto pPanel = std::dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
         pPanel->updateCoords(print);
 
-        auto padCoordsActs = pPanel->getPadCoords();
+        Eigen::Matrix3d padCoordsActs;
+        unsigned long version = pPanel->__getTrackedPadCoords(padCoordsActs);
         if (print) {
             spdlog::info("{}: MirrorController::readPositionAll(): Panel {} frame pad coordinates:\n{}\n", m_Identity, pPanel->getIdentity().position,
                          padCoordsActs);
-            // and transform this to the telescope reference frame:
-            // these are pad coordinates in TRF as computed from actuator lengths
-            if (SCTMath::Ring(pPanel->getIdentity().position) != 0) {
-                for (int i = 0; i < padCoordsActs.cols(); i++)
-                    padCoordsActs.col(i) = __toTelRF(panelPos, padCoordsActs.col(i));
-                spdlog::info("{}: MirrorController::readPositionAll(): Telescope frame pad coordinates:\n{}\n\n\n\n",
-                             m_Identity,
-                             padCoordsActs);
-            }
         }
+        int ring = SCTMath::Ring(panelPos);
+        if (ring == 0)
+            continue;
+
+        // and transform this to the telescope reference frame:
+        // these are pad coordinates in TRF as computed from actuator lengths
+        __transformPoints(__getPanelTransform(panelPos).toTelRF, padCoordsActs, m_PadCoordsActsTelRF.middleCols<3>(col));
+        m_PanelCoordsCols[panelPos] = col;
+        m_PanelCoordsVersions[panelPos] = version;
+        // and the ideal ones, rotated to this panel's place
+        m_PadCoordsIdealTelRF.middleCols<3>(col).noalias() =
+            __rotMat(2, __getAzOffset(panelPos)) * m_PadCoordsTelFrame.at(ring);
+        if (print) {
+            spdlog::info("{}: MirrorController::readPositionAll(): Telescope frame pad coordinates:\n{}\n\n\n\n",
+                         m_Identity,
+                         m_PadCoordsActsTelRF.middleCols<3>(col));
+        }
+        col += 3;
     }
 
     return status;
@@ -1415,6 +1513,7 @@ MirrorController::__calculateMoveDeltaCoords(const Eigen::VectorXd &deltaMirrorC
     spdlog::info("{} : Moving to target coordinates:\n{}\n", m_Identity, targetMirrorCoords);
 
     std::vector<std::shared_ptr<PanelController>> panelsToMove;
+    const Eigen::Affine3d mirrorMotion = __motionTransform(deltaMirrorCoords);
 
     unsigned positionNum;
     Eigen::VectorXd prf_coords;
@@ -1433,16 +1532,13 @@ MirrorController::__calculateMoveDeltaCoords(const Eigen::VectorXd &deltaMirrorC
         // for this panel, we get PRF pad coords, transform them to TRF,
         // move them in TRF, transform back to PRF, and then compute new ACT lengths
         // based on the new pad coords. so simple!
-        auto padCoords_PanelRF = std::dynamic_pointer_cast<PanelController>(pPanel)->getPadCoords();
-        auto padCoords_TelRF = padCoords_PanelRF;
+        // (all in one transform: to TRF, move by the desired telescope coordinates, back to PRF)
+        const PanelTransform &transform = __getPanelTransform(positionNum);
+        Eigen::Matrix3d padCoords_PanelRF;
+        __transformPoints(transform.toPanelRF * mirrorMotion * transform.toTelRF,
+                          std::dynamic_pointer_cast<PanelController>(pPanel)->getPadCoords(), padCoords_PanelRF);
         double newPadCoords[3][3];
         for (unsigned pad = 0; pad < 3; pad++) {
-            // transform to TRF
-            padCoords_TelRF.col(pad) = __toTelRF(positionNum, padCoords_PanelRF.col(pad));
-            // move by the desired telescope coordinates
-            padCoords_TelRF.col(pad) = __moveInCurrentRF(padCoords_TelRF.col(pad), deltaMirrorCoords);
-            // transform back to PRF
-            padCoords_PanelRF.col(pad) = __toPanelRF(positionNum, padCoords_TelRF.col(pad));
             for (unsigned coord = 0; coord < 3; coord++)
                 newPadCoords[pad][coord] = padCoords_PanelRF.col(pad)(coord);
         }
@@ -1482,6 +1578,7 @@ MirrorController::__calculateMoveToCoords(const Eigen::VectorXd &targetMirrorCoo
     spdlog::info("{} : Delta coordinates:\n{}\n", m_Identity, deltaMirrorCoords);
 
     std::vector<std::shared_ptr<PanelController>> panelsToMove;
+    const Eigen::Affine3d mirrorMotion = __motionTransform(deltaMirrorCoords);
 
     unsigned positionNum;
     Eigen::VectorXd prf_coords;
@@ -1500,16 +1597,13 @@ MirrorController::__calculateMoveToCoords(const Eigen::VectorXd &targetMirrorCoo
         // for this panel, we get PRF pad coords, transform them to TRF,
         // move them in TRF, transform back to PRF, and then compute new ACT lengths
         // based on the new pad coords. so simple!
-        auto padCoords_PanelRF = std::dynamic_pointer_cast<PanelController>(pPanel)->getPadCoords();
-        auto padCoords_TelRF = padCoords_PanelRF;
+        // (all in one transform: to TRF, move by the desired telescope coordinates, back to PRF)
+        const PanelTransform &transform = __getPanelTransform(positionNum);
+        Eigen::Matrix3d padCoords_PanelRF;
+        __transformPoints(transform.toPanelRF * mirrorMotion * transform.toTelRF,
+                          std::dynamic_pointer_cast<PanelController>(pPanel)->getPadCoords(), padCoords_PanelRF);
         double newPadCoords[3][3];
         for (unsigned pad = 0; pad < 3; pad++) {
-            // transform to TRF
-            padCoords_TelRF.col(pad) = __toTelRF(positionNum, padCoords_PanelRF.col(pad));
-            // move by the desired telescope coordinates
-            padCoords_TelRF.col(pad) = __moveInCurrentRF(padCoords_TelRF.col(pad), deltaMirrorCoords);
-            // transform back to PRF
-            padCoords_PanelRF.col(pad) = __toPanelRF(positionNum, padCoords_TelRF.col(pad));
             for (unsigned coord = 0; coord < 3; coord++)
                 newPadCoords[pad][coord] = padCoords_PanelRF.col(pad)(coord);
         }
@@ -1559,6 +1653,172 @@ UaStatus MirrorController::alignSequential(const std::string &startEdge, const s
 
     UaStatus status;
 
+    std::vector<std::string> selectedEdges;
+    status = __collectEdges(startEdge, endEdge, dir, selectedEdges);
+    if (status.isBad())
+        return status;
+
+    std::ostringstream os;
+    for (const auto &edge : selectedEdges) {
+        os << edge << std::endl;
+    }
+    spdlog::info("{}: Edges to align sequentially:\n{}", m_Identity, os.str());
+
+    std::deque<std::string> toAlign{}; // yes, deque, not vector!
+    for (int i = 0; i < (int) selectedEdges.size() && m_State != Device::DeviceState::Off; i++) {
+        toAlign.push_front(selectedEdges.at(i));
+        spdlog::info("{}: Aligning Edge {} and all previous edges...", m_Identity, toAlign.front());
+        // align all the preceding panels
+        for (const auto &edgeEaddress : toAlign) {
+            bool wasAligned;
+            status = __alignEdge(edgeEaddress, dir, wasAligned);
+            if (!status.isGood())
+                return status;
+            if (m_State == Device::DeviceState::Off) { break; }
+        }
+    }
+
+    return status;
+}
+
+/// @details Every edge moves its "smaller" panel (in the sense of dir) and reads the MPES it shares with the
+/// "larger" one, so two edges can only disturb each other if they have a panel in common. Edges are greedily
+/// colored on that conflict graph; each color is then a set of edges that can be aligned concurrently. Since the
+/// edges of a ring form a cycle, this gives two or three sets whatever the number of edges.
+UaStatus MirrorController::alignWavefront(const std::string &startEdge, const std::string &endEdge, unsigned dir,
+                                          unsigned maxRounds)
+{
+    UaStatus status;
+
+    std::vector<std::string> selectedEdges;
+    status = __collectEdges(startEdge, endEdge, dir, selectedEdges);
+    if (status.isBad())
+        return status;
+
+    auto edgeSets = __colorEdges(selectedEdges, dir);
+    std::ostringstream os;
+    for (unsigned i = 0; i < edgeSets.size(); i++) {
+        os << "Set " << i << ":";
+        for (const auto &edge : edgeSets.at(i))
+            os << " " << edge;
+        os << std::endl;
+    }
+    spdlog::info("{}: Edges to align in {} concurrent sets:\n{}", m_Identity, edgeSets.size(), os.str());
+
+    for (unsigned round = 1; round <= maxRounds && m_State != Device::DeviceState::Off; round++) {
+        spdlog::info("{}: Wavefront alignment round {}...", m_Identity, round);
+        bool allAligned = true;
+        for (const auto &edgeSet : edgeSets) {
+            // std::vector<bool> packs its elements, so the flags written concurrently need to be separate objects
+            std::unique_ptr<bool[]> wasAligned(new bool[edgeSet.size()]());
+            std::vector<std::future<UaStatus>> futures;
+            futures.reserve(edgeSet.size());
+            for (unsigned i = 0; i < edgeSet.size(); i++) {
+                futures.push_back(std::async(std::launch::async, &MirrorController::__alignEdge, this,
+                                             std::cref(edgeSet.at(i)), dir, std::ref(wasAligned[i])));
+            }
+            // wait for all of them before looking at the results, so none is left moving
+            std::vector<UaStatus> statuses;
+            for (auto &f : futures)
+                statuses.push_back(f.get());
+            for (unsigned i = 0; i < edgeSet.size(); i++) {
+                if (!statuses.at(i).isGood()) {
+                    spdlog::error("{}: Failed to align Edge {}. Method aborted.", m_Identity, edgeSet.at(i));
+                    return statuses.at(i);
+                }
+                allAligned = allAligned && wasAligned[i];
+            }
+            if (m_State == Device::DeviceState::Off) { return status; }
+        }
+        if (allAligned) {
+            spdlog::info("{}: All edges were aligned at the start of round {}. Done.", m_Identity, round);
+            return status;
+        }
+    }
+
+    if (m_State != Device::DeviceState::Off)
+        spdlog::warn("{}: Edges still moved in the last of {} rounds; the mirror may not be fully aligned.",
+                     m_Identity, maxRounds);
+    return status;
+}
+
+/// @details A panel's motion only shows in the sensors of the edges it belongs to, so edges that share no panel can
+/// be measured at the same time without disturbing each other.
+UaStatus MirrorController::findMatrices(double stepSize, const std::string &design, unsigned nPatterns)
+{
+    UaStatus status;
+
+    if (m_selectedEdges.empty()) {
+        spdlog::error("{} : MirrorController::findMatrices() : No Edges selected. Nothing to do, method call aborted.",
+                      m_Identity);
+        return OpcUa_BadInvalidArgument;
+    }
+
+    // the direction only decides which panel of an edge is listed first, not which edges conflict
+    std::vector<std::string> edges(m_selectedEdges.begin(), m_selectedEdges.end());
+    auto edgeSets = __colorEdges(edges, 0);
+    spdlog::info("{}: Measuring response matrices of {} edges in {} concurrent sets.", m_Identity, edges.size(),
+                 edgeSets.size());
+
+    UaVariantArray args;
+    args.create(3);
+    UaVariant var;
+    var.setDouble(stepSize);
+    var.copyTo(&args[0]);
+    var.setString(UaString(design.c_str()));
+    var.copyTo(&args[1]);
+    var.setUInt32(nPatterns);
+    var.copyTo(&args[2]);
+
+    for (const auto &edgeSet : edgeSets) {
+        std::vector<std::future<UaStatus>> futures;
+        for (const auto &edgeEaddress : edgeSet) {
+            auto edge = m_ChildrenEaddressMap.at(PAS_EdgeType).at(edgeEaddress);
+            futures.push_back(std::async(std::launch::async, [edge, &args]() {
+                return edge->operate(PAS_EdgeType_FindMatrixDesigned, args);
+            }));
+        }
+        for (unsigned i = 0; i < edgeSet.size(); i++) {
+            UaStatus edgeStatus = futures.at(i).get();
+            if (!edgeStatus.isGood()) {
+                spdlog::error("{}: Failed to measure the response matrix of Edge {}.", m_Identity, edgeSet.at(i));
+                status = edgeStatus;
+            }
+        }
+        if (!status.isGood() || m_State == Device::DeviceState::Off) { break; }
+    }
+
+    return status;
+}
+
+std::vector<std::vector<std::string>> MirrorController::__colorEdges(const std::vector<std::string> &edges,
+                                                                      unsigned dir)
+{
+    std::vector<std::vector<std::string>> edgeSets;
+    std::vector<std::set<unsigned>> setPanels;
+    for (const auto &edge : edges) {
+        auto panels = SCTMath::GetPanelsFromEdge(edge, dir);
+        unsigned color = 0;
+        for (; color < edgeSets.size(); color++) {
+            bool conflict = false;
+            for (auto panel : panels)
+                conflict = conflict || setPanels.at(color).count(panel);
+            if (!conflict)
+                break;
+        }
+        if (color == edgeSets.size()) {
+            edgeSets.emplace_back();
+            setPanels.emplace_back();
+        }
+        edgeSets.at(color).push_back(edge);
+        setPanels.at(color).insert(panels.begin(), panels.end());
+    }
+    return edgeSets;
+}
+
+UaStatus MirrorController::__collectEdges(const std::string &startEdge, const std::string &endEdge, unsigned dir,
+                                          std::vector<std::string> &selectedEdges)
+{
     if (m_ChildrenEaddressMap.at(PAS_EdgeType).find(startEdge) == m_ChildrenEaddressMap.at(PAS_EdgeType).end()) {
         spdlog::error("{}: Could not find start edge {} in mirror. Method call aborted.", m_Identity, startEdge);
         return OpcUa_Bad;
@@ -1570,7 +1830,7 @@ UaStatus MirrorController::alignSequential(const std::string &startEdge, const s
     }
 
     std::string curEdge = startEdge;
-    std::vector<std::string> selectedEdges = {curEdge};
+    selectedEdges = {curEdge};
     // First collect and calculate all edges (in order) between start edge and end edge in direction
     while (curEdge != endEdge) {
         std::string nextEdge = SCTMath::GetEdgeNeighbor(curEdge, dir);
@@ -1593,98 +1853,98 @@ UaStatus MirrorController::alignSequential(const std::string &startEdge, const s
         }    
     }
 
-    std::ostringstream os;
-    for (const auto &edge : selectedEdges) {
-        os << edge << std::endl;
-    }
-    spdlog::info("{}: Edges to align sequentially:\n{}", m_Identity, os.str());
-
-    std::deque<std::string> toAlign{}; // yes, deque, not vector!
-    for (int i = 0; i < (int) selectedEdges.size() && m_State != Device::DeviceState::Off; i++) {
-        toAlign.push_front(selectedEdges.at(i));
-        spdlog::info("{}: Aligning Edge {} and all previous edges...", m_Identity, toAlign.front());
-        // align all the preceding panels
-        for (const auto &edgeEaddress : toAlign) {
-            // figure out which panel is "greater" and which one is "smaller" in the sense
-            // of dir, assuming a two-panel edge for now.
-            // get vector of panel positions:
-            auto curPanels = SCTMath::GetPanelsFromEdge(edgeEaddress, dir);
-            auto edge = m_ChildrenEaddressMap.at(PAS_EdgeType).at(edgeEaddress);
+    return OpcUa_Good;
+}
 
-            // align this edge moving the "smaller" panel
-            UaVariantArray args; 
-            args.create(4);
-            args[0].Value.UInt32 = curPanels.at(0); // "smaller" panel
-            args[1].Value.UInt32 = curPanels.at(1); // larger panel
-            args[2].Value.Double = 1.0;
-            args[3].Value.String = *UaString("calculate").toOpcUaString(); // first, calculate
-            auto movingPanel = m_ChildrenPositionMap.at(PAS_PanelType).at(curPanels.at(0));
-            // do this until the edge is aligned
-            int alignIter = 1;
-            spdlog::debug("{} Calculating motion for Edge {}...", m_Identity, edgeEaddress);
-            status = edge->operate(PAS_EdgeType_Align, args);
-            spdlog::debug("{} Setting align frac for Edge {}...", m_Identity, edgeEaddress);
-            args[3].Value.String = *UaString("setAlignFrac").toOpcUaString(); // first, calculate
-            status = edge->operate(PAS_EdgeType_Align, args);
-            Device::DeviceState curState;
+UaStatus MirrorController::__alignEdge(const std::string &edgeEaddress, unsigned dir, bool &wasAligned)
+{
+    UaStatus status;
+    wasAligned = false;
+
+    // figure out which panel is "greater" and which one is "smaller" in the sense
+    // of dir, assuming a two-panel edge for now.
+    // get vector of panel positions:
+    auto curPanels = SCTMath::GetPanelsFromEdge(edgeEaddress, dir);
+    auto edge = m_ChildrenEaddressMap.at(PAS_EdgeType).at(edgeEaddress);
+
+    // align this edge moving the "smaller" panel
+    UaVariantArray args; 
+    args.create(4);
+    args[0].Value.UInt32 = curPanels.at(0); // "smaller" panel
+    args[1].Value.UInt32 = curPanels.at(1); // larger panel
+    args[2].Value.Double = 1.0;
+    args[3].Value.String = *UaString("calculate").toOpcUaString(); // first, calculate
+    auto movingPanel = m_ChildrenPositionMap.at(PAS_PanelType).at(curPanels.at(0));
+    // do this until the edge is aligned
+    int alignIter = 1;
+    spdlog::debug("{} Calculating motion for Edge {}...", m_Identity, edgeEaddress);
+    status = edge->operate(PAS_EdgeType_Align, args);
+    spdlog::debug("{} Setting align frac for Edge {}...", m_Identity, edgeEaddress);
+    args[3].Value.String = *UaString("setAlignFrac").toOpcUaString(); // first, calculate
+    status = edge->operate(PAS_EdgeType_Align, args);
+    Device::DeviceState curState;
+    edge->getState(curState);
+    while (curState == Device::DeviceState::Busy) {
+        usleep(500 * 1000); // microseconds
+        edge->getState(curState);
+    }
+    if (m_State == Device::DeviceState::Off) { return status; }
+    args[3].Value.String = *UaString("execute").toOpcUaString(); // first, calculate; // this time, execute
+    spdlog::debug("{}: Executing alignment motion for Edge {}...", m_Identity, edgeEaddress);
+    status = edge->operate(PAS_EdgeType_Align, args);
+    while (curState == Device::DeviceState::Busy) {
+        usleep(500 * 1000); // microseconds
+        edge->getState(curState);
+    }
+    if (!status.isGood()) {
+        spdlog::error("{}: Failed while executing motion. Method aborted.", m_Identity);
+        return status; 
+    }
+    if (m_State == Device::DeviceState::Off) { return status; }
+    wasAligned = std::dynamic_pointer_cast<EdgeController>(edge)->isAligned();
+    while (!std::dynamic_pointer_cast<EdgeController>(edge)->isAligned()) {
+        if (alignIter >= MAX_EDGE_ALIGN_ITERATIONS) {
+            spdlog::error("{}: Edge {} still not aligned after {} iterations. Giving up.", m_Identity, edgeEaddress,
+                          alignIter);
+            return OpcUa_Bad;
+        }
+        spdlog::info("{}: Alignment Iteration {}.", m_Identity, alignIter);
+        usleep(400*1000); // microseconds
+
+        Device::DeviceState curstate;
+        movingPanel->getState(curstate);
+        while (curstate == Device::DeviceState::Busy) {
+            spdlog::debug("{}: Waiting for Panel {}", m_Identity, curPanels.at(0));
+            usleep(200*1000); // microseconds
+            movingPanel->getState(curstate);
+        }
+        alignIter++;
+        args[3].Value.String = *UaString("calculate").toOpcUaString();
+        spdlog::debug("{} Calculating motion for Edge {}...", m_Identity, edgeEaddress);
+        status = edge->operate(PAS_EdgeType_Align, args);
+        spdlog::debug("{} Setting align frac for Edge {}...", m_Identity, edgeEaddress);
+        args[3].Value.String = *UaString("setAlignFrac").toOpcUaString(); // first, calculate
+        status = edge->operate(PAS_EdgeType_Align, args);
+        while (curState == Device::DeviceState::Busy) {
+            usleep(500 * 1000); // microseconds
             edge->getState(curState);
-            while (curState == Device::DeviceState::Busy) {
-                usleep(500 * 1000); // microseconds
-                edge->getState(curState);
-            }
-            if (m_State == Device::DeviceState::Off) { break; }
-            args[3].Value.String = *UaString("execute").toOpcUaString(); // first, calculate; // this time, execute
-            spdlog::debug("{}: Executing alignment motion for Edge {}...", m_Identity, edgeEaddress);
-            status = edge->operate(PAS_EdgeType_Align, args);
-            while (curState == Device::DeviceState::Busy) {
-                usleep(500 * 1000); // microseconds
-                edge->getState(curState);
-            }
-            if (!status.isGood()) {
-                spdlog::error("{}: Failed while executing motion. Method aborted.", m_Identity);
-                return status; 
-            }
-            if (m_State == Device::DeviceState::Off) { break; }
-            while (!std::dynamic_pointer_cast<EdgeController>(edge)->isAligned()) {
-                spdlog::info("{}: Alignment Iteration {}.", m_Identity, alignIter);
-                usleep(400*1000); // microseconds
-
-                Device::DeviceState curstate;
-                movingPanel->getState(curstate);
-                while (curstate == Device::DeviceState::Busy) {
-                    spdlog::debug("{}: Waiting for Panel {}", m_Identity, curPanels.at(0));
-                    usleep(200*1000); // microseconds
-                    movingPanel->getState(curstate);
-                }
-                alignIter++;
-                args[3].Value.String = *UaString("calculate").toOpcUaString();
-                spdlog::debug("{} Calculating motion for Edge {}...", m_Identity, edgeEaddress);
-                status = edge->operate(PAS_EdgeType_Align, args);
-                spdlog::debug("{} Setting align frac for Edge {}...", m_Identity, edgeEaddress);
-                args[3].Value.String = *UaString("setAlignFrac").toOpcUaString(); // first, calculate
-                status = edge->operate(PAS_EdgeType_Align, args);
-                while (curState == Device::DeviceState::Busy) {
-                    usleep(500 * 1000); // microseconds
-                    edge->getState(curState);
-                }
-                if (m_State == Device::DeviceState::Off) { break; }
-                args[3].Value.String = *UaString("execute").toOpcUaString(); // execute motion
-                spdlog::debug("{}: Executing alignment motion for Edge {}...", m_Identity, edgeEaddress);
-                status = edge->operate(PAS_EdgeType_Align, args);
-                if (!status.isGood()) {
-                    spdlog::error("{}: Failed while executing motion. Method aborted.", m_Identity);
-                    return status; 
-                }
-                while (curState == Device::DeviceState::Busy) {
-                    usleep(500 * 1000); // microseconds
-                    edge->getState(curState);
-                }
-                if (m_State == Device::DeviceState::Off) { break; }
-            }
-            spdlog::info("{}: Edge {} aligned.", m_Identity,
-                         edge->getIdentity());
         }
+        if (m_State == Device::DeviceState::Off) { break; }
+        args[3].Value.String = *UaString("execute").toOpcUaString(); // execute motion
+        spdlog::debug("{}: Executing alignment motion for Edge {}...", m_Identity, edgeEaddress);
+        status = edge->operate(PAS_EdgeType_Align, args);
+        if (!status.isGood()) {
+            spdlog::error("{}: Failed while executing motion. Method aborted.", m_Identity);
+            return status; 
+        }
+        while (curState == Device::DeviceState::Busy) {
+            usleep(500 * 1000); // microseconds
+            edge->getState(curState);
+        }
+        if (m_State == Device::DeviceState::Off) { break; }
     }
+    spdlog::info("{}: Edge {} aligned.", m_Identity,
+                 edge->getIdentity());
 
     return status;
 }
@@ -1803,26 +2063,69 @@ void MirrorController::parseAndSetSelection(const std::string &selectionString,
 UaStatus MirrorController::updateCoords(bool print)
 {
     UaStatus status;
+    std::lock_guard<std::recursive_mutex> lock(m_CoordsMutex);
 
     status = readPositionAll(print);
 
+    // everything was read afresh, so fit afresh too
+    __fitMirrorCoords(false, print);
+    m_LastUpdateTime = TIME::now();
+
+    return OpcUa_Good;
+}
+
+void MirrorController::__refreshTrackedCoords()
+{
+    if (!m_HasCoordsFit)
+        return;
+
+    // replace the pads of the panels that moved since the last fit
+    bool changed = false;
+    for (const auto &panelCol : m_PanelCoordsCols) {
+        unsigned panelPos = panelCol.first;
+        auto pPanel = std::dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
+        Eigen::Matrix3d padCoordsActs;
+        unsigned long version = pPanel->__getTrackedPadCoords(padCoordsActs);
+        if (version == m_PanelCoordsVersions.at(panelPos))
+            continue;
+        __transformPoints(__getPanelTransform(panelPos).toTelRF, padCoordsActs,
+                          m_PadCoordsActsTelRF.middleCols<3>(panelCol.second));
+        m_PanelCoordsVersions[panelPos] = version;
+        changed = true;
+    }
+    if (!changed)
+        return;
+
+    spdlog::trace("{} : MirrorController::__refreshTrackedCoords() : Panel coordinates changed, refitting mirror coordinates.",
+                  m_Identity);
+    __fitMirrorCoords(true, false);
+}
+
+void MirrorController::__fitMirrorCoords(bool warmStart, bool print)
+{
     // minimize chisq and get telescope coordinates
-    auto minuit = new TMinuit(6); // 6 parameters for 6 telescope coords
+    std::unique_ptr<TMinuit> minuit(new TMinuit(6)); // 6 parameters for 6 telescope coords
     minuit->SetPrintLevel(-1); // suppress all output
     spdlog::trace("Starting minimize chisq and get telescope coordinates");
 	MirrorControllerCompute::getInstance(this).resetMirror(this);
     minuit->SetFCN(MirrorControllerCompute::getInstance(this).chiSqFCN);
+    // start from the previous fit if asked to (and it is within the limits)
+    const double lowLim[6] = {-20., -20., -10., -0.05, -0.05, -0.05};
+    const double highLim[6] = {20., 20., 40., 0.05, 0.05, 0.05};
+    double start[6] = {0., 0., 0., 0., 0., 0.};
+    for (int i = 0; i < 6 && warmStart && m_HasCoordsFit; i++)
+        start[i] = std::min(std::max(m_curCoords(i), lowLim[i]), highLim[i]);
     // mnparm implements parameter definition:
     // void mnparm(I index, S "name", D start, D step, D LoLim, D HiLim, I& errflag)
     int ierflg;
     // distances in mm
-    minuit->mnparm(0, "x", 0., 0.1, -20., 20., ierflg);
-    minuit->mnparm(1, "y", 0., 0.1, -20., 20., ierflg);
-    minuit->mnparm(2, "z", 0., 0.1, -10., 40., ierflg);
+    minuit->mnparm(0, "x", start[0], 0.1, lowLim[0], highLim[0], ierflg);
+    minuit->mnparm(1, "y", start[1], 0.1, lowLim[1], highLim[1], ierflg);
+    minuit->mnparm(2, "z", start[2], 0.1, lowLim[2], highLim[2], ierflg);
     // angles in radians
-    minuit->mnparm(3, "xRot", 0., 0.0001, -0.05, 0.05, ierflg);
-    minuit->mnparm(4, "yRot", 0., 0.0001, -0.05, 0.05, ierflg);
-    minuit->mnparm(5, "zRot", 0., 0.0001, -0.05, 0.05, ierflg);
+    minuit->mnparm(3, "xRot", start[3], 0.0001, lowLim[3], highLim[3], ierflg);
+    minuit->mnparm(4, "yRot", start[4], 0.0001, lowLim[4], highLim[4], ierflg);
+    minuit->mnparm(5, "zRot", start[5], 0.0001, lowLim[5], highLim[5], ierflg);
 
     // minimize
     double arglist[2] = {5000, 0.1}; // migrad args: max iterations; convergence tolerance
@@ -1831,6 +2134,7 @@ UaStatus MirrorController::updateCoords(bool print)
     // get results back from MINUIT and copy them to current coordinates vars
     for (int i = 0; i < 6; i++)
         minuit->GetParameter(i, m_curCoords(i), m_curCoordsErr(i));
+    m_HasCoordsFit = true;
 
     if (print) {
         std::ostringstream os;
@@ -1842,9 +2146,6 @@ UaStatus MirrorController::updateCoords(bool print)
         //    for (int i = 3; i < 6; i++)
         //       os << m_curCoords(i)*kBaseRadius << " +/- " << m_curCoordsErr(i)*kBaseRadius << std::endl;
     }
-    m_LastUpdateTime = TIME::now();
-
-    return OpcUa_Good;
 }
 
 Eigen::MatrixXd MirrorController::__computeSystematicsMatrix(unsigned pos1, unsigned pos2)
@@ -1884,22 +2185,18 @@ Eigen::MatrixXd MirrorController::__computeSystematicsMatrix(unsigned pos1, unsi
         orig_panelCoords2(coord) = m_pStewartPlatform->GetPanelCoords()[coord];
 
     // handle pads coords of panel 2
+    const PanelTransform &transform1 = __getPanelTransform(pos1);
+    const PanelTransform &transform2 = __getPanelTransform(pos2);
     Eigen::Matrix3d padCoords2;
     Eigen::VectorXd panelCoords2(6);
     Eigen::VectorXd TRANSFORM(6);
     for (auto TR = 0; TR < 6; TR++) {
         TRANSFORM.setZero();
         TRANSFORM(TR) = (TR > 2) ? 1. / 320. : 1.;
+        // To PRF of panel1, moved in PRF of panel1, back to TRF, to PRF of panel2:
+        __transformPoints(transform2.toPanelRF * transform1.toTelRF * __motionTransform(TRANSFORM) *
+                          transform1.toPanelRF, orig_padCoords2, padCoords2);
         for (auto pad = 0; pad < 3; pad++) {
-            // To PRF::
-            padCoords2.col(pad) = __toPanelRF(pos1, orig_padCoords2.col(pad));
-            // Moved in PRF of panel1:
-            padCoords2.col(pad) = __moveInCurrentRF(padCoords2.col(pad), TRANSFORM);
-            // back to TRF:
-            padCoords2.col(pad) = __toTelRF(pos1, padCoords2.col(pad));
-            // to PRF of panel2:
-            padCoords2.col(pad) = __toPanelRF(pos2, padCoords2.col(pad));
-
             for (unsigned coord = 0; coord < 3; coord++)
                 PadCoords[pad][coord] = padCoords2.col(pad)(coord);
         }
@@ -2303,125 +2600,21 @@ UaStatus MirrorController::__calculateAlignRing(int fixPanel)
 UaStatus MirrorController::saveActuatorLengths(const std::string &saveFilePath) {
     // Will save all panel positions, including OT, if it is a child of this mirror.
     spdlog::info("{}: Attempting to write Mirror position to file {}...", m_Identity, saveFilePath);
-
-    //Check if file already exists
-    struct stat buf{};
-    if (stat(saveFilePath.c_str(), &buf) != -1) {
-        spdlog::error(
-            "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
-            m_Identity, saveFilePath);
-        return OpcUa_Bad;
-    }
-
-    std::vector<double> AzEl;
-    AzEl = getAzEl();
-
-    // Create output file stream
-    std::ofstream f(saveFilePath);
-
-    if (f.bad()) {
-        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, saveFilePath);
-        f.close();
-        return OpcUa_Bad;
-    }
-
-    // Place mirror name/Type and
-    // other information at top of file
-    f << "Mirror: " << m_Identity << std::endl;
-    std::time_t now = std::time(0);
-    f << "Timestamp: " << std::ctime(&now) << std::endl;
-    f << "Global coordinates:\n " << m_curCoords << std::endl;
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-    f << SAVEFILE_DELIMITER << std::endl;
-
-    for (unsigned panelPos : m_selectedPanels) {
-        auto pPanel = std::dynamic_pointer_cast<PanelController>(
-            m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
-        Eigen::VectorXd actuatorLengths(6);
-        UaStatus status = std::dynamic_pointer_cast<PanelController>(pPanel)->__getActuatorLengths(actuatorLengths);
-        if (status.isBad()) {
-            spdlog::error("{}: Unable to write position for Panel {}, failed to read actuator lengths.", m_Identity, pPanel->getIdentity());
-            continue;
-        }
-        f << "Panel: " << pPanel->getIdentity() << std::endl;
-        f << actuatorLengths << std::endl;
-        f << SAVEFILE_DELIMITER << std::endl;
-    }
-
-    AzEl = getAzEl();
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-
-    f.close();
-    spdlog::info("{}: Done writing Mirror position to file {}.", m_Identity, saveFilePath);
-
-    return OpcUa_Good;
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
+    return __writeSnapshotText(snapshot, MirrorSnapshot::ACTUATOR_LENGTHS, saveFilePath);
 }
 
 UaStatus MirrorController::savePanelPhysicalCoords(const std::string &saveFilePath) {
     // Will save all panel positions, including OT, if it is a child of this mirror.
     spdlog::info("{}: Attempting to write Mirror position to file {}...", m_Identity, saveFilePath);
-
-    //Check if file already exists
-    struct stat buf{};
-    if (stat(saveFilePath.c_str(), &buf) != -1) {
-        spdlog::error(
-                "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
-                m_Identity, saveFilePath);
-        return OpcUa_Bad;
-    }
-
-    std::vector<double> AzEl;
-    AzEl = getAzEl();
-
-    // Create output file stream
-    std::ofstream f(saveFilePath);
-
-    if (f.bad()) {
-        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, saveFilePath);
-        f.close();
-        return OpcUa_Bad;
-    }
-
-    // Place mirror name/Type and
-    // other information at top of file
-    f << "Mirror: " << m_Identity << std::endl;
-    std::time_t now = std::time(0);
-    f << "Timestamp: " << std::ctime(&now) << std::endl;
-    f << "Global coordinates:\n " << m_curCoords << std::endl;
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-    f << SAVEFILE_DELIMITER << std::endl;
-
-    StewartPlatform SP;
-    for (unsigned panelPos : m_selectedPanels) {
-        auto pPanel = std::dynamic_pointer_cast<PanelController>(
-                m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
-        Eigen::VectorXd actuatorLengths(6);
-        Eigen::VectorXd physicalCoords(6);
-        UaStatus status = std::dynamic_pointer_cast<PanelController>(pPanel)->__getActuatorLengths(actuatorLengths);
-        if (status.isBad()) {
-            spdlog::error("{}: Unable to write position for Panel {}, failed to read actuator lengths.", m_Identity, pPanel->getIdentity());
-            continue;
-        }
-
-        SP.SetPanelType(StewartPlatform::PanelType::OPT);
-        // update current coordinates
-        SP.ComputeStewart(actuatorLengths.data());
-        // panel coords
-        for (int i = 0; i < 6; i++)
-            physicalCoords[i] = SP.GetPanelCoords()[i];
-
-        f << "Panel: " << pPanel->getIdentity() << std::endl;
-        f << physicalCoords << std::endl;
-        f << SAVEFILE_DELIMITER << std::endl;
-    }
-
-    AzEl = getAzEl();
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-
-    f.close();
-    spdlog::info("{}: Done writing Mirror position to file {}.", m_Identity, saveFilePath);
-
-    return OpcUa_Good;
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
+    return __writeSnapshotText(snapshot, MirrorSnapshot::PANEL_COORDS, saveFilePath);
 }
 
 std::vector<double> MirrorController::getAzEl() {
@@ -2453,205 +2646,217 @@ std::vector<double> MirrorController::getAzEl() {
 UaStatus MirrorController::savePanelTemperatures(const std::string &saveFilePath) {
     // Will save all panel temperatures, including OT, if it is a child of this mirror.
     spdlog::info("{}: Attempting to write Panel Temperatures to file {}...", m_Identity, saveFilePath);
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
+    return __writeSnapshotText(snapshot, MirrorSnapshot::PANEL_TEMPERATURES, saveFilePath);
+}
 
-    //Check if file already exists
-    struct stat buf{};
-    if (stat(saveFilePath.c_str(), &buf) != -1) {
-        spdlog::error(
-                "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
-                m_Identity, saveFilePath);
-        return OpcUa_Bad;
-    }
+UaStatus MirrorController::saveMPESAlignmentOffset(const std::string &saveFilePath) {
+    spdlog::info("{}: Attempting to write alignment offset to file {}...", m_Identity, saveFilePath);
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
+    return __writeSnapshotText(snapshot, MirrorSnapshot::MPES_ALIGNMENT_OFFSETS, saveFilePath);
+}
 
-    std::vector<double> AzEl;
-    AzEl = getAzEl();
+UaStatus MirrorController::saveMPESPositions(const std::string &saveFilePath) {
+    spdlog::info("{}: Attempting to write MPES Positions to file {}...", m_Identity, saveFilePath);
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
+    return __writeSnapshotText(snapshot, MirrorSnapshot::MPES_POSITIONS, saveFilePath);
+}
 
-    // Create output file stream
-    std::ofstream f(saveFilePath);
+UaStatus MirrorController::saveSnapshot(const std::string &saveFilePath, bool textExport) {
+    MirrorSnapshot snapshot;
+    UaStatus status = __acquireSnapshot(snapshot);
+    if (status.isBad())
+        return status;
 
-    if (f.bad()) {
-        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, saveFilePath);
-        f.close();
+    if (!snapshot.save(saveFilePath)) {
+        spdlog::error("{}: Failed to write Mirror snapshot to file {}.", m_Identity, saveFilePath);
         return OpcUa_Bad;
     }
+    spdlog::info("{}: Wrote snapshot of {} panels and {} MPES to file {}.", m_Identity, snapshot.panels.size(),
+                 snapshot.mpes.size(), saveFilePath);
 
-    // Place mirror name/Type and
-    // other information at top of file
-    f << "Mirror: " << m_Identity << std::endl;
-    std::time_t now = std::time(0);
-    f << "Timestamp: " << std::ctime(&now) << std::endl;
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-
-    f << SAVEFILE_DELIMITER << std::endl;
-
-    UaVariant vtmp;
-    double intTemp, extTemp;
-    UaStatus status;
-    for (unsigned panelPos : m_selectedPanels) {
-        auto pPanel = std::dynamic_pointer_cast<PanelController>(
-                m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
-        status = std::dynamic_pointer_cast<PanelController>(pPanel)->getData(PAS_PanelType_ExtTemperature, vtmp);
-        if (status.isBad()) {
-            spdlog::error("{}: Unable to write temperature for Panel {}, failed to read temperature.", m_Identity, pPanel->getIdentity());
-            continue;
-        }
-        else {
-            vtmp.toDouble(extTemp);
-        }
-        status = std::dynamic_pointer_cast<PanelController>(pPanel)->getData(PAS_PanelType_IntTemperature, vtmp);
-        if (status.isBad()) {
-            spdlog::error("{}: Unable to write temperature for Panel {}, failed to read temperature.", m_Identity, pPanel->getIdentity());
-            continue;
-        }
-        else {
-            vtmp.toDouble(intTemp);
+    if (textExport) {
+        const std::vector<std::pair<MirrorSnapshot::TextView, std::string>> views = {
+            {MirrorSnapshot::ACTUATOR_LENGTHS,       "_actuatorLengths"},
+            {MirrorSnapshot::PANEL_COORDS,           "_physicalCoords"},
+            {MirrorSnapshot::PANEL_TEMPERATURES,     "_temperatures"},
+            {MirrorSnapshot::MPES_POSITIONS,         "_MPESPositions"},
+            {MirrorSnapshot::MPES_ALIGNMENT_OFFSETS, "_MPESAlignmentOffset"}};
+        // the binary snapshot above replaces any earlier one at this path, and so do its text views
+        for (const auto &view : views) {
+            UaStatus viewStatus = __writeSnapshotText(snapshot, view.first, saveFilePath + view.second, true);
+            if (viewStatus.isBad())
+                status = viewStatus;
         }
-        f << "Panel: " << pPanel->getIdentity() << std::endl;
-        f << intTemp << std::endl;
-        f << extTemp << std::endl;
-        f << SAVEFILE_DELIMITER << std::endl;
     }
 
-    AzEl = getAzEl();
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-
-    f.close();
-    spdlog::info("{}: Done writing Mirror temperature to file {}.", m_Identity, saveFilePath);
-
-    return OpcUa_Good;
+    return status;
 }
 
-UaStatus MirrorController::saveMPESAlignmentOffset(const std::string &saveFilePath) {
-    spdlog::info("{}: Attempting to write alignment offset to file {}...", m_Identity, saveFilePath);
-
-    //Check if file already exists
-    struct stat buf{};
-    if (stat(saveFilePath.c_str(), &buf) != -1) {
-        spdlog::error(
-            "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
-            m_Identity, saveFilePath);
-        return OpcUa_Bad;
+// One read request for the whole mirror -- the actuator lengths and temperatures of the selected panels, and the
+// readings of the selected MPES -- instead of a request per variable.
+UaStatus MirrorController::__acquireSnapshot(MirrorSnapshot &snapshot) {
+    snapshot = MirrorSnapshot();
+    snapshot.header.mirror = MirrorSnapshot::toRecordIdentity(m_Identity);
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_CoordsMutex);
+        __refreshTrackedCoords();
+        for (int i = 0; i < 6; i++) {
+            snapshot.header.coords[i] = m_curCoords(i);
+            snapshot.header.coordsErr[i] = m_curCoordsErr(i);
+        }
     }
+    std::vector<double> AzEl = getAzEl();
+    snapshot.header.az = AzEl[0];
+    snapshot.header.el = AzEl[1];
 
-    std::vector<double> AzEl;
-    AzEl = getAzEl();
-
-    // Create output file stream
-    std::ofstream f(saveFilePath);
-
-    if (f.bad()) {
-        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, saveFilePath);
-        f.close();
-        return OpcUa_Bad;
+    std::vector<std::string> nodesToRead;
+    std::vector<std::shared_ptr<PanelController>> panels;
+    for (unsigned panelPos : m_selectedPanels) {
+        auto pPanel = std::dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos));
+        if (pPanel->getActuatorCount() != 6) {
+            spdlog::error("{}: Panel {} has {} actuators, leaving it out of the snapshot.", m_Identity,
+                          pPanel->getIdentity(), pPanel->getActuatorCount());
+            continue;
+        }
+        panels.push_back(pPanel);
+        for (int i = 1; i <= 6; i++)
+            nodesToRead.push_back(
+                m_pClient->getDeviceNodeId(pPanel->getChildAtPosition(PAS_ACTType, i)->getIdentity()) + ".MeasuredLength");
+        std::string panelNodeId = m_pClient->getDeviceNodeId(pPanel->getIdentity());
+        nodesToRead.push_back(panelNodeId + ".InternalTemperature");
+        nodesToRead.push_back(panelNodeId + ".ExternalTemperature");
     }
 
-    // Place mirror name/Type and
-    // other information at top of file
-    f << "Mirror: " << m_Identity << std::endl;
-    std::time_t now = std::time(0);
-    f << "Timestamp: " << std::ctime(&now) << std::endl;
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-    f << SAVEFILE_DELIMITER << std::endl;
-
-    std::vector<std::shared_ptr<MPESController>> alignMPES;
+    const std::vector<std::string> mpesVariables = {"xCentroidAvg", "yCentroidAvg", "xCentroidNominal",
+                                                    "yCentroidNominal", "RawTimestamp"};
+    std::vector<std::shared_ptr<MPESController>> sensors;
     for (int mpesSerial : m_selectedMPES) {
-        std::shared_ptr<MPESController> mpes = std::dynamic_pointer_cast<MPESController>(
-            m_ChildrenSerialMap.at(PAS_MPESType).at(mpesSerial));
-        //if (mpes->isVisible())
-        //    alignMPES.push_back(mpes);
-        alignMPES.push_back(mpes);
+        auto pMPES = std::dynamic_pointer_cast<MPESController>(m_ChildrenSerialMap.at(PAS_MPESType).at(mpesSerial));
+        sensors.push_back(pMPES);
+        std::string mpesNodeId = m_pClient->getDeviceNodeId(pMPES->getIdentity());
+        for (const auto &var : mpesVariables)
+            nodesToRead.push_back(mpesNodeId + "." + var);
     }
-    UaVariant vtmp;
-    Eigen::VectorXd curRead(2 * alignMPES.size());
-    Eigen::VectorXd targetRead(2 * alignMPES.size());
-    for (int m = 0; m < (int) alignMPES.size(); m++) {
-        alignMPES.at(m)->getData(PAS_MPESType_xCentroidAvg, vtmp);
-        vtmp.toDouble(curRead(m * 2));
-        alignMPES.at(m)->getData(PAS_MPESType_yCentroidAvg, vtmp);
-        vtmp.toDouble(curRead(m * 2 + 1));
-        targetRead.segment(2 * m, 2) = alignMPES.at(m)->getAlignedReadings()
-                                       - alignMPES.at(m)->getSystematicOffsets();
-        f << "MPES: " << alignMPES.at(m)->getIdentity() << std::endl;
-        f << curRead(m * 2)-targetRead(m * 2) << std::endl;
-        f << curRead(m * 2 + 1)-targetRead(m * 2 + 1) << std::endl;
-        f << SAVEFILE_DELIMITER << std::endl;
+
+    std::vector<UaVariant> values(nodesToRead.size());
+    std::vector<UaStatus> itemStatuses;
+    UaStatus status = m_pClient->read(nodesToRead, values.data(), itemStatuses);
+    if (status.isBad()) {
+        spdlog::error("{}: Failed to read the Mirror state ({}).", m_Identity, status.toString().toUtf8());
+        return status;
     }
+    int64_t readTime = MirrorSnapshot::now();
 
-    AzEl = getAzEl();
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
+    auto toDouble = [&](size_t i, double &v) {
+        return itemStatuses[i].isGood() && OpcUa_IsGood(values[i].toDouble(v));
+    };
 
-    f.close();
-    spdlog::info("{}: Done writing Mirror alignment to file {}.", m_Identity, saveFilePath);
+    // panel coordinates from the lengths; neighbouring panels are close, so each solution starts from the last
+    StewartPlatform SP;
+    SP.SetPanelType(StewartPlatform::PanelType::OPT);
+    size_t n = 0;
+    for (const auto &pPanel : panels) {
+        MirrorSnapshot::PanelRecord record{};
+        record.identity = MirrorSnapshot::toRecordIdentity(pPanel->getIdentity());
+        record.timestamp = readTime;
+
+        bool lengthsValid = true;
+        for (int i = 0; i < 6; i++)
+            lengthsValid = toDouble(n++, record.actuatorLengths[i]) && lengthsValid;
+        if (lengthsValid) {
+            record.flags |= MirrorSnapshot::LENGTHS_VALID;
+            SP.ComputeStewart(record.actuatorLengths, 1e-12, true);
+            for (int i = 0; i < 6; i++)
+                record.coords[i] = SP.GetPanelCoords()[i];
+        } else {
+            spdlog::error("{}: Unable to save position for Panel {}, failed to read actuator lengths.", m_Identity,
+                          pPanel->getIdentity());
+        }
 
-    return OpcUa_Good;
-}
+        bool temperaturesValid = toDouble(n, record.internalTemperature);
+        temperaturesValid = toDouble(n + 1, record.externalTemperature) && temperaturesValid;
+        n += 2;
+        if (temperaturesValid)
+            record.flags |= MirrorSnapshot::TEMPERATURES_VALID;
+        else
+            spdlog::error("{}: Unable to save temperature for Panel {}, failed to read temperature.", m_Identity,
+                          pPanel->getIdentity());
+
+        snapshot.panels.push_back(record);
+    }
+
+    for (const auto &pMPES : sensors) {
+        MirrorSnapshot::MPESRecord record{};
+        record.identity = MirrorSnapshot::toRecordIdentity(pMPES->getIdentity());
+
+        bool readingValid = toDouble(n, record.xCentroid);
+        readingValid = toDouble(n + 1, record.yCentroid) && readingValid;
+        bool nominalValid = toDouble(n + 2, record.xNominal);
+        nominalValid = toDouble(n + 3, record.yNominal) && nominalValid;
+        // the sensor reports its reading time in seconds
+        OpcUa_Int64 timestamp = 0;
+        record.timestamp = (itemStatuses[n + 4].isGood() && OpcUa_IsGood(values[n + 4].toInt64(timestamp)) &&
+                            timestamp > 0) ? timestamp * 1000000 : readTime;
+        n += mpesVariables.size();
+
+        record.xSystematicOffset = pMPES->getSystematicOffsets()(0);
+        record.ySystematicOffset = pMPES->getSystematicOffsets()(1);
+        if (readingValid)
+            record.flags |= MirrorSnapshot::READING_VALID;
+        else
+            spdlog::error("{}: Unable to save reading of MPES {}, failed to read it.", m_Identity, pMPES->getIdentity());
+        if (nominalValid)
+            record.flags |= MirrorSnapshot::NOMINAL_VALID;
 
-UaStatus MirrorController::saveMPESPositions(const std::string &saveFilePath) {
-    spdlog::info("{}: Attempting to write MPES Positions to file {}...", m_Identity, saveFilePath);
+        snapshot.mpes.push_back(record);
+    }
+
+    return status;
+}
 
+UaStatus MirrorController::__writeSnapshotText(const MirrorSnapshot &snapshot, MirrorSnapshot::TextView view,
+                                               const std::string &saveFilePath, bool overwrite) {
     //Check if file already exists
     struct stat buf{};
-    if (stat(saveFilePath.c_str(), &buf) != -1) {
+    if (!overwrite && stat(saveFilePath.c_str(), &buf) != -1) {
         spdlog::error(
-                "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
-                m_Identity, saveFilePath);
+            "{}: File {} already exists. Please select a different path, or manually delete/move/rename the file in your system.",
+            m_Identity, saveFilePath);
         return OpcUa_Bad;
     }
 
-    std::vector<double> AzEl;
-    AzEl = getAzEl();
-
-    // Create output file stream
-    std::ofstream f(saveFilePath);
-
-    if (f.bad()) {
-        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, saveFilePath);
-        f.close();
+    // write next to the target and rename, so a failed write never leaves a truncated file behind
+    std::string tmpFilePath = saveFilePath + ".tmp";
+    std::ofstream f(tmpFilePath, std::ios::trunc);
+    if (!f) {
+        spdlog::error("{}: Cannot write to file at {}. Aborting...", m_Identity, tmpFilePath);
         return OpcUa_Bad;
     }
 
-    // Place mirror name/Type and
-    // other information at top of file
-    f << "Mirror: " << m_Identity << std::endl;
-    std::time_t now = std::time(0);
-    f << "Timestamp: " << std::ctime(&now) << std::endl;
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
-    f << SAVEFILE_DELIMITER << std::endl;
-
-    std::vector<std::shared_ptr<MPESController>> alignMPES;
-    for (int mpesSerial : m_selectedMPES) {
-        std::shared_ptr<MPESController> mpes = std::dynamic_pointer_cast<MPESController>(
-                m_ChildrenSerialMap.at(PAS_MPESType).at(mpesSerial));
-        //if (mpes->isVisible())
-        //    alignMPES.push_back(mpes);
-        alignMPES.push_back(mpes);
-    }
-    UaVariant vtmp;
-    Eigen::VectorXd curRead(2 * alignMPES.size());
-    Eigen::VectorXd targetRead(2 * alignMPES.size());
-    for (int m = 0; m < (int) alignMPES.size(); m++) {
-        alignMPES.at(m)->getData(PAS_MPESType_xCentroidAvg, vtmp);
-        vtmp.toDouble(curRead(m * 2));
-        alignMPES.at(m)->getData(PAS_MPESType_yCentroidAvg, vtmp);
-        vtmp.toDouble(curRead(m * 2 + 1));
-        f << "MPES: " << alignMPES.at(m)->getIdentity() << std::endl;
-        f << curRead(m * 2) << std::endl;
-        f << curRead(m * 2 + 1) << std::endl;
-        f << SAVEFILE_DELIMITER << std::endl;
-    }
-
-    AzEl = getAzEl();
-    f << "Az: " << AzEl[0] << ", El: " << AzEl[1] << std::endl;
+    snapshot.writeText(f, view, SAVEFILE_DELIMITER);
 
     f.close();
-    spdlog::info("{}: Done writing Mirror alignment to file {}.", m_Identity, saveFilePath);
+    if (f.fail() || std::rename(tmpFilePath.c_str(), saveFilePath.c_str()) != 0) {
+        spdlog::error("{}: Failed to write Mirror state to file {}.", m_Identity, saveFilePath);
+        std::remove(tmpFilePath.c_str());
+        return OpcUa_Bad;
+    }
+    spdlog::info("{}: Done writing Mirror state to file {}.", m_Identity, saveFilePath);
 
     return OpcUa_Good;
 }
 
 UaStatus MirrorController::__calculateLoadActuatorLengths(const std::string &loadFilePath) {
-    UaStatus status;
-
     spdlog::info("{}: Attempting to load Mirror position from file {}...", m_Identity, loadFilePath);
 
     //Check if file already exists
@@ -2692,14 +2897,9 @@ UaStatus MirrorController::__calculateLoadActuatorLengths(const std::string &loa
     }
     spdlog::info("{}: Mirror Info:\n Mirror Identity: {}\n{}", m_Identity, m_Identity, os.str());
 
-    Eigen::VectorXd X(m_pChildren.at(PAS_PanelType).size() * 6);
-    Eigen::VectorXd deltaActLengths(6);
-    Eigen::VectorXd targetActLengths(6);
-    Eigen::VectorXd currentActLengths(6);
-    std::vector<std::shared_ptr<PanelController>> panelsToMove;
-    unsigned j = 0;
 
     // Parse all target actuator lengths
+    Eigen::VectorXd targetActLengths(6);
     Device::Identity panelId;
     int i = 0;
 
@@ -2722,6 +2922,21 @@ UaStatus MirrorController::__calculateLoadActuatorLengths(const std::string &loa
         spdlog::info("{}: Found position for Panel {}:\n{}\n", m_Identity, panelId, targetActLengths);
     }
 
+    return __calculateMoveToActuatorLengths(panelPositions, PAS_MirrorType_LoadActuatorLengths);
+}
+
+UaStatus MirrorController::__calculateMoveToActuatorLengths(
+    const std::map<Device::Identity, Eigen::VectorXd> &panelPositions, unsigned methodTypeId) {
+    UaStatus status;
+    Device::Identity panelId;
+
+    Eigen::VectorXd X(m_pChildren.at(PAS_PanelType).size() * 6);
+    Eigen::VectorXd deltaActLengths(6);
+    Eigen::VectorXd targetActLengths(6);
+    Eigen::VectorXd currentActLengths(6);
+    std::vector<std::shared_ptr<PanelController>> panelsToMove;
+    unsigned j = 0;
+
     for (const auto &pPanel : m_pChildren.at(PAS_PanelType)) {
         status = std::dynamic_pointer_cast<PanelController>(pPanel)->operate(PAS_PanelType_ReadPosition);
         panelId = std::dynamic_pointer_cast<PanelController>(pPanel)->getIdentity();
@@ -2761,11 +2976,95 @@ UaStatus MirrorController::__calculateLoadActuatorLengths(const std::string &loa
 
     m_Xcalculated = X;
     m_panelsToMove = panelsToMove;
-    m_previousCalculatedMethod = PAS_MirrorType_LoadActuatorLengths;
+    m_previousCalculatedMethod = methodTypeId;
 
     return status;
 }
 
+UaStatus MirrorController::__calculateLoadSnapshot(const std::string &loadFilePath) {
+    spdlog::info("{}: Attempting to load Mirror snapshot from file {}...", m_Identity, loadFilePath);
+
+    MirrorSnapshot snapshot;
+    if (!snapshot.load(loadFilePath)) {
+        spdlog::error("{}: File {} could not be loaded. Please make sure the selected file path is valid.", m_Identity,
+                      loadFilePath);
+        return OpcUa_Bad;
+    }
+
+    Device::Identity mirrorId = MirrorSnapshot::fromRecordIdentity(snapshot.header.mirror);
+    if (mirrorId != m_Identity) {
+        spdlog::error(
+            "{}: Mirror Identity indicated in file ({}) does not match the Identity of this mirror ({}). Cannot load position.",
+            m_Identity, mirrorId, m_Identity);
+        return OpcUa_Bad;
+    }
+    std::time_t time = snapshot.header.timestamp / 1000000;
+    spdlog::info("{}: Mirror snapshot taken at {}Az: {}, El: {}", m_Identity, std::ctime(&time),
+                 snapshot.header.az, snapshot.header.el);
+
+    std::map<Device::Identity, Eigen::VectorXd> panelPositions;
+    for (const auto &panel : snapshot.panels) {
+        if (!(panel.flags & MirrorSnapshot::LENGTHS_VALID))
+            continue;
+        Device::Identity panelId = MirrorSnapshot::fromRecordIdentity(panel.identity);
+        panelPositions[panelId] = Eigen::Map<const Eigen::VectorXd>(panel.actuatorLengths, 6);
+        spdlog::info("{}: Found position for Panel {}:\n{}\n", m_Identity, panelId, panelPositions[panelId]);
+    }
+
+    return __calculateMoveToActuatorLengths(panelPositions, PAS_MirrorType_LoadSnapshot);
+}
+
+/// @details The model is rebuilt from the snapshots on every call, so that a snapshot saved after the last alignment
+/// is used right away. Panels missing from the model, or without a logged temperature, are left where they are or
+/// moved without the temperature correction.
+UaStatus MirrorController::__calculateLoadElevationModel(const std::string &modelDirectory, double el) {
+    spdlog::info("{}: Building the panel position model from the snapshots in {}...", m_Identity, modelDirectory);
+
+    PanelPositionModel model(m_Identity);
+    if (!model.loadDirectory(modelDirectory)) {
+        spdlog::error("{}: No usable snapshots of this mirror in {}. Cannot load position.", m_Identity,
+                      modelDirectory);
+        return OpcUa_Bad;
+    }
+    model.fit();
+
+    // current temperatures (and elevation) in one read
+    MirrorSnapshot current;
+    __acquireSnapshot(current);
+    if (el < 0.)
+        el = current.header.el;
+    if (el < 0.) {
+        spdlog::error("{}: Current elevation unknown and none given. Cannot load position.", m_Identity);
+        return OpcUa_Bad;
+    }
+    std::map<Device::Identity, double> temperatures;
+    for (const auto &panel : current.panels) {
+        if (panel.flags & MirrorSnapshot::TEMPERATURES_VALID)
+            temperatures[MirrorSnapshot::fromRecordIdentity(panel.identity)] = panel.externalTemperature;
+    }
+    spdlog::info("{}: Predicting aligned positions at El: {} from {} snapshots.", m_Identity, el,
+                 model.getSampleCount());
+
+    std::map<Device::Identity, Eigen::VectorXd> panelPositions;
+    for (const auto &pPanel : m_pChildren.at(PAS_PanelType)) {
+        Device::Identity panelId = pPanel->getIdentity();
+        auto it = temperatures.find(panelId);
+        double temperature = (it != temperatures.end()) ? it->second : std::numeric_limits<double>::quiet_NaN();
+        Eigen::VectorXd targetActLengths;
+        if (!model.predict(panelId, el, temperature, targetActLengths))
+            continue;
+
+        auto range = model.getElevationRange(panelId);
+        if (el < range.first || el > range.second)
+            spdlog::warn("{}: El {} is outside the logged range for Panel {} ({} to {}); using the nearest end.",
+                         m_Identity, el, panelId, range.first, range.second);
+        panelPositions[panelId] = targetActLengths;
+        spdlog::info("{}: Predicted position for Panel {}:\n{}\n", m_Identity, panelId, targetActLengths);
+    }
+
+    return __calculateMoveToActuatorLengths(panelPositions, PAS_MirrorType_LoadElevationModel);
+}
+
 UaStatus MirrorController::__calculateLoadDeltaCoords(const std::string &loadFilePath) {
     UaStatus status;
 
@@ -2820,6 +3119,7 @@ UaStatus MirrorController::__calculateLoadDeltaCoords(const std::string &loadFil
     unsigned j = 0;
 
     // Parse all target actuator lengths
+    Eigen::VectorXd targetActLengths(6);
     Device::Identity panelId;
     int i = 0;
 
@@ -3349,7 +3649,7 @@ UaStatus MirrorController::__moveSelectedPanels(unsigned methodTypeId, double al
                 int temp;
                 UaVariant(var).toInt32(temp);
                 auto errorState = static_cast<Device::ErrorState>(temp);
-                actuator->getData(PAS_ACTType_CurrentLength, var);
+                actuator->getData(PAS_ACTType_MeasuredLength, var);
                 float finalLength;
                 UaVariant(var).toFloat(finalLength);
                 finalLengths[actuator->getIdentity()] = finalLength;
@@ -3409,36 +3709,37 @@ double MirrorController::__getAzOffset(unsigned pos)
 }
 
 
-Eigen::Vector3d MirrorController::__toPanelRF(unsigned pos, const Eigen::Vector3d &in_coords)
+const MirrorController::PanelTransform &MirrorController::__getPanelTransform(unsigned pos)
 {
-    // all angles in radians
+    auto it = m_PanelTransforms.find(pos);
+    if (it != m_PanelTransforms.end())
+        return it->second;
 
+    // all angles in radians
     int ring = SCTMath::Ring(pos);
     double phi = __getAzOffset(pos);
 
     // this panel's frame is the rotated frame of the ideal panel
     Eigen::Matrix3d zRot = __rotMat(2, phi);
-    Eigen::Matrix3d panelFrame = zRot * m_PanelFrame.at(ring);
-    Eigen::Vector3d panelOrigin = zRot * m_PanelOriginTelFrame.at(ring);
+    PanelTransform transform;
+    transform.toTelRF.linear() = zRot * m_PanelFrame.at(ring);
+    transform.toTelRF.translation() = zRot * m_PanelOriginTelFrame.at(ring);
+    transform.toTelRF.makeAffine();
+    // remember panel frame is an orthogonal matrix -- very simple inversion
+    transform.toPanelRF = transform.toTelRF.inverse(Eigen::Isometry);
 
-    return panelFrame.transpose() * (in_coords - panelOrigin);
+    return m_PanelTransforms.emplace(pos, transform).first->second;
+}
+
+Eigen::Vector3d MirrorController::__toPanelRF(unsigned pos, const Eigen::Vector3d &in_coords)
+{
+    return __getPanelTransform(pos).toPanelRF * in_coords;
 }
 
 Eigen::Vector3d MirrorController::__toTelRF(unsigned pos, const Eigen::Vector3d &in_coords)
 {
-    // all angles in radians
     // The inverse of the above
-
-    int ring = SCTMath::Ring(pos);
-    double phi = __getAzOffset(pos);
-
-    // this panel's frame is the rotated frame of the ideal panel
-    Eigen::Matrix3d zRot = __rotMat(2, phi);
-    Eigen::Matrix3d panelFrame = zRot * m_PanelFrame.at(ring);
-    Eigen::Vector3d panelOrigin = zRot * m_PanelOriginTelFrame.at(ring);
-
-    // remember panel frame is an orthogonal matrix -- very simple inversion
-    return panelFrame * in_coords + panelOrigin;
+    return __getPanelTransform(pos).toTelRF * in_coords;
 }
 
 Eigen::Matrix3d MirrorController::__rotMat(int axis, double a)
@@ -3463,68 +3764,48 @@ Eigen::Matrix3d MirrorController::__rotMat(int axis, double a)
     return rot;
 }
 
-Eigen::Vector3d MirrorController::__moveInCurrentRF(const Eigen::Vector3d &in_vec, const Eigen::VectorXd &tr_coords)
+Eigen::Affine3d MirrorController::__motionTransform(const Eigen::Ref<const Eigen::VectorXd> &tr_coords)
 {
-    // check that we have 6 coords. if not, resize if necessary
-    Eigen::VectorXd tr(6);
-    tr.head(tr_coords.size()) = tr_coords;
-    if (tr_coords.size() != 6)
-        tr.tail(6 - tr_coords.size()).setZero();
+    // missing coords are zero
+    double tr[6] = {0., 0., 0., 0., 0., 0.};
+    for (int i = 0; i < std::min<int>(tr_coords.size(), 6); i++)
+        tr[i] = tr_coords(i);
 
-    Eigen::Vector3d out_vec = in_vec;
     // compute the transform due to the change in TRF: Rot(z -> x -> y)*v + T
-    out_vec = __rotMat(2, tr(5)) * out_vec;
-    out_vec = __rotMat(0, tr(3)) * out_vec;
-    out_vec = __rotMat(1, tr(4)) * out_vec;
-    out_vec += tr.head(3);
+    Eigen::Affine3d transform;
+    transform.linear() = __rotMat(1, tr[4]) * __rotMat(0, tr[3]) * __rotMat(2, tr[5]);
+    transform.translation() = Eigen::Vector3d(tr[0], tr[1], tr[2]);
+    transform.makeAffine();
+    return transform;
+}
 
-    return out_vec;
+Eigen::Vector3d MirrorController::__moveInCurrentRF(const Eigen::Vector3d &in_vec, const Eigen::VectorXd &tr_coords)
+{
+    return __motionTransform(tr_coords) * in_vec;
+}
+
+void MirrorController::__transformPoints(const Eigen::Affine3d &transform,
+                                         const Eigen::Ref<const Eigen::Matrix3Xd> &in_coords,
+                                         Eigen::Ref<Eigen::Matrix3Xd> out_coords)
+{
+    out_coords.noalias() = transform.linear() * in_coords;
+    out_coords.colwise() += transform.translation();
 }
 
 
 
 /* ============== MINUIT INTERFACE ============== */
-double MirrorController::chiSq(const Eigen::VectorXd &telDelta)
+double MirrorController::chiSq(const Eigen::Matrix<double, 6, 1> &telDelta)
 {
     // Ignores OT even if it is in the selectedPanels list.
-    // tel delta is a perturbation to the coordinates of the mirror
-    double chiSq = 0.;
-    // pad coordinates in TRF as computed from actuator lengths
-    Eigen::Vector3d padCoordsActs;
-    // pad coordinates in TRF as computed from telescope perturbation
-    Eigen::Vector3d padCoordsTel;
-
-    UaVariant val;
-    // go over all panels
-    for (unsigned panelPos : m_selectedPanels) {
-        int pos = (int)panelPos;
-        int ring = SCTMath::Ring(pos);
-        if (ring == 0){
-            continue;
-        }
-
-        // go over all pads -- ChiSq is the squared difference between pad coordinates
-        // as computed from actuator lengths and pad coordinates as computed from telescope
-        // coordinates
-        for (int pad = 0; pad < 3; pad++) {
-            padCoordsActs = std::dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panelPos))->getPadCoords().col(
-                pad);
-            // and transform this to the telescope reference frame:
-            // these are pad coordinates in TRF as computed from actuator lengths
-            padCoordsActs = __toTelRF(pos, padCoordsActs);
-
-            // compute telescope frame pad coordinates by transforming the ideal ones
-            padCoordsTel = __rotMat(2, __getAzOffset(pos)) * m_PadCoordsTelFrame.at(ring).col(pad);
-            // compute transform by the telescope perturbation: Rot(z -> x -> y)*v + T
-            padCoordsTel = __moveInCurrentRF(padCoordsTel, telDelta);
-            // padCoordsTel are the pad coords in TRF as computed from Tel coords
-
-            // change the value of ChiSq:
-            chiSq += (padCoordsTel - padCoordsActs).squaredNorm();
-        }
-    }
-
-    return chiSq;
+    // tel delta is a perturbation to the coordinates of the mirror.
+    // ChiSq is the squared difference between pad coordinates as computed from actuator lengths
+    // (m_PadCoordsActsTelRF) and pad coordinates as computed from telescope coordinates: the ideal ones,
+    // transformed by the telescope perturbation Rot(z -> x -> y)*v + T
+    __transformPoints(__motionTransform(telDelta), m_PadCoordsIdealTelRF, m_PadCoordsWork);
+    m_PadCoordsWork -= m_PadCoordsActsTelRF;
+
+    return m_PadCoordsWork.squaredNorm();
 }
 
 void MirrorControllerCompute::chiSqFCN(int &npar, double *gin, double &f, double *par, int iflag) // MINUIT interface
@@ -2,11 +2,14 @@
 #define __PASMIRROR_H__
 
 #include <cfloat>
+#include <mutex>
 #include <set>
 
 #include "TObject.h" // to be able to use ROOT's MINUIT implementation
 
 #include <Eigen/Dense> // Eigen3 for linear algebra needs
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
 
 #include "common/alignment/device.hpp"
 #include "common/simulatestewart/stewartplatform.hpp"
@@ -15,6 +18,7 @@
 #include "client/controllers/opttablecontroller.hpp"
 #include "client/controllers/opticalalignmentcontroller.hpp"
 #include "client/controllers/globalalignmentcontroller.hpp"
+#include "client/utilities/mirrorsnapshot.hpp"
 
 class AGeoAsphericDisk;
 
@@ -84,7 +88,7 @@ public:
 
 protected:
     // compute chiSq for all panels given a perturbation to the mirror
-    virtual double chiSq(const Eigen::VectorXd &telDelta);
+    virtual double chiSq(const Eigen::Matrix<double, 6, 1> &telDelta);
 
 private:
     std::string m_Mode;
@@ -116,11 +120,32 @@ private:
     UaStatus saveMPESAlignmentOffset(const std::string &saveFilePath);
     UaStatus saveMPESPositions(const std::string &saveFilePath);
     UaStatus savePanelTemperatures(const std::string &saveFilePath);
+    // binary snapshot of the whole mirror state, overwritten atomically; with textExport, also the text files above
+    // (as <saveFilePath>_actuatorLengths etc.)
+    UaStatus saveSnapshot(const std::string &saveFilePath, bool textExport = false);
 
     std::vector<double> getAzEl();
 
     // Align all edges fron need_alignment starting at start_idx and  moving in the direction dir
     UaStatus alignSequential(const std::string &startEdge, const std::string &EndEdge, unsigned dir);
+    // Align the same edges in rounds: edges that share no panel are aligned at the same time, and rounds repeat
+    // until every edge was already aligned at the start of one, or maxRounds is reached
+    UaStatus alignWavefront(const std::string &startEdge, const std::string &endEdge, unsigned dir,
+                            unsigned maxRounds);
+
+    // edges from startEdge to endEdge, walking in the direction dir
+    UaStatus __collectEdges(const std::string &startEdge, const std::string &endEdge, unsigned dir,
+                            std::vector<std::string> &selectedEdges);
+
+    // measure the response matrices of the selected edges with EdgeController::findMatrixDesigned, running edges
+    // that share no panel at the same time
+    UaStatus findMatrices(double stepSize, const std::string &design, unsigned nPatterns);
+
+    // calculate/execute alignment of one edge, moving its "smaller" panel, until it is aligned
+    UaStatus __alignEdge(const std::string &edgeEaddress, unsigned dir, bool &wasAligned);
+
+    // split edges into sets of edges that move disjoint panels, in their original order
+    std::vector<std::vector<std::string>> __colorEdges(const std::vector<std::string> &edges, unsigned dir);
 
     UaStatus __calculateAlignSector(int align_mode=0);
 
@@ -132,6 +157,22 @@ private:
 
     UaStatus __calculateLoadActuatorLengths(const std::string &loadFilePath);
 
+    UaStatus __calculateLoadSnapshot(const std::string &loadFilePath);
+
+    // aligned actuator lengths at elevation el (the current one if negative), from the snapshots in modelDirectory
+    UaStatus __calculateLoadElevationModel(const std::string &modelDirectory, double el);
+
+    // motion of the panels in panelPositions to their actuator lengths
+    UaStatus __calculateMoveToActuatorLengths(const std::map<Device::Identity, Eigen::VectorXd> &panelPositions,
+                                              unsigned methodTypeId);
+
+    // read the state of the selected panels and MPES in one request
+    UaStatus __acquireSnapshot(MirrorSnapshot &snapshot);
+
+    // written to a temporary file and renamed into place; an existing file is only replaced if overwrite is set
+    UaStatus __writeSnapshotText(const MirrorSnapshot &snapshot, MirrorSnapshot::TextView view,
+                                 const std::string &saveFilePath, bool overwrite = false);
+
     UaStatus __calculateLoadDeltaCoords(const std::string &loadFilePath);
 
     UaStatus __calculateLoadMPESAlignmentOffset(const std::string &loadFilePath);
@@ -172,6 +213,36 @@ private:
     // the direction of the norm of the whole mirror: +1 for Primary, -1 for secondary
     double m_SurfaceNorm = 1.;
 
+    // panel <-> telescope reference frame transforms of a panel position. These depend only on the mirror
+    // geometry, so they are computed once per position, on first use after initialize().
+    struct PanelTransform {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        Eigen::Affine3d toTelRF;
+        Eigen::Affine3d toPanelRF;
+    };
+    std::map<unsigned, PanelTransform, std::less<unsigned>,
+             Eigen::aligned_allocator<std::pair<const unsigned, PanelTransform>>> m_PanelTransforms;
+
+    // pads of all selected panels (OT excluded), 3 columns per panel, in the telescope frame: as computed from
+    // the actuator lengths, and ideal. Refreshed by readPositionAll() whenever the panel coordinates are read,
+    // so chiSq() is one matrix multiply per evaluation.
+    Eigen::Matrix3Xd m_PadCoordsActsTelRF;
+    Eigen::Matrix3Xd m_PadCoordsIdealTelRF;
+    Eigen::Matrix3Xd m_PadCoordsWork; // scratch for chiSq()
+    // first column of each panel's pads in m_PadCoordsActsTelRF, and the version of the panel coordinates they
+    // were computed from -- panels whose coordinates changed since are refreshed and the mirror refit from the
+    // previous fit by __refreshTrackedCoords()
+    std::map<unsigned, int> m_PanelCoordsCols;
+    std::map<unsigned, unsigned long> m_PanelCoordsVersions;
+    bool m_HasCoordsFit = false;
+    // guards the coordinate state above and m_curCoords
+    std::recursive_mutex m_CoordsMutex;
+
+    // fit the mirror coordinates to m_PadCoordsActsTelRF, starting from the current ones if warmStart
+    void __fitMirrorCoords(bool warmStart, bool print);
+    // refit if any panel's coordinates changed since the last fit
+    void __refreshTrackedCoords();
+
     // COORDINATE TRANSFORMATION HELPERS
     // reference frame tansformations:
     double __getAzOffset(unsigned pos);
@@ -189,6 +260,13 @@ private:
     // the output is the transformed 3D vector
     Eigen::Vector3d __moveInCurrentRF(const Eigen::Vector3d &in_vec, const Eigen::VectorXd &tr_coords);
 
+    const PanelTransform &__getPanelTransform(unsigned pos);
+    // the transform __moveInCurrentRF applies: Rot(z -> x -> y)*v + T
+    static Eigen::Affine3d __motionTransform(const Eigen::Ref<const Eigen::VectorXd> &tr_coords);
+    // apply a transform to every column (point) of in_coords
+    static void __transformPoints(const Eigen::Affine3d &transform, const Eigen::Ref<const Eigen::Matrix3Xd> &in_coords,
+                                  Eigen::Ref<Eigen::Matrix3Xd> out_coords);
+
     Eigen::MatrixXd __computeSystematicsMatrix(unsigned pos1, unsigned pos2);
 
     /**** SIMULATED OBJECTS WE RELY ON FOR COMPUTE *****/
@@ -203,6 +281,10 @@ private:
     float m_lastSetAlignFrac;
 
     static const std::string SAVEFILE_DELIMITER;
+    // webcams each panel server lets stream at once in ReadSensorsParallel, to stay within its USB bandwidth
+    static const int MAX_CONCURRENT_WEBCAM_CAPTURES;
+    // iterations __alignEdge runs before giving up on an edge that does not converge
+    static const int MAX_EDGE_ALIGN_ITERATIONS;
 
     UaStatus __moveSelectedPanels(unsigned methodTypeId, double alignFrac);
     UaStatus __setAlignFrac(double alignFrac);
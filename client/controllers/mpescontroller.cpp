@@ -338,6 +338,9 @@ UaStatus MPESController::operate(OpcUa_UInt32 offset, const UaVariantArray &args
     } else if (offset == PAS_MPESType_ClearAllErrors) {
         spdlog::info("{} : MPESController calling clearAllErrors()", m_Identity);
         status = m_pClient->callMethod(m_pClient->getDeviceNodeId(m_Identity), UaString("ClearAllErrors"));
+    } else if (offset == PAS_MPESType_PredictShift) {
+        spdlog::debug("{} : MPESController calling predictShift()", m_Identity);
+        status = m_pClient->callMethod(m_pClient->getDeviceNodeId(m_Identity), UaString("PredictShift"), args);
     } else if (offset == PAS_MPESType_TurnOn) {
         spdlog::info("{} : MPESController calling turnOn()", m_Identity);
         status = m_pClient->callMethod(m_pClient->getDeviceNodeId(m_Identity), UaString("TurnOn"));
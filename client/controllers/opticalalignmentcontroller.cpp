@@ -4,6 +4,7 @@
 #include <chrono>
 #include <cmath>
 #include <deque>
+#include <future>
 #include <set>
 #include <sstream>
 #include <string>
@@ -168,6 +169,13 @@ UaStatus OpticalAlignmentController::operate(OpcUa_UInt32 offset, const UaVarian
     switch (offset) {
         case PAS_OpticalAlignmentType_CalibrateFirstOrderCorr: {
             spdlog::info("OpticalAlignmentController::operate() :  Calling CalibrateFirstOrderCorr...");
+            std::string sector = UaString(args[5].Value.String).toUtf8();
+            if (!focalplane::isSector(sector)) {
+                spdlog::error("{} : OpticalAlignmentController::operate() : Unknown sector {}, must be P1, P2, S1 or S2.",
+                              m_Identity, sector);
+                status = OpcUa_BadInvalidArgument;
+                break;
+            }
 
             _loadPatternImageParameters(); //get best (human derived) parameters to analyze image for this ring that label panels properly.  This should come from focalplaneimage object.
 
@@ -176,8 +184,36 @@ UaStatus OpticalAlignmentController::operate(OpcUa_UInt32 offset, const UaVarian
             m_show_plot = args[2].Value.Boolean; //bool
             m_offset_limit = args[3].Value.Double; // float, in pixels. Max distance to target position
             m_respFile = UaString(args[4].Value.String).toUtf8();
+            m_focalPlaneImage.m_Sector = sector;
 
             m_processing = true;
+            m_batchCalibration = false;
+            start();
+
+            status = OpcUa_Good;
+            break;
+        }
+        case PAS_OpticalAlignmentType_CalibrateFirstOrderCorrBatch: {
+            spdlog::info("OpticalAlignmentController::operate() :  Calling CalibrateFirstOrderCorrBatch...");
+            std::string sector = UaString(args[5].Value.String).toUtf8();
+            if (!focalplane::isSector(sector)) {
+                spdlog::error("{} : OpticalAlignmentController::operate() : Unknown sector {}, must be P1, P2, S1 or S2.",
+                              m_Identity, sector);
+                status = OpcUa_BadInvalidArgument;
+                break;
+            }
+
+            _loadPatternImageParameters();
+
+            m_target_coordinates_center_x = args[0].Value.Double;
+            m_target_coordinates_center_y = args[1].Value.Double;
+            m_show_plot = args[2].Value.Boolean;
+            m_offset_limit = args[3].Value.Double;
+            m_respFile = UaString(args[4].Value.String).toUtf8();
+            m_focalPlaneImage.m_Sector = sector;
+
+            m_processing = true;
+            m_batchCalibration = true;
             start();
 
             status = OpcUa_Good;
@@ -237,233 +273,317 @@ UaStatus OpticalAlignmentController::operate(OpcUa_UInt32 offset, const UaVarian
 }
 
 void OpticalAlignmentController::calibrateFirstOrderCorrection() {
-    double image_delta_x;
-    double image_delta_y;
-    double image_delta_x_resampled;
-    double image_delta_y_resampled;
-    int panel;
-    double distance_panel_to_target;
-    double distance_panel_to_target_resampled;
-    int n_correction_tries;
-
-    Eigen::VectorXd deltaCoords(6);
-    map <int , vector<double>> starting_coordinates_per_panel;
-    map <int , vector<double>> resampled_coordinates_per_panel;
-
-    vector<double> current_panel_coordinates;
-
-    Eigen::VectorXd curr_coords_deltas_for_panel(6);
-    Eigen::VectorXd total_coord_deltas(6);
+    /*
+     * Panels are calibrated one at a time, and every exposure follows the motion of exactly one panel, so the
+     * spot that moved is never in doubt. What overlaps is everything around the motions:
+     *  - the image that ends a panel's calibration also has the rest of the ring in it; its pattern analysis
+     *    (giving the next panel's starting position) runs while the panel returns to the pattern;
+     *  - the image taken after the return, which checks that the panel got back to its place on the ring,
+     *    is analyzed while the next panel moves towards the target and its first image is taken.
+     */
+    std::map<int, std::vector<double>> pattern_coordinates_per_panel; // latest known spot of every panel on the ring
+
+    std::future<std::map<int, std::vector<double>>> pending_return_check;
+    int returned_panel = -1;
+    std::vector<double> returned_panel_expected;
+
+    // wait for the check of the last return, and take the refreshed ring positions from it
+    auto finish_return_check = [&]() {
+        if (!pending_return_check.valid())
+            return;
+        std::map<int, std::vector<double>> refreshed = pending_return_check.get();
+        auto it = refreshed.find(returned_panel);
+        if (it == refreshed.end()) {
+            spdlog::warn("{}: Not found on the ring after returning to the pattern.", returned_panel);
+        } else {
+            double miss = std::hypot(it->second[0] - returned_panel_expected[0],
+                                     it->second[1] - returned_panel_expected[1]);
+            if (miss > m_offset_limit)
+                spdlog::warn("{}: Returned to ({}, {}), {} away from its pattern position.", returned_panel,
+                             it->second[0], it->second[1], miss);
+        }
+        for (const auto &panel_item : refreshed)
+            pattern_coordinates_per_panel[panel_item.first] = panel_item.second;
+    };
 
-#ifdef SIMMODE
-    std::string image_filepath = "/app/focal_plane/data/The Imaging Source Europe GmbH-37514083-2592-1944-Mono8-2019-12-17-03:20:27.raw";
-    m_focalPlaneImage.setDataDir("/app/focal_plane/data/");
-#else
     std::string image_filepath = _captureSingleImage();
-#endif
-    starting_coordinates_per_panel = _analyzeImagePatternAutomatically(image_filepath, m_show_plot);
-    resampled_coordinates_per_panel = starting_coordinates_per_panel;
+    pattern_coordinates_per_panel = _analyzeImagePatternAutomatically(image_filepath, m_show_plot);
 
-    spdlog::debug("Starting loop");
-
-    for (const auto &panel_item : starting_coordinates_per_panel) {
-        if (m_processing) {
-            panel = panel_item.first;
-            current_panel_coordinates = panel_item.second;
-            bool pController_exists =
-                    m_ChildrenPositionMap.at(PAS_PanelType).find(panel) !=
-                    m_ChildrenPositionMap.at(PAS_PanelType).end();
-            bool panel_selected = (m_selectedPanels.find(panel) != m_selectedPanels.end());
-
-            if (!pController_exists | !panel_selected) {
-                spdlog::warn("{}: This panel not available or selected. Moving on...", panel);
-                continue;
-            }
+    // the panels to go through, in order, fixed up front: the map is refreshed as we go
+    std::vector<int> panels;
+    for (const auto &panel_item : pattern_coordinates_per_panel)
+        panels.push_back(panel_item.first);
 
-            spdlog::info("Capturing starting image for panel {}", panel);
-
-#ifdef SIMMODE
-            image_filepath = "/app/focal_plane/data/The Imaging Source Europe GmbH-37514083-2592-1944-Mono8-2019-12-17-03:20:27.raw";
-            m_focalPlaneImage.setDataDir("/app/focal_plane/data/");
-#else
-            image_filepath = _captureSingleImage();
-#endif
-            resampled_coordinates_per_panel = _analyzeImagePatternAutomatically(image_filepath, m_show_plot);
-            spdlog::info("Remeasured pattern in case coordinates changed over time.");
-
-            image_delta_x_resampled =
-                    resampled_coordinates_per_panel.at(panel)[0] - m_target_coordinates_center_x;
-            image_delta_y_resampled =
-                    resampled_coordinates_per_panel.at(panel)[1] - m_target_coordinates_center_y;
-            distance_panel_to_target_resampled = sqrt(image_delta_x_resampled * image_delta_x_resampled +
-                                                      image_delta_y_resampled * image_delta_y_resampled);
+    spdlog::debug("Starting loop");
 
-            image_delta_x = current_panel_coordinates[0] - m_target_coordinates_center_x;
-            image_delta_y = current_panel_coordinates[1] - m_target_coordinates_center_y;
-            distance_panel_to_target = sqrt(image_delta_x * image_delta_x + image_delta_y * image_delta_y);
+    for (int panel : panels) {
+        if (!m_processing)
+            break;
 
-            spdlog::info("{}: New pattern position changed from ({}, {}) to ({}, {}) since this loop started",
-                         panel,
-                         current_panel_coordinates[0], current_panel_coordinates[1],
-                         resampled_coordinates_per_panel.at(panel)[0],
-                         resampled_coordinates_per_panel.at(panel)[1]);
+        bool pController_exists =
+                m_ChildrenPositionMap.at(PAS_PanelType).find(panel) !=
+                m_ChildrenPositionMap.at(PAS_PanelType).end();
+        bool panel_selected = (m_selectedPanels.find(panel) != m_selectedPanels.end());
+        if (!pController_exists | !panel_selected) {
+            spdlog::warn("{}: This panel not available or selected. Moving on...", panel);
+            continue;
+        }
+        auto pPanel = dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panel));
+
+        std::vector<double> pattern_panel_coordinates = pattern_coordinates_per_panel.at(panel);
+        std::vector<double> current_panel_coordinates = pattern_panel_coordinates;
+        double image_delta_x = current_panel_coordinates[0] - m_target_coordinates_center_x;
+        double image_delta_y = current_panel_coordinates[1] - m_target_coordinates_center_y;
+        double distance_panel_to_target = sqrt(image_delta_x * image_delta_x + image_delta_y * image_delta_y);
+
+        spdlog::info("{}: Current coordinates ({},{}), {} from target.", panel,
+                     current_panel_coordinates[0],
+                     current_panel_coordinates[1], distance_panel_to_target);
+
+        Eigen::VectorXd total_coord_deltas = Eigen::VectorXd::Zero(6);
+        std::string last_image_filepath;
+        int n_correction_tries = 0;
+        // repeat motion/analysis until panel reaches target within m_offset_limit.
+        while ((distance_panel_to_target > m_offset_limit) & m_processing) {
+            if (n_correction_tries > 5 ) { break;}
+            spdlog::info("Still far from target {} > {} ", distance_panel_to_target, m_offset_limit);
+
+            Eigen::VectorXd curr_coords_deltas_for_panel = _calculatePanelMotion(panel, image_delta_x, image_delta_y,
+                                                                                 m_respFile);
+            spdlog::info("{}: Found actuator deltas for this motion to target", panel);
+            if (!_doSafePanelMotion(pPanel, curr_coords_deltas_for_panel)) {
+                spdlog::error("{}: Motion failed. Moving on to a different panel...", panel);
+                break;
+            }
+            total_coord_deltas += curr_coords_deltas_for_panel;
+            spdlog::info("{}: Moved to new position", panel);
 
-            spdlog::info("{}: Using the new coordinates...", panel);
+            last_image_filepath = _captureSingleImage();
+            // the previous panel's return check had the motion and the exposure to finish
+            finish_return_check();
 
-            current_panel_coordinates = resampled_coordinates_per_panel.at(panel);
+            current_panel_coordinates = _analyzeImageSinglePanelAutomatically(last_image_filepath, m_show_plot);
+            if (current_panel_coordinates.empty()) {
+                spdlog::error("{}: Lost the panel spot. Moving on to a different panel...", panel);
+                break;
+            }
+            spdlog::info("{}: Took new image and found new panel coordinate", panel);
 
             image_delta_x = current_panel_coordinates[0] - m_target_coordinates_center_x;
             image_delta_y = current_panel_coordinates[1] - m_target_coordinates_center_y;
             distance_panel_to_target = sqrt(image_delta_x * image_delta_x + image_delta_y * image_delta_y);
-
-            spdlog::info("{}: Current coordinates ({},{}), {} from target.", panel,
+            spdlog::info("{} Current coordinates ({},{}), {} from target.", panel,
                          current_panel_coordinates[0],
                          current_panel_coordinates[1], distance_panel_to_target);
 
-            n_correction_tries = 0;
-            // while statement to repeat motion/analysis until panel reaches target within m_offset_limit.
-            while ((distance_panel_to_target > m_offset_limit) & m_processing) {
-                if (n_correction_tries > 5 ) { break;}
-                spdlog::info("Still far from target {} > {} ", distance_panel_to_target, m_offset_limit);
-
-                curr_coords_deltas_for_panel = _calculatePanelMotion(panel, image_delta_x, image_delta_y,
-                                                                     m_respFile);
-                spdlog::info("{}: Found actuator deltas for this motion to target", panel);
-                try {
-                    auto pPanel = dynamic_pointer_cast<PanelController>(
-                            m_ChildrenPositionMap.at(PAS_PanelType).at(panel));
-                    _doSafePanelMotion(pPanel, curr_coords_deltas_for_panel);
-                    pPanel->getActuatorLengths();
-                    //                MirrorController::__calculateMoveDeltaCoords();
-                    //                pPanel->__moveDeltaLengths(curr_coords_deltas_for_panel);
+            n_correction_tries++;
+        }
+        finish_return_check();
+        m_corrected_coordinate_deltas_per_panel[panel] = total_coord_deltas;
+        spdlog::info(
+                "{}: Total coordinate deltas (pattern position to focus point) found for this panel after 1st order correction",
+                panel);
+
+        if (last_image_filepath.empty()) {
+            spdlog::info("Completed calibration of panel {} without moving it. Moving on...", panel);
+            continue;
+        }
 
-                }
-                catch (std::out_of_range &oor) {
-                    spdlog::error("{}: Not found in controller list. Moving on to a different panel... ({})",
-                                  panel,
-                                  oor.what());
-                    break;
-                }
-                spdlog::info("{}: Moved to new position", panel);
+        // the rest of the ring is in the last image: analyze it while this panel goes back
+        auto pending_ring = _analyzeImagePatternAsync(last_image_filepath);
 
-#ifdef SIMMODE
-                image_filepath = "/app/focal_plane/data/The Imaging Source Europe GmbH-37514083-2592-1944-Mono8-2019-12-17-03:20:27.raw";
-                m_focalPlaneImage.setDataDir("/app/focal_plane/data/");
-#else
-                image_filepath = _captureSingleImage();
-#endif
-                current_panel_coordinates = _analyzeImageSinglePanelAutomatically(image_filepath, m_show_plot);
-                spdlog::info("{}: Took new image and found new panel coordinate", panel);
+        spdlog::info("{}: Returning this panel to pattern position", panel);
+        bool returned = _doSafePanelMotion(pPanel, -total_coord_deltas);
 
-                image_delta_x = current_panel_coordinates[0] - m_target_coordinates_center_x;
-                image_delta_y = current_panel_coordinates[1] - m_target_coordinates_center_y;
+        std::map<int, std::vector<double>> refreshed = pending_ring.get();
+        refreshed.erase(panel); // at the target in that image, not on the ring
+        for (const auto &panel_item : refreshed)
+            pattern_coordinates_per_panel[panel_item.first] = panel_item.second;
 
-                total_coord_deltas += curr_coords_deltas_for_panel;
+        if (!returned) {
+            spdlog::error("{}: Failed to return to the pattern position.", panel);
+            continue;
+        }
+        // image the return now, before the next panel moves; check it while that one does
+        pending_return_check = _analyzeImagePatternAsync(_captureSingleImage());
+        returned_panel = panel;
+        returned_panel_expected = pattern_panel_coordinates;
 
-                distance_panel_to_target = sqrt(image_delta_x * image_delta_x + image_delta_y * image_delta_y);
-                spdlog::info("{} Current coordinates ({},{}), {} from target.", panel,
-                             current_panel_coordinates[0],
-                             current_panel_coordinates[1], distance_panel_to_target);
+        spdlog::info("Completed calibration of panel {}. Moving on...", panel);
+    }
+    finish_return_check();
 
-                n_correction_tries++;
-            }
-            m_corrected_coordinate_deltas_per_panel[panel] = total_coord_deltas;
-            spdlog::info(
-                    "{}: Total coordinate deltas (pattern position to focus point) found for this panel after 1st order correction",
-                    panel);
+    _saveCorrections(
+            m_corrected_coordinate_deltas_per_panel); //save these corrected values to file/DB. Also use elsewhere here during this session.
+    spdlog::info("Completed calibration of all panels. ");
+}
 
-            spdlog::info("{}: Returning this panel to pattern position", panel);
+void OpticalAlignmentController::calibrateFirstOrderCorrectionBatch() {
+    /*
+     * All selected panels at once: each is sent to the target plus an offset of its own, so their spots can be
+     * told apart in a single image. A round of corrections then takes one exposure however many panels there
+     * are, and the offsets are taken out of the recorded corrections at the end.
+     */
+    std::string image_filepath = _captureSingleImage();
+    std::map<int, std::vector<double>> pattern_coordinates_per_panel =
+            _analyzeImagePatternAutomatically(image_filepath, m_show_plot);
+    // panels the ring fit missed are taken to be at their place on the ring
+    for (const auto &panel_item : m_focalPlaneImage.getPatternPositions())
+        pattern_coordinates_per_panel.insert(panel_item);
+
+    std::vector<int> panels;
+    std::map<int, std::shared_ptr<PanelController>> pPanels;
+    for (const auto &panel_item : pattern_coordinates_per_panel) {
+        int panel = panel_item.first;
+        bool pController_exists =
+                m_ChildrenPositionMap.at(PAS_PanelType).find(panel) !=
+                m_ChildrenPositionMap.at(PAS_PanelType).end();
+        bool panel_selected = (m_selectedPanels.find(panel) != m_selectedPanels.end());
+        if (!pController_exists | !panel_selected)
+            continue;
+        panels.push_back(panel);
+        pPanels[panel] = dynamic_pointer_cast<PanelController>(m_ChildrenPositionMap.at(PAS_PanelType).at(panel));
+    }
+    std::map<int, std::vector<double>> spot_offsets = m_focalPlaneImage.getSpotOffsets(panels);
+
+    std::map<int, std::vector<double>> current_coordinates_per_panel;
+    std::map<int, Eigen::VectorXd> total_coord_deltas;
+    std::set<int> remaining, lost;
+    for (int panel : panels) {
+        current_coordinates_per_panel[panel] = pattern_coordinates_per_panel.at(panel);
+        total_coord_deltas[panel] = Eigen::VectorXd::Zero(6);
+        remaining.insert(panel);
+    }
+    spdlog::info("Calibrating {} panels together.", panels.size());
 
-            curr_coords_deltas_for_panel = _calculatePanelMotion(panel, image_delta_x, image_delta_y, m_respFile);
-            curr_coords_deltas_for_panel *= -1;
-            spdlog::info("{}: Found actuator deltas for this motion to target", panel);
+    int n_correction_tries = 0;
+    while (!remaining.empty() && m_processing) {
+        if (n_correction_tries > 5) { break; }
 
-            try {
-                auto pPanel = dynamic_pointer_cast<PanelController>(
-                        m_ChildrenPositionMap.at(PAS_PanelType).at(panel));
-                _doSafePanelMotion(pPanel, curr_coords_deltas_for_panel);
-                pPanel->getActuatorLengths();
-                //                MirrorController::__calculateMoveDeltaCoords();
-                //                pPanel->__moveDeltaLengths(curr_coords_deltas_for_panel);
-            }
-            catch (std::out_of_range & oor) {
-                spdlog::error("{}: Not found in controller list. Moving on to a different panel... ({})", panel,
-                              oor.what());
-                break;
+        // where every panel's spot should be in the next image
+        std::map<int, std::vector<double>> expected_coordinates_per_panel;
+        for (int panel : panels) {
+            if (lost.count(panel))
+                continue;
+            std::vector<double> target = {m_target_coordinates_center_x + spot_offsets.at(panel)[0],
+                                          m_target_coordinates_center_y + spot_offsets.at(panel)[1]};
+            if (!remaining.count(panel)) {
+                expected_coordinates_per_panel[panel] = current_coordinates_per_panel.at(panel);
+                continue;
             }
 
-
-            spdlog::info("Completed calibration of panel {}. Moving on...", panel);
+            const std::vector<double> &current = current_coordinates_per_panel.at(panel);
+            Eigen::VectorXd curr_coords_deltas_for_panel =
+                    _calculatePanelMotion(panel, current[0] - target[0], current[1] - target[1], m_respFile);
+            if (!_doSafePanelMotion(pPanels.at(panel), curr_coords_deltas_for_panel)) {
+                spdlog::error("{}: Motion failed. Leaving this panel out...", panel);
+                lost.insert(panel);
+                continue;
+            }
+            total_coord_deltas.at(panel) += curr_coords_deltas_for_panel;
+            expected_coordinates_per_panel[panel] = target;
         }
-        else {
+        for (int panel : lost)
+            remaining.erase(panel);
+        if (remaining.empty())
+            break;
+
+        image_filepath = _captureSingleImage();
+        m_focalPlaneImage.m_ImageFile = image_filepath;
+        std::shared_ptr<const FocalPlaneImage> pImage = m_focalPlaneImage.getImage();
+        if (!pImage) {
+            spdlog::error("No image to analyze. Stopping the calibration...");
             break;
         }
+        std::map<int, std::vector<double>> found_coordinates_per_panel =
+                m_focalPlaneImage.analyzeSpots(*pImage, expected_coordinates_per_panel);
+
+        for (auto it = remaining.begin(); it != remaining.end();) {
+            int panel = *it;
+            auto found = found_coordinates_per_panel.find(panel);
+            if (found == found_coordinates_per_panel.end()) {
+                spdlog::error("{}: Spot not identified. Leaving this panel out...", panel);
+                lost.insert(panel);
+                it = remaining.erase(it);
+                continue;
+            }
+            current_coordinates_per_panel[panel] = found->second;
+            const std::vector<double> &target = expected_coordinates_per_panel.at(panel);
+            double distance_panel_to_target = std::hypot(found->second[0] - target[0], found->second[1] - target[1]);
+            spdlog::info("{}: Current coordinates ({},{}), {} from target.", panel, found->second[0],
+                         found->second[1], distance_panel_to_target);
+            if (distance_panel_to_target <= m_offset_limit)
+                it = remaining.erase(it);
+            else
+                ++it;
+        }
+        n_correction_tries++;
     }
-    _saveCorrections(
-            m_corrected_coordinate_deltas_per_panel); //save these corrected values to file/DB. Also use elsewhere here during this session.
-    spdlog::info("Completed calibration of all panels. ");
-}
 
-std::string OpticalAlignmentController::_captureSingleImage() {
-    string command;
-    command = m_focalPlaneImage.saveImageCommand();
-    spdlog::debug(command);
+    for (int panel : panels) {
+        if (lost.count(panel)) {
+            spdlog::warn("{}: Not calibrated.", panel);
+        } else {
+            // take the panel's own offset back out: the correction is to the target itself
+            const std::vector<double> &current = current_coordinates_per_panel.at(panel);
+            m_corrected_coordinate_deltas_per_panel[panel] = total_coord_deltas.at(panel) +
+                    _calculatePanelMotion(panel, current[0] - m_target_coordinates_center_x,
+                                          current[1] - m_target_coordinates_center_y, m_respFile);
+            spdlog::info("{}: Total coordinate deltas (pattern position to focus point) found for this panel "
+                         "after 1st order correction", panel);
+        }
 
-    string ret;
-    ret = focalplane::exec(command.c_str());
-    spdlog::info(ret);
+        spdlog::info("{}: Returning this panel to pattern position", panel);
+        if (!total_coord_deltas.at(panel).isZero() &&
+            !_doSafePanelMotion(pPanels.at(panel), -total_coord_deltas.at(panel)))
+            spdlog::error("{}: Failed to return to the pattern position.", panel);
+    }
+
+    _saveCorrections(m_corrected_coordinate_deltas_per_panel);
+    spdlog::info("Completed calibration of all panels in {} exposures.", n_correction_tries + 1);
+}
 
-    std::string filename = m_focalPlaneImage.get_image_file();
+std::string OpticalAlignmentController::_captureSingleImage() {
+#ifdef SIMMODE
+    std::string filename = "/app/focal_plane/data/The Imaging Source Europe GmbH-37514083-2592-1944-Mono8-2019-12-17-03:20:27.raw";
+    m_focalPlaneImage.setDataDir("/app/focal_plane/data/");
+#else
+    std::string filename = m_focalPlaneImage.captureImage();
+#endif
+    spdlog::info("Focal Plane Image path: {}", filename);
     return filename;
 }
 
 std::map<int, std::vector<double>> OpticalAlignmentController::_analyzeImagePatternAutomatically(const std::string& image_filepath, bool plot) {
-    string command;
     m_focalPlaneImage.m_ImageFile = image_filepath;
     m_focalPlaneImage.m_show = plot;
     spdlog::info("Image to analyze: {}", m_focalPlaneImage.get_image_file());
-    command = m_focalPlaneImage.analyzePatternCommand();
-    spdlog::debug(command);
-
-    string ret;
-    ret = focalplane::exec(command.c_str());
-    spdlog::info(ret);
-
-    spdlog::info("Loading output CSV file");
-    spdlog::trace("Getting csv filepath from {}.", m_focalPlaneImage.m_ImageFile);
-    string csv_file = m_focalPlaneImage.getCSVFilepathFromImageName(image_filepath);
-    spdlog::trace("Reading csv file {} ", csv_file);
-    std::vector<std::vector<std::string>> csv_results = focalplane::getCSVData(csv_file);
-
-    spdlog::trace("Converting csv vectors to coordinate map");
-    std::map<int, std::vector<double>> coordinate_map = m_focalPlaneImage.makePanelCoordinateMap(csv_results);
-    
+
+    std::map<int, std::vector<double>> coordinate_map = m_focalPlaneImage.analyzePattern();
+
     return coordinate_map;
 }
 
-std::vector<double> OpticalAlignmentController::_analyzeImageSinglePanelAutomatically(const std::string& image_filepath, bool plot) {
-    string command;
+std::future<std::map<int, std::vector<double>>>
+OpticalAlignmentController::_analyzeImagePatternAsync(const std::string &image_filepath) {
     m_focalPlaneImage.m_ImageFile = image_filepath;
-    m_focalPlaneImage.m_show = plot;
     spdlog::info("Image to analyze: {}", m_focalPlaneImage.get_image_file());
-    command = m_focalPlaneImage.analyzeSinglePanelCommand();
-    //TODO need to fix focal_plane.py so that the output of this is either _vvv.cvs file, or a printout to regex.
-    spdlog::debug(command);
-
-    string ret;
-    ret = focalplane::exec(command.c_str());
-    spdlog::info(ret);
 
-    spdlog::debug("Loading output CSV file");
-    spdlog::trace("Getting csv filepath.");
-    std::string csv_file = m_focalPlaneImage.getCSVFilepathFromImageName(image_filepath);
-    spdlog::trace("Reading csv file {} ", csv_file);
-    std::vector<std::vector<std::string>> csv_results = focalplane::getCSVData(csv_file);
+    // analyze a snapshot, so the next capture can go ahead meanwhile
+    std::shared_ptr<const FocalPlaneImage> pImage = m_focalPlaneImage.getImage();
+    return std::async(std::launch::async, [this, pImage, image_filepath]() {
+        if (!pImage)
+            return std::map<int, std::vector<double>>();
+        return m_focalPlaneImage.analyzePattern(*pImage, image_filepath);
+    });
+}
 
-    spdlog::trace("Converting csv vectors to coordinate map");
-    std::map<int, std::vector<double>> coordinate_map = m_focalPlaneImage.makePanelCoordinateMap(csv_results);
+std::vector<double> OpticalAlignmentController::_analyzeImageSinglePanelAutomatically(const std::string& image_filepath, bool plot) {
+    m_focalPlaneImage.m_ImageFile = image_filepath;
+    m_focalPlaneImage.m_show = plot;
+    spdlog::info("Image to analyze: {}", m_focalPlaneImage.get_image_file());
 
-    std::vector<double> panel_coordinates;
+    std::vector<double> panel_coordinates = m_focalPlaneImage.analyzeSinglePanel();
 
 #ifdef SIMMODE
     panel_coordinates = {1700.9,900.9};
@@ -475,30 +595,15 @@ std::vector<double> OpticalAlignmentController::_analyzeImageSinglePanelAutomati
 Eigen::VectorXd OpticalAlignmentController::_calculatePanelMotion(int panel, double x, double y, std::string respFile) {
     Eigen::VectorXd panel_motion_coords(6);
     panel_motion_coords << 0,0,0,0,0,0 ;
-    string command;
-    command = m_focalPlaneImage.CalcMotionSinglePanel2center(panel, x, y, respFile);
-
-    spdlog::debug(command);
-
-    string ret;
-    ret = focalplane::exec(command.c_str());
-    spdlog::info(ret);
-
-    const char * raw_literal_expr = R"rxp(rx.{3}(\d{1,4}\.\d{1,4}).{3}ry.{3}(\d{1,4}\.\d{1,4}))rxp";
-    spdlog::trace("Regex search pattern: {}", raw_literal_expr);
 
-    boost::regex expr(raw_literal_expr);
-    boost::smatch what;
-
-    if (boost::regex_search(ret, what, expr))
-    {
-        spdlog::trace("Found something during regex");
-        spdlog::trace("Response: {}", what[0].str());
-        panel_motion_coords[3] = std::stod(what[1]);
-        panel_motion_coords[4] = std::stod(what[2]);
+    // (x, y) is the spot's offset from the target: move it back by that much
+    focalplane::PanelMotion motion = m_focalPlaneImage.CalcMotion(panel, -x, -y, respFile);
+    if (motion.valid) {
+        panel_motion_coords[3] = motion.rx;
+        panel_motion_coords[4] = motion.ry;
     }
     else{
-        spdlog::warn("Nothing came out of regex search for this motion.");
+        spdlog::warn("No motion found for panel {}.", panel);
     }
 
 #ifdef SIMMODE
@@ -536,6 +641,8 @@ void OpticalAlignmentController::_loadPatternImageParameters() {
     value.toInt32(m_focalPlaneImage.m_PatternRadius);
     pController->getData(PAS_FocalPlaneType_PhaseOffsetRad, value);
     value.toDouble(m_focalPlaneImage.m_PhaseOffsetRad);
+    pController->getData(PAS_FocalPlaneType_RingDirection, value);
+    value.toInt32(m_focalPlaneImage.m_RingDirection);
     pController->getData(PAS_FocalPlaneType_RingFrac, value);
     value.toDouble(m_focalPlaneImage.m_RingFrac);
     pController->getData(PAS_FocalPlaneType_MinDist, value);
@@ -602,35 +709,22 @@ OpticalAlignmentController::_doSafePanelMotion(std::shared_ptr<PanelController>
 
     if (status.isBad()) {
         spdlog::error("{}: Unable to moveDeltaCoords, failed to get actuator lengths.", m_Identity);
-        return OpcUa_Bad;
+        return false;
     }
 
     deltaLengths = targetLengths - currentLengths;
     if (pPanel->checkForCollision(deltaLengths)) {
-        return OpcUa_Bad;
-    } else {
-        status = pPanel->operate(PAS_PanelType_MoveToLengths, lengthArgs);
+        return false;
     }
 
-    // Wait for completion
-    spdlog::info("{}: Waiting for all motions to complete...", m_Identity);
-    UaThread::sleep(5);
-    bool stillMoving = true;
-    while (stillMoving) {
-        stillMoving = false;
-        Device::DeviceState state;
-        getState(state);
-        if (state == Device::DeviceState::Busy) {
-            spdlog::trace("{}: Panel {} is still busy...", m_Identity, getIdentity());
-            stillMoving = true;
-        } else {
-            spdlog::trace("{}: Panel {} is idle.", m_Identity, getIdentity());
-        }
-        UaThread::sleep(1);
+    // returns once the panel is done moving
+    status = pPanel->operate(PAS_PanelType_MoveToLengths, lengthArgs);
+    if (status.isBad()) {
+        spdlog::error("{}: Panel {} failed to move.", m_Identity, pPanel->getIdentity());
+        return false;
     }
     spdlog::info("{}: Done! All motions completed for MoveDeltaCoords method.", m_Identity);
-
-
+    return true;
 }
 
 void OpticalAlignmentController::run() {
@@ -642,7 +736,10 @@ void OpticalAlignmentController::run() {
     spdlog::debug("Minimum distance to target: {}", m_offset_limit);
     spdlog::debug("Show plots in between steps? {}", m_show_plot);
 
-    calibrateFirstOrderCorrection();
+    if (m_batchCalibration)
+        calibrateFirstOrderCorrectionBatch();
+    else
+        calibrateFirstOrderCorrection();
 }
 
 void OpticalAlignmentController::parseAndSetSelection(const string &selectionString, unsigned int deviceType,
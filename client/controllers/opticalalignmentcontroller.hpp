@@ -2,6 +2,7 @@
 #define ALIGNMENT_OPTICALALIGNMENTCONTROLLER_H
 
 #include <Eigen/Dense> // Eigen3 for linear algebra needs
+#include <future>
 #include <math.h>
 
 #include "client/controllers/mpescontroller.hpp"
@@ -56,6 +57,7 @@ private:
     double m_offset_limit;
     std::string m_respFile;
     bool m_processing = true;
+    bool m_batchCalibration = false; // calibrate all selected panels together rather than one by one
 
     void setTargetX(double x) {m_target_coordinates_center_x = x;};
     void setTargetY(double y) {m_target_coordinates_center_y = y;};
@@ -75,6 +77,8 @@ private:
     std::string _captureSingleImage();
 
     std::map<int, std::vector<double>> _analyzeImagePatternAutomatically(const std::string& image_filepath, bool plot);
+    // pattern analysis of the image on a background thread
+    std::future<std::map<int, std::vector<double>>> _analyzeImagePatternAsync(const std::string &image_filepath);
     std::vector<double> _analyzeImageSinglePanelAutomatically(const std::string& image_filepath, bool plot);
 
     Eigen::VectorXd _calculatePanelMotion(int panel, double x, double y, std::string respFile);
@@ -85,6 +89,8 @@ private:
 
     void calibrateFirstOrderCorrection();
 
+    void calibrateFirstOrderCorrectionBatch();
+
     bool _doSafePanelMotion(std::shared_ptr<PanelController> pPanel, Eigen::VectorXd deltaCoords);
 };
 
@@ -7,6 +7,7 @@
 #include <Eigen/Dense>
 
 #include "common/alignment/device.hpp"
+#include "common/alignment/mpes.hpp"
 
 #include "client/clienthelper.hpp"
 #include "client/objects/panelobject.hpp"
@@ -18,6 +19,7 @@
 PanelController::PanelController(Device::Identity identity, Client *pClient, std::string mode) :
     PasCompositeController(std::move(identity), pClient, 5000), m_mode(mode) {
     m_SP.SetPanelType(StewartPlatform::PanelType::OPT);
+    m_ForwardSP.SetPanelType(StewartPlatform::PanelType::OPT);
 
     // define possible children types
     m_ChildrenTypes = {PAS_ACTType, PAS_MPESType, PAS_EdgeType};
@@ -76,6 +78,9 @@ UaStatus PanelController::getData(OpcUa_UInt32 offset, UaVariant &value) {
             }
         }
         */
+        // cheap unless an actuator length changed since the last read
+        std::lock_guard<std::mutex> lock(m_CoordsMutex);
+        __refreshTrackedCoords();
         int dataOffset = offset - PAS_PanelType_x;
         value.setDouble(m_curCoords[dataOffset]);
 
@@ -427,6 +432,10 @@ UaStatus PanelController::operate(OpcUa_UInt32 offset, const UaVariantArray &arg
 
     } else if (offset == PAS_PanelType_ReadPosition) {
         status = updateCoords(true);
+    } else if (offset == PAS_PanelType_ReadSensors) {
+        // blocks until the server has read all of the panel's webcams
+        spdlog::info("{} : PanelController calling readSensors()", m_Identity);
+        status = m_pClient->callMethod(m_pClient->getDeviceNodeId(m_Identity), UaString("ReadSensors"), args);
     }
         /************************************************
          * stop the motion in progress                  *
@@ -479,7 +488,8 @@ bool PanelController::checkForCollision(const Eigen::VectorXd &deltaLengths) {
     Eigen::VectorXd Sen_delta; // sensor delta
     Eigen::VectorXd Sen_new; // sensor new position = Sen_delta + current sensor reading
     Eigen::VectorXd Sen_center(6); // center of sensor camera
-    Sen_center << 160.0, 120.0, 160.0, 120.0, 160.0, 120.0; // Hardcoded
+    const double centerX = MPESBase::FRAME_CENTER_X, centerY = MPESBase::FRAME_CENTER_Y;
+    Sen_center << centerX, centerY, centerX, centerY, centerX, centerY;
     Eigen::VectorXd Sen_deviation; // deviated sensor reading
 
     Eigen::VectorXd currentLengths(6);
@@ -563,25 +573,102 @@ UaStatus PanelController::updateCoords(bool print) {
         spdlog::info("{} : PanelController::updateCoords() : Current Actuator Lengths :\n{}", m_Identity,
                      os.str());
     }
-    // update current coordinates
-    m_SP.ComputeStewart(currentLengths.data());
+    {
+        // the lengths just read supersede the tracked ones
+        std::lock_guard<std::mutex> lock(m_CoordsMutex);
+        for (int i = 0; i < 6; i++)
+            m_TrackedLengths[i] = currentLengths(i);
+        m_ReceivedLengths = 0x3f;
+        m_CoordsStale = false;
+        __computeCoords(currentLengths.data());
+
+        if (print) {
+            spdlog::info(
+                    "{} : PanelController::operate() : Current panel coordinates (x, y ,z xRot, yRot, zRot):\n{}\n{}\n{}\n{}\n{}\n{}\n",
+                    m_Identity, m_curCoords[0], m_curCoords[1], m_curCoords[2], m_curCoords[3], m_curCoords[4], m_curCoords[5]);
+        }
+    }
+
+    m_LastUpdateTime = TIME::now();
+
+    startCoordinateTracking();
+
+    return status;
+}
+
+bool PanelController::startCoordinateTracking() {
+    {
+        std::lock_guard<std::mutex> lock(m_CoordsMutex);
+        if (m_TrackingStarted)
+            return m_Tracking;
+        m_TrackingStarted = true;
+    }
+
+    if (getActuatorCount() != 6) {
+        spdlog::warn("{} : PanelController::startCoordinateTracking() : Panel has {} actuators, not tracking coordinates.",
+                     m_Identity, getActuatorCount());
+        return false;
+    }
+
+    for (const auto &pair : m_ChildrenPositionMap.at(PAS_ACTType)) {
+        int actuator = pair.first - 1;
+        std::string nodeId = m_pClient->getDeviceNodeId(pair.second->getIdentity()) + ".CurrentLength";
+        UaStatus status = m_pClient->monitor(nodeId, [this, actuator](const UaVariant &value) {
+            double length;
+            if (OpcUa_IsGood(UaVariant(value).toDouble(length)))
+                __onLengthChange(actuator, length);
+        });
+        if (status.isBad()) {
+            spdlog::warn("{} : PanelController::startCoordinateTracking() : Failed to monitor {} ({}), "
+                         "coordinates will only be updated on request.", m_Identity, nodeId, status.toString().toUtf8());
+            return false;
+        }
+    }
+    spdlog::debug("{} : PanelController::startCoordinateTracking() : Tracking actuator lengths.", m_Identity);
+
+    std::lock_guard<std::mutex> lock(m_CoordsMutex);
+    m_Tracking = true;
+    return true;
+}
+
+void PanelController::__onLengthChange(int actuator, double length) {
+    std::lock_guard<std::mutex> lock(m_CoordsMutex);
+    if ((m_ReceivedLengths & (1u << actuator)) && m_TrackedLengths[actuator] == length)
+        return;
+    spdlog::trace("{} : PanelController : Actuator {} length changed to {}", m_Identity, actuator + 1, length);
+    m_TrackedLengths[actuator] = length;
+    m_ReceivedLengths |= 1u << actuator;
+    m_CoordsStale = true;
+}
+
+void PanelController::__computeCoords(const double *lengths) {
+    // lengths change little between updates, so the previous solution is a close starting point
+    m_ForwardSP.ComputeStewart(lengths, 1e-12, true);
     // panel coords
     for (int i = 0; i < 6; i++)
-        m_curCoords[i] = m_SP.GetPanelCoords()[i];
+        m_curCoords[i] = m_ForwardSP.GetPanelCoords()[i];
 
     // pad coords -- each column corresponds to a pad
     for (int pad = 0; pad < 3; pad++)
         // populate panel frame pad coordinates
         for (int coord = 0; coord < 3; coord++)
-            m_PadCoords.col(pad)(coord) = m_SP.GetPadCoords(pad)[coord];
+            m_PadCoords.col(pad)(coord) = m_ForwardSP.GetPadCoords(pad)[coord];
 
-    if (print) {
-        spdlog::info(
-                "{} : PanelController::operate() : Current panel coordinates (x, y ,z xRot, yRot, zRot):\n{}\n{}\n{}\n{}\n{}\n{}\n",
-                m_Identity, m_curCoords[0], m_curCoords[1], m_curCoords[2], m_curCoords[3], m_curCoords[4], m_curCoords[5]);
-    }
+    m_CoordsVersion++;
+}
 
-    m_LastUpdateTime = TIME::now();
+void PanelController::__refreshTrackedCoords() {
+    if (!m_Tracking || !m_CoordsStale || m_ReceivedLengths != 0x3f)
+        return;
+    __computeCoords(m_TrackedLengths.data());
+    m_CoordsStale = false;
+}
+
+unsigned long PanelController::__getTrackedPadCoords(Eigen::Matrix3d &padCoords) {
+    std::lock_guard<std::mutex> lock(m_CoordsMutex);
+    __refreshTrackedCoords();
+    padCoords = m_PadCoords;
+    return m_CoordsVersion;
 }
 
 Eigen::VectorXd PanelController::getActuatorLengths() {
@@ -604,7 +691,7 @@ UaStatus PanelController::__getActuatorLengths(Eigen::VectorXd &lengths) {
 
     lengths.resize(6);
     for (const auto &pair : actuatorPositionMap) {
-        status = pair.second->getData(PAS_ACTType_CurrentLength, val);
+        status = pair.second->getData(PAS_ACTType_MeasuredLength, val);
         if (status.isBad()) {
             for (int i = 0; i < 6; i++) {
                 lengths(i) = -1;
@@ -1,6 +1,9 @@
 #ifndef CLIENT_PANELCONTROLLER_HPP
 #define CLIENT_PANELCONTROLLER_HPP
 
+#include <array>
+#include <mutex>
+
 #include <Eigen/Dense>
 
 #include "common/alignment/device.hpp"
@@ -49,6 +52,10 @@ public:
     // helper
     UaStatus updateCoords(bool printout = false);
 
+    // follow the actuator lengths through subscriptions and recompute the coordinates only when one changes,
+    // so that reading them is a cache hit. Started by the first updateCoords(); returns whether it is running
+    bool startCoordinateTracking();
+
     Device::ErrorState getErrorState() override;
 
 private:
@@ -60,13 +67,39 @@ private:
     double m_safetyRadius = 60.0;
 
     StewartPlatform m_SP;
+    // forward kinematics only (lengths -> coords), warm started from its previous solution
+    StewartPlatform m_ForwardSP;
 
     // helper to be able to run ChiSq minimization
-    Eigen::Matrix3d getPadCoords() { return m_PadCoords; };
+    Eigen::Matrix3d getPadCoords() {
+        Eigen::Matrix3d padCoords;
+        __getTrackedPadCoords(padCoords);
+        return padCoords;
+    };
 
     // pad coords -- column per pad
     Eigen::Matrix3d m_PadCoords;
 
+    // guards the coordinates (m_curCoords, m_PadCoords) and the tracking state below, which the subscription
+    // thread updates
+    std::mutex m_CoordsMutex;
+    bool m_TrackingStarted = false;
+    bool m_Tracking = false;
+    // latest actuator lengths from the subscriptions, and a bit per actuator that has reported one
+    std::array<double, 6> m_TrackedLengths;
+    unsigned m_ReceivedLengths = 0;
+    bool m_CoordsStale = false;
+    // incremented whenever the coordinates are recomputed
+    unsigned long m_CoordsVersion = 0;
+
+    void __onLengthChange(int actuator, double length);
+    // recompute the coordinates from the lengths; the caller holds m_CoordsMutex
+    void __computeCoords(const double *lengths);
+    // recompute the coordinates if a tracked length changed since; the caller holds m_CoordsMutex
+    void __refreshTrackedCoords();
+    // up to date pad coords and their version
+    unsigned long __getTrackedPadCoords(Eigen::Matrix3d &padCoords);
+
     UaStatus __getActuatorLengths(Eigen::VectorXd &lengths);
 
     UaStatus __moveToLengths(const UaVariantArray &args) {
@@ -37,6 +37,16 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
         {PAS_EdgeType_FindMatrix, {"FindMatrix", {       std::make_tuple("Step Size",
                                                                          UaNodeId(OpcUaId_Double),
                                                                          "Size of step to use when calculating response matrix (in mm)")}}},
+        {PAS_EdgeType_FindMatrixDesigned, {"FindMatrixDesigned", {
+                                                         std::make_tuple("Step Size",
+                                                                         UaNodeId(OpcUaId_Double),
+                                                                         "Size of step to use when calculating response matrix (in mm)"),
+                                                         std::make_tuple("Design",
+                                                                         UaNodeId(OpcUaId_String),
+                                                                         "Perturbation sequence (hadamard, random)."),
+                                                         std::make_tuple("Patterns",
+                                                                         UaNodeId(OpcUaId_UInt32),
+                                                                         "Number of perturbation patterns per panel (0 for the design's minimum)")}}},
         {PAS_EdgeType_Read,       {"Read",       {}}},
         {PAS_EdgeType_Stop,       {"Stop",       {}}}
 };
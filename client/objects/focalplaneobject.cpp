@@ -40,6 +40,8 @@ const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean, O
         {PAS_FocalPlaneType_PatternCenter, std::make_tuple("PatternCenter", UaVariant("1910 1010"), OpcUa_False,
                                                      Ua_AccessLevel_CurrentRead)},
         {PAS_FocalPlaneType_RingTol, std::make_tuple("RingTol", UaVariant(0.1), OpcUa_False, Ua_AccessLevel_CurrentRead)},
+        {PAS_FocalPlaneType_RingDirection, std::make_tuple("RingDirection", UaVariant(1), OpcUa_False,
+                                                           Ua_AccessLevel_CurrentRead | Ua_AccessLevel_CurrentWrite)},
         {PAS_FocalPlaneType_Exposure, std::make_tuple("Exposure", UaVariant(500000), OpcUa_False,
                                                        Ua_AccessLevel_CurrentRead | Ua_AccessLevel_CurrentWrite)},
         {PAS_FocalPlaneType_Gain, std::make_tuple("Gain", UaVariant(15), OpcUa_False,
@@ -75,6 +77,9 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
                                                                                          std::make_tuple("RingTol",
                                                                                                          UaNodeId(OpcUaId_Double),
                                                                                                          "Tolerance for how far to find panels between pattern positions. Default is 0.2"),
+                                                                                         std::make_tuple("Sector",
+                                                                                                         UaNodeId(OpcUaId_String),
+                                                                                                         "Mirror sector whose ring is in the image, i.e. P1, P2, S1 or S2."),
                                                                                  }}},
         {PAS_FocalPlaneType_AnalyzeSinglePanelImage, {"AnalyzeSinglePanelImage", {}}},
         {PAS_FocalPlaneType_SaveImage,               {"SaveImage",               {}}},
@@ -123,6 +123,31 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
                                                                              UaNodeId(OpcUaId_UInt32),
                                                                              "Direction to align edges in (0 for +z rotation, 1 for -z rotation)"),
                                                          }}},
+    {PAS_MirrorType_AlignWavefront, {"AlignWavefront", {
+                                                                               std::make_tuple("Start edge",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Edge to start aligning from (eAddress)"),
+                                                                               std::make_tuple("End edge",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Edge to align to (eAddress)"),
+                                                                               std::make_tuple("Direction",
+                                                                                               UaNodeId(OpcUaId_UInt32),
+                                                                                               "Direction to align edges in (0 for +z rotation, 1 for -z rotation)"),
+                                                                               std::make_tuple("Max Rounds",
+                                                                                               UaNodeId(OpcUaId_UInt32),
+                                                                                               "Maximum number of rounds over all edges before giving up."),
+                                                         }}},
+    {PAS_MirrorType_FindMatrices, {"FindMatrices", {
+                                                                               std::make_tuple("Step Size",
+                                                                                               UaNodeId(OpcUaId_Double),
+                                                                                               "Size of step to use when calculating response matrices (in mm)"),
+                                                                               std::make_tuple("Design",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Perturbation sequence (hadamard, random)."),
+                                                                               std::make_tuple("Patterns",
+                                                                                               UaNodeId(OpcUaId_UInt32),
+                                                                                               "Number of perturbation patterns per panel (0 for the design's minimum)"),
+                                                         }}},
     {PAS_MirrorType_AlignSector,     {"AlignSector",     {
                                                             std::make_tuple("Align Fraction",
                                                                          UaNodeId(OpcUaId_Double),
@@ -162,6 +187,39 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
                                                                                      UaNodeId(OpcUaId_String),
                                                                                      "Absolute path to .mirrorPos file to save temperatures to.")
                                                              }}},
+    {PAS_MirrorType_SaveSnapshot, {"SaveSnapshot", {
+                                                                     std::make_tuple("Save File Name",
+                                                                                     UaNodeId(OpcUaId_String),
+                                                                                     "Absolute path to binary .mirrorSnap file to save the mirror state to (overwritten)."),
+                                                                     std::make_tuple("Text Export",
+                                                                                     UaNodeId(OpcUaId_Boolean),
+                                                                                     "Also write the state as text files next to it.")
+                                                             }}},
+    {PAS_MirrorType_LoadSnapshot, {"LoadSnapshot", {
+                                                                               std::make_tuple("Load File Name",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Absolute path to binary .mirrorSnap file to load position from."),
+                                                                               std::make_tuple("Align Fraction",
+                                                                                               UaNodeId(OpcUaId_Double),
+                                                                                               "Fraction of motion to carry out (between 0.0 and 1.0) from current position to loaded position."),
+                                                                               std::make_tuple("Command",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Command to run (calculate, setAlignFrac, execute)."),
+                                                                           }}},
+    {PAS_MirrorType_LoadElevationModel, {"LoadElevationModel", {
+                                                                               std::make_tuple("Model Directory",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Absolute path to a directory of .mirrorSnap files saved right after aligning."),
+                                                                               std::make_tuple("Align Fraction",
+                                                                                               UaNodeId(OpcUaId_Double),
+                                                                                               "Fraction of motion to carry out (between 0.0 and 1.0) from current position to predicted position."),
+                                                                               std::make_tuple("Command",
+                                                                                               UaNodeId(OpcUaId_String),
+                                                                                               "Command to run (calculate, setAlignFrac, execute)."),
+                                                                               std::make_tuple("Elevation",
+                                                                                               UaNodeId(OpcUaId_Double),
+                                                                                               "Elevation to predict the position at (degrees); negative for the current elevation."),
+                                                                           }}},
     {PAS_MirrorType_LoadMPESAlignmentOffset, {"LoadAlignmentOffset", {
                                                                                std::make_tuple("Load File Name",
                                                                                                UaNodeId(OpcUaId_String),
@@ -42,6 +42,33 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
                                                                                                std::make_tuple(
                         "RespFile",
                         UaNodeId(OpcUaId_String),
-                        "Response Matrix file, in .yml format.")}}},
+                        "Response Matrix file, in .yml format."),
+                                                                                               std::make_tuple(
+                        "Sector",
+                        UaNodeId(OpcUaId_String),
+                        "Mirror sector being calibrated, i.e. P1, P2, S1 or S2.")}}},
+        {PAS_OpticalAlignmentType_CalibrateFirstOrderCorrBatch, {"CalibrateFirstOrderCorrBatch", {std::make_tuple("CenterX",
+                                                                                                        UaNodeId(OpcUaId_Double),
+                                                                                                        "Target Focal Point x coordinate"),
+                                                                                               std::make_tuple(
+                                                                                                       "CenterY",
+                                                                                                       UaNodeId(OpcUaId_Double),
+                                                                                                       "Target Focal Point y coordinate"),
+                                                                                               std::make_tuple(
+                                                                                                       "ShowPlot",
+                                                                                                       UaNodeId(OpcUaId_Int16),
+                                                                                                       "Show Plot in between panel motions (1 True, 0 False)"),
+                                                                                               std::make_tuple(
+                                                                                                       "OffsetLimit",
+                                                                                                       UaNodeId(OpcUaId_Double),
+                                                                                                       "Max pixel distance between current and target panel position."),
+                                                                                               std::make_tuple(
+                        "RespFile",
+                        UaNodeId(OpcUaId_String),
+                        "Response Matrix file, in .yml format."),
+                                                                                               std::make_tuple(
+                        "Sector",
+                        UaNodeId(OpcUaId_String),
+                        "Mirror sector being calibrated, i.e. P1, P2, S1 or S2.")}}},
         {PAS_OpticalAlignmentType_MoveForCalibration,      {"MoveForCalibration",      {}}}
 };
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "client/utilities/mirrorsnapshot.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/utilities/spdlog/spdlog.h"
+#include "common/utilities/spdlog/fmt/ostr.h"
+
+static_assert(std::is_trivially_copyable<MirrorSnapshot::Header>::value, "snapshot header must be trivially copyable");
+static_assert(std::is_trivially_copyable<MirrorSnapshot::PanelRecord>::value, "panel record must be trivially copyable");
+static_assert(std::is_trivially_copyable<MirrorSnapshot::MPESRecord>::value, "MPES record must be trivially copyable");
+
+const char MirrorSnapshot::MAGIC[8] = {'P', 'A', 'S', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t MirrorSnapshot::VERSION = 1;
+
+namespace {
+void copyString(char *dest, size_t size, const std::string &src) {
+    std::memset(dest, 0, size);
+    std::strncpy(dest, src.c_str(), size - 1);
+}
+
+std::string fromFixedString(const char *src, size_t size) {
+    return std::string(src, strnlen(src, size));
+}
+
+bool writeAll(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+}
+
+MirrorSnapshot::MirrorSnapshot() : header() {
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.panelRecordSize = sizeof(PanelRecord);
+    header.mpesRecordSize = sizeof(MPESRecord);
+    header.timestamp = now();
+    header.az = -1.;
+    header.el = -1.;
+}
+
+int64_t MirrorSnapshot::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+MirrorSnapshot::Identity MirrorSnapshot::toRecordIdentity(const Device::Identity &identity) {
+    Identity id;
+    id.serialNumber = identity.serialNumber;
+    id.position = identity.position;
+    copyString(id.eAddress, sizeof(id.eAddress), identity.eAddress);
+    copyString(id.name, sizeof(id.name), identity.name);
+    return id;
+}
+
+Device::Identity MirrorSnapshot::fromRecordIdentity(const Identity &identity) {
+    Device::Identity id;
+    id.serialNumber = identity.serialNumber;
+    id.position = identity.position;
+    id.eAddress = fromFixedString(identity.eAddress, sizeof(identity.eAddress));
+    id.name = fromFixedString(identity.name, sizeof(identity.name));
+    return id;
+}
+
+/// @details Writes the header and records to <path>.tmp with a single write, syncs it and renames it over path.
+bool MirrorSnapshot::save(const std::string &path) const {
+    Header h = header;
+    h.nPanels = panels.size();
+    h.nMPES = mpes.size();
+
+    std::vector<char> buffer(sizeof(Header) + panels.size() * sizeof(PanelRecord) + mpes.size() * sizeof(MPESRecord));
+    char *p = buffer.data();
+    std::memcpy(p, &h, sizeof(Header));
+    p += sizeof(Header);
+    if (!panels.empty())
+        std::memcpy(p, panels.data(), panels.size() * sizeof(PanelRecord));
+    p += panels.size() * sizeof(PanelRecord);
+    if (!mpes.empty())
+        std::memcpy(p, mpes.data(), mpes.size() * sizeof(MPESRecord));
+
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        spdlog::error("MirrorSnapshot::save() : Cannot open {} for writing.", tmpPath);
+        return false;
+    }
+    bool ok = writeAll(fd, buffer.data(), buffer.size()) && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        spdlog::error("MirrorSnapshot::save() : Failed to write snapshot to {}.", path);
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MirrorSnapshot::load(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        spdlog::error("MirrorSnapshot::load() : Cannot open {}.", path);
+        return false;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(Header)) {
+        spdlog::error("MirrorSnapshot::load() : {} is too short to be a snapshot.", path);
+        ::close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        spdlog::error("MirrorSnapshot::load() : Cannot map {}.", path);
+        return false;
+    }
+
+    const char *p = static_cast<const char *>(map);
+    Header h;
+    std::memcpy(&h, p, sizeof(Header));
+    bool ok = true;
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        spdlog::error("MirrorSnapshot::load() : {} is not a mirror snapshot.", path);
+        ok = false;
+    } else if (h.version != VERSION || h.headerSize != sizeof(Header) || h.panelRecordSize != sizeof(PanelRecord) ||
+               h.mpesRecordSize != sizeof(MPESRecord)) {
+        spdlog::error("MirrorSnapshot::load() : {} is a version {} snapshot, expected version {}.", path, h.version,
+                      VERSION);
+        ok = false;
+    } else if (size != sizeof(Header) + h.nPanels * sizeof(PanelRecord) + h.nMPES * sizeof(MPESRecord)) {
+        spdlog::error("MirrorSnapshot::load() : {} is truncated or corrupt.", path);
+        ok = false;
+    }
+
+    if (ok) {
+        header = h;
+        p += sizeof(Header);
+        panels.resize(h.nPanels);
+        if (h.nPanels > 0)
+            std::memcpy(panels.data(), p, h.nPanels * sizeof(PanelRecord));
+        p += h.nPanels * sizeof(PanelRecord);
+        mpes.resize(h.nMPES);
+        if (h.nMPES > 0)
+            std::memcpy(mpes.data(), p, h.nMPES * sizeof(MPESRecord));
+    }
+
+    ::munmap(map, size);
+    return ok;
+}
+
+/// @details Each view has the layout of the text file MirrorController wrote before snapshots existed, so that the
+/// text loaders read it unchanged.
+void MirrorSnapshot::writeText(std::ostream &os, TextView view, const std::string &delimiter) const {
+    std::time_t time = header.timestamp / 1000000;
+
+    // Place mirror name/Type and
+    // other information at top of file
+    os << "Mirror: " << fromRecordIdentity(header.mirror) << std::endl;
+    os << "Timestamp: " << std::ctime(&time) << std::endl;
+    if (view == ACTUATOR_LENGTHS || view == PANEL_COORDS) {
+        os << "Global coordinates:\n";
+        for (double coord : header.coords)
+            os << " " << coord << std::endl;
+    }
+    os << "Az: " << header.az << ", El: " << header.el << std::endl;
+    os << delimiter << std::endl;
+
+    if (view == ACTUATOR_LENGTHS || view == PANEL_COORDS || view == PANEL_TEMPERATURES) {
+        uint32_t required = (view == PANEL_TEMPERATURES) ? TEMPERATURES_VALID : LENGTHS_VALID;
+        for (const auto &panel : panels) {
+            if (!(panel.flags & required))
+                continue;
+            os << "Panel: " << fromRecordIdentity(panel.identity) << std::endl;
+            if (view == ACTUATOR_LENGTHS) {
+                for (double length : panel.actuatorLengths)
+                    os << length << std::endl;
+            } else if (view == PANEL_COORDS) {
+                for (double coord : panel.coords)
+                    os << coord << std::endl;
+            } else {
+                os << panel.internalTemperature << std::endl;
+                os << panel.externalTemperature << std::endl;
+            }
+            os << delimiter << std::endl;
+        }
+    } else {
+        // an offset needs the aligned reading as well
+        unsigned required = (view == MPES_POSITIONS) ? READING_VALID : (READING_VALID | NOMINAL_VALID);
+        for (const auto &sensor : mpes) {
+            if ((sensor.flags & required) != required)
+                continue;
+            os << "MPES: " << fromRecordIdentity(sensor.identity) << std::endl;
+            if (view == MPES_POSITIONS) {
+                os << sensor.xCentroid << std::endl;
+                os << sensor.yCentroid << std::endl;
+            } else {
+                // offset from the aligned reading
+                os << sensor.xCentroid - (sensor.xNominal - sensor.xSystematicOffset) << std::endl;
+                os << sensor.yCentroid - (sensor.yNominal - sensor.ySystematicOffset) << std::endl;
+            }
+            os << delimiter << std::endl;
+        }
+    }
+
+    os << "Az: " << header.az << ", El: " << header.el << std::endl;
+}
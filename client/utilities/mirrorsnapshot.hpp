@@ -0,0 +1,109 @@
+/**
+ * @file mirrorsnapshot.hpp
+ * @brief Header file for the binary snapshot of a mirror's state.
+ */
+
+#ifndef MIRRORSNAPSHOT_H
+#define MIRRORSNAPSHOT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "common/alignment/device.hpp"
+
+/// @brief The state of a whole mirror at one time: panel actuator lengths, coordinates and temperatures, and
+/// MPES readings, nominal readings and systematic offsets, each with the time it was taken.
+///
+/// On disk this is a fixed size header followed by fixed size panel and MPES records, in host byte order. A
+/// snapshot is written to a temporary file that is renamed over the target, so a reader never sees a partial
+/// one, and is loaded by mapping the file rather than parsing it.
+class MirrorSnapshot {
+public:
+    static const char MAGIC[8];
+    /// @brief Bumped whenever the layout of the records changes; other versions are refused on load.
+    static const uint32_t VERSION;
+
+    enum RecordFlags : uint32_t {
+        LENGTHS_VALID = 1u << 0,
+        TEMPERATURES_VALID = 1u << 1,
+        READING_VALID = 1u << 2,
+        NOMINAL_VALID = 1u << 3
+    };
+
+    struct Identity {
+        int32_t serialNumber = -1;
+        int32_t position = -1;
+        char eAddress[32] = {};
+        char name[32] = {};
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize; // sizes of the header and records, as a check of the layout
+        uint32_t panelRecordSize;
+        uint32_t mpesRecordSize;
+        Identity mirror;
+        int64_t timestamp; // microseconds since the epoch
+        double az, el;
+        double coords[6]; // x, y, z, xRot, yRot, zRot
+        double coordsErr[6];
+        uint32_t nPanels;
+        uint32_t nMPES;
+    };
+
+    struct PanelRecord {
+        Identity identity;
+        int64_t timestamp; // microseconds since the epoch
+        uint32_t flags;
+        uint32_t reserved;
+        double actuatorLengths[6];
+        double coords[6]; // x, y, z, xRot, yRot, zRot, from the actuator lengths
+        double internalTemperature;
+        double externalTemperature;
+    };
+
+    struct MPESRecord {
+        Identity identity;
+        int64_t timestamp; // microseconds since the epoch, of the reading as reported by the sensor
+        uint32_t flags;
+        uint32_t reserved;
+        double xCentroid, yCentroid;
+        double xNominal, yNominal;
+        double xSystematicOffset, ySystematicOffset;
+    };
+
+    Header header;
+    std::vector<PanelRecord> panels;
+    std::vector<MPESRecord> mpes;
+
+    MirrorSnapshot();
+
+    static int64_t now();
+
+    static Identity toRecordIdentity(const Device::Identity &identity);
+    static Device::Identity fromRecordIdentity(const Identity &identity);
+
+    /// @brief Write the snapshot to path, atomically.
+    /// @return Whether the snapshot was written.
+    bool save(const std::string &path) const;
+
+    /// @brief Replace this snapshot with the one at path.
+    /// @return Whether the file held a valid snapshot of this version.
+    bool load(const std::string &path);
+
+    enum TextView {
+        ACTUATOR_LENGTHS,
+        PANEL_COORDS,
+        PANEL_TEMPERATURES,
+        MPES_POSITIONS,
+        MPES_ALIGNMENT_OFFSETS
+    };
+
+    /// @brief Write one part of the snapshot as text, in the layout the MirrorController text loaders read.
+    void writeText(std::ostream &os, TextView view, const std::string &delimiter) const;
+};
+
+#endif // MIRRORSNAPSHOT_H
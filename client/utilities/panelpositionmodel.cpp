@@ -0,0 +1,212 @@
+#include "client/utilities/panelpositionmodel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <dirent.h>
+
+#include "common/utilities/spdlog/spdlog.h"
+#include "common/utilities/spdlog/fmt/ostr.h"
+
+const double PanelPositionModel::ELEVATION_BIN = 0.5;
+const double PanelPositionModel::MIN_TEMPERATURE_SPREAD = 1.0;
+const std::string PanelPositionModel::SNAPSHOT_SUFFIX = ".mirrorSnap";
+
+bool PanelPositionModel::addSnapshot(const MirrorSnapshot &snapshot) {
+    Device::Identity mirrorId = MirrorSnapshot::fromRecordIdentity(snapshot.header.mirror);
+    if (mirrorId != m_Mirror) {
+        spdlog::warn("PanelPositionModel::addSnapshot() : Snapshot of Mirror {} ignored, model is for Mirror {}.",
+                     mirrorId, m_Mirror);
+        return false;
+    }
+    if (snapshot.header.el < 0.) {
+        spdlog::warn("PanelPositionModel::addSnapshot() : Snapshot without a known elevation ignored.");
+        return false;
+    }
+
+    for (const auto &panel : snapshot.panels) {
+        if (!(panel.flags & MirrorSnapshot::LENGTHS_VALID))
+            continue;
+        Sample sample;
+        sample.el = snapshot.header.el;
+        sample.temperature = (panel.flags & MirrorSnapshot::TEMPERATURES_VALID) ? panel.externalTemperature
+                                                                                : std::numeric_limits<double>::quiet_NaN();
+        std::copy(std::begin(panel.actuatorLengths), std::end(panel.actuatorLengths), sample.lengths.begin());
+        m_Samples[MirrorSnapshot::fromRecordIdentity(panel.identity)].push_back(sample);
+    }
+    m_nSnapshots++;
+
+    return true;
+}
+
+unsigned PanelPositionModel::loadDirectory(const std::string &directory) {
+    DIR *dir = opendir(directory.c_str());
+    if (!dir) {
+        spdlog::error("PanelPositionModel::loadDirectory() : Cannot open directory {}.", directory);
+        return 0;
+    }
+
+    std::vector<std::string> files;
+    while (struct dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > SNAPSHOT_SUFFIX.size() &&
+            name.compare(name.size() - SNAPSHOT_SUFFIX.size(), SNAPSHOT_SUFFIX.size(), SNAPSHOT_SUFFIX) == 0)
+            files.push_back(directory + "/" + name);
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+
+    unsigned nUsed = 0;
+    for (const auto &file : files) {
+        MirrorSnapshot snapshot;
+        if (snapshot.load(file) && addSnapshot(snapshot))
+            nUsed++;
+    }
+    spdlog::info("PanelPositionModel::loadDirectory() : Used {} of {} snapshots in {}.", nUsed, files.size(),
+                 directory);
+
+    return nUsed;
+}
+
+void PanelPositionModel::fit() {
+    m_Models.clear();
+
+    for (auto &pair : m_Samples) {
+        auto &samples = pair.second;
+        PanelModel model;
+
+        std::vector<const Sample *> withTemperature;
+        double tMin = std::numeric_limits<double>::max(), tMax = std::numeric_limits<double>::lowest(), tSum = 0.;
+        for (const auto &sample : samples) {
+            if (std::isnan(sample.temperature))
+                continue;
+            withTemperature.push_back(&sample);
+            tMin = std::min(tMin, sample.temperature);
+            tMax = std::max(tMax, sample.temperature);
+            tSum += sample.temperature;
+        }
+        model.referenceTemperature = withTemperature.empty() ? 0. : tSum / withTemperature.size();
+
+        // temperature coefficients, from lengths = a + b * el + k * (T - Tref), so that a temperature that happens to
+        // follow elevation is not taken for the temperature dependence
+        model.temperatureCoeffs.fill(0.);
+        if (withTemperature.size() >= 4 && tMax - tMin >= MIN_TEMPERATURE_SPREAD) {
+            Eigen::MatrixXd A(withTemperature.size(), 3);
+            Eigen::MatrixXd L(withTemperature.size(), 6);
+            for (unsigned i = 0; i < withTemperature.size(); i++) {
+                A.row(i) << 1., withTemperature[i]->el, withTemperature[i]->temperature - model.referenceTemperature;
+                for (int j = 0; j < 6; j++)
+                    L(i, j) = withTemperature[i]->lengths[j];
+            }
+            Eigen::MatrixXd coeffs = A.colPivHouseholderQr().solve(L);
+            for (int j = 0; j < 6; j++)
+                model.temperatureCoeffs[j] = coeffs(2, j);
+        }
+
+        // temperature corrected lengths, averaged per elevation bin
+        std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.el < b.el; });
+        std::vector<double> knots;
+        std::array<std::vector<double>, 6> values;
+        unsigned binSize = 0;
+        double binStart = 0.;
+        for (const auto &sample : samples) {
+            if (!binSize || sample.el - binStart > ELEVATION_BIN) {
+                if (binSize) {
+                    knots.back() /= binSize;
+                    for (auto &v : values)
+                        v.back() /= binSize;
+                }
+                binStart = sample.el;
+                binSize = 0;
+                knots.push_back(0.);
+                for (auto &v : values)
+                    v.push_back(0.);
+            }
+            knots.back() += sample.el;
+            for (int j = 0; j < 6; j++) {
+                double correction = std::isnan(sample.temperature) ? 0. : model.temperatureCoeffs[j] *
+                                                                           (sample.temperature - model.referenceTemperature);
+                values[j].back() += sample.lengths[j] - correction;
+            }
+            binSize++;
+        }
+        if (binSize) {
+            knots.back() /= binSize;
+            for (auto &v : values)
+                v.back() /= binSize;
+        }
+
+        for (int j = 0; j < 6; j++)
+            model.splines[j].fit(knots, values[j]);
+
+        spdlog::debug("PanelPositionModel::fit() : Panel {} : {} samples in {} elevation bins from {} to {} deg, "
+                      "temperature coefficients (mm/C) {} {} {} {} {} {}.", pair.first, samples.size(), knots.size(),
+                      knots.front(), knots.back(), model.temperatureCoeffs[0], model.temperatureCoeffs[1],
+                      model.temperatureCoeffs[2], model.temperatureCoeffs[3], model.temperatureCoeffs[4],
+                      model.temperatureCoeffs[5]);
+        m_Models[pair.first] = model;
+    }
+}
+
+bool PanelPositionModel::predict(const Device::Identity &panel, double el, double temperature,
+                                 Eigen::VectorXd &lengths) const {
+    auto it = m_Models.find(panel);
+    if (it == m_Models.end())
+        return false;
+
+    const auto &model = it->second;
+    lengths.resize(6);
+    for (int j = 0; j < 6; j++) {
+        lengths(j) = model.splines[j](el);
+        if (!std::isnan(temperature))
+            lengths(j) += model.temperatureCoeffs[j] * (temperature - model.referenceTemperature);
+    }
+
+    return true;
+}
+
+std::pair<double, double> PanelPositionModel::getElevationRange(const Device::Identity &panel) const {
+    auto it = m_Models.find(panel);
+    if (it == m_Models.end())
+        return {-1., -1.};
+    const auto &x = it->second.splines[0].x;
+    return {x.front(), x.back()};
+}
+
+void PanelPositionModel::Spline::fit(const std::vector<double> &knots, const std::vector<double> &values) {
+    x = knots;
+    y = values;
+    unsigned n = x.size();
+    m.assign(n, 0.); // natural spline: no curvature at the ends; with two knots this is a straight line
+    if (n < 3)
+        return;
+
+    // tridiagonal system for the interior second derivatives, solved by forward elimination and back substitution
+    std::vector<double> diag(n, 0.), rhs(n, 0.);
+    for (unsigned i = 1; i < n - 1; i++) {
+        double h0 = x[i] - x[i - 1], h1 = x[i + 1] - x[i];
+        diag[i] = 2. * (h0 + h1);
+        rhs[i] = 6. * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+        if (i > 1) {
+            double w = h0 / diag[i - 1];
+            diag[i] -= w * h0;
+            rhs[i] -= w * rhs[i - 1];
+        }
+    }
+    for (unsigned i = n - 2; i >= 1; i--)
+        m[i] = (rhs[i] - (x[i + 1] - x[i]) * m[i + 1]) / diag[i];
+}
+
+double PanelPositionModel::Spline::operator()(double at) const {
+    if (x.size() == 1)
+        return y.front();
+    at = std::max(x.front(), std::min(x.back(), at));
+
+    unsigned i = std::upper_bound(x.begin(), x.end(), at) - x.begin();
+    i = std::min<unsigned>(std::max(i, 1u), x.size() - 1) - 1;
+    double h = x[i + 1] - x[i];
+    double a = (x[i + 1] - at) / h, b = (at - x[i]) / h;
+
+    return a * y[i] + b * y[i + 1] + ((a * a * a - a) * m[i] + (b * b * b - b) * m[i + 1]) * h * h / 6.;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file panelpositionmodel.hpp
+ * @brief Header file for the lookup model of aligned panel positions versus elevation.
+ */
+
+#ifndef PANELPOSITIONMODEL_H
+#define PANELPOSITIONMODEL_H
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "common/alignment/device.hpp"
+#include "client/utilities/mirrorsnapshot.hpp"
+
+/// @brief Aligned actuator lengths of every panel as a function of telescope elevation and panel temperature,
+/// built from snapshots of the mirror taken right after it was aligned.
+///
+/// For each actuator, a linear temperature coefficient is fitted to all samples together with a linear trend in
+/// elevation; the temperature corrected lengths are then averaged per elevation bin and interpolated with a natural
+/// cubic spline. Outside the range of logged elevations the lengths at the nearest end are used.
+class PanelPositionModel {
+public:
+    /// @brief Samples within this many degrees of elevation are averaged into one spline knot.
+    static const double ELEVATION_BIN;
+    /// @brief Minimum spread of logged temperatures (in C) before a temperature coefficient is fitted.
+    static const double MIN_TEMPERATURE_SPREAD;
+    /// @brief File name suffix of the snapshots read by loadDirectory().
+    static const std::string SNAPSHOT_SUFFIX;
+
+    explicit PanelPositionModel(Device::Identity mirror) : m_Mirror(std::move(mirror)) {}
+
+    /// @brief Add every panel of snapshot that has valid actuator lengths. Snapshots of other mirrors or without a
+    /// known elevation are ignored.
+    /// @return Whether the snapshot was used.
+    bool addSnapshot(const MirrorSnapshot &snapshot);
+
+    /// @brief Add every snapshot file (*.mirrorSnap) in directory.
+    /// @return The number of snapshots used.
+    unsigned loadDirectory(const std::string &directory);
+
+    /// @brief Fit the model to the samples added so far.
+    void fit();
+
+    /// @brief Predicted aligned actuator lengths of panel at elevation el (degrees) and temperature. A NaN
+    /// temperature skips the temperature correction.
+    /// @return Whether the model has the panel.
+    bool predict(const Device::Identity &panel, double el, double temperature, Eigen::VectorXd &lengths) const;
+
+    /// @brief Range of logged elevations of panel, as {min, max}.
+    std::pair<double, double> getElevationRange(const Device::Identity &panel) const;
+
+    unsigned getSampleCount() const { return m_nSnapshots; }
+
+private:
+    struct Sample {
+        double el;
+        double temperature; // NaN if not logged
+        std::array<double, 6> lengths;
+    };
+
+    // natural cubic spline through (x, y), with second derivatives m at the knots
+    struct Spline {
+        std::vector<double> x, y, m;
+
+        void fit(const std::vector<double> &knots, const std::vector<double> &values);
+        double operator()(double at) const;
+    };
+
+    struct PanelModel {
+        std::array<Spline, 6> splines;
+        std::array<double, 6> temperatureCoeffs;
+        double referenceTemperature;
+    };
+
+    Device::Identity m_Mirror;
+    unsigned m_nSnapshots = 0;
+    std::map<Device::Identity, std::vector<Sample>> m_Samples;
+    std::map<Device::Identity, PanelModel> m_Models;
+};
+
+#endif // PANELPOSITIONMODEL_H
@@ -14,6 +14,9 @@
 
 class Configuration;
 
+const OpcUa_UInt32 Subscription::FIRST_HANDLER_CLIENT_HANDLE = 0x10000;
+const OpcUa_Double Subscription::HANDLER_SAMPLING_INTERVAL = 1000;
+
 /// @details The constructor nitializes the internal Configuration pointer,
 /// but leaves the internal Session and Subscription pointers as NULL.
 Subscription::Subscription(std::shared_ptr<Configuration> pConfiguration)
@@ -52,7 +55,8 @@ void Subscription::subscriptionStatusChanged(
 
 /// @details If a monitored variable(s) changes, prints a notification about the
 /// change(s). If any of the changed variables indicate an error, prints an
-/// error message instead.
+/// error message instead. Changes of the nodes monitored through monitorNode()
+/// are passed to their handlers instead of being printed.
 void Subscription::dataChange(
     OpcUa_UInt32               clientSubscriptionHandle, //!< [in] Client defined handle of the affected subscription
     const UaDataNotifications& dataNotifications,        //!< [in] List of data notifications sent by the server
@@ -60,10 +64,35 @@ void Subscription::dataChange(
 {
     OpcUa_ReferenceParameter(clientSubscriptionHandle); // We use the callback only for this subscription
     OpcUa_ReferenceParameter(diagnosticInfos);
-    OpcUa_UInt32 i = 0;
+
+    // values of the nodes monitored through monitorNode() go to their handlers
+    std::vector<OpcUa_UInt32> printed;
+    for ( OpcUa_UInt32 i=0; i<dataNotifications.length(); i++ )
+    {
+        if (dataNotifications[i].ClientHandle < FIRST_HANDLER_CLIENT_HANDLE)
+        {
+            printed.push_back(i);
+            continue;
+        }
+        DataChangeHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(m_HandlersMutex);
+            auto it = m_Handlers.find(dataNotifications[i].ClientHandle);
+            if (it != m_Handlers.end())
+                handler = it->second.second;
+        }
+        if (handler && OpcUa_IsGood(dataNotifications[i].Value.StatusCode))
+        {
+            handler(UaVariant(dataNotifications[i].Value.Value));
+        }
+    }
+    if (printed.empty())
+    {
+        return;
+    }
 
     printf("-- DataChange Notification ---------------------------------\n");
-    for ( i=0; i<dataNotifications.length(); i++ )
+    for ( OpcUa_UInt32 i : printed )
     {
         if ( OpcUa_IsGood(dataNotifications[i].Value.StatusCode) )
         {
@@ -233,6 +262,92 @@ UaStatus Subscription::createMonitoredItems()
     return result;
 }
 
+/// @details Creates the internal UaSubscription in the provided UaSession if
+/// there is none yet, then adds the node to it. Nodes are sampled every
+/// HANDLER_SAMPLING_INTERVAL ms, as sampling may be costly on the server side
+/// (e.g. reading an actuator length reads its encoder).
+UaStatus Subscription::monitorNode(UaClientSdk::UaSession* pSession, const UaNodeId &nodeId, DataChangeHandler handler)
+{
+    UaStatus result;
+    if (m_pSubscription == nullptr)
+    {
+        result = createSubscription(pSession);
+        if (result.isBad())
+        {
+            return result;
+        }
+    }
+
+    OpcUa_UInt32 clientHandle;
+    {
+        std::lock_guard<std::mutex> lock(m_HandlersMutex);
+        clientHandle = FIRST_HANDLER_CLIENT_HANDLE + m_Handlers.size();
+        m_Handlers[clientHandle] = std::make_pair(nodeId, std::move(handler));
+    }
+
+    result = createHandlerMonitoredItems({clientHandle});
+    if (result.isBad())
+    {
+        std::lock_guard<std::mutex> lock(m_HandlersMutex);
+        m_Handlers.erase(clientHandle);
+    }
+    return result;
+}
+
+UaStatus Subscription::createHandlerMonitoredItems(const std::vector<OpcUa_UInt32> &clientHandles)
+{
+    if (m_pSubscription == nullptr)
+    {
+        return OpcUa_BadInvalidState;
+    }
+
+    UaStatus result;
+    UaClientSdk::ServiceSettings serviceSettings;
+    UaMonitoredItemCreateRequests itemsToCreate;
+    UaMonitoredItemCreateResults createResults;
+
+    itemsToCreate.create(clientHandles.size());
+    {
+        std::lock_guard<std::mutex> lock(m_HandlersMutex);
+        for (OpcUa_UInt32 i = 0; i < clientHandles.size(); i++)
+        {
+            itemsToCreate[i].ItemToMonitor.AttributeId = OpcUa_Attributes_Value;
+            m_Handlers.at(clientHandles[i]).first.copyTo(&itemsToCreate[i].ItemToMonitor.NodeId);
+            itemsToCreate[i].RequestedParameters.ClientHandle = clientHandles[i];
+            itemsToCreate[i].RequestedParameters.SamplingInterval = HANDLER_SAMPLING_INTERVAL;
+            itemsToCreate[i].RequestedParameters.QueueSize = 1;
+            itemsToCreate[i].RequestedParameters.DiscardOldest = OpcUa_True;
+            itemsToCreate[i].MonitoringMode = OpcUa_MonitoringMode_Reporting;
+        }
+    }
+
+    result = m_pSubscription->createMonitoredItems(
+        serviceSettings,
+        OpcUa_TimestampsToReturn_Both,
+        itemsToCreate,
+        createResults);
+
+    if (result.isGood())
+    {
+        for (OpcUa_UInt32 i = 0; i < createResults.length(); i++)
+        {
+            if (OpcUa_IsBad(createResults[i].StatusCode))
+            {
+                printf("CreateMonitoredItems failed for item: %s - Status %s\n",
+                    UaNodeId(itemsToCreate[i].ItemToMonitor.NodeId).toXmlString().toUtf8(),
+                    UaStatus(createResults[i].StatusCode).toString().toUtf8());
+                result = createResults[i].StatusCode;
+            }
+        }
+    }
+    else
+    {
+        printf("CreateMonitoredItems failed with status %s\n", result.toString().toUtf8());
+    }
+
+    return result;
+}
+
 /// @details Sets the internal Configuration object pointer to the provided
 /// Configuration object pointer.
 void Subscription::setConfiguration(std::shared_ptr<Configuration> pConfiguration)
@@ -262,6 +377,17 @@ UaStatus Subscription::recoverSubscription()
     {
         result = createMonitoredItems();
     }
+    // and those of the handlers
+    std::vector<OpcUa_UInt32> clientHandles;
+    {
+        std::lock_guard<std::mutex> lock(m_HandlersMutex);
+        for (const auto &handler : m_Handlers)
+            clientHandles.push_back(handler.first);
+    }
+    if (result.isGood() && !clientHandles.empty())
+    {
+        result = createHandlerMonitoredItems(clientHandles);
+    }
 
     printf("-------------------------------------------------------------\n");
     if (result.isGood())
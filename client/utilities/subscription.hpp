@@ -8,7 +8,11 @@
 #ifndef __SUBSCRIPTION_H__
 #define __SUBSCRIPTION_H__
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "uabase/uabase.h"
 #include "uaclient/uaclientsdk.h"
@@ -77,6 +81,18 @@ public:
     /// @return An OPC UA status code.
     UaStatus createMonitoredItems();
 
+    /// @brief Callback for the value changes of a node monitored through monitorNode().
+    typedef std::function<void(const UaVariant &value)> DataChangeHandler;
+
+    /// @brief Monitor a single node and pass each new value of it to a handler
+    /// (starting with its current value).
+    /// @param pSession OPC UA session object in which to create the
+    /// subscription, if it does not exist yet.
+    /// @param nodeId Node to monitor.
+    /// @param handler Called from the OPC UA SDK's thread with every new value.
+    /// @return An OPC UA status code.
+    UaStatus monitorNode(UaClientSdk::UaSession* pSession, const UaNodeId &nodeId, DataChangeHandler handler);
+
     // set the configuration where we get the list of NodeIds to monitored from.
     /// @brief Set a new instance as the internal Configuration object.
     /// @param pConfiguration A Configuration object to attach to the
@@ -94,6 +110,10 @@ private:
     /// and re-create monitored items if it becomes invalid/fails.
     /// @return An OPC UA status code.
     UaStatus recoverSubscription();
+    /// @brief Add the nodes monitored through monitorNode() with the given
+    /// client handles to the Subscription.
+    /// @return An OPC UA status code.
+    UaStatus createHandlerMonitoredItems(const std::vector<OpcUa_UInt32> &clientHandles);
     /// @brief Pointer to an OPC UA session object, used to
     /// create an OPC UA subscription object.
     UaClientSdk::UaSession* m_pSession;
@@ -104,6 +124,15 @@ private:
     /// @brief Pointer to a Configuration object, used to retrieve a list
     /// of OPC UA nodes to monitor via subscription.
     std::shared_ptr<Configuration> m_pConfiguration;
+
+    /// @brief Nodes monitored through monitorNode() and their handlers, by
+    /// client handle. Handles start at FIRST_HANDLER_CLIENT_HANDLE, so that
+    /// they do not collide with those of the Configuration's nodes.
+    std::map<OpcUa_UInt32, std::pair<UaNodeId, DataChangeHandler>> m_Handlers;
+    std::mutex m_HandlersMutex;
+    static const OpcUa_UInt32 FIRST_HANDLER_CLIENT_HANDLE;
+    /// @brief Sampling interval (ms) of the nodes monitored through monitorNode().
+    static const OpcUa_Double HANDLER_SAMPLING_INTERVAL;
 };
 
 #endif // SUBSCRIPTION_H
@@ -1,5 +1,6 @@
 #include "common/alignment/actuator.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <memory>
@@ -258,8 +259,7 @@ void ActuatorBase::loadStatusFromASF()
 {
     ActuatorStatus RecordedPosition;
     if (readStatusFromASF(RecordedPosition)) {
-        m_CurrentPosition.revolution = RecordedPosition.position.revolution;
-        m_CurrentPosition.angle = RecordedPosition.position.angle;
+        setCurrentPosition(RecordedPosition.position);
         for (int i = 0; i < getNumErrors(); i++) {
             if (RecordedPosition.errorCodes[i]) {
                 setError(i);
@@ -308,7 +308,10 @@ float ActuatorBase::readVoltage() {
 }
 
 int ActuatorBase::readAngle() {
-    float voltage = __readVoltage();
+    return angleFromVoltage(__readVoltage());
+}
+
+int ActuatorBase::angleFromVoltage(float voltage) {
     //find minimum deviation from measured voltage and array of voltages. index of this array is the angle.
     float MinimumDifference = std::fabs(voltage - m_encoderScale[0]);
     int index = 0;
@@ -396,6 +399,39 @@ int ActuatorBase::performHysteresisMotion(int steps) {
     return stepsRemaining;
 }
 
+//Checks the encoder after the driver has been commanded stepsTaken steps and records the new position. Returns false if the actuator is not stepping, missed too many steps or cannot be read.
+bool ActuatorBase::registerSteps(int stepsTaken) {
+    Position PredictedPosition = predictNewPosition(m_CurrentPosition, -stepsTaken);
+    int MissedSteps = checkAngleQuick(
+        PredictedPosition);//negative*negative=positive sign because retraction is increasing internal counter and missed steps is negative by definition.
+    if (m_Errors[7])//if voltage measurement has issues.
+    {
+        return false;
+    }
+
+    int StepsTaken = stepsTaken - MissedSteps;
+    setCurrentPosition(predictNewPosition(m_CurrentPosition, -StepsTaken));
+
+    if (std::abs(StepsTaken) == 0 && std::abs(stepsTaken) > m_MinimumMissedStepsToFlagError) {
+        spdlog::error("{} : Fatal Error (6): Actuator does not appear to be stepping.", m_Identity);
+        setError(6);//fatal
+        saveStatusToASF();
+        return false;
+    }
+    //if the actuator misses a certain percent of steps AND misses more than a threshold number of steps.
+    else if (std::abs(MissedSteps) >
+             std::max(int(m_TolerablePercentOfMissedSteps * std::abs(stepsTaken)), m_MinimumMissedStepsToFlagError)) {
+        spdlog::error("{} : Fatal Error (8): Actuator has missed a large number of steps ({})", m_Identity,
+                      MissedSteps);
+        setError(8);//fatal
+        saveStatusToASF();
+        return false;
+    }
+
+    saveStatusToASF();
+    return true;
+}
+
 //Port, Serial, ASFPath, and sometimes DB are loaded. The rest of the loading needs to be designed here. Set Current position. This does not handle error during initialization process (e.g. calibration information cannot be loaded). This is always returning true even when something goes wrong.
 bool ActuatorBase::initialize() {
     spdlog::debug("{} : Initializing actuator...", m_Identity);
@@ -555,10 +591,16 @@ float ActuatorBase::__measureLength() {
     int StepsFromHome = convertPositionToSteps(m_CurrentPosition);
     float DistanceFromHome = StepsFromHome * mmPerStep;
     float currentLength = HomeLength - DistanceFromHome;
+    m_LastLength = currentLength;
 
     return currentLength;
 }
 
+void ActuatorBase::setCurrentPosition(Position position) {
+    m_CurrentPosition = position;
+    m_LastLength = HomeLength - convertPositionToSteps(position) * mmPerStep;
+}
+
 void ActuatorBase::probeEndStop(int direction) {
     if (direction != 1 && direction != -1) {
         spdlog::error(
@@ -570,6 +612,193 @@ void ActuatorBase::probeEndStop(int direction) {
     __probeEndStop(direction);
 }
 
+void ActuatorBase::beginEndStopSearch(EndStopSearch &search, int direction) {
+    search.direction = direction;
+    search.stepsTaken = 0;
+    search.atStop = false;
+    search.failed = false;
+    search.stepsToStop = -1;
+    if (!m_Errors[0] && !m_Errors[9]) {
+        // Home is known, so we know roughly how far away the stop is.
+        Position stopPosition = (direction == 1) ? m_ExtendStopPosition : m_RetractStopPosition;
+        search.stepsToStop = std::max(0, direction * (convertPositionToSteps(m_CurrentPosition) -
+                                                      convertPositionToSteps(stopPosition)));
+    }
+
+    setError(0); // Set home position not found error until probe home is complete
+    m_keepStepping = true;
+
+    search.lastVoltage = __readVoltage();
+    if (m_Errors[7]) {
+        search.failed = true;
+    }
+}
+
+int ActuatorBase::nextEndStopSearchSteps(const EndStopSearch &search) {
+    int steps = EndstopSearchStepsize;
+    if (search.stepsToStop >= 0) {
+        // Far from the expected stop, search in coarse chunks (under half a revolution so the encoder
+        // discontinuity is never mistaken for a stop). Keep a margin of a revolution plus the recovery tolerance
+        // in which only the calibrated search step size is used.
+        int coarseSteps = std::max(EndstopSearchStepsize, StepsPerRevolution / 4);
+        int stepsBeforeMargin =
+            search.stepsToStop - search.stepsTaken - StepsPerRevolution - m_EndStopRecoverySteps;
+        if (stepsBeforeMargin > steps) {
+            steps = std::min(coarseSteps, stepsBeforeMargin);
+        }
+    }
+    return search.direction * steps;
+}
+
+void ActuatorBase::updateEndStopSearch(EndStopSearch &search, int stepsTaken) {
+    float voltage = __readVoltage();
+    if (m_Errors[7]) {
+        search.failed = true;
+        return;
+    }
+    search.stepsTaken += std::abs(stepsTaken);
+    if (std::fabs(voltage - search.lastVoltage) < std::fabs(dV * stepsTaken * m_StoppedSteppingFactor)) {
+        search.atStop = true;
+    }
+    search.lastVoltage = voltage;
+}
+
+void ActuatorBase::beginHomeSearch(HomeSearch &search) {
+    search.cyclesFromExtendStop = 0;
+    search.stepsFromExtendStop = 0;
+    search.backOffSteps = 0;
+    search.backOffs = 0;
+    search.fine = false;
+    search.done = false;
+    search.failed = false;
+    m_keepStepping = true;
+
+    float MeasuredVoltage = __readVoltage();
+    if (m_Errors[7]) {
+        search.failed = true;
+        return;
+    }
+    float ExtendStopVoltageMax = m_VMax - (StepsPerRevolution / 4.0) * dV;
+    float ExtendStopVoltageMin = m_VMin + (StepsPerRevolution / 4.0) * dV;
+    if (MeasuredVoltage > ExtendStopVoltageMax || MeasuredVoltage < ExtendStopVoltageMin) {
+        spdlog::error(
+            "{} : Operable Error (11): Actuator voltage at Extend Stop reads {}. Encoder should have been set during assembly to have a voltage in the range ({} - {}). Could possibly cause a {} step uncertainty in position.",
+            m_Identity, MeasuredVoltage, ExtendStopVoltageMin, ExtendStopVoltageMax, StepsPerRevolution);
+        setError(11);//operable
+        saveStatusToASF();
+    }
+    search.lastVoltage = MeasuredVoltage;
+}
+
+int ActuatorBase::nextHomeSearchSteps(const HomeSearch &search) {
+    if (search.backOffSteps > 0) {
+        return search.backOffSteps;
+    }
+    if (search.fine) {
+        return -1;//step once, negative is retraction.
+    }
+    // Discontinuities before the one defining home only need to be counted, so cross them in coarse chunks
+    // (under half a revolution, so that each crossing still shows up as a large voltage drop).
+    int coarseSteps = std::max(1, StepsPerRevolution / 4);
+    if (search.cyclesFromExtendStop + 1 < m_CyclesDefiningHome) {
+        return -coarseSteps;
+    }
+    // Approach the defining discontinuity in coarse chunks, then finish with single steps.
+    int stepsToDiscontinuity = StepsPerRevolution - angleFromVoltage(search.lastVoltage);
+    int steps = std::min(coarseSteps, stepsToDiscontinuity - 2 * m_QuickAngleCheckRange);
+    return (steps > 1) ? -steps : -1;
+}
+
+void ActuatorBase::updateHomeSearch(HomeSearch &search, int stepsTaken) {
+    float VoltageAfter = __readVoltage();
+    if (m_Errors[7]) {
+        search.failed = true;
+        return;
+    }
+    search.stepsFromExtendStop -= stepsTaken;
+
+    if (stepsTaken > 0) {
+        // Backing off: we are back before the discontinuity once the encoder reads in the upper half of its range.
+        if (VoltageAfter > (m_VMin + m_VMax) / 2.0) {
+            search.backOffSteps = 0;
+        } else if (++search.backOffs >= m_MaxHomeBackOffs) {
+            spdlog::error(
+                "{} : Fatal Error (0): Actuator failed to back off past home after {} attempts. Home position not set.",
+                m_Identity, search.backOffs);
+            setError(0);
+            saveStatusToASF();
+            search.failed = true;
+        }
+        search.lastVoltage = VoltageAfter;
+        return;
+    }
+
+    float DeltaVoltage = VoltageAfter - search.lastVoltage;
+    if (DeltaVoltage < 0)//a negative step increases the voltage by dV. if we detect a voltage that is decreasing...
+    {
+        if (std::fabs(DeltaVoltage) > ((dV * StepsPerRevolution) / 2))//if we jump voltage greater than half of the range.
+        {
+            if (search.cyclesFromExtendStop + 1 == m_CyclesDefiningHome && stepsTaken < -1) {
+                // Crossed the discontinuity defining home inside a coarse chunk. Back off past it and refine.
+                spdlog::debug("{} : Overshot home within {} steps, backing off to refine...", m_Identity, -stepsTaken);
+                search.backOffSteps = -stepsTaken + m_QuickAngleCheckRange;
+                search.fine = true;
+                search.lastVoltage = VoltageAfter;
+                return;
+            }
+            search.cyclesFromExtendStop++;
+        } else if (search.fine && std::fabs(DeltaVoltage) < dV) {
+            // Single steps taken up after backing off may only be taking up backlash, so a change below one
+            // step is encoder noise rather than a stuck actuator.
+        } else//error must have occured.. probably stuck
+        {
+            spdlog::error("{} : Fatal Error (0): Actuator appears to be stuck at the end stop. Home position not set.",
+                          m_Identity);
+            setError(0);
+            saveStatusToASF();
+            search.failed = true;
+            return;
+        }
+    } else if (stepsTaken < -1 && DeltaVoltage < std::fabs(dV * stepsTaken * m_StoppedSteppingFactor)) {
+        spdlog::error("{} : Fatal Error (0): Actuator appears to be stuck at the end stop. Home position not set.",
+                      m_Identity);
+        setError(0);
+        saveStatusToASF();
+        search.failed = true;
+        return;
+    }
+    search.lastVoltage = VoltageAfter;
+
+    if (search.cyclesFromExtendStop == m_CyclesDefiningHome) {
+        search.done = true;
+    } else if (search.stepsFromExtendStop > (m_CyclesDefiningHome + 1) * StepsPerRevolution) {
+        spdlog::error(
+            "{} : Fatal Error (0): Actuator has retracted {} steps from the extend stop without finding home. Home position not set.",
+            m_Identity, search.stepsFromExtendStop);
+        setError(0);
+        saveStatusToASF();
+        search.failed = true;
+    }
+}
+
+void ActuatorBase::finishHomeSearch(const HomeSearch &search) {
+    int RecordedStepsFromExtendStop = -1 * (convertPositionToSteps(m_ExtendStopPosition));
+    int StepsDeviationFromExtendStop = RecordedStepsFromExtendStop - search.stepsFromExtendStop;
+    if (std::abs(StepsDeviationFromExtendStop) > m_ExtendStopToHomeStepsDeviation) {
+        spdlog::error(
+            "{} : Operable Error (13): Actuator has stopped at {} steps away from the last recorded end stop position. Home position may be ill-defined.",
+            m_Identity, StepsDeviationFromExtendStop);
+        setError(13);//operable. if home is ill defined, we should still be able to move the actuator. Also, if internal position "ExtendStop" is not correct, we should still be able to move actuator.
+    }
+    //Actuator::position
+    Position HomePosition{};
+    HomePosition.revolution = 0;
+    HomePosition.angle = 0;
+    setCurrentPosition(HomePosition);
+    unsetError(0);
+    saveStatusToASF();
+}
+
 void ActuatorBase::clearErrors() {
     Device::clearErrors();
     saveStatusToASF();
@@ -588,8 +817,8 @@ bool ActuatorBase::forceRecover() {
 }
 
 void ActuatorBase::emergencyStop() {
-    spdlog::warn("{} : Emergency stopping actuator motion...", m_Identity);
     m_keepStepping = false;
+    spdlog::warn("{} : Emergency stopping actuator motion...", m_Identity);
 }
 
 void ActuatorBase::copyFile(const std::string &srcFilePath, const std::string &destFilePath) {
@@ -707,8 +936,7 @@ bool Actuator::readStatusFromDB(ActuatorStatus &RecordedPosition) {
 void Actuator::loadStatusFromDB() {
     ActuatorStatus recordedStatus;
     if (readStatusFromDB(recordedStatus)) {
-        m_CurrentPosition.revolution = recordedStatus.position.revolution;
-        m_CurrentPosition.angle = recordedStatus.position.angle;
+        setCurrentPosition(recordedStatus.position);
         for (int i = 0; i < getNumErrors(); i++) {
             if (recordedStatus.errorCodes[i]) {
                 setError(i);
@@ -805,79 +1033,25 @@ void Actuator::probeHome()//method used to define home.
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
     spdlog::trace("{} : Probing Home position...", m_Identity);
 
+    unsigned abortCount = m_pCBC->driver.getAbortCount();
     __probeEndStop(1);
-
-    float MeasuredVoltage = __readVoltage();
-    if (m_Errors[7] == true) {
+    if (m_Errors[7] == true || m_pCBC->driver.getAbortCount() != abortCount) {
         return;
     }
-    float ExtendStopVoltageMax = m_VMax - (StepsPerRevolution / 4.0) * dV;
-    float ExtendStopVoltageMin = m_VMin + (StepsPerRevolution / 4.0) * dV;
-    if (MeasuredVoltage > ExtendStopVoltageMax || MeasuredVoltage < ExtendStopVoltageMin) {
-        spdlog::error(
-            "{} : Operable Error (11): Actuator voltage at Extend Stop reads {}. Encoder should have been set during assembly to have a voltage in the range ({} - {}). Could possibly cause a {} step uncertainty in position.",
-            m_Identity, MeasuredVoltage, ExtendStopVoltageMin, ExtendStopVoltageMax, StepsPerRevolution);
-        setError(11);//operable
-        saveStatusToASF();
-    }
-
-    float VoltageBefore;
-    float AbsDeltaVoltage;
-    float VoltageAfter = MeasuredVoltage;
-    if (m_Errors[7] == true) {
-        return;
-    }
-    int CurrentCyclesFromExtendStop = 0;
-    int StepsFromExtendStop = 0;
-    bool NotReachedHome = true;
-    m_keepStepping = true;
 
-    while (NotReachedHome && m_keepStepping) {
-        VoltageBefore = VoltageAfter;
-        m_pCBC->driver.step(getPortNumber(), -1);//step once, negative is retraction.
-        StepsFromExtendStop++;
-        VoltageAfter = __readVoltage();
-        if (m_Errors[7] == true) {
-            return;
-        }
-        if ((VoltageAfter - VoltageBefore) <
-            0)//a negative step increases the voltage by dV. if we detect a voltage that is decreasing...
-        {
-            AbsDeltaVoltage = std::fabs(VoltageAfter - VoltageBefore);
-            if (AbsDeltaVoltage >
-                ((dV * StepsPerRevolution) / 2))//if we jump voltage greater than half of the range.
-            {
-                CurrentCyclesFromExtendStop++;
-            } else//error must have occured.. probably stuck
-            {
-                spdlog::error(
-                    "{} : Fatal Error (0): Actuator appears to be stuck at the end stop. Home position not set.",
-                    m_Identity);
-                setError(0);
-                //setError(14);
-                saveStatusToASF();
-                return;
-            }
-        }
-        if (CurrentCyclesFromExtendStop == m_CyclesDefiningHome) {
-            NotReachedHome = false;
+    HomeSearch search{};
+    beginHomeSearch(search);
+    while (!search.done && !search.failed && m_keepStepping) {
+        int steps = nextHomeSearchSteps(search);
+        m_pCBC->driver.step(getPortNumber(), steps);
+        if (m_pCBC->driver.getAbortCount() != abortCount) {
+            return; // stopped
         }
+        updateHomeSearch(search, steps);
     }
-    int RecordedStepsFromExtendStop = -1 * (convertPositionToSteps(m_ExtendStopPosition));
-    int StepsDeviationFromExtendStop = RecordedStepsFromExtendStop - StepsFromExtendStop;
-    if (std::abs(StepsDeviationFromExtendStop) > m_ExtendStopToHomeStepsDeviation) {
-        spdlog::error(
-            "{} : Operable Error (13): Actuator has stopped at {} steps away from the last recorded end stop position. Home position may be ill-defined.",
-            m_Identity, StepsDeviationFromExtendStop);
-        setError(13);//operable. if home is ill defined, we should still be able to move the actuator. Also, if internal position "ExtendStop" is not correct, we should still be able to move actuator.
+    if (search.done) {
+        finishHomeSearch(search);
     }
-    //Actuator::position
-    Position HomePosition{};
-    HomePosition.revolution = 0;
-    HomePosition.angle = 0;
-    setCurrentPosition(HomePosition);
-    unsetError(0);
-    saveStatusToASF();
 }
 
 int Actuator::__step(int steps) {
@@ -890,9 +1064,6 @@ int Actuator::__step(int steps) {
     loadStatusFromASF();
     recoverPosition();
     Position FinalPosition = predictNewPosition(m_CurrentPosition, -steps);
-    Position PredictedPosition{};
-    int MissedSteps;
-    int StepsTaken;
     int Sign;
     int StepsRemaining = -(convertPositionToSteps(FinalPosition) - convertPositionToSteps(
         m_CurrentPosition));//negative because positive step is retraction, and (0,0) is defined as full extraction.
@@ -905,6 +1076,7 @@ int Actuator::__step(int steps) {
 
     int StepsToTake = Sign * RecordingInterval;
     m_keepStepping = true;
+    unsigned abortCount = m_pCBC->driver.getAbortCount();
 
     while ((m_keepStepping) && (getErrorState() != Device::ErrorState::FatalError) &&
            (getDeviceState() != Device::DeviceState::Off)) {
@@ -912,40 +1084,17 @@ int Actuator::__step(int steps) {
             StepsToTake = StepsRemaining;
             m_keepStepping = false;
         }
-        PredictedPosition = predictNewPosition(m_CurrentPosition, -StepsToTake);
         spdlog::trace("{} : Stepping actuator {} steps...", m_Identity, StepsToTake);
-        m_pCBC->driver.step(getPortNumber(), StepsToTake);
-        MissedSteps = checkAngleQuick(
-            PredictedPosition);//negative*negative=positive sign because retraction is increasing internal counter and missed steps is negative by definition.
-        if (m_Errors[7] == true)//if voltage measurement has issues.
-        {
-            return StepsRemaining;
-        }
-
-        StepsTaken = StepsToTake - MissedSteps;
-        setCurrentPosition(predictNewPosition(m_CurrentPosition, -StepsTaken));
-
-        if (std::abs(StepsTaken)==0 && std::abs(StepsToTake)>m_MinimumMissedStepsToFlagError)
-	{
-            spdlog::error("{} : Fatal Error (6): Actuator does not appear to be stepping.",
-                    m_Identity);
-            setError(6);//fatal
-            saveStatusToASF();
-            return StepsRemaining;//quit, don't record or register steps attempted to be taken.
-	}
-        
-        //if( (std::abs(MissedSteps)/float(std::abs(StepsToTake)))>TolerablePercentOfMissedSteps && std::abs(MissedSteps)>MinimumMissedStepsToFlagError)//if the actuator misses a certain percent of steps AND misses more than a threshold number of steps.
-        else if (std::abs(MissedSteps) >
-            std::max(int(m_TolerablePercentOfMissedSteps * std::abs(StepsToTake)), m_MinimumMissedStepsToFlagError)) {
-            spdlog::error("{} : Fatal Error (8): Actuator has missed a large number of steps ({})", m_Identity,
-                          MissedSteps);
-            setError(8);//fatal
-            saveStatusToASF();
+        int StepsTaken = m_pCBC->driver.step(getPortNumber(), StepsToTake);
+        bool stopped = (m_pCBC->driver.getAbortCount() != abortCount);
+        if (!registerSteps(stopped ? StepsTaken : StepsToTake)) {//a stopped motion only registers the steps it took.
             return StepsRemaining;//quit, don't record or register steps attempted to be taken.
         }
-
-        saveStatusToASF();
         StepsRemaining = -(convertPositionToSteps(FinalPosition) - convertPositionToSteps(m_CurrentPosition));
+        if (stopped) {
+            spdlog::info("{} : Actuator::step() : Stopped with {} steps remaining.", m_Identity, StepsRemaining);
+            break;
+        }
     }
 
     return StepsRemaining;
@@ -965,7 +1114,12 @@ void Actuator::__findHomeFromEndStop(int direction) {
         return;
     }
 
+    unsigned abortCount = m_pCBC->driver.getAbortCount();
     __probeEndStop(direction);
+    if (m_pCBC->driver.getAbortCount() != abortCount) {
+        spdlog::warn("{} : Actuator::findHomeFromEndStop() : Stopped before reaching the end stop.", m_Identity);
+        return;
+    }
 
     int indexDeviation = checkAngleSlow(targetPosition);
     setCurrentPosition(predictNewPosition(targetPosition, indexDeviation));
@@ -980,6 +1134,9 @@ void Actuator::__findHomeFromEndStop(int direction) {
         saveStatusToASF();
         //Step here to check if we are stuck?
         int StepsRemaining = __step(-1 * direction * RecordingInterval);
+        if (m_pCBC->driver.getAbortCount() != abortCount) {
+            return; // stopped, steps were not missed
+        }
         if (std::abs(StepsRemaining) > (RecordingInterval / 2))//If we miss more than half of the steps
         {
 
@@ -995,36 +1152,22 @@ void Actuator::__findHomeFromEndStop(int direction) {
 }
 
 void Actuator::__probeEndStop(int direction) {
-    setError(0); // Set home position not found error until probe home is complete
-
-    int searchSteps = direction * EndstopSearchStepsize;
-    if (m_Errors[7] == true) {
-        return;
-    }
-
-    bool atStop = false;
-    m_keepStepping = true;
-
-    float VoltageBefore;
-    float VoltageAfter = __readVoltage();
-    float AbsDeltaVoltage;
-    while (!atStop && m_keepStepping) {
-        VoltageBefore = VoltageAfter;
-        m_pCBC->driver.step(getPortNumber(), searchSteps);
-        VoltageAfter = __readVoltage();
-        if (m_Errors[7] == true) {
-            return;
-        }
-        AbsDeltaVoltage = std::fabs(VoltageAfter - VoltageBefore);
-        if (AbsDeltaVoltage < std::fabs(dV * searchSteps * m_StoppedSteppingFactor)) {
-            atStop = true;
+    EndStopSearch search{};
+    beginEndStopSearch(search, direction);
+    unsigned abortCount = m_pCBC->driver.getAbortCount();
+    while (!search.atStop && !search.failed && m_keepStepping) {
+        int steps = nextEndStopSearchSteps(search);
+        m_pCBC->driver.step(getPortNumber(), steps);
+        if (m_pCBC->driver.getAbortCount() != abortCount) {
+            return; // stopped
         }
+        updateEndStopSearch(search, steps);
     }
 }
 
 int Actuator::stepDriver(int inputSteps) {
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
-    m_pCBC->driver.step(getPortNumber(), inputSteps);
+    return m_pCBC->driver.step(getPortNumber(), inputSteps);
 }
 
 bool Actuator::isOn() {
@@ -1037,6 +1180,12 @@ void Actuator::turnOn() {
     initialize();
 }
 
+void Actuator::emergencyStop() {
+    // stop first, log after: the log may be flushed to disk
+    m_pCBC->driver.abort();
+    ActuatorBase::emergencyStop();
+}
+
 void Actuator::turnOff() {
     spdlog::debug("{} : DummyActuator : Turning off power...", m_Identity);
     saveStatusToASF();
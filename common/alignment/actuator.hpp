@@ -2,6 +2,7 @@
 #define ALIGNMENT_ACTUATOR_HPP
 
 #include <array>
+#include <atomic>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -38,6 +39,28 @@ public:
         std::vector<int> errorCodes;
     };
 
+    /// @brief Progress of an end stop search, advanced one chunk of steps at a time.
+    struct EndStopSearch {
+        int direction;
+        int stepsToStop; // predicted steps to the end stop, -1 if the current position cannot be trusted
+        int stepsTaken;
+        float lastVoltage;
+        bool atStop;
+        bool failed;
+    };
+
+    /// @brief Progress of a home search from the extend stop, advanced one chunk of steps at a time.
+    struct HomeSearch {
+        int cyclesFromExtendStop;
+        int stepsFromExtendStop;
+        int backOffSteps; // pending extension after overshooting the discontinuity defining home
+        int backOffs; // back-off moves that did not clear the discontinuity
+        float lastVoltage;
+        bool fine; // single steps only, set after backing off
+        bool done;
+        bool failed;
+    };
+
     static const std::vector<Device::ErrorDefinition> ERROR_DEFINITIONS;
 
     Device::ErrorDefinition getErrorCodeDefinition(int errorCode) override {
@@ -60,6 +83,10 @@ public:
 
     float measureLength();
 
+    /// @brief Length at the last measurement, motion or status load, without touching the hardware. Negative if
+    /// there has been none yet. Safe to call while the actuator is busy.
+    float getLastLength() const { return m_LastLength; }
+
     float moveToLength(float targetLength);
     float moveDeltaLength(float lengthToMove);
 
@@ -67,6 +94,16 @@ public:
 
     void probeEndStop(int direction);
 
+    // Incremental searches, so that several actuators can share each pass of the motor drivers.
+    void beginEndStopSearch(EndStopSearch &search, int direction);
+    int nextEndStopSearchSteps(const EndStopSearch &search);
+    void updateEndStopSearch(EndStopSearch &search, int stepsTaken);
+
+    void beginHomeSearch(HomeSearch &search);
+    int nextHomeSearchSteps(const HomeSearch &search);
+    void updateHomeSearch(HomeSearch &search, int stepsTaken);
+    void finishHomeSearch(const HomeSearch &search);
+
     void findHomeFromEndStop(int direction);
 
     bool forceRecover();
@@ -104,6 +141,9 @@ public:
     int step(int inputSteps);
 
     int performHysteresisMotion(int steps);
+    int getHysteresisSteps() const { return m_HysteresisSteps; }
+
+    bool registerSteps(int stepsTaken);
     Position predictNewPosition(Position position, int steps);
 
     void recoverPosition();
@@ -137,7 +177,7 @@ protected:
     const int NUM_DB_PROFILE_COLUMNS = 5; //serial, start_date, end_date, angle, voltage
 
     Device::DBInfo m_DBInfo;
-    bool m_keepStepping;
+    std::atomic<bool> m_keepStepping; // cleared by emergencyStop() from another thread
 
     static void copyFile(const std::string &srcFilePath, const std::string &destFilePath);
 
@@ -149,6 +189,7 @@ protected:
     float m_CalibrationTemperature = 22.0;
     float m_StoppedSteppingFactor = 0.5; //hardcoded? 1 means it always stops, 0 means it never stops.
     Position m_CurrentPosition{50, 0};
+    std::atomic<float> m_LastLength{-1.0f}; // published copy of the length at m_CurrentPosition
     Position m_RetractStopPosition{103, 32};
     Position m_ExtendStopPosition{-3, 89};
     int m_HysteresisSteps{RecordingInterval - 50};
@@ -157,6 +198,7 @@ protected:
     float m_StdDevMax{5.0f * dV};
     int m_QuickAngleCheckRange{5};
     int m_CyclesDefiningHome{3};
+    int m_MaxHomeBackOffs{3};
     int m_MinimumMissedStepsToFlagError{3};
     float m_TolerablePercentOfMissedSteps{0.1};
     int m_ExtendStopToHomeStepsDeviation{StepsPerRevolution / 4};
@@ -187,7 +229,9 @@ protected:
 
     virtual int checkAngleSlow(Position expectedPosition);
 
-    void setCurrentPosition(Position position) { m_CurrentPosition = position; }
+    int angleFromVoltage(float voltage);
+
+    void setCurrentPosition(Position position);
 
     float __measureLength();
 
@@ -224,6 +268,9 @@ public:
 
     void probeHome() override;
 
+    // also aborts the step in progress on the board's driver, which stops every drive the board is stepping
+    void emergencyStop() override;
+
     void createDefaultASF() override;
 
 protected:
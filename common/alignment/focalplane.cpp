@@ -4,14 +4,29 @@
 
 #include "focalplane.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 #include <utility>
 
+#include "common/globalalignment/ccd/AravisCamera.h"
+#include "common/simulatestewart/mathtools.hpp"
+#include "common/simulatestewart/mirrordefinitions.hpp"
+#include "common/utilities/imagesink.hpp"
+
 const std::vector<Device::ErrorDefinition> focalplane::ERROR_DEFINITIONS = {
         {"Could not find image.", Device::ErrorState::OperableError},//error 0
+        {"Could not read response matrix file.", Device::ErrorState::OperableError},//error 1
+        {"Could not capture image.", Device::ErrorState::OperableError},//error 2
 };
 
 focalplane::focalplane(Device::Identity identity) :
         Device::Device(std::move(identity)) {
+    m_Errors.assign(getNumErrors(), false);
     spdlog::debug("Created Focal Plane....");
     spdlog::debug("Verbosity: {}, ImageFile: {}", std::to_string(m_verbosity), m_ImageFile);
 }
@@ -48,103 +63,261 @@ Device::ErrorState focalplane::getErrorState() {
     return Device::getErrorState();
 }
 
-std::string focalplane::analyzeSinglePanelCommand() {
-    std::string command;
-    command = m_pModPath + m_pFocalPlane_PY + " " + m_ImageFile
-              + " --DETECT_MINAREA " + std::to_string(m_imgAnalysisParams.m_DetectMinArea)
-              + " --DEBLEND_MINCONT " + std::to_string(m_imgAnalysisParams.m_DeblendMinCont)
-              + " --THRESH " + std::to_string(m_imgAnalysisParams.m_Thresh)
-              + " --search_xs " + m_imgAnalysisParams.m_SearchXs
-              + " --search_ys " + m_imgAnalysisParams.m_SearchYs
-              + " --datadir " + m_data_dir
-              + " -s ";
-    if (m_verbosity) {
-        command += " -v";
+bool focalplane::isSector(const std::string &sector) {
+    return sector.size() == 2 && (sector[0] == 'P' || sector[0] == 'S') && (sector[1] == '1' || sector[1] == '2');
+}
+
+std::vector<unsigned> focalplane::getRingPanels(const std::string &sector) {
+    std::vector<unsigned> panels;
+    if (!isSector(sector)) {
+        spdlog::error("focalplane::getRingPanels() : Unknown sector {}.", sector);
+        return panels;
+    }
+    unsigned mirror = (sector[0] == 'P') ? 1 : 2;
+    unsigned ring = sector[1] - '0';
+    int nPanels = (mirror == 1) ? SCT::Primary::kPanels[ring - 1] : SCT::Secondary::kPanels[ring - 1];
+
+    // panels go around the ring quadrant by quadrant
+    int perQuadrant = nPanels / 4;
+    for (int i = 0; i < nPanels; i++)
+        panels.push_back(SCTMath::Position(mirror, i / perQuadrant + 1, ring, i % perQuadrant + 1));
+    return panels;
+}
+
+std::shared_ptr<const FocalPlaneImage> focalplane::getImage() {
+    std::string path = m_ImageFile;
+    // the image file used to be passed to the analysis scripts quoted
+    path.erase(std::remove(path.begin(), path.end(), '\''), path.end());
+    if (path.empty()) {
+        spdlog::error("{} : focalplane::getImage() : No image file to analyze.", m_Identity);
+        setError(0);
+        return nullptr;
     }
-    if (m_show){
-        command += " --show";
+    if (path == m_LoadedImageFile && m_pImage)
+        return m_pImage;
+
+    auto pImage = std::make_shared<FocalPlaneImage>();
+    if (!FocalPlaneAnalyzer::loadRawImage(path, *pImage)) {
+        setError(0);
+        m_pImage.reset();
+        m_LoadedImageFile.clear();
+        return nullptr;
     }
+    unsetError(0);
+    m_pImage = pImage;
+    m_LoadedImageFile = path;
+    return m_pImage;
+}
 
-    return command;
-}
-
-std::string focalplane::analyzePatternCommand() {
-    std::string command;
-    command = m_pModPath + m_pFocalPlane_PY + " " + m_ImageFile
-              + " --DETECT_MINAREA " + std::to_string(m_imgAnalysisParams.m_DetectMinArea)
-              + " --DEBLEND_MINCONT " + std::to_string(m_imgAnalysisParams.m_DeblendMinCont)
-              + " --THRESH " + std::to_string(m_imgAnalysisParams.m_Thresh)
-              + " -r --ring_rad " + std::to_string(m_PatternRadius)
-              + " --ring_frac " + std::to_string(m_RingFrac)
-              + " -p " + m_PatternCenter
-              + " --ring_tol " + std::to_string(m_RingTol)
-              + " --min_dist " + std::to_string(m_MinDist)
-              + " --phase_offset_rad " + std::to_string(m_PhaseOffsetRad)
-              + " --datadir " + m_data_dir;
-
-    if (m_verbosity) {
-        command += " -v";
+FocalPlaneAnalyzer::ExtractionParameters focalplane::__extractionParameters(bool useSearchWindow) {
+    FocalPlaneAnalyzer::ExtractionParameters params;
+    params.threshold = m_imgAnalysisParams.m_Thresh;
+    params.minArea = m_imgAnalysisParams.m_DetectMinArea;
+    params.deblendMinCont = m_imgAnalysisParams.m_DeblendMinCont;
+    if (useSearchWindow) {
+        std::istringstream(m_imgAnalysisParams.m_SearchXs) >> params.x0 >> params.x1;
+        std::istringstream(m_imgAnalysisParams.m_SearchYs) >> params.y0 >> params.y1;
     }
-    if (m_show){
-        command += " --show";
+    return params;
+}
+
+FocalPlaneAnalyzer::RingParameters focalplane::__ringParameters() {
+    FocalPlaneAnalyzer::RingParameters params;
+    std::istringstream(m_PatternCenter) >> params.centerX >> params.centerY;
+    params.radius = m_PatternRadius;
+    params.ringTol = m_RingTol;
+    params.ringFrac = m_RingFrac;
+    params.minDist = m_MinDist;
+    params.phaseOffset = m_PhaseOffsetRad;
+    params.direction = (m_RingDirection < 0) ? -1 : 1;
+    return params;
+}
+
+const std::map<unsigned, FocalPlaneAnalyzer::ResponseMatrix> *
+focalplane::__getResponseMatrices(const std::string &respFile) {
+    auto it = m_ResponseMatrices.find(respFile);
+    if (it == m_ResponseMatrices.end()) {
+        std::map<unsigned, FocalPlaneAnalyzer::ResponseMatrix> matrices;
+        if (!FocalPlaneAnalyzer::loadResponseMatrices(respFile, matrices)) {
+            setError(1);
+            return nullptr;
+        }
+        unsetError(1);
+        it = m_ResponseMatrices.emplace(respFile, std::move(matrices)).first;
+    }
+    return &it->second;
+}
+
+std::vector<double> focalplane::analyzeSinglePanel() {
+    auto pImage = getImage();
+    if (!pImage)
+        return std::vector<double>();
+    return analyzeSinglePanel(*pImage);
+}
+
+std::map<int, std::vector<double>> focalplane::analyzePattern() {
+    auto pImage = getImage();
+    if (!pImage)
+        return std::map<int, std::vector<double>>();
+    return analyzePattern(*pImage, m_LoadedImageFile);
+}
+
+std::vector<double> focalplane::analyzeSinglePanel(const FocalPlaneImage &image) {
+    std::vector<double> coordinates;
+    auto sources = FocalPlaneAnalyzer::extractSources(image, __extractionParameters(true));
+    if (sources.empty()) {
+        spdlog::warn("{} : focalplane::analyzeSinglePanel() : No spot found.", m_Identity);
+        return coordinates;
+    }
+
+    const FocalPlaneAnalyzer::Source &spot = sources.front();
+    spdlog::info("{} : focalplane::analyzeSinglePanel() : Spot at ({}, {}), flux {}.", m_Identity, spot.x, spot.y,
+                 spot.flux);
+    coordinates = {spot.x, spot.y};
+    return coordinates;
+}
+
+std::map<int, std::vector<double>> focalplane::analyzePattern(const FocalPlaneImage &image,
+                                                              const std::string &imageFile) {
+    std::map<int, std::vector<double>> coordinatesPerPanel;
+    auto sources = FocalPlaneAnalyzer::extractSources(image, __extractionParameters(false));
+    auto ring = FocalPlaneAnalyzer::fitRing(sources, __ringParameters(), getRingPanels(m_Sector));
+    if (!ring.valid)
+        spdlog::warn("{} : focalplane::analyzePattern() : Found only {} panels of sector {} on the ring.", m_Identity,
+                     ring.panelSources.size(), m_Sector);
+    spdlog::info("{} : focalplane::analyzePattern() : Ring center ({}, {}), radius {}.", m_Identity, ring.centerX,
+                 ring.centerY, ring.radius);
+
+    std::string csvFile = getCSVFilepathFromImageName(imageFile);
+    std::ofstream csv(csvFile, std::ios::trunc);
+    csv << "panel,flux,x,y" << std::endl;
+    for (const auto &panelSource : ring.panelSources) {
+        const FocalPlaneAnalyzer::Source &spot = panelSource.second;
+        spdlog::debug("{}: ({}, {})", panelSource.first, spot.x, spot.y);
+        coordinatesPerPanel[(int) panelSource.first] = {spot.x, spot.y};
+        csv << panelSource.first << "," << spot.flux << "," << spot.x << "," << spot.y << std::endl;
+    }
+    if (!csv.good())
+        spdlog::warn("{} : focalplane::analyzePattern() : Could not write results to {}.", m_Identity, csvFile);
+
+    return coordinatesPerPanel;
+}
+
+std::map<int, std::vector<double>> focalplane::analyzeSpots(const FocalPlaneImage &image,
+                                                            const std::map<int, std::vector<double>> &expected) {
+    std::map<int, std::vector<double>> coordinatesPerPanel;
+    std::map<unsigned, std::array<double, 2>> expectedPositions;
+    for (const auto &panel : expected)
+        expectedPositions[(unsigned) panel.first] = {{panel.second[0], panel.second[1]}};
+
+    auto sources = FocalPlaneAnalyzer::extractSources(image, __extractionParameters(false));
+    auto assignment = FocalPlaneAnalyzer::assignSources(sources, expectedPositions, m_BatchSpotSpacing);
+    spdlog::info("{} : focalplane::analyzeSpots() : Identified {} of {} panels, common shift ({}, {}).", m_Identity,
+                 assignment.panelSources.size(), expected.size(), assignment.shiftX, assignment.shiftY);
+
+    for (const auto &panelSource : assignment.panelSources) {
+        spdlog::debug("{}: ({}, {})", panelSource.first, panelSource.second.x, panelSource.second.y);
+        coordinatesPerPanel[(int) panelSource.first] = {panelSource.second.x, panelSource.second.y};
+    }
+    return coordinatesPerPanel;
+}
+
+std::map<int, std::vector<double>> focalplane::getPatternPositions() {
+    std::map<int, std::vector<double>> positions;
+    auto params = __ringParameters();
+    auto panels = getRingPanels(m_Sector);
+    for (int i = 0; i < (int) panels.size(); i++) {
+        double x, y;
+        FocalPlaneAnalyzer::ringPosition(params, i, panels.size(), x, y);
+        positions[(int) panels[i]] = {x, y};
     }
+    return positions;
+}
 
-    return command;
+std::map<int, std::vector<double>> focalplane::getSpotOffsets(const std::vector<int> &panels) {
+    std::map<int, std::vector<double>> offsets;
+    if (panels.empty())
+        return offsets;
+
+    // grid points closest to the middle first, enough of them for every panel
+    int half = (int) std::ceil(std::sqrt((double) panels.size()) / 2.0);
+    std::vector<std::pair<int, int>> cells;
+    for (int i = -half; i <= half; i++)
+        for (int j = -half; j <= half; j++)
+            cells.emplace_back(i, j);
+    std::stable_sort(cells.begin(), cells.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return a.first * a.first + a.second * a.second < b.first * b.first + b.second * b.second;
+    });
+
+    for (size_t k = 0; k < panels.size(); k++)
+        offsets[panels[k]] = {cells[k].first * m_BatchSpotSpacing, cells[k].second * m_BatchSpotSpacing};
+    return offsets;
 }
 
-std::string focalplane::CalcMotionPatternToCenter(std::string &sector, std::string &respFile) {
-    std::string command;
-    command = m_pModPath + m_pCalcMotion_PY + " --p2c "
-              + " --sector " + sector
-              + " --pattern_radius " + std::to_string(m_PatternRadius)
-              + " --resp_file " + respFile;
-    if (m_verbosity) {
-        command += " -v";
+focalplane::PanelMotion focalplane::CalcMotion(int panel, double dx, double dy, const std::string &respFile) {
+    PanelMotion motion;
+    auto pMatrices = __getResponseMatrices(respFile);
+    if (!pMatrices)
+        return motion;
+    auto it = pMatrices->find((unsigned) panel);
+    if (it == pMatrices->end()) {
+        spdlog::error("{} : focalplane::CalcMotion() : No response matrix for panel {} in {}.", m_Identity, panel,
+                      respFile);
+        return motion;
     }
-//    "python calc_motion.py --p2c --sector 'P1' --pattern_radius 280 --resp_file M1_matirx_fast.yaml"
-    return command;
-}
-
-std::string focalplane::CalcMotionCenterToPattern(std::string &sector, std::string &respFile) {
-    std::string command;
-    command = m_pModPath + m_pCalcMotion_PY + " --c2p "
-              + " --sector " + sector
-              + " --pattern_radius " + std::to_string(m_PatternRadius)
-              + " --resp_file " + respFile;
-    if (m_verbosity) {
-        command += " -v";
+
+    motion = FocalPlaneAnalyzer::solveMotion(it->second, dx, dy);
+    if (motion.valid)
+        spdlog::info("{}: rx = {}, ry = {}", panel, motion.rx, motion.ry);
+    else
+        spdlog::error("{} : focalplane::CalcMotion() : Singular response matrix for panel {}.", m_Identity, panel);
+    return motion;
+}
+
+std::map<unsigned, focalplane::PanelMotion>
+focalplane::CalcMotionPatternToCenter(const std::string &sector, const std::string &respFile) {
+    std::map<unsigned, PanelMotion> motions;
+    auto params = __ringParameters();
+    auto panels = getRingPanels(sector);
+    for (int i = 0; i < (int) panels.size(); i++) {
+        double x, y;
+        FocalPlaneAnalyzer::ringPosition(params, i, panels.size(), x, y);
+        motions[panels[i]] = CalcMotion(panels[i], params.centerX - x, params.centerY - y, respFile);
     }
-//    "python calc_motion.py --p2c --sector 'P1' --pattern_radius 280 --resp_file M1_matirx_fast.yaml"
-    return command;
-}
-
-std::string
-focalplane::CalcMotionSinglePanel2center(int panel, double current_x, double currentY, std::string &respFile) {
-    std::string command;
-    command = m_pModPath + m_pCalcMotion_PY + " " + std::to_string(panel) + " -c "
-              + " -x " + std::to_string(current_x)
-              + " -y " + std::to_string(currentY)
-              + " --center_coord " + m_PatternCenter
-              + " --resp_file " + respFile;
-    if (m_verbosity) {
-        command += " -v";
+    return motions;
+}
+
+std::map<unsigned, focalplane::PanelMotion>
+focalplane::CalcMotionCenterToPattern(const std::string &sector, const std::string &respFile) {
+    // the response is linear: the way back is the way in, reversed
+    auto motions = CalcMotionPatternToCenter(sector, respFile);
+    for (auto &motion : motions) {
+        motion.second.rx *= -1;
+        motion.second.ry *= -1;
     }
-//    "python calc_motion.py 1328 -c -x 1444 -y 877"
-    return command;
-}
-
-std::string
-focalplane::CalcMotionSinglePanel2pattern(int panel, double currentX, double currentY, std::string &respFile) {
-    std::string command;
-    command = m_pModPath + m_pCalcMotion_PY + " " + std::to_string(panel) + " -p "
-              + " -x " + std::to_string(currentX)
-              + " -y " + std::to_string(currentY)
-              + " --resp_file " + respFile;
-    if (m_verbosity) {
-        command += " -v";
+    return motions;
+}
+
+focalplane::PanelMotion
+focalplane::CalcMotionSinglePanel2center(int panel, double currentX, double currentY, const std::string &respFile) {
+    auto params = __ringParameters();
+    return CalcMotion(panel, params.centerX - currentX, params.centerY - currentY, respFile);
+}
+
+focalplane::PanelMotion
+focalplane::CalcMotionSinglePanel2pattern(int panel, double currentX, double currentY, const std::string &respFile) {
+    PanelMotion motion;
+    auto panels = getRingPanels(m_Sector);
+    auto slot = std::find(panels.begin(), panels.end(), (unsigned) panel);
+    if (slot == panels.end()) {
+        spdlog::error("{} : focalplane::CalcMotionSinglePanel2pattern() : Panel {} is not in sector {}.", m_Identity,
+                      panel, m_Sector);
+        return motion;
     }
-//    "python calc_motion.py 1328 -p -x 1444 -y 877"
-    return command;
+
+    double x, y;
+    FocalPlaneAnalyzer::ringPosition(__ringParameters(), slot - panels.begin(), panels.size(), x, y);
+    return CalcMotion(panel, x - currentX, y - currentY, respFile);
 }
 
 std::string focalplane::getResponseMatrixPatternFast() {
@@ -155,27 +328,12 @@ std::string focalplane::getResponseMatrixSinglePanel() {
     return std::string();
 }
 
-std::string focalplane::exec(const char* cmd) {
-    char buffer[8192];
-    std::string result = "";
-    FILE* pipe = popen(cmd, "r");
-    if (!pipe) throw std::runtime_error("popen() failed!");
-    try {
-        while (fgets(buffer, sizeof buffer, pipe) != NULL) {
-            result += buffer;
-        }
-    } catch (...) {
-        pclose(pipe);
-        throw;
-    }
-    pclose(pipe);
-    return result;
-}
 std::string focalplane::getDatetimeFromRAWname(const std::string& raw_name){
     std::string output;
     spdlog::debug("Filename to get datetime string: \'{}\'", raw_name);
     try {
-        const char *raw_literal_expr = R"rgx((\d{1,4})-(\d{1,2})-(\d{1,2})-(\d{1,2}):(\d{1,2}):(\d{1,2}))rgx";
+        // the milliseconds are missing from images captured before they were added to the name
+        const char *raw_literal_expr = R"rgx((\d{1,4})-(\d{1,2})-(\d{1,2})-(\d{1,2}):(\d{1,2}):(\d{1,2})(?:\.(\d{3}))?)rgx";
         spdlog::trace("Regex search pattern: {}", raw_literal_expr);
 
         boost::regex expr(raw_literal_expr);
@@ -186,7 +344,8 @@ std::string focalplane::getDatetimeFromRAWname(const std::string& raw_name){
             spdlog::trace("Found something during regex");
             spdlog::trace("Response: {}", what[0].str());
             for (int i = 1; i < (int) what.size(); i ++){
-                output += what[i] + "_";
+                if (what[i].matched)
+                    output += what[i] + "_";
             }
         }
         else{
@@ -232,58 +391,58 @@ std::string focalplane::getCSVFilepathFromImageName(std::string image_filepath)
     return final_path;
 }
 
-std::vector<std::vector<std::string>> focalplane::getCSVData(std::string data_file) {
-    CSVReader reader(std::move(data_file));
-    std::vector<std::vector<std::string> > dataList = reader.getData();
-    return dataList;
-}
-
-std::map<int, std::vector<double>> focalplane::makePanelCoordinateMap(std::vector<std::vector<std::string>> dataList) {
-    std::map <int , std::vector<double>>  m_coordinates_per_panel;
-
-    int i = 0;
-    for (const std::vector<std::string> &line : dataList) {
-        if (i==0) {
-            i++;
-            continue;
+std::string focalplane::captureImage() {
+    if (!m_pCamera || !m_pCamera->isReady()) {
+        m_pCamera = std::make_shared<AravisCamera>(m_CameraID.c_str());
+        if (!m_pCamera->isReady()) {
+            spdlog::error("{} : focalplane::captureImage() : Could not open camera {}.", m_Identity, m_CameraID);
+            m_pCamera.reset();
+            setError(2);
+            return "";
         }
-        else{
-            i++;
-        }
-        std::string panel = line[0];
-        std::string x_coord = line[2];
-        std::string y_coord = line[3];
-        spdlog::debug("{}: ({}, {})", panel, x_coord, y_coord);
-        int p = std::stoi(panel);
-        double x = std::stod(x_coord);
-        double y = std::stod(y_coord);
-        m_coordinates_per_panel[p] = {x, y};
+        m_pCamera->setPixelDepth(8);
     }
-
-    return m_coordinates_per_panel;
-}
-
-std::string focalplane::saveImageCommand() {
-    std::string command;
-
-    std::time_t rawtime;
+    m_pCamera->setGain((int) m_captureParams.gain);
+    m_pCamera->setExposure(m_captureParams.exposure);
+    m_pCamera->setFrameRate(m_captureParams.frame_rate);
+
+    Frame frame = m_pCamera->captureFrame();
+    size_t nPixels = (size_t) m_pCamera->px() * m_pCamera->py();
+    if (frame.empty() || frame.size() < nPixels) {
+        spdlog::error("{} : focalplane::captureImage() : No image from camera {}.", m_Identity, m_CameraID);
+        setError(2);
+        return "";
+    }
+    unsetError(2);
+
+    // copy out of the stream buffer right away -- the camera only has a few
+    auto pImage = std::make_shared<FocalPlaneImage>();
+    pImage->width = m_pCamera->px();
+    pImage->height = m_pCamera->py();
+    pImage->pixels.assign(frame.data(), frame.data() + nPixels);
+
+    // to the millisecond, so that captures in the same second do not overwrite each other's image and results
+    auto now = std::chrono::system_clock::now();
+    std::time_t rawtime = std::chrono::system_clock::to_time_t(now);
+    int millis = (int) (std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
     struct tm * timeinfo;
     char buffer [80];
-    std::time (&rawtime);
     timeinfo = std::localtime (&rawtime);
     std::strftime(buffer, 80, "%Y-%m-%d-%H:%M:%S", timeinfo);
+    char millisBuffer[8];
+    std::snprintf(millisBuffer, sizeof(millisBuffer), ".%03d", millis);
 
     std::string time_stamp;
-    time_stamp = buffer;
-
-    std::string filename = "The Imaging Source Europe GmbH-37514083-2592-1944-Mono8-" + time_stamp + ".png";
-    set_image_file("\'" + m_pPicture_dir + filename + "\'");
-
-    command = "source /home/ctauser/set_skycam && " + m_pModPath + m_pGet_focal_plane_image_PY
-            + " -e " + std::to_string(m_captureParams.exposure)
-            + " -g " + std::to_string(m_captureParams.gain)
-            + " -f " + std::to_string(m_captureParams.frame_rate)
-            + " --data_outdir " + m_pPicture_dir
-            + " --data_outfile \'" + filename + "\'";
-    return command;
+    time_stamp = std::string(buffer) + millisBuffer;
+
+    std::string filename = m_CameraID + "-" + std::to_string(pImage->width) + "-" + std::to_string(pImage->height) +
+                           "-Mono8-" + time_stamp + ".raw";
+    ImageSink::forDirectory(m_pPicture_dir)->submit(filename, [pImage](const std::string &path, int) {
+        return FocalPlaneAnalyzer::saveRawImage(path, *pImage);
+    }, "focalplane");
+
+    set_image_file(m_pPicture_dir + filename);
+    m_pImage = pImage;
+    m_LoadedImageFile = m_ImageFile;
+    return m_ImageFile;
 }
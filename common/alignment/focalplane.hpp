@@ -6,29 +6,63 @@
 #define ALIGNMENT_FOCALPLANE_HPP
 
 #include "common/alignment/device.hpp"
-#include "common/utilities/CSVReader.hpp"
+#include "common/alignment/focalplaneanalysis.hpp"
 #include <boost/regex.hpp>
 #include <utility>
 #include <libgen.h>
 
 #include "spdlog/spdlog.h"
 
+class AravisCamera;
+
 class focalplane : public Device {
 
 public:
+    typedef FocalPlaneAnalyzer::PanelMotion PanelMotion;
+
     explicit focalplane(Device::Identity identity);
 
-    std::string analyzeSinglePanelCommand();
+    /// @brief The current image: as last captured, or loaded from m_ImageFile. nullptr if there is none.
+    /// Snapshots stay valid (and unchanged) when the next image is taken.
+    std::shared_ptr<const FocalPlaneImage> getImage();
+
+    /// @brief Spot position {x, y} of the brightest source in the search window of the current image; empty if none.
+    std::vector<double> analyzeSinglePanel();
+
+    /// @brief Spot positions {x, y} of the panels of the sector ring in the current image, by panel position.
+    /// Also written to the results CSV (see getCSVFilepathFromImageName).
+    std::map<int, std::vector<double>> analyzePattern();
+
+    // the same on a given image; these only read the analysis parameters, so they can run alongside a capture
+    std::vector<double> analyzeSinglePanel(const FocalPlaneImage &image);
 
-    std::string analyzePatternCommand();
+    std::map<int, std::vector<double>> analyzePattern(const FocalPlaneImage &image, const std::string &imageFile);
 
-    std::string CalcMotionPatternToCenter(std::string &sector, std::string &respFile);
+    /// @brief Spots of many panels in one image, told apart by their expected positions {x, y}: each source goes
+    /// to the panel expected nearest it, jointly over all panels, within m_BatchSpotSpacing.
+    std::map<int, std::vector<double>> analyzeSpots(const FocalPlaneImage &image,
+                                                    const std::map<int, std::vector<double>> &expected);
 
-    std::string CalcMotionCenterToPattern(std::string &sector, std::string &respFile);
+    /// @brief Expected spot positions {x, y} of the panels of the sector on the pattern ring.
+    std::map<int, std::vector<double>> getPatternPositions();
 
-    std::string CalcMotionSinglePanel2center(int panel, double current_x, double currentY, std::string &respFile);
+    /// @brief Offsets {dx, dy} from a common point that keep the panels' spots m_BatchSpotSpacing apart, on a
+    /// square grid filled from the middle out.
+    std::map<int, std::vector<double>> getSpotOffsets(const std::vector<int> &panels);
 
-    std::string CalcMotionSinglePanel2pattern(int panel, double currentX, double currentY, std::string &respFile);
+    /// @brief Motions taking every panel of the sector from its place on the pattern ring to the pattern center.
+    std::map<unsigned, PanelMotion> CalcMotionPatternToCenter(const std::string &sector, const std::string &respFile);
+
+    std::map<unsigned, PanelMotion> CalcMotionCenterToPattern(const std::string &sector, const std::string &respFile);
+
+    /// @brief Motion taking the panel's spot from (currentX, currentY) to the pattern center.
+    PanelMotion CalcMotionSinglePanel2center(int panel, double currentX, double currentY, const std::string &respFile);
+
+    /// @brief Motion taking the panel's spot from (currentX, currentY) to its place on the pattern ring.
+    PanelMotion CalcMotionSinglePanel2pattern(int panel, double currentX, double currentY, const std::string &respFile);
+
+    /// @brief Motion moving the panel's spot by (dx, dy).
+    PanelMotion CalcMotion(int panel, double dx, double dy, const std::string &respFile);
 
     std::string getResponseMatrixPatternFast();
 
@@ -44,6 +78,12 @@ public:
 
     static const std::vector<Device::ErrorDefinition> ERROR_DEFINITIONS;
 
+    /// @brief Whether sector names a ring of panels: "P1", "P2", "S1" or "S2".
+    static bool isSector(const std::string &sector);
+
+    /// @brief Panel positions of a sector ("P1", "P2", "S1", "S2") in order around its ring.
+    static std::vector<unsigned> getRingPanels(const std::string &sector);
+
     Device::ErrorDefinition getErrorCodeDefinition(int errorCode) {
         return focalplane::ERROR_DEFINITIONS.at(errorCode);
     }
@@ -84,34 +124,44 @@ public:
     capture_parameters m_captureParams = capture_parameters();
     int m_PatternRadius;
     std::string m_PatternCenter = "1913 1010";
+    std::string m_Sector = "P1"; // sector whose ring is in the pattern image, set with the analysis parameters
+    double m_BatchSpotSpacing = 60; // pixels between panel spots when measuring many at once
     double m_PhaseOffsetRad;
+    int m_RingDirection = 1; // 1 if the panel numbers follow increasing image angle, -1 for a mirrored ring
     double m_RingTol;
     double m_RingFrac;
     int m_MinDist;
     bool m_show = false;
 
-    static std::string exec(const char* cmd);
-
     std::string getCSVFilepathFromImageName(std::string image_filepath);
 
-    static std::vector<std::vector<std::string>> getCSVData(std::string data_file);
-
-    std::map<int, std::vector<double>> makePanelCoordinateMap(std::vector<std::vector<std::string>> dataList);
-
     static std::string getDatetimeFromRAWname(const std::string& raw_name);
 
     void setDataDir(std::string data_dir) {m_data_dir = std::move(data_dir);};
 
-    std::string saveImageCommand();
+    /// @brief Take an image with the focal plane camera. It becomes the current image, and is saved as a raw
+    /// Mono8 file in the background. Returns its path, empty on failure.
+    std::string captureImage();
 
 protected:
-    std::string m_pModPath = "/home/ctauser/focal_plane/";
     std::string m_data_dir = "/home/ctauser/focal_plane/data/";
-    std::string m_pFocalPlane_PY = "focal_plane.py";
-    std::string m_pFindMotionFocalPlane_PY = "find_motion_focal_plane.py";
-    std::string m_pCalcMotion_PY = "calc_motion.py";
-    std::string m_pGet_focal_plane_image_PY = "get_focal_plane_image.py";
     std::string m_pPicture_dir = "/home/ctauser/Pictures/Aravis/";
+    std::string m_CameraID = "The Imaging Source Europe GmbH-37514083";
+
+    std::shared_ptr<AravisCamera> m_pCamera; // opened on first capture
+
+    // the current image, as last captured or loaded from m_ImageFile
+    std::shared_ptr<const FocalPlaneImage> m_pImage;
+    std::string m_LoadedImageFile;
+
+    // response matrices by file
+    std::map<std::string, std::map<unsigned, FocalPlaneAnalyzer::ResponseMatrix>> m_ResponseMatrices;
+
+    FocalPlaneAnalyzer::ExtractionParameters __extractionParameters(bool useSearchWindow);
+
+    FocalPlaneAnalyzer::RingParameters __ringParameters();
+
+    const std::map<unsigned, FocalPlaneAnalyzer::ResponseMatrix> *__getResponseMatrices(const std::string &respFile);
 };
 
 
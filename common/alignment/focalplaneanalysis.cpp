@@ -0,0 +1,572 @@
+#include "common/alignment/focalplaneanalysis.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "common/utilities/spdlog/spdlog.h"
+#include "common/utilities/spdlog/fmt/ostr.h"
+
+
+const int FocalPlaneAnalyzer::DEFAULT_WIDTH = 2592;
+const int FocalPlaneAnalyzer::DEFAULT_HEIGHT = 1944;
+
+bool FocalPlaneAnalyzer::loadRawImage(const std::string &path, FocalPlaneImage &image) {
+    int width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
+
+    // ".../<camera>-<serial>-2592-1944-Mono8-<date>.raw"
+    size_t format = path.rfind("-Mono8");
+    if (format != std::string::npos) {
+        size_t heightStart = path.rfind('-', format - 1);
+        size_t widthStart = (heightStart == std::string::npos || heightStart == 0) ? std::string::npos :
+                            path.rfind('-', heightStart - 1);
+        if (widthStart != std::string::npos) {
+            int w = std::atoi(path.substr(widthStart + 1, heightStart - widthStart - 1).c_str());
+            int h = std::atoi(path.substr(heightStart + 1, format - heightStart - 1).c_str());
+            if (w > 0 && h > 0) {
+                width = w;
+                height = h;
+            }
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.good()) {
+        spdlog::error("FocalPlaneAnalyzer : Could not open image {}.", path);
+        return false;
+    }
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t) width * height);
+    file.read(reinterpret_cast<char *>(image.pixels.data()), image.pixels.size());
+    if (file.gcount() != (std::streamsize) image.pixels.size()) {
+        spdlog::error("FocalPlaneAnalyzer : {} holds {} bytes, expected a {}x{} Mono8 image.", path, file.gcount(),
+                      width, height);
+        image.pixels.clear();
+        return false;
+    }
+    return true;
+}
+
+bool FocalPlaneAnalyzer::saveRawImage(const std::string &path, const FocalPlaneImage &image) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(image.pixels.data()), image.pixels.size());
+    return file.good();
+}
+
+FocalPlaneAnalyzer::Background FocalPlaneAnalyzer::estimateBackground(const FocalPlaneImage &image) {
+    Background background;
+    if (image.empty())
+        return background;
+
+    // 8 bit pixels: median and MAD straight from the histogram
+    size_t histogram[256] = {0};
+    for (unsigned char pixel : image.pixels)
+        histogram[pixel]++;
+
+    const size_t half = (image.pixels.size() + 1) / 2;
+    size_t count = 0;
+    int median = 0;
+    while (median < 255 && (count += histogram[median]) < half)
+        median++;
+
+    size_t deviations[256] = {0};
+    for (int value = 0; value < 256; value++)
+        deviations[std::abs(value - median)] += histogram[value];
+    count = 0;
+    int mad = 0;
+    while (mad < 255 && (count += deviations[mad]) < half)
+        mad++;
+
+    background.level = median;
+    // a mostly flat dark frame can have a MAD of 0 -- don't go below one count of noise
+    background.sigma = std::max(1.4826 * mad, 1.0);
+    return background;
+}
+
+std::vector<FocalPlaneAnalyzer::Source> FocalPlaneAnalyzer::extractSources(const FocalPlaneImage &image,
+                                                                           const ExtractionParameters &params) {
+    std::vector<Source> sources;
+    if (image.empty())
+        return sources;
+
+    const int width = image.width, height = image.height;
+    int x0 = 0, x1 = width, y0 = 0, y1 = height;
+    if (params.x0 != params.x1 && params.y0 != params.y1) {
+        x0 = std::max(0, std::min(params.x0, params.x1));
+        x1 = std::min(width, std::max(params.x0, params.x1));
+        y0 = std::max(0, std::min(params.y0, params.y1));
+        y1 = std::min(height, std::max(params.y0, params.y1));
+    }
+
+    Background background = estimateBackground(image);
+    const double detectLevel = params.threshold * background.sigma; // above background
+    const double pixelThreshold = background.level + detectLevel;
+    spdlog::debug("FocalPlaneAnalyzer : background {} +- {}, detecting above {}", background.level,
+                  background.sigma, pixelThreshold);
+
+    // 8-connected groups of pixels above threshold
+    std::vector<unsigned char> visited((size_t) width * height, 0);
+    std::vector<int> stamp;
+    int stampCounter = 0;
+    std::vector<Blob> blobs;
+    std::deque<int> frontier;
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int start = y * width + x;
+            if (visited[start] || image.pixels[start] <= pixelThreshold)
+                continue;
+
+            Blob blob;
+            visited[start] = 1;
+            frontier.push_back(start);
+            while (!frontier.empty()) {
+                int pixel = frontier.front();
+                frontier.pop_front();
+                blob.pixels.push_back(pixel);
+                blob.flux += image.pixels[pixel] - background.level;
+
+                int px = pixel % width, py = pixel / width;
+                for (int ny = std::max(py - 1, y0); ny <= std::min(py + 1, y1 - 1); ny++) {
+                    for (int nx = std::max(px - 1, x0); nx <= std::min(px + 1, x1 - 1); nx++) {
+                        int neighbor = ny * width + nx;
+                        if (!visited[neighbor] && image.pixels[neighbor] > pixelThreshold) {
+                            visited[neighbor] = 1;
+                            frontier.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+
+            if ((int) blob.pixels.size() < params.minArea)
+                continue;
+            if (stamp.empty())
+                stamp.assign((size_t) width * height, 0);
+            __deblend(image, background.level, blob, detectLevel, blob.flux, params, stamp, stampCounter, blobs);
+        }
+    }
+
+    for (const Blob &blob : blobs)
+        sources.push_back(__measure(image, background.level, blob));
+    std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) { return a.flux > b.flux; });
+
+    spdlog::debug("FocalPlaneAnalyzer : found {} sources", sources.size());
+    return sources;
+}
+
+void FocalPlaneAnalyzer::__deblend(const FocalPlaneImage &image, double background, const Blob &blob,
+                                   double baseLevel, double totalFlux, const ExtractionParameters &params,
+                                   std::vector<int> &stamp, int &stampCounter, std::vector<Blob> &out) {
+    const int width = image.width;
+    double peak = 0.0;
+    for (int pixel : blob.pixels)
+        peak = std::max(peak, image.pixels[pixel] - background);
+
+    if (params.deblendLevels > 1 && params.deblendMinCont < 1.0 && peak > baseLevel && baseLevel > 0) {
+        std::deque<int> frontier;
+        for (int i = 1; i < params.deblendLevels; i++) {
+            double level = baseLevel * std::pow(peak / baseLevel, (double) i / params.deblendLevels);
+
+            // branches of the blob above this level; stamps tell members (inSet) from already grouped pixels
+            const int inSet = ++stampCounter;
+            const int grouped = ++stampCounter;
+            for (int pixel : blob.pixels) {
+                if (image.pixels[pixel] - background >= level)
+                    stamp[pixel] = inSet;
+            }
+
+            std::vector<Blob> branches;
+            for (int start : blob.pixels) {
+                if (stamp[start] != inSet)
+                    continue;
+                Blob branch;
+                stamp[start] = grouped;
+                frontier.push_back(start);
+                while (!frontier.empty()) {
+                    int pixel = frontier.front();
+                    frontier.pop_front();
+                    branch.pixels.push_back(pixel);
+                    branch.flux += image.pixels[pixel] - background;
+                    int px = pixel % width, py = pixel / width;
+                    for (int ny = std::max(py - 1, 0); ny <= std::min(py + 1, image.height - 1); ny++) {
+                        for (int nx = std::max(px - 1, 0); nx <= std::min(px + 1, width - 1); nx++) {
+                            int neighbor = ny * width + nx;
+                            if (stamp[neighbor] == inSet) {
+                                stamp[neighbor] = grouped;
+                                frontier.push_back(neighbor);
+                            }
+                        }
+                    }
+                }
+                if (branch.flux >= params.deblendMinCont * totalFlux)
+                    branches.push_back(std::move(branch));
+            }
+
+            if (branches.size() < 2)
+                continue;
+
+            // the blob splits here: hand every pixel to the branch with the nearest centroid, then look for
+            // further splits within each branch
+            std::vector<Source> centers;
+            for (const Blob &branch : branches)
+                centers.push_back(__measure(image, background, branch));
+            std::vector<Blob> children(branches.size());
+            for (int pixel : blob.pixels) {
+                double px = pixel % width, py = pixel / width;
+                size_t nearest = 0;
+                double best = -1.0;
+                for (size_t b = 0; b < centers.size(); b++) {
+                    double d = (px - centers[b].x) * (px - centers[b].x) + (py - centers[b].y) * (py - centers[b].y);
+                    if (best < 0 || d < best) {
+                        best = d;
+                        nearest = b;
+                    }
+                }
+                children[nearest].pixels.push_back(pixel);
+                children[nearest].flux += image.pixels[pixel] - background;
+            }
+            for (const Blob &child : children)
+                __deblend(image, background, child, level, totalFlux, params, stamp, stampCounter, out);
+            return;
+        }
+    }
+
+    out.push_back(blob);
+}
+
+FocalPlaneAnalyzer::Source FocalPlaneAnalyzer::__measure(const FocalPlaneImage &image, double background,
+                                                         const Blob &blob) {
+    Source source;
+    double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumYY = 0.0, sumXY = 0.0;
+    for (int pixel : blob.pixels) {
+        double value = std::max(image.pixels[pixel] - background, 0.0);
+        double x = pixel % image.width, y = pixel / image.width;
+        source.flux += value;
+        source.peak = std::max(source.peak, value);
+        sumX += value * x;
+        sumY += value * y;
+        sumXX += value * x * x;
+        sumYY += value * y * y;
+        sumXY += value * x * y;
+    }
+    source.npix = (int) blob.pixels.size();
+    if (source.flux > 0) {
+        source.x = sumX / source.flux;
+        source.y = sumY / source.flux;
+        source.x2 = sumXX / source.flux - source.x * source.x;
+        source.y2 = sumYY / source.flux - source.y * source.y;
+        source.xy = sumXY / source.flux - source.x * source.y;
+    }
+    return source;
+}
+
+void FocalPlaneAnalyzer::ringPosition(const RingParameters &params, int i, int n, double &x, double &y) {
+    double angle = params.phaseOffset + params.direction * 2.0 * M_PI * i / n;
+    x = params.centerX + params.radius * std::cos(angle);
+    y = params.centerY + params.radius * std::sin(angle);
+}
+
+FocalPlaneAnalyzer::Ring FocalPlaneAnalyzer::fitRing(const std::vector<Source> &sources, const RingParameters &params,
+                                                     const std::vector<unsigned> &ringPanels) {
+    Ring ring;
+    ring.centerX = params.centerX;
+    ring.centerY = params.centerY;
+    ring.radius = params.radius;
+    if (ringPanels.empty() || params.radius <= 0)
+        return ring;
+
+    // sources are brightest first: keep a source only if no brighter one is within minDist
+    std::vector<Source> spots;
+    for (const Source &source : sources) {
+        bool isolated = true;
+        for (const Source &kept : spots) {
+            if (std::hypot(source.x - kept.x, source.y - kept.y) < params.minDist) {
+                isolated = false;
+                break;
+            }
+        }
+        if (isolated)
+            spots.push_back(source);
+    }
+
+    auto onRing = [&ring, &params](const Source &s) {
+        return std::fabs(std::hypot(s.x - ring.centerX, s.y - ring.centerY) - ring.radius) <=
+               params.ringTol * ring.radius;
+    };
+
+    // algebraic (Kasa) circle fit x^2 + y^2 + D x + E y + F = 0 on the sources near the ring, a few times over
+    // as sources move in and out of the tolerance band
+    for (int iteration = 0; iteration < 5; iteration++) {
+        double A[3][3] = {{0}}, b[3] = {0};
+        int n = 0;
+        for (const Source &s : spots) {
+            if (!onRing(s))
+                continue;
+            double row[3] = {s.x, s.y, 1.0};
+            double rhs = -(s.x * s.x + s.y * s.y);
+            for (int i = 0; i < 3; i++) {
+                b[i] += row[i] * rhs;
+                for (int j = 0; j < 3; j++)
+                    A[i][j] += row[i] * row[j];
+            }
+            n++;
+        }
+        if (n < 3)
+            break;
+
+        // Cramer's rule
+        auto det3 = [](double m[3][3]) {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                   m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                   m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        };
+        double det = det3(A);
+        if (std::fabs(det) < 1e-9)
+            break;
+        double solution[3];
+        for (int k = 0; k < 3; k++) {
+            double M[3][3];
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++)
+                    M[i][j] = (j == k) ? b[i] : A[i][j];
+            solution[k] = det3(M) / det;
+        }
+        double cx = -solution[0] / 2.0, cy = -solution[1] / 2.0;
+        double r2 = cx * cx + cy * cy - solution[2];
+        if (r2 <= 0)
+            break;
+        bool moved = std::fabs(cx - ring.centerX) > 0.01 || std::fabs(cy - ring.centerY) > 0.01 ||
+                     std::fabs(std::sqrt(r2) - ring.radius) > 0.01;
+        ring.centerX = cx;
+        ring.centerY = cy;
+        ring.radius = std::sqrt(r2);
+        if (!moved)
+            break;
+    }
+
+    // label each spot on the ring with the panel whose place on the ring is angularly closest
+    const int n = (int) ringPanels.size();
+    const double spacing = 2.0 * M_PI / n;
+    std::map<int, double> residuals;
+    for (const Source &s : spots) {
+        if (!onRing(s))
+            continue;
+        double angle = params.direction * (std::atan2(s.y - ring.centerY, s.x - ring.centerX) - params.phaseOffset);
+        long slot = std::lround(angle / spacing);
+        double residual = std::fabs(angle - slot * spacing);
+        slot = ((slot % n) + n) % n;
+
+        unsigned panel = ringPanels[slot];
+        auto previous = residuals.find((int) slot);
+        if (previous == residuals.end() || residual < previous->second) {
+            if (previous != residuals.end())
+                ring.unassigned.push_back(ring.panelSources[panel]);
+            ring.panelSources[panel] = s;
+            residuals[(int) slot] = residual;
+        } else {
+            ring.unassigned.push_back(s);
+        }
+    }
+
+    ring.valid = !ring.panelSources.empty() && ring.panelSources.size() >= params.ringFrac * n;
+    spdlog::debug("FocalPlaneAnalyzer : ring at ({}, {}), radius {}: {} of {} panels found", ring.centerX,
+                  ring.centerY, ring.radius, ring.panelSources.size(), n);
+    return ring;
+}
+
+bool FocalPlaneAnalyzer::loadResponseMatrices(const std::string &path,
+                                              std::map<unsigned, ResponseMatrix> &matrices) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        spdlog::error("FocalPlaneAnalyzer : Could not open response matrix file {}.", path);
+        return false;
+    }
+
+    std::string line;
+    bool inPanel = false;
+    unsigned panel = 0;
+    ResponseMatrix matrix{};
+    int nValues = 0;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t'\"");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+
+        // "<panel>:" starts a new panel
+        size_t colon = line.find(':', start);
+        const char *numbers = line.c_str();
+        if (colon != std::string::npos) {
+            std::string key = line.substr(start, colon - start);
+            key.erase(key.find_last_not_of(" \t'\"") + 1);
+            if (!key.empty() && key.find_first_not_of("0123456789") == std::string::npos) {
+                panel = (unsigned) std::stoul(key);
+                inPanel = true;
+                nValues = 0;
+                numbers = line.c_str() + colon + 1;
+            }
+        }
+        if (!inPanel)
+            continue;
+
+        const char *c = numbers;
+        while (*c && nValues < 4) {
+            bool startsNumber = isdigit(*c) || ((*c == '-' || *c == '+' || *c == '.') && isdigit(c[1])) ||
+                                ((*c == '-' || *c == '+') && c[1] == '.' && isdigit(c[2]));
+            if (!startsNumber) {
+                c++;
+                continue;
+            }
+            char *end;
+            matrix[nValues++] = std::strtod(c, &end);
+            c = end;
+        }
+        if (nValues == 4) {
+            matrices[panel] = matrix;
+            inPanel = false;
+        }
+    }
+
+    spdlog::debug("FocalPlaneAnalyzer : Read response matrices for {} panels from {}.", matrices.size(), path);
+    return !matrices.empty();
+}
+
+FocalPlaneAnalyzer::PanelMotion FocalPlaneAnalyzer::solveMotion(const ResponseMatrix &response, double dx,
+                                                                double dy) {
+    PanelMotion motion;
+    double det = response[0] * response[3] - response[1] * response[2];
+    if (std::fabs(det) < 1e-12)
+        return motion;
+    motion.rx = (response[3] * dx - response[1] * dy) / det;
+    motion.ry = (-response[2] * dx + response[0] * dy) / det;
+    motion.valid = true;
+    return motion;
+}
+
+std::vector<int> FocalPlaneAnalyzer::solveAssignment(const std::vector<std::vector<double>> &cost) {
+    // Hungarian algorithm with potentials (rows <= columns), O(rows^2 columns); 1-based internally, with
+    // row/column 0 as the sentinel
+    const int n = cost.size();
+    const int m = n ? cost[0].size() : 0;
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> u(n + 1, 0.0), v(m + 1, 0.0), minv(m + 1);
+    std::vector<int> rowOf(m + 1, 0), way(m + 1, 0);
+    std::vector<char> used(m + 1);
+
+    for (int i = 1; i <= n; i++) {
+        rowOf[0] = i;
+        int j0 = 0;
+        std::fill(minv.begin(), minv.end(), inf);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[j0] = 1;
+            int i0 = rowOf[j0], j1 = 0;
+            double delta = inf;
+            for (int j = 1; j <= m; j++) {
+                if (used[j])
+                    continue;
+                double reduced = cost[i0 - 1][j - 1] - u[i0] - v[j];
+                if (reduced < minv[j]) {
+                    minv[j] = reduced;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (used[j]) {
+                    u[rowOf[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (rowOf[j0] != 0);
+        do {
+            int j1 = way[j0];
+            rowOf[j0] = rowOf[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    std::vector<int> columnOf(n, -1);
+    for (int j = 1; j <= m; j++) {
+        if (rowOf[j])
+            columnOf[rowOf[j] - 1] = j - 1;
+    }
+    return columnOf;
+}
+
+FocalPlaneAnalyzer::Assignment FocalPlaneAnalyzer::assignSources(const std::vector<Source> &sources,
+                                                                 const std::map<unsigned, std::array<double, 2>> &expected,
+                                                                 double maxDist) {
+    Assignment assignment;
+    if (expected.empty()) {
+        assignment.unassigned = sources;
+        return assignment;
+    }
+
+    std::vector<unsigned> panels;
+    for (const auto &panel : expected)
+        panels.push_back(panel.first);
+    const int n = panels.size(), m = sources.size();
+    const double gate = maxDist * maxDist;
+
+    std::vector<int> columnOf;
+    // assign, take out the median offset of the matched spots (the whole pattern drifting), and assign again
+    for (int pass = 0; pass < 2; pass++) {
+        // columns: the sources, then one "not found" column per panel at the gate cost, so that a far-off
+        // source is never preferred over leaving a panel out
+        std::vector<std::vector<double>> cost(n, std::vector<double>(m + n, 2.0 * gate));
+        for (int i = 0; i < n; i++) {
+            const std::array<double, 2> &position = expected.at(panels[i]);
+            for (int j = 0; j < m; j++) {
+                double dx = sources[j].x - position[0] - assignment.shiftX;
+                double dy = sources[j].y - position[1] - assignment.shiftY;
+                double d2 = dx * dx + dy * dy;
+                if (d2 <= gate)
+                    cost[i][j] = d2;
+            }
+            cost[i][m + i] = gate;
+        }
+        columnOf = solveAssignment(cost);
+
+        if (pass == 1)
+            break;
+        std::vector<double> offsetsX, offsetsY;
+        for (int i = 0; i < n; i++) {
+            if (columnOf[i] < 0 || columnOf[i] >= m)
+                continue;
+            offsetsX.push_back(sources[columnOf[i]].x - expected.at(panels[i])[0]);
+            offsetsY.push_back(sources[columnOf[i]].y - expected.at(panels[i])[1]);
+        }
+        if (offsetsX.size() < 3)
+            break; // too few to tell a drift from a misplaced panel
+        std::nth_element(offsetsX.begin(), offsetsX.begin() + offsetsX.size() / 2, offsetsX.end());
+        std::nth_element(offsetsY.begin(), offsetsY.begin() + offsetsY.size() / 2, offsetsY.end());
+        assignment.shiftX = offsetsX[offsetsX.size() / 2];
+        assignment.shiftY = offsetsY[offsetsY.size() / 2];
+    }
+
+    std::vector<char> taken(m, 0);
+    for (int i = 0; i < n; i++) {
+        if (columnOf[i] >= 0 && columnOf[i] < m) {
+            assignment.panelSources[panels[i]] = sources[columnOf[i]];
+            taken[columnOf[i]] = 1;
+        }
+    }
+    for (int j = 0; j < m; j++) {
+        if (!taken[j])
+            assignment.unassigned.push_back(sources[j]);
+    }
+
+    spdlog::debug("FocalPlaneAnalyzer : assigned {} of {} panels, common shift ({}, {})",
+                  assignment.panelSources.size(), n, assignment.shiftX, assignment.shiftY);
+    return assignment;
+}
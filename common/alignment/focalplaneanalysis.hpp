@@ -0,0 +1,155 @@
+/**
+ * @file focalplaneanalysis.hpp
+ * @brief Header file for the in-process analysis of focal plane camera images.
+ */
+
+#ifndef ALIGNMENT_FOCALPLANEANALYSIS_HPP
+#define ALIGNMENT_FOCALPLANEANALYSIS_HPP
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+/// @brief An 8-bit grayscale focal plane image, row-major.
+struct FocalPlaneImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+
+    bool empty() const { return pixels.empty(); }
+};
+
+/**
+ * Finds the panel spots in focal plane images and works out the panel motions that move them.
+ *
+ * Source extraction follows SExtractor/SEP: pixels more than a threshold (in units of the background noise)
+ * above the background are grouped into 8-connected objects of a minimum area, which are then deblended by
+ * re-thresholding each object at exponentially spaced levels between the detection threshold and its peak.
+ * A branch is split off as its own source if it holds at least a minimum fraction of the object's flux.
+ *
+ * In a pattern image the spots of the panels of one ring lie on a circle. The circle is fitted to the sources
+ * near the expected ring, and every source on it is labelled with the panel whose place on the ring
+ * (evenly spaced in panel order, starting at a phase offset) is closest to its angle.
+ *
+ * When many panels' spots are in the image at once away from the ring (e.g. each sent to the focus plus a
+ * deliberate offset of its own), they are told apart by a minimum-cost assignment of sources to expected
+ * positions (Hungarian algorithm), after taking out the common shift of all spots.
+ *
+ * Panel motions are solved from per-panel 2x2 response matrices: d(spot x, spot y) / d(rx, ry).
+ */
+class FocalPlaneAnalyzer {
+public:
+    struct Source {
+        double x = 0.0, y = 0.0; // flux-weighted centroid, pixels
+        double flux = 0.0; // background subtracted
+        double peak = 0.0; // background subtracted
+        int npix = 0;
+        double x2 = 0.0, y2 = 0.0, xy = 0.0; // flux-weighted second moments about the centroid
+    };
+
+    struct ExtractionParameters {
+        double threshold = 6.0; // detection threshold, in background sigma
+        int minArea = 30; // pixels
+        double deblendMinCont = 0.01; // minimum flux fraction of a deblended branch
+        int deblendLevels = 32;
+        // search window, ignored if empty (x0 == x1 or y0 == y1)
+        int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+    };
+
+    struct RingParameters {
+        double centerX = 0.0, centerY = 0.0; // expected center of the ring
+        double radius = 0.0; // expected radius
+        double ringTol = 0.1; // sources within ringTol * radius of the ring are on it
+        double ringFrac = 0.5; // the fit is valid if at least this fraction of the ring's panels is found
+        double minDist = 0.0; // of two sources closer than this, only the brighter one is kept
+        double phaseOffset = 0.0; // angle (rad) of the first panel of the ring
+        int direction = 1; // 1 if the panels follow increasing image angle (atan2 with y down), -1 if decreasing
+    };
+
+    struct Ring {
+        bool valid = false;
+        double centerX = 0.0, centerY = 0.0, radius = 0.0;
+        std::map<unsigned, Source> panelSources; // panel position -> its spot
+        std::vector<Source> unassigned; // sources on the ring that lost out to a closer one for their panel
+    };
+
+    struct Assignment {
+        std::map<unsigned, Source> panelSources; // panel position -> its spot
+        std::vector<Source> unassigned;
+        double shiftX = 0.0, shiftY = 0.0; // common offset of the spots from their expected positions
+    };
+
+    struct Background {
+        double level = 0.0;
+        double sigma = 1.0;
+    };
+
+    /// 2x2 response d(spot x, spot y) / d(rx, ry), row-major.
+    typedef std::array<double, 4> ResponseMatrix;
+
+    struct PanelMotion {
+        bool valid = false;
+        double rx = 0.0, ry = 0.0;
+    };
+
+    static const int DEFAULT_WIDTH;
+    static const int DEFAULT_HEIGHT;
+
+    /**
+     * @brief Load a raw Mono8 image. The size is taken from the "-<width>-<height>-Mono8" part of the file
+     * name if present (as written by the focal plane camera), else DEFAULT_WIDTH x DEFAULT_HEIGHT.
+     */
+    static bool loadRawImage(const std::string &path, FocalPlaneImage &image);
+
+    static bool saveRawImage(const std::string &path, const FocalPlaneImage &image);
+
+    /// Median and (MAD-based) standard deviation of the image.
+    static Background estimateBackground(const FocalPlaneImage &image);
+
+    /// Sources in the image, brightest first.
+    static std::vector<Source> extractSources(const FocalPlaneImage &image, const ExtractionParameters &params);
+
+    /// @param ringPanels panel positions in order around the ring
+    static Ring fitRing(const std::vector<Source> &sources, const RingParameters &params,
+                        const std::vector<unsigned> &ringPanels);
+
+    /**
+     * @brief Label sources with the panels expected nearest to them, minimizing the total squared distance.
+     * A panel is left out rather than matched to a source more than maxDist from its expected position.
+     */
+    static Assignment assignSources(const std::vector<Source> &sources,
+                                    const std::map<unsigned, std::array<double, 2>> &expected, double maxDist);
+
+    /// Indices of the column assigned to each row of a cost matrix with at least as many columns as rows.
+    static std::vector<int> solveAssignment(const std::vector<std::vector<double>> &cost);
+
+    /// Expected spot position of the i-th of n panels on a ring.
+    static void ringPosition(const RingParameters &params, int i, int n, double &x, double &y);
+
+    /**
+     * @brief Read per-panel response matrices. Lines with a panel position followed by ':' start a panel; the
+     * next four numbers (on that line or the following ones, in any YAML-ish layout) are its matrix, row-major.
+     */
+    static bool loadResponseMatrices(const std::string &path, std::map<unsigned, ResponseMatrix> &matrices);
+
+    /// Motion (rx, ry) that moves a spot by (dx, dy).
+    static PanelMotion solveMotion(const ResponseMatrix &response, double dx, double dy);
+
+private:
+    // pixel indices of one object, plus its flux
+    struct Blob {
+        std::vector<int> pixels;
+        double flux = 0.0;
+    };
+
+    // split blob into branches holding at least deblendMinCont of totalFlux, recursively; pixel values are
+    // background subtracted, baseLevel is the level blob was found at
+    static void __deblend(const FocalPlaneImage &image, double background, const Blob &blob, double baseLevel,
+                          double totalFlux, const ExtractionParameters &params, std::vector<int> &stamp,
+                          int &stampCounter, std::vector<Blob> &out);
+
+    static Source __measure(const FocalPlaneImage &image, double background, const Blob &blob);
+};
+
+#endif //ALIGNMENT_FOCALPLANEANALYSIS_HPP
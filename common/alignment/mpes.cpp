@@ -1,7 +1,10 @@
 #include "common/alignment/mpes.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <ctime>
 #include <dirent.h>
 #include <fstream>
 #include <iomanip>
@@ -10,12 +13,15 @@
 #include <unistd.h>
 
 #include "common/alignment/platform.hpp"
+#include "common/alignment/usbdevices.hpp"
 
 #include "common/utilities/spdlog/spdlog.h"
 #include "common/utilities/spdlog/fmt/ostr.h"
 
 
 const int MPESBase::DEFAULT_IMAGES_TO_CAPTURE = 9;
+// what an average of DEFAULT_IMAGES_TO_CAPTURE frames gives, at a typical frame-to-frame scatter of 0.2 px
+const float MPESBase::DEFAULT_TARGET_CENTROID_SIGMA = 0.07;
 const std::string MPESBase::DEFAULT_IMAGES_SAVE_DIR_PATH = "/home/root/mpesimages";
 const std::string MPESBase::MATRIX_CONSTANTS_DIR_PATH = "/home/root/mpesCalibration/";
 const std::string MPESBase::CAL2D_CONSTANTS_DIR_PATH = "/home/root/mpesCalibration/";
@@ -66,12 +72,56 @@ int MPESBase::updatePosition() {
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
     spdlog::info("{} : MPES::updatePosition() : Reading webcam...", m_Identity);
-    int intensity;
-    intensity = __updatePosition();
+    if (!__captureFrames()) {
+        spdlog::error("{} : MPES::updatePosition() : Failed to grab any frames.", m_Identity);
+        return 0;
+    }
+    int intensity = __analyzeFrames();
+    spdlog::info("{} : MPES::updatePosition() : Done.", m_Identity);
+    return intensity;
+}
+
+int MPESBase::updatePosition(CaptureBudget &budget) {
+    if (isBusy()) {
+        spdlog::error("{} : MPES::updatePosition() : Busy, cannot read webcam.", m_Identity);
+        return -1;
+    }
+    Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    bool captured;
+    {
+        std::lock_guard<CaptureBudget> slot(budget);
+        spdlog::info("{} : MPES::updatePosition() : Reading webcam...", m_Identity);
+        captured = __captureFrames();
+    }
+    if (!captured) {
+        spdlog::error("{} : MPES::updatePosition() : Failed to grab any frames.", m_Identity);
+        return 0;
+    }
+    int intensity = __analyzeFrames();
     spdlog::info("{} : MPES::updatePosition() : Done.", m_Identity);
     return intensity;
 }
 
+void MPESBase::CaptureBudget::lock() {
+    if (m_Unlimited) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Released.wait(lock, [this]() { return m_Free > 0; });
+    m_Free--;
+}
+
+void MPESBase::CaptureBudget::unlock() {
+    if (m_Unlimited) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Free++;
+    }
+    m_Released.notify_one();
+}
+
 void MPESBase::turnOn() {
     if (isBusy()) {
         spdlog::error("{} : MPES::turnOn() : Busy, cannot turn on MPES.", m_Identity);
@@ -93,6 +143,12 @@ void MPESBase::turnOn() {
 #include "common/mpescode/MPESImageSet.h"
 #include "common/mpescode/MPESDevice.h"
 
+const int MPES::EXPOSURE_PROBE_IMAGES = 2;
+const int MPES::MAX_EXPOSURE_ITERATIONS = 8;
+const int MPES::EXPOSURE_CACHE_LIFETIME = 6 * 3600;
+const float MPES::EXPOSURE_CACHE_TEMPERATURE_TOLERANCE = 3.;
+const float MPES::MAX_SATURATED_FRACTION = 0.5;
+
 void MPES::turnOff() {
     if (isBusy()) {
         spdlog::error("{} : MPES::turnOff() : Busy, cannot turn off MPES.", m_Identity);
@@ -110,39 +166,33 @@ bool MPES::isOn() {
 // check this value to see if everything is working fine
 bool MPES::__initialize() {
     spdlog::info("{} : MPES::initialize() : Initializing...", m_Identity);
-    // we toggle the usb port, checking the video devices when it's off and again when it's on.
-    // the new video device is the ID of the newly created MPES.
+    // look the webcam up by the USB topology behind our port. Only if the port has never been seen
+    // do we toggle it and wait for the new video device to show up.
 
     m_Errors.assign(getNumErrors(), false);
 
-    m_pCBC->usb.disable(getPortNumber()); // make sure our USB is off
-    std::set<int> oldVideoDevices = getVideoDevices(); // count video devices
-
-    m_pCBC->usb.enable(getPortNumber()); // switch the usb back on and wait for the video device to show up
-    sleep(4);
-
-    std::set<int> newVideoDevices = getVideoDevices(); // check all video devices again
-
-    std::set<int> toggledDevices;
-    std::set_difference(newVideoDevices.begin(), newVideoDevices.end(), oldVideoDevices.begin(), oldVideoDevices.end(),
-                        std::inserter(toggledDevices, toggledDevices.begin()));
+    int newVideoDeviceId = -1;
+    if (m_pCBC->usb.isEnabled(getPortNumber())) {
+        newVideoDeviceId = USBDeviceRegistry::findDevice(getPortNumber(), "video");
+    }
+    if (newVideoDeviceId < 0) {
+        newVideoDeviceId = USBDeviceRegistry::toggleAndFind(m_pCBC, getPortNumber(), "video");
+    }
 
-    int newVideoDeviceId;
-    if (toggledDevices.size() == 1) {
-        newVideoDeviceId = *toggledDevices.begin(); // get the only element in the set -- this is the new device ID
-        if (newVideoDeviceId == -1) {
-            return false; // make sure this is a valid video device -- i.e., not -1
-        }
-    } else {
-        spdlog::error("{} : MPES::initialize() : Found {} devices, should be exactly 1.", m_Identity,
-                      toggledDevices.size());
+    if (newVideoDeviceId < 0) {
+        spdlog::error("{} : MPES::initialize() : Found no video device on USB {}, should be exactly 1.", m_Identity,
+                      getPortNumber());
         setError(0); // fatal
-        return false; // the list should be just one device at this point
+        return false;
     }
 
     spdlog::debug("MPES::initialize(): Detected new video device {}.", newVideoDeviceId);
     m_pDevice = std::unique_ptr<MPESDevice>(new MPESDevice(newVideoDeviceId));
     m_pImageSet = std::unique_ptr<MPESImageSet>(new MPESImageSet(m_pDevice.get(), DEFAULT_IMAGES_TO_CAPTURE,DEFAULT_IMAGES_SAVE_DIR_PATH.c_str()));
+    {
+        std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+        m_SpotFilter.reset(); // possibly a different webcam
+    }
 
     std::ostringstream oss;
     oss << std::setfill('0') << std::setw(6) << getSerialNumber(); // pad serial number to 6 digits with zeros
@@ -176,99 +226,129 @@ int MPES::__setExposure() {
     spdlog::info("{} : MPES::setExposure() : Resetting exposure...", m_Identity);
 
     m_pDevice->SetTolerance(INTENSITY_RATIO_TOLERANCE);
+    unsetError(4);
+    unsetError(5);
+    unsetError(6);
+
+    const float target = m_pDevice->GetTargetIntensity();
+    const float temperature = m_pCBC->adc.readTemperature();
+    const std::time_t now = std::time(0);
+
+    int exposure = m_pDevice->GetExposure();
+    if (m_ExposureCache.exposure > 0 && (now - m_ExposureCache.timestamp) < EXPOSURE_CACHE_LIFETIME &&
+        std::abs(temperature - m_ExposureCache.temperature) < EXPOSURE_CACHE_TEMPERATURE_TOLERANCE) {
+        exposure = m_ExposureCache.exposure;
+        spdlog::info("{} : MPES::setExposure() : Starting from cached exposure {} ({} s old, {} C).", m_Identity,
+                     exposure, now - m_ExposureCache.timestamp, m_ExposureCache.temperature);
+    }
+    exposure = std::max(MIN_EXPOSURE, std::min(MAX_EXPOSURE, exposure));
+
+    // I(e) is close to linear (with a small dark offset) as long as the spot is not clipped, so a secant
+    // through the last two unclipped frames lands on target in one or two steps. Clipped frames
+    // under-report the intensity and are only used to step the exposure down.
+    int prevExposure = -1;
+    float prevIntensity = -1.;
+    float intensity = -1.;
+    bool clipped = false;
+    bool converged = false;
+
+    for (int iteration = 0; iteration < MAX_EXPOSURE_ITERATIONS; iteration++) {
+        // average a second frame once we are close, so frame-to-frame noise does not decide convergence
+        bool close = (prevIntensity > 0) && (prevIntensity > target / 2.) && (prevIntensity < target * 2.);
+        const MPESSetData &data = probeExposure(exposure, close ? EXPOSURE_PROBE_IMAGES : 1);
+        intensity = data.CleanedIntensity;
+
+        spdlog::info("{} : MPES::setExposure() : Exposure {} -> intensity {} ({}), {} saturated pixels.", m_Identity,
+                     exposure, intensity, target, data.nSat);
+
+        if (intensity <= 0.) {
+            // no pixels pass threshold -- nothing to scale from, so jump straight to the brightest setting
+            if (exposure >= MAX_EXPOSURE) {
+                break;
+            }
+            exposure = MAX_EXPOSURE;
+            prevExposure = -1;
+            prevIntensity = -1.;
+            continue;
+        }
 
-    int currentExposure;
-    int tempExposure = m_pDevice->GetExposure();
-    bool tryExtremeExposure = true ;
-    bool ratio_error = false;
-
-    do{
-        spdlog::info("Trying read() again to maintain inside constraints");
-        unsetError(4);
-        unsetError(5);
-        unsetError(6);
-
-        currentExposure = m_pDevice->GetExposure();
-        if (std::abs(m_Position.xSpotWidth / m_Position.ySpotWidth - 1) > 0.40) {
-            spdlog::error("Image is severely uneven and outside physical expectations. Exiting setExposure loop.");
-            ratio_error = true;
+        if (data.ySpotSD > 0 && std::abs(data.xSpotSD / data.ySpotSD - 1) > 0.40) {
+            // errors 5 and 6 are left to the analysis of the refreshed position below
+            spdlog::error("{} : MPES::setExposure() : Image is severely uneven and outside physical expectations. Stopping exposure search.",
+                          m_Identity);
             break;
         }
 
-        spdlog::info("Condition 1: {} <= {} * {}/{} = {}",m_Position.cleanedIntensity, m_pDevice->GetTargetIntensity(), currentExposure,std::to_string(MAX_EXPOSURE),std::to_string(m_pDevice->GetTargetIntensity() * ((float)tempExposure/MAX_EXPOSURE)));
-        spdlog::info("Condition 2: {} >= {} * {}/{} = {}",m_Position.cleanedIntensity, m_pDevice->GetTargetIntensity(), currentExposure,std::to_string(MIN_EXPOSURE),std::to_string(m_pDevice->GetTargetIntensity() * ((float)tempExposure/MIN_EXPOSURE)));
-
-        __updatePosition();
-
-
-        spdlog::info("After updating position: ");
-        spdlog::info("Condition 1: {} <= {} * {}/{} = {}",m_Position.cleanedIntensity, m_pDevice->GetTargetIntensity(), currentExposure,std::to_string(MAX_EXPOSURE),std::to_string(m_pDevice->GetTargetIntensity() * ((float)tempExposure/MAX_EXPOSURE)));
-        spdlog::info("Condition 2: {} >= {} * {}/{} = {}",m_Position.cleanedIntensity, m_pDevice->GetTargetIntensity(), currentExposure,std::to_string(MIN_EXPOSURE),std::to_string(m_pDevice->GetTargetIntensity() * ((float)tempExposure/MIN_EXPOSURE)));
-
-        spdlog::info("{} : MPES::setExposure() : Intensity {} ({}). Exposure: {}.", m_Identity, m_Position.cleanedIntensity,
-                      m_pDevice->GetTargetIntensity(), currentExposure);
-
-        tempExposure = m_pDevice->GetExposure();
-
-        // Case 1: intensity is less than target (or even is zero), multiply exposure by precision and try again.
-        if (m_Position.cleanedIntensity <= (m_pDevice->GetTargetIntensity() * ((float)tempExposure/MAX_EXPOSURE))){
-            if (tryExtremeExposure) {
-                tryExtremeExposure = false;
-                m_pDevice->SetExposure(MAX_EXPOSURE);
-            } else {
-                m_pDevice->SetExposure((int) ((float) tempExposure * PRECISION));
-            }
-            spdlog::warn("Image is too dim, resetting exposure up to {}, from {} ",m_pDevice->GetExposure(), currentExposure);
-        }
-        // Case 2: intensity is greater than target (or is totally bright, e.g. tube open), divide exposure by precision and try again.
-        else if (m_Position.cleanedIntensity >=(m_pDevice->GetTargetIntensity() * ((float)tempExposure/MIN_EXPOSURE))) {
-            if (tryExtremeExposure)
-            {
-                tryExtremeExposure = false;
-                m_pDevice->SetExposure(MIN_EXPOSURE);
-            }
-            else
-            {
-                m_pDevice->SetExposure((int)((float)tempExposure / PRECISION));
-                spdlog::warn("Image is too bright, resetting exposure up to {}, from {}",m_pDevice->GetExposure(), currentExposure);
-            }
+        clipped = (data.nSat * 255.) > (MAX_SATURATED_FRACTION * intensity);
+        if (!clipped && intensity >= target / PRECISION && intensity <= target * PRECISION) {
+            converged = true;
+            break;
         }
-        // Case 3: normal operation, just increment to get closer to target.
-        else {
-            m_pDevice->SetExposure((int)((float)tempExposure * (m_pDevice->GetTargetIntensity() / m_Position.cleanedIntensity )));
-            spdlog::info("Normal operation, incrementing exposure up to {} from {}",m_pDevice->GetExposure(), currentExposure);
+
+        float nextExposure;
+        if (clipped) {
+            // true intensity is higher than measured -- step down at least by half
+            nextExposure = exposure * std::min(0.5f, target / intensity);
+        } else if (prevIntensity > 0 && prevExposure != exposure &&
+                   (intensity - prevIntensity) / (exposure - prevExposure) > 0) {
+            nextExposure = exposure + (target - intensity) * (exposure - prevExposure) / (intensity - prevIntensity);
+        } else {
+            nextExposure = exposure * (target / intensity);
         }
-    }
-    while (((m_Position.cleanedIntensity < (m_pDevice->GetTargetIntensity()/PRECISION)) || (m_Position.cleanedIntensity > (m_pDevice->GetTargetIntensity() * PRECISION))) && (m_pDevice->GetExposure() <= MAX_EXPOSURE ) && (m_pDevice->GetExposure() >= MIN_EXPOSURE));
 
-    if (m_pDevice->GetExposure() > MAX_EXPOSURE){
-        if (m_Position.cleanedIntensity <= (m_pDevice->GetTargetIntensity()/PRECISION)){
-        spdlog::error("{} : MPES::setExposure() : Failed to set exposure, reached maximum limit of {}. Setting Error 2 (too dim)...",
-                      m_Identity, std::to_string(MPESBase::MAX_EXPOSURE));
-        setError(2); //fatal
+        int next = std::max(MIN_EXPOSURE, std::min(MAX_EXPOSURE, (int) std::round(nextExposure)));
+        if (next == exposure) {
+            break; // pinned at a limit, or the step is below the exposure resolution
         }
-        m_pDevice->SetExposure(tempExposure);
-    }
-    else if (m_pDevice->GetExposure() < MIN_EXPOSURE){
-        if (m_Position.cleanedIntensity >= (m_pDevice->GetTargetIntensity() * PRECISION)){
-        spdlog::error("{} : MPES::setExposure() : Failed to set exposure, reached minimum limit of {}. Setting Error 3 (too bright)...",
-                      m_Identity, std::to_string(MPESBase::MIN_EXPOSURE));
-        setError(4); //operable
+
+        if (!clipped) {
+            prevExposure = exposure;
+            prevIntensity = intensity;
         }
-        m_pDevice->SetExposure(tempExposure);
+        exposure = next;
     }
-    else{
-        if (! ratio_error) {
-            spdlog::info("Normal exit from do-while loop. Intensity and exposure within the bound.");
+
+    m_pDevice->SetExposure(exposure);
+
+    if (converged) {
+        m_ExposureCache.exposure = exposure;
+        m_ExposureCache.timestamp = std::time(0);
+        m_ExposureCache.temperature = temperature;
+        spdlog::info("{} : MPES::setExposure() : Converged to exposure {} with intensity {}.", m_Identity, exposure,
+                     intensity);
+    } else {
+        m_ExposureCache = ExposureCache();
+        if (exposure >= MAX_EXPOSURE && intensity < target / PRECISION) {
+            spdlog::error("{} : MPES::setExposure() : Failed to set exposure, reached maximum limit of {}. Setting Error 2 (too dim)...",
+                          m_Identity, std::to_string(MPESBase::MAX_EXPOSURE));
+            setError(2); //fatal
+        } else if (exposure <= MIN_EXPOSURE && (clipped || intensity > target * PRECISION)) {
+            spdlog::error("{} : MPES::setExposure() : Failed to set exposure, reached minimum limit of {}. Setting Error 4 (too bright)...",
+                          m_Identity, std::to_string(MPESBase::MIN_EXPOSURE));
+            setError(4); //operable
+        } else {
+            spdlog::warn("{} : MPES::setExposure() : Did not converge, keeping exposure {} with intensity {}.",
+                         m_Identity, exposure, intensity);
         }
     }
 
+    // the probes are not saved or analyzed, so read the spot again at the exposure we settled on
+    __captureFrames();
+    __analyzeFrames();
+
     spdlog::info("{} : MPES::setExposure() : Done.", m_Identity);
 
-    return (int)m_Position.cleanedIntensity;
+    return (int) m_Position.cleanedIntensity;
 }
 
-int MPES::__updatePosition() {
+const MPESSetData &MPES::probeExposure(int exposure, int nImages) {
+    m_pDevice->SetExposure(exposure);
+    m_pImageSet->Capture(nImages, false);
+    m_pImageSet->simpleAverage();
+    return m_pImageSet->SetData;
+}
+
+bool MPES::__captureFrames() {
     // initialize to something obvious in case of failure
     m_Position.xCentroid = -3.;
     m_Position.yCentroid = -3.;
@@ -280,12 +360,97 @@ int MPES::__updatePosition() {
     m_Position.nSat = -3;
 
     // read sensor
-    if (int(m_pImageSet->Capture()) > 0) {
+    if (m_TargetCentroidSigma <= 0.) {
+        {
+            std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+            m_SpotFilter.reset();
+        }
+        if (m_pImageSet->Grab() <= 0) {
+            return __failedCapture();
+        }
+        return true;
+    }
+
+    // fuse frames into the estimate left by the previous reads until it is precise enough. The estimate alone never
+    // ends a read: at least one frame of this read has to agree with it, and a frame held back as an outlier has to be
+    // settled by the next one first.
+    int nFrames = 0;
+    int nAccepted = 0;
+    int nGrabbed = m_pImageSet->Grab(DEFAULT_IMAGES_TO_CAPTURE, true,
+                                     [this, &nFrames, &nAccepted](const MPESImageData &data) {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        nFrames++;
+        if (data.CleanedIntensity <= 0) // -1: no spot, -2: no image
+            return false;
+        std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+        if (!m_SpotFilter.update(data.xCentroid, data.yCentroid, t))
+            return false;
+        nAccepted++;
+        return m_SpotFilter.isValid() && m_SpotFilter.GetSigma() <= m_TargetCentroidSigma;
+    });
+    float sigma;
+    {
+        std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+        sigma = m_SpotFilter.GetSigma();
+    }
+    spdlog::debug("{} : MPES::captureFrames() : {} frames, {} accepted, centroid sigma {} px.", m_Identity, nFrames,
+                  nAccepted, sigma);
+    if (nGrabbed <= 0) {
+        return __failedCapture();
+    }
+    return true;
+}
+
+bool MPES::__failedCapture() {
+    // the image set keeps the first frame of a read that timed out, so it can tell a timeout from a missing webcam
+    const auto &datasets = m_pImageSet->datasetvec;
+    if (!datasets.empty() && !datasets.back().empty() && int(datasets.back().at(0).CleanedIntensity) == -2) {
+        m_Position.cleanedIntensity = -2.;
+        setError(1);
+        spdlog::error("{}: [1] [Fatal] Cleaned Intensity = -2. Failed to read data, possible select timeout.",m_Identity.serialNumber);
+    }
+    else {
+        setError(0);
+        spdlog::error("{}: [0] [Fatal] Cleaned Intensity = -3. Device not found. Default values unchanged. ",m_Identity.serialNumber);
+    }
+    m_Position.last_img = "";
+    m_Position.exposure = m_pDevice->GetExposure();
+    m_Position.timestamp = std::time(0);
+    return false;
+}
+
+void MPES::predictSpotShift(float dx, float dy) {
+    // the filter works on the raw centroids, which the matrix transform rotates into the reported ones
+    if (m_Calibrate && m_pDevice && m_pDevice->MatrixLoaded()) {
+        float angle = m_pDevice->GetCalibration().Angle;
+        float rawdx = dx * std::cos(angle) + dy * std::sin(angle);
+        float rawdy = -dx * std::sin(angle) + dy * std::cos(angle);
+        dx = rawdx;
+        dy = rawdy;
+    }
+    spdlog::debug("{} : MPES::predictSpotShift() : Spot expected to move by ({}, {}) px.", m_Identity, dx, dy);
+    std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+    m_SpotFilter.predict(dx, dy);
+}
+
+void MPES::flushImages() {
+    if (m_pImageSet) {
+        m_pImageSet->FlushImages();
+    }
+}
+
+int MPES::__analyzeFrames() {
+    if (m_pImageSet->Analyze() > 0) {
+        // average before calibrating, so the calibration works on this read's centroids
+        if (m_TargetCentroidSigma > 0.) {
+            std::lock_guard<std::mutex> lock(m_SpotFilterMutex);
+            m_pImageSet->filteredAverage(m_SpotFilter);
+        } else {
+            m_pImageSet->simpleAverage();
+        }
         if (m_Calibrate) {
             m_pImageSet->Matrix_Transform();
             m_pImageSet->Calibrate2D();
-        } else {
-            m_pImageSet->simpleAverage();
         }
 
         m_Position.xCentroid = m_pImageSet->SetData.xCentroid;
@@ -295,7 +460,7 @@ int MPES::__updatePosition() {
         m_Position.cleanedIntensity = m_pImageSet->SetData.CleanedIntensity;
         m_Position.nSat = m_pImageSet->SetData.nSat;
     }
-    m_Position.last_img = getLastImage();
+    m_Position.last_img = m_pImageSet->GetLastImage();
     if (int(m_Position.cleanedIntensity) == -1 ){
         // Real image possible, but no pixels pass threshold
         setError(7);
@@ -335,33 +500,6 @@ int MPES::__updatePosition() {
     return static_cast<int>(m_Position.cleanedIntensity);
 }
 
-std::set<int> MPES::getVideoDevices() {
-    std::set<int> videoDevices;
-
-    DIR *dir;
-    struct dirent *ent;
-
-    if ((dir = opendir("/dev")) != nullptr) { // Open /dev device directory in filesystem
-        /* print all the files and directories within directory */
-        while ((ent = readdir(dir)) != nullptr) {
-            std::string currentEntry = ent->d_name;
-            size_t pos;
-            std::string substringToFind = "video"; // Locate video devices (name including the string "video")
-            if ((pos = currentEntry.find(substringToFind)) != std::string::npos) { // Found video device
-                pos += substringToFind.length(); // go to immediately after the substring "video"
-                int deviceNumber = std::stoi(
-                        currentEntry.substr(pos)); // grab remaining part of device name to get the device number
-                videoDevices.insert(deviceNumber);
-            }
-        }
-        closedir(dir);
-    } else {
-        videoDevices = {-1}; // output signalling failure
-    }
-
-    return videoDevices;
-}
-
 #endif
 
 void DummyMPES::turnOff() {
@@ -424,7 +562,11 @@ int DummyMPES::__setExposure() {
     return intensity;
 }
 
-int DummyMPES::__updatePosition() {
+bool DummyMPES::__captureFrames() {
+    return true;
+}
+
+int DummyMPES::__analyzeFrames() {
     // Set internal position variable to dummy values
     std::random_device rd{};
     std::mt19937 generator{rd()};
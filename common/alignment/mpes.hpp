@@ -6,9 +6,11 @@
 #ifndef ALIGNMENT_MPES_HPP
 #define ALIGNMENT_MPES_HPP
 
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <math.h>
@@ -38,6 +40,24 @@ public:
         std::string last_img;
     };
 
+    /// @brief Limits how many webcams stream at once, so that their combined bandwidth fits on the USB bus.
+    /// Each lock() takes one capture slot (waiting for one to free up), unlock() gives it back.
+    class CaptureBudget {
+    public:
+        /// @param maxConcurrentCaptures Number of webcams allowed to stream at once; 0 or less for no limit.
+        explicit CaptureBudget(int maxConcurrentCaptures) : m_Free(maxConcurrentCaptures),
+                                                            m_Unlimited(maxConcurrentCaptures <= 0) {}
+
+        void lock();
+        void unlock();
+
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Released;
+        int m_Free;
+        bool m_Unlimited;
+    };
+
     static const std::vector<Device::ErrorDefinition> ERROR_DEFINITIONS;
 
     Device::ErrorDefinition getErrorCodeDefinition(int errorCode) override {
@@ -54,6 +74,8 @@ public:
     int getPortNumber() const { return std::stoi(m_Identity.eAddress); };
     int getSerialNumber() const { return m_Identity.serialNumber; };
     std::string getLastImage() const { return m_Position.last_img; };
+    // block until the images of the reads so far are on disk -- they are written in the background
+    virtual void flushImages() {}
 
     bool initialize() override;
 
@@ -63,11 +85,24 @@ public:
     void setyNominalPosition(float y) { m_Position.yNominal = y; }
 
     int updatePosition();
+    // as above, but only opens the webcam once the budget has room for it, and gives the room back
+    // before analyzing the frames
+    int updatePosition(CaptureBudget &budget);
 
     MPESBase::Position getPosition() const { return m_Position; };
 
+    // Reads stop capturing frames once the centroid is known to this precision (px), carrying the estimate over from
+    // earlier reads; 0 or less to always average DEFAULT_IMAGES_TO_CAPTURE fresh frames.
+    float getTargetCentroidSigma() const { return m_TargetCentroidSigma; }
+    void setTargetCentroidSigma(float sigma) { m_TargetCentroidSigma = sigma; }
+
+    // Tell the sensor that its spot is expected to move by (dx, dy) px, e.g. from a commanded panel motion, so that the
+    // next read starts from there instead of from scratch.
+    virtual void predictSpotShift(float dx, float dy) {}
+
     // Hardcoded constants
     static const int DEFAULT_IMAGES_TO_CAPTURE;
+    static const float DEFAULT_TARGET_CENTROID_SIGMA;
     static const std::string MATRIX_CONSTANTS_DIR_PATH;
     static const std::string CAL2D_CONSTANTS_DIR_PATH;
     static const std::string DEFAULT_IMAGES_SAVE_DIR_PATH;
@@ -80,6 +115,9 @@ public:
     static constexpr int MIN_EXPOSURE = kMIN_EXPOSURE;
     static constexpr float INTENSITY_RATIO_TOLERANCE = kINTENSITY_RATIO_TOLERANCE;
     static constexpr float PRECISION = kPRECISION;
+    // centre of the default frame, where the spot is safest from leaving the field of view
+    static constexpr float FRAME_CENTER_X = kDEFAULT_RESOLUTION / 2.;
+    static constexpr float FRAME_CENTER_Y = kDEFAULT_RESOLUTION * 3. / 8.;
 
     void turnOn();
 
@@ -90,10 +128,15 @@ protected:
     bool m_Calibrate;
 
     Position m_Position = Position(); // MPES Reading
+    float m_TargetCentroidSigma = DEFAULT_TARGET_CENTROID_SIGMA;
 
     virtual bool __initialize() = 0;
 
-    virtual int __updatePosition() = 0;
+    // read frames off the webcam; false if none could be read
+    virtual bool __captureFrames() = 0;
+
+    // analyze the frames from __captureFrames() into m_Position; returns the intensity of the beam
+    virtual int __analyzeFrames() = 0;
 
     virtual int __setExposure() = 0;
 };
@@ -103,6 +146,7 @@ protected:
 #include "common/cbccode/cbc.hpp"
 #include "common/mpescode/MPESDevice.h"
 #include "common/mpescode/MPESImageSet.h"
+#include "common/mpescode/MPESSpotFilter.h"
 
 class MPES : public MPESBase {
 public:
@@ -116,20 +160,48 @@ public:
 
     bool isOn() override;
 
+    void predictSpotShift(float dx, float dy) override;
+
+    void flushImages() override;
+
 protected:
     std::shared_ptr<CBC> m_pCBC;
 
     bool __initialize() override;
 
-    int __updatePosition() override;
+    bool __captureFrames() override;
+    int __analyzeFrames() override;
 
     int __setExposure() override;
 
+    // raise the fatal error of a grab that read no frames, which is not analyzed; returns false
+    bool __failedCapture();
+
     // helpers
     std::shared_ptr<MPESImageSet> m_pImageSet;
     std::unique_ptr<MPESDevice> m_pDevice;
+    MPESSpotFilter m_SpotFilter; // centroid estimate carried from read to read
+    std::mutex m_SpotFilterMutex; // predictSpotShift() comes in on the client's thread, not the reading one
+
+    // Last exposure that converged, reused as the starting point of the next search
+    // as long as it is recent and the board temperature has not drifted.
+    struct ExposureCache {
+        ExposureCache() : exposure(-1), timestamp(0), temperature(0.) {}
+
+        int exposure;
+        std::time_t timestamp;
+        float temperature;
+    };
+    ExposureCache m_ExposureCache;
+
+    static const int EXPOSURE_PROBE_IMAGES; // frames per search iteration once close to target
+    static const int MAX_EXPOSURE_ITERATIONS;
+    static const int EXPOSURE_CACHE_LIFETIME; // seconds
+    static const float EXPOSURE_CACHE_TEMPERATURE_TOLERANCE; // degrees C
+    static const float MAX_SATURATED_FRACTION; // fraction of intensity in saturated pixels before the frame is treated as clipped
 
-    static std::set<int> getVideoDevices();
+    // capture nImages frames at the given exposure without saving them, and return their averaged data
+    const MPESSetData &probeExposure(int exposure, int nImages);
 };
 
 #endif
@@ -143,7 +215,8 @@ public:
 
     bool __initialize() override;
     int __setExposure() override;
-    int __updatePosition() override;
+    bool __captureFrames() override;
+    int __analyzeFrames() override;
 
     void turnOff() override;
 
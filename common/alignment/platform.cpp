@@ -7,6 +7,8 @@
 #include <cppconn/exception.h>
 #include <cppconn/resultset.h>
 #include <cppconn/statement.h>
+#include <chrono>
+#include <future>
 #include <random>
 #include <algorithm>
 #include <unistd.h>
@@ -78,11 +80,133 @@ PlatformBase::step(std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> inputSte
         return inputSteps;
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsRemaining = __step(inputSteps);
 
     return stepsRemaining;
 }
 
+bool PlatformBase::planMotion(const std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> &inputSteps,
+                              PlatformBase::MotionPlan &plan) {
+    // Each actuator first moves its full distance minus its hysteresis steps (overshooting when retracting),
+    // then returns by the hysteresis steps so that every final approach comes from the same direction.
+    // Both legs are split into check points no further apart than each actuator's RecordingInterval, and all
+    // actuators share the same check points so that they move simultaneously and finish together.
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> mainSteps{};
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> hysteresisSteps{};
+    int mainCheckPoints = 0;
+    int hysteresisCheckPoints = 0;
+
+    plan.checkPoints.clear();
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        plan.startPositions[i] = m_Actuators[i]->getCurrentPosition();
+        plan.finalPositions[i] = m_Actuators[i]->predictNewPosition(plan.startPositions[i],
+                                                                   -inputSteps[i]);//negative steps because positive step is extension of motor, negative steps increases counter since home is defined (0,0)
+        if (inputSteps[i] != 0) {
+            hysteresisSteps[i] = m_Actuators[i]->getHysteresisSteps();
+            mainSteps[i] = inputSteps[i] - hysteresisSteps[i];
+        }
+        int interval = m_Actuators[i]->RecordingInterval;
+        if (mainSteps[i] != 0) {
+            mainCheckPoints = std::max(mainCheckPoints, 1 + ((std::abs(mainSteps[i]) - 1) /
+                                                             interval));//simply integer division rounded up, hence the -1.
+        }
+        if (hysteresisSteps[i] != 0) {
+            hysteresisCheckPoints = std::max(hysteresisCheckPoints, 1 + ((std::abs(hysteresisSteps[i]) - 1) / interval));
+        }
+    }
+
+    MotionCheckPoint checkPoint{};
+    for (int k = 1; k <= mainCheckPoints + hysteresisCheckPoints; k++) {
+        checkPoint.hysteresisReturn = (k > mainCheckPoints);
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            int stepsSoFar;
+            if (!checkPoint.hysteresisReturn) {
+                stepsSoFar = (mainSteps[i] * k) / mainCheckPoints;
+            } else {
+                stepsSoFar = mainSteps[i] + (hysteresisSteps[i] * (k - mainCheckPoints)) / hysteresisCheckPoints;
+            }
+            checkPoint.positions[i] = m_Actuators[i]->predictNewPosition(plan.startPositions[i], -stepsSoFar);
+        }
+        plan.checkPoints.push_back(checkPoint);
+    }
+
+    // Every point of the trajectory (including the overshoot) must stay within the software range.
+    std::vector<std::array<ActuatorBase::Position, PlatformBase::NUM_ACTS_PER_PLATFORM>> pointsToCheck;
+    pointsToCheck.push_back(plan.finalPositions);
+    for (const auto &point : plan.checkPoints) {
+        pointsToCheck.push_back(point.positions);
+    }
+    for (const auto &positions : pointsToCheck) {
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            if (positions[i].revolution < m_Actuators[i]->ExtendRevolutionLimit ||
+                positions[i].revolution >= m_Actuators[i]->RetractRevolutionLimit) {
+                spdlog::error(
+                    "{} : Platform::planMotion() : Operable Error (12): Attempting to move Actuator {} outside of software range ({}-{} mm).",
+                    m_Identity, m_Actuators[i]->getIdentity(),
+                    m_Actuators[i]->HomeLength -
+                    (m_Actuators[i]->RetractRevolutionLimit *
+                     m_Actuators[i]->StepsPerRevolution *
+                     m_Actuators[i]->mmPerStep),
+                    m_Actuators[i]->HomeLength -
+                    (m_Actuators[i]->ExtendRevolutionLimit *
+                     m_Actuators[i]->StepsPerRevolution *
+                     m_Actuators[i]->mmPerStep));
+                setError(12);
+                return false;
+            }
+        }
+    }
+
+    spdlog::debug("{} : Platform::planMotion() : Planned {} main and {} hysteresis check points.", m_Identity,
+                  mainCheckPoints, hysteresisCheckPoints);
+    return true;
+}
+
+std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM>
+PlatformBase::__executeMotionPlan(const PlatformBase::MotionPlan &plan) {
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsRemaining{};
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsToTake{};
+
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(plan.finalPositions[i]) -
+                              m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
+    }
+
+    for (const auto &checkPoint : plan.checkPoints) {
+        if (__isStopRequested()) {
+            spdlog::warn("{} : Platform::step() : Successfully stopped motion, {:.1f} ms after the stop request.",
+                         m_Identity, __msSinceStopRequest());
+            return StepsRemaining;
+        }
+        if (getDeviceState() == Device::DeviceState::Off || getErrorState() == Device::ErrorState::FatalError) {
+            spdlog::warn("{} : Platform::step() : Successfully stopped motion.", m_Identity);
+            return StepsRemaining;
+        }
+        // Steps are measured from the verified position, so steps missed at the previous check point are
+        // made up on the way to the next one.
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            StepsToTake[i] = -(m_Actuators[i]->convertPositionToSteps(checkPoint.positions[i]) -
+                               m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
+        }
+        spdlog::trace("{} : Platform::step() : Stepping ({}, {}, {}, {}, {}, {}) steps to next {}check point.",
+                      m_Identity, StepsToTake[0], StepsToTake[1], StepsToTake[2], StepsToTake[3], StepsToTake[4],
+                      StepsToTake[5], checkPoint.hysteresisReturn ? "hysteresis " : "");
+        if (!__stepToCheckPoint(StepsToTake)) {
+            spdlog::error("{} : Platform::step() : Failed to register steps at check point, motion plan stopped.",
+                          m_Identity);
+            break;
+        }
+
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(plan.finalPositions[i]) -
+                                  m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
+        }
+    }
+
+    return StepsRemaining;
+}
+
 void PlatformBase::checkActuatorStatus(int actuatorIdx) {
     Device::ErrorState actuatorStatus = m_Actuators.at(actuatorIdx)->getErrorState();
     if (actuatorStatus == Device::ErrorState::FatalError) {
@@ -110,6 +234,7 @@ void PlatformBase::probeEndStopAll(int direction) {
         return;
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     __probeEndStopAll(direction);
 }
 
@@ -132,6 +257,7 @@ std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> PlatformBase::__measureLe
 std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM>
 PlatformBase::moveToLengths(std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> targetLengths) {
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
 
     std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> currentLengths = __measureLengths();
     std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> deltaLengths{};
@@ -149,6 +275,7 @@ PlatformBase::moveToLengths(std::array<float, PlatformBase::NUM_ACTS_PER_PLATFOR
 std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM>
 PlatformBase::moveDeltaLengths(std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> deltaLengths) {
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsToTake{};
 
     for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
@@ -174,10 +301,18 @@ bool PlatformBase::isOn() {
 }
 
 void PlatformBase::emergencyStop() {
+    // stop first, log after: the log may be flushed to disk
+    m_StopRequestTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_StopCount++;
+    __abortMotion();
     spdlog::warn("{} : Platform::emergencyStop(): Stopping all actuator motion...", m_Identity);
-    m_On = false; // We temporarily set the state to off to indicate that the motion should be stopped.
-    sleep(1);
-    m_On = true;
+}
+
+double PlatformBase::__msSinceStopRequest() const {
+    long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (now - m_StopRequestTime) / 1.e6;
 }
 
 Device::ErrorState PlatformBase::getErrorState() {
@@ -222,12 +357,54 @@ void PlatformBase::clearPlatformErrors() {
     }
 }
 
+bool PlatformBase::addMPESAll(const std::vector<Device::Identity> &identities) {
+    bool success = true;
+    for (const auto &identity : identities) {
+        success &= addMPES(identity);
+    }
+    return success;
+}
+
 MPESBase::Position PlatformBase::readMPES(int idx) {
     spdlog::info("{} : Reading MPES {}...", m_Identity, idx);
     m_MPES.at(idx)->updatePosition();
     return m_MPES.at(idx)->getPosition();
 }
 
+std::map<Device::Identity, MPESBase::Position> PlatformBase::readMPESAll(int maxConcurrentCaptures,
+                                                                         const std::set<int> &serials) {
+    spdlog::info("{} : Reading {} MPES, at most {} webcams at a time...", m_Identity,
+                 serials.empty() ? "all" : std::to_string(serials.size()), maxConcurrentCaptures);
+
+    MPESBase::CaptureBudget budget(maxConcurrentCaptures);
+    std::vector<MPESBase *> toRead;
+    std::vector<std::future<int>> reads;
+    for (const auto &pMPES : m_MPES) {
+        if (!serials.empty() && serials.find(pMPES->getIdentity().serialNumber) == serials.end()) {
+            continue;
+        }
+        if (pMPES->getDeviceState() != Device::DeviceState::On ||
+            pMPES->getErrorState() == Device::ErrorState::FatalError) {
+            spdlog::error("{} : MPES {} is off/in fatal error state, unable to read.", m_Identity,
+                          pMPES->getIdentity());
+            continue;
+        }
+        MPESBase *p = pMPES.get();
+        toRead.push_back(p);
+        reads.push_back(std::async(std::launch::async, [p, &budget]() { return p->updatePosition(budget); }));
+    }
+
+    std::map<Device::Identity, MPESBase::Position> positions;
+    for (unsigned i = 0; i < toRead.size(); i++) {
+        if (reads[i].get() <= 0) {
+            spdlog::error("{} : Failed to read MPES {}.", m_Identity, toRead[i]->getIdentity());
+            continue;
+        }
+        positions.insert(std::make_pair(toRead[i]->getIdentity(), toRead[i]->getPosition()));
+    }
+    return positions;
+}
+
 #ifndef SIMMODE
 
 #include "common/cbccode/cbc.hpp"
@@ -386,135 +563,101 @@ Platform::__step(std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> inputSteps
 
     spdlog::debug("{} : Platform::step() : Stepping platform ({}, {}, {}, {}, {}, {}) steps.",
                   m_Identity, inputSteps[0], inputSteps[1], inputSteps[2], inputSteps[3], inputSteps[4], inputSteps[5]);
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsRemaining{};
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> ActuatorIterations = {0, 0, 0, 0, 0, 0};
-    std::array<ActuatorBase::Position, PlatformBase::NUM_ACTS_PER_PLATFORM> FinalPosition{};
 
     for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
         m_Actuators[i]->loadStatusFromASF();
         m_Actuators[i]->recoverPosition();
-        FinalPosition[i] = m_Actuators[i]->predictNewPosition(m_Actuators[i]->getCurrentPosition(),
-                                                              -inputSteps[i]);//negative steps because positive step is extension of motor, negative steps increases counter since home is defined (0,0)
-        StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                              m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-
-        if (FinalPosition[i].revolution < m_Actuators[i]->ExtendRevolutionLimit ||
-            FinalPosition[i].revolution >= m_Actuators[i]->RetractRevolutionLimit) {
-            spdlog::error(
-                "{} : Platform::step() : Operable Error (12): Attempting to move Actuator {} {}-{} mm outside of software range.",
-                m_Identity, m_Actuators[i]->getIdentity(),
-                m_Actuators[i]->HomeLength -
-                (m_Actuators[i]->RetractRevolutionLimit *
-                 m_Actuators[i]->StepsPerRevolution *
-                 m_Actuators[i]->mmPerStep),
-                m_Actuators[i]->HomeLength -
-                (m_Actuators[i]->ExtendRevolutionLimit *
-                 m_Actuators[i]->StepsPerRevolution *
-                 m_Actuators[i]->mmPerStep));
-            setError(12);
-
-            return inputSteps;
-        }
+    }
 
-        if (StepsRemaining[i] != 0) {
-            ActuatorIterations[i] = 1 + ((std::abs(StepsRemaining[i]) - 1) /
-                                         m_Actuators[i]->RecordingInterval);//simply integer division rounded up, hence the -1.
-        }
+    MotionPlan plan;
+    if (!planMotion(inputSteps, plan)) {
+        return inputSteps;
     }
 
-    spdlog::debug("{} : Platform::step() : Actuator iterations: ({}, {}, {}, {}, {}, {}).",
-                  m_Identity, ActuatorIterations[0], ActuatorIterations[1], ActuatorIterations[2],
-                  ActuatorIterations[3], ActuatorIterations[4], ActuatorIterations[5]);
+    m_pCBC->driver.enableAll();
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsRemaining = __executeMotionPlan(plan);
+    m_pCBC->driver.disableAll();
 
-    int IterationsRemaining = *std::max_element(ActuatorIterations.begin(), ActuatorIterations.end());
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsToTake = {0, 0, 0, 0, 0, 0};
-    int Sign;
-    int StepsMissed;
+    spdlog::debug("{} : Platform::step() : Finished stepping.", m_Identity);
 
-    m_pCBC->driver.enableAll();
-    while (IterationsRemaining > 1) {
-        spdlog::trace("{} : Platform::step() : Iterations remaining: {}",
-                      m_Identity, IterationsRemaining);
-        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-            if (ActuatorIterations[i] > 1) {
-                if (getDeviceState() == Device::DeviceState::Off || getErrorState() == Device::ErrorState::FatalError) {
-                    m_pCBC->driver.disableAll();
-                    spdlog::warn("{} : Platform::step() : Successfully stopped motion.", m_Identity);
-                    return StepsRemaining;
-                }
-                StepsToTake[i] = StepsToTake[i] + StepsRemaining[i] / IterationsRemaining;
-                spdlog::trace("{} : Platform::step() : Actuator {} stepsToTake = {}.", m_Identity,
-                              m_Actuators[i]->getIdentity(), StepsToTake[i]);
-                if (std::abs(StepsToTake[i]) > m_Actuators[i]->RecordingInterval) {
-                    Sign = (StepsToTake[i] > 0) - (StepsToTake[i] < 0);
-                    StepsMissed = m_Actuators[i]->step(Sign * m_Actuators[i]->RecordingInterval);
-                    StepsToTake[i] = StepsToTake[i] - (Sign * m_Actuators[i]->RecordingInterval) + StepsMissed;
-                    StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                                          m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-                    ActuatorIterations[i] = 1 + ((std::abs(StepsRemaining[i]) - 1) / m_Actuators[i]->RecordingInterval);
-                    spdlog::trace("{} : Platform::step() : Steps remaining for actuator {} : {}", m_Identity,
-                                  m_Actuators[i]->getIdentity(), StepsRemaining[i]);
-                }
-            }
+    return StepsRemaining;
+}
+
+std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM>
+Platform::__stepDrives(const std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> &stepsToTake) {
+    // The driver counts drives by port number, which need not match the actuator order.
+    std::vector<int> driveSteps(PlatformBase::NUM_ACTS_PER_PLATFORM, 0);
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        if (stepsToTake[i] != 0) {
+            driveSteps.at(m_Actuators[i]->getPortNumber() - 1) = stepsToTake[i];
         }
-        IterationsRemaining = *std::max_element(ActuatorIterations.begin(), ActuatorIterations.end());
     }
+    std::vector<int> driveStepsTaken = m_pCBC->driver.step(driveSteps);
 
-    //Hysteresis Motion
-    if (getErrorState() != Device::ErrorState::FatalError) {
-        spdlog::debug("{} : Platform::step() : Executing hysteresis motion...", m_Identity);
-        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-            if (getDeviceState() == Device::DeviceState::Off || getErrorState() == Device::ErrorState::FatalError) {
-                m_pCBC->driver.disableAll();
-                spdlog::warn("{} : Platform::step() : Successfully stopped hysteresis motion.", m_Identity);
-                return StepsRemaining;
-            }
-            if (StepsRemaining[i] != 0) {
-                m_Actuators[i]->performHysteresisMotion(StepsRemaining[i]);
-                StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                                      m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-            }
-
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsTaken{};
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        if (stepsToTake[i] != 0) {
+            stepsTaken[i] = driveStepsTaken.at(m_Actuators[i]->getPortNumber() - 1);
         }
     }
+    if (__isStopRequested()) {
+        spdlog::info("{} : Platform::step() : Stepping stopped {:.1f} ms after the stop request.", m_Identity,
+                     __msSinceStopRequest());
+    }
+    return stepsTaken;
+}
 
-    m_pCBC->driver.disableAll();
-
-    spdlog::debug("{} : Platform::step() : Finished stepping.", m_Identity);
+bool Platform::__stepToCheckPoint(const std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> &stepsToTake) {
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsTaken = __stepDrives(stepsToTake);
 
-    return StepsRemaining;
+    // A stopped motion falls short of the check point, and only the steps it took may be registered.
+    bool stopped = __isStopRequested();
+    bool registered = true;
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        if (stepsToTake[i] != 0 && !m_Actuators[i]->registerSteps(stopped ? stepsTaken[i] : stepsToTake[i])) {
+            spdlog::error("{} : Platform::__stepToCheckPoint() : Failed to register steps for actuator {}.",
+                          m_Identity, i);
+            checkActuatorStatus(i);
+            registered = false;
+        }
+    }
+    return registered;
 }
 
 void Platform::__probeEndStopAll(int direction) {
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> SearchSteps{};
-    std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> VoltageBefore{};
-    std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> AbsDeltaVoltage{};
-    std::array<float, PlatformBase::NUM_ACTS_PER_PLATFORM> VoltageAfter{};
+    std::array<ActuatorBase::EndStopSearch, PlatformBase::NUM_ACTS_PER_PLATFORM> searches{};
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsToTake{};
+    bool searching = true;
 
     for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-        SearchSteps[i] = direction * m_Actuators[i]->EndstopSearchStepsize;
-        VoltageAfter[i] = m_Actuators[i]->readVoltage();
+        m_Actuators[i]->beginEndStopSearch(searches[i], direction);
     }
-    float StoppedSteppingFactor = 0.5;
-    std::array<bool, PlatformBase::NUM_ACTS_PER_PLATFORM> NotReachedStop = {true, true, true, true, true, true};
 
     m_pCBC->driver.enableAll();
-    while (NotReachedStop[0] || NotReachedStop[1] || NotReachedStop[2] || NotReachedStop[3] || NotReachedStop[4] ||
-           NotReachedStop[5]) {
+    while (searching) {
+        if (getDeviceState() == Device::DeviceState::Off || __isStopRequested()) {
+            spdlog::info("{} : Platform::probeEndStopAll() : Successfully stopped motion.", m_Identity);
+            m_pCBC->driver.disableAll();
+            return;
+        }
+        searching = false;
         for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-            if (NotReachedStop[i]) {
-                VoltageBefore[i] = VoltageAfter[i];
-                m_Actuators[i]->stepDriver(SearchSteps[i]);
-                VoltageAfter[i] = m_Actuators[i]->readVoltage();
-                if (getDeviceState() == Device::DeviceState::Off) {
-                    spdlog::info("{} : Platform::probeEndStopAll() : Successfully stopped motion.", m_Identity);
-                    m_pCBC->driver.disableAll();
-                    return;
-                }
-                AbsDeltaVoltage[i] = std::fabs(VoltageAfter[i] - VoltageBefore[i]);
-                if (AbsDeltaVoltage[i] < std::fabs(m_Actuators[i]->dV * SearchSteps[i] * StoppedSteppingFactor)) {
-                    NotReachedStop[i] = false;
-                }
+            stepsToTake[i] = 0;
+            if (!searches[i].atStop && !searches[i].failed) {
+                stepsToTake[i] = m_Actuators[i]->nextEndStopSearchSteps(searches[i]);
+                searching = true;
+            }
+        }
+        if (!searching) {
+            break;
+        }
+        __stepDrives(stepsToTake);
+        if (__isStopRequested()) {
+            continue;
+        }
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            if (stepsToTake[i] != 0) {
+                m_Actuators[i]->updateEndStopSearch(searches[i], stepsToTake[i]);
             }
         }
     }
@@ -540,6 +683,7 @@ void Platform::findHomeFromEndStopAll(int direction) {
         return;
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     __probeEndStopAll(direction);
 
     if (getErrorState() == Device::ErrorState::FatalError) {
@@ -552,9 +696,13 @@ void Platform::findHomeFromEndStopAll(int direction) {
         spdlog::error("{} : Platform::findHomeFromEndStopAll() : Platform is off. Find home aborted.", m_Identity);
         return;
     }
+    else if (__isStopRequested()) {
+        spdlog::warn("{} : Platform::findHomeFromEndStopAll() : Stopped. Find home aborted.", m_Identity);
+        return;
+    }
 
     m_pCBC->driver.enableAll();
-    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++)
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM && !__isStopRequested(); i++)
     {
         m_Actuators[i]->findHomeFromEndStop(direction);
     }
@@ -564,17 +712,67 @@ void Platform::findHomeFromEndStopAll(int direction) {
 bool Platform::probeHomeAll()
 {
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     spdlog::info("{} : Platform : Probing Home for all Actuators...", m_Identity);
 
     __probeEndStopAll(1);
+    if (getDeviceState() == Device::DeviceState::Off) {
+        spdlog::error("{} : Platform::probeHomeAll() : Platform is off. Probe home aborted.", m_Identity);
+        return false;
+    }
+    if (__isStopRequested()) {
+        spdlog::warn("{} : Platform::probeHomeAll() : Stopped. Probe home aborted.", m_Identity);
+        return false;
+    }
+
+    std::array<ActuatorBase::HomeSearch, PlatformBase::NUM_ACTS_PER_PLATFORM> searches{};
+    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> stepsToTake{};
+    bool searching = true;
+
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        m_Actuators[i]->beginHomeSearch(searches[i]);
+    }
+
     m_pCBC->driver.enableAll();
-    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++)
-    {
-        m_Actuators.at(i)->probeHome();
+    while (searching) {
+        if (getDeviceState() == Device::DeviceState::Off || __isStopRequested()) {
+            spdlog::info("{} : Platform::probeHomeAll() : Successfully stopped motion.", m_Identity);
+            m_pCBC->driver.disableAll();
+            return false;
+        }
+        searching = false;
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            stepsToTake[i] = 0;
+            if (!searches[i].done && !searches[i].failed) {
+                stepsToTake[i] = m_Actuators[i]->nextHomeSearchSteps(searches[i]);
+                searching = true;
+            }
+        }
+        if (!searching) {
+            break;
+        }
+        __stepDrives(stepsToTake);
+        if (__isStopRequested()) {
+            continue;
+        }
+        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+            if (stepsToTake[i] != 0) {
+                m_Actuators[i]->updateHomeSearch(searches[i], stepsToTake[i]);
+            }
+        }
     }
     m_pCBC->driver.disableAll();
 
-    return true;
+    bool success = true;
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+        if (searches[i].done) {
+            m_Actuators[i]->finishHomeSearch(searches[i]);
+        } else {
+            success = false;
+        }
+    }
+
+    return success;
 }
 
 float Platform::getInternalTemperature()
@@ -664,6 +862,40 @@ bool Platform::addMPES(const Device::Identity &identity)
     }
 }
 
+bool Platform::addMPESAll(const std::vector<Device::Identity> &identities)
+{
+    spdlog::info("{} : Platform::addMPESAll() : Adding {} MPES...", m_Identity, identities.size());
+
+    // each MPES only touches its own USB port (toggles, if any, are serialized by the USB device registry),
+    // so the slow part -- waiting for the webcams -- can overlap.
+    std::vector<std::unique_ptr<MPES>> newMPES;
+    std::vector<std::future<bool>> initialized;
+    for (const auto &identity : identities) {
+        if (identity.serialNumber < 0 || std::stoi(identity.eAddress) < 0) {
+            spdlog::error("{} : Platform::addMPESAll() : Failed to add MPES {}, invalid USB/serial number.", m_Identity,
+                          identity);
+            continue;
+        }
+        newMPES.emplace_back(new MPES(m_pCBC, identity));
+        MPES *pMPES = newMPES.back().get();
+        initialized.push_back(std::async(std::launch::async, [pMPES]() { return pMPES->initialize(); }));
+    }
+
+    bool success = (newMPES.size() == identities.size());
+    for (unsigned i = 0; i < newMPES.size(); i++) {
+        Device::Identity identity = newMPES[i]->getIdentity();
+        if (!initialized[i].get()) {
+            spdlog::warn("{} : Platform::addMPESAll() : Failed to initialize MPES {} at USB {}.", m_Identity, identity,
+                         identity.eAddress);
+            success = false;
+        }
+        m_MPES.push_back(std::move(newMPES[i]));
+        m_MPESIdentityMap.insert(std::make_pair(identity, m_MPES.size() - 1));
+    }
+
+    return success;
+}
+
 bool Platform::addPSD(const Device::Identity &identity)
 {
     spdlog::info("{} : Platform::addPSD() : Adding PSD {} at USB {}.", m_Identity, identity, identity.eAddress);
@@ -745,82 +977,22 @@ DummyPlatform::__step(std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> input
 
     spdlog::debug("{} : DummyPlatform::step() : Stepping platform ({}, {}, {}, {}, {}, {}) steps.",
                   m_Identity, inputSteps[0], inputSteps[1], inputSteps[2], inputSteps[3], inputSteps[4], inputSteps[5]);
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsRemaining{};
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> ActuatorIterations = {0, 0, 0, 0, 0, 0};
-    std::array<ActuatorBase::Position, PlatformBase::NUM_ACTS_PER_PLATFORM> FinalPosition{};
-
-    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-        FinalPosition[i] = m_Actuators[i]->predictNewPosition(m_Actuators[i]->getCurrentPosition(),
-                                                              -inputSteps[i]);//negative steps because positive step is extension of motor, negative steps increases counter since home is defined (0,0)
-        StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                              m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-
-        if (FinalPosition[i].revolution < m_Actuators[i]->ExtendRevolutionLimit ||
-            FinalPosition[i].revolution >= m_Actuators[i]->RetractRevolutionLimit) {
-            spdlog::error(
-                "{} : DummyPlatform::step() : Operable Error (12): Attempting to move Actuator {} {}-{} mm outside of software range.",
-                m_Identity, m_Actuators[i]->getIdentity(),
-                m_Actuators[i]->HomeLength -
-                (m_Actuators[i]->RetractRevolutionLimit *
-                 m_Actuators[i]->StepsPerRevolution *
-                 m_Actuators[i]->mmPerStep),
-                m_Actuators[i]->HomeLength -
-                (m_Actuators[i]->ExtendRevolutionLimit *
-                 m_Actuators[i]->StepsPerRevolution *
-                 m_Actuators[i]->mmPerStep));
-            setError(12);
-            return inputSteps;
-        }
 
-        if (StepsRemaining[i] != 0) {
-            ActuatorIterations[i] = 1 + ((std::abs(StepsRemaining[i]) - 1) /
-                                         m_Actuators[i]->RecordingInterval);//simply integer division rounded up, hence the -1.
-        }
+    MotionPlan plan;
+    if (!planMotion(inputSteps, plan)) {
+        return inputSteps;
     }
 
-    int IterationsRemaining = *std::max_element(ActuatorIterations.begin(), ActuatorIterations.end());
-    std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> StepsToTake = {0, 0, 0, 0, 0, 0};
-    int Sign;
-    int StepsMissed;
-
-    while (IterationsRemaining > 1) {
-        for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-            if (ActuatorIterations[i] > 1) {
-                if (getDeviceState() == Device::DeviceState::Off || getErrorState() == Device::ErrorState::FatalError) {
-                    spdlog::info("{} : DummyPlatform::step() : Successfully stopped motion.", m_Identity);
-                    return StepsRemaining;
-                }
-                StepsToTake[i] = StepsToTake[i] + StepsRemaining[i] / IterationsRemaining;
-                if (std::abs(StepsToTake[i]) > m_Actuators[i]->RecordingInterval) {
-                    Sign = (StepsToTake[i] > 0) - (StepsToTake[i] < 0);
-                    StepsMissed = m_Actuators[i]->step(Sign * m_Actuators[i]->RecordingInterval);
-                    StepsToTake[i] = StepsToTake[i] - (Sign * m_Actuators[i]->RecordingInterval) + StepsMissed;
-                    StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                                          m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-                    ActuatorIterations[i] = 1 + ((std::abs(StepsRemaining[i]) - 1) / m_Actuators[i]->RecordingInterval);
-                    spdlog::trace("{} : DummyPlatform::step() : Steps remaining for Actuator {} : {}.", m_Identity,
-                                  m_Actuators[i]->getIdentity(), StepsRemaining[i]);
-                }
-            }
-        }
-        IterationsRemaining = *std::max_element(ActuatorIterations.begin(), ActuatorIterations.end());
-    }
+    return __executeMotionPlan(plan);
+}
 
-    //Hysteresis Motion
+bool DummyPlatform::__stepToCheckPoint(const std::array<int, PlatformBase::NUM_ACTS_PER_PLATFORM> &stepsToTake) {
     for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
-        if (getDeviceState() == Device::DeviceState::Off || getErrorState() == Device::ErrorState::FatalError) {
-            spdlog::info("{} : DummyPlatform::step() : Successfully stopped motion.", m_Identity);
-            return StepsRemaining;
+        if (stepsToTake[i] != 0) {
+            m_Actuators[i]->step(stepsToTake[i]);
         }
-        if (StepsRemaining[i] != 0) {
-            m_Actuators[i]->performHysteresisMotion(StepsRemaining[i]);
-            StepsRemaining[i] = -(m_Actuators[i]->convertPositionToSteps(FinalPosition[i]) -
-                                  m_Actuators[i]->convertPositionToSteps(m_Actuators[i]->getCurrentPosition()));
-        }
-
     }
-
-    return StepsRemaining;
+    return true;
 }
 
 void DummyPlatform::__probeEndStopAll(int direction) {
@@ -848,6 +1020,7 @@ void DummyPlatform::findHomeFromEndStopAll(int direction) {
         return;
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     __probeEndStopAll(direction);
 
     if (getErrorState() == Device::ErrorState::FatalError) {
@@ -860,16 +1033,17 @@ void DummyPlatform::findHomeFromEndStopAll(int direction) {
         return;
     }
 
-    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM && !__isStopRequested(); i++) {
         m_Actuators[i]->findHomeFromEndStop(direction);
     }
 }
 
 bool DummyPlatform::probeHomeAll() {
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    __beginMotion();
     spdlog::info("{} : DummyPlatform :: Probing Home for All Actuators", m_Identity);
     __probeEndStopAll(1);
-    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM; i++) {
+    for (int i = 0; i < PlatformBase::NUM_ACTS_PER_PLATFORM && !__isStopRequested(); i++) {
         m_Actuators.at(i)->probeHome();
     }
     return true;
@@ -937,13 +1111,6 @@ void DummyPlatform::turnOn() {
     m_On = true;
 }
 
-void DummyPlatform::emergencyStop() {
-    spdlog::warn("{} : DummyPlatform::emergencyStop() : Emergency stopping all actuator motion...", m_Identity);
-    m_On = false; // We temporarily set the state to off to indicate that the motion should be stopped.
-    sleep(1);
-    m_On = true;
-}
-
 void DummyPlatform::turnOff() {
     spdlog::info("{} : DummyPlatform::turnOff() : Turning off power to platform...", m_Identity);
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
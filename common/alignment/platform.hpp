@@ -7,8 +7,10 @@
 #define ALIGNMENT_PLATFORM_HPP
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -105,7 +107,22 @@ public:
     std::unique_ptr<GASRangeFinderBase> &getRangefinderbyIdentity(const Device::Identity &identity) {
         return m_Rangefinder.at(m_RangefinderIdentityMap.at(identity));
     }
+    /// @brief Expected actuator positions at a point of a motion where encoders are verified.
+    struct MotionCheckPoint {
+        std::array<ActuatorBase::Position, NUM_ACTS_PER_PLATFORM> positions;
+        bool hysteresisReturn; // true for the final approach that takes out backlash
+    };
+
+    /// @brief Coordinated trajectory for all actuators: main move with overshoot, then hysteresis return.
+    struct MotionPlan {
+        std::array<ActuatorBase::Position, NUM_ACTS_PER_PLATFORM> startPositions;
+        std::array<ActuatorBase::Position, NUM_ACTS_PER_PLATFORM> finalPositions;
+        std::vector<MotionCheckPoint> checkPoints;
+    };
+
     // Actuator-related methods
+    bool planMotion(const std::array<int, NUM_ACTS_PER_PLATFORM> &inputSteps, MotionPlan &plan);
+
     void probeEndStopAll(int direction);
 
     virtual void findHomeFromEndStopAll(int direction) = 0;
@@ -131,7 +148,19 @@ public:
      In the Sim mode, MPES are added regardlessly.
      */
     virtual bool addMPES(const Device::Identity &identity) = 0;
+    /**
+     * @brief Adds several MPES, keeping their order. Returns true only if all of them initialized.
+     */
+    virtual bool addMPESAll(const std::vector<Device::Identity> &identities);
     MPESBase::Position readMPES(int idx);
+    /**
+     * @brief Reads the MPES with the given serial numbers (all of them if empty) that are on and not in fatal error at
+     once, with at most maxConcurrentCaptures webcams streaming at a time (0 or less for no limit). Each MPES analyzes
+     its frames on its own thread as soon as it has grabbed them, so the webcams that are still waiting for a slot are
+     not held up by the analysis. Only the MPES that were read successfully are returned.
+     */
+    std::map<Device::Identity, MPESBase::Position> readMPESAll(int maxConcurrentCaptures,
+                                                               const std::set<int> &serials = std::set<int>());
 
     virtual bool addPSD(const Device::Identity &identity) = 0;
 
@@ -139,7 +168,11 @@ public:
 
     virtual bool addRangefinder(const Device::Identity &identity) = 0;
 
-    virtual void emergencyStop();
+    /**
+     * @brief Stops the motion in progress without waiting for it, and may be called from any thread. Steps stop
+     within one step period; motions started after this call are not affected.
+     */
+    void emergencyStop();
 
     bool isOn() override;
 
@@ -163,10 +196,29 @@ protected:
 
     virtual std::array<int, NUM_ACTS_PER_PLATFORM> __step(std::array<int, NUM_ACTS_PER_PLATFORM> inputSteps) = 0;
 
+    std::array<int, NUM_ACTS_PER_PLATFORM> __executeMotionPlan(const MotionPlan &plan);
+
+    // Moves all actuators the given number of steps at once, stopping to verify encoders afterwards.
+    // Returns false if the steps could not be registered, in which case the motion plan must not continue.
+    virtual bool __stepToCheckPoint(const std::array<int, NUM_ACTS_PER_PLATFORM> &stepsToTake) = 0;
+
     std::array<float, NUM_ACTS_PER_PLATFORM> __measureLengths();
 
     virtual void __probeEndStopAll(int direction) = 0;
 
+    // Stop token: emergencyStop() increments m_StopCount, and the motion in progress stops once it no longer matches
+    // the count when the motion began. Lock-free, as it is set while the motion holds the platform.
+    std::atomic<unsigned> m_StopCount{0};
+    unsigned m_MotionStopCount = 0;
+    std::atomic<long long> m_StopRequestTime{0}; // steady clock, ns
+
+    void __beginMotion() { m_MotionStopCount = m_StopCount; }
+    bool __isStopRequested() const { return m_StopCount != m_MotionStopCount; }
+    double __msSinceStopRequest() const;
+
+    // Interrupts the stepping in progress, called by emergencyStop().
+    virtual void __abortMotion() {}
+
     bool m_HighCurrent = false;
     bool m_SynchronousRectification = true;
 
@@ -230,6 +282,10 @@ public:
      In the Sim mode, MPES are added regardlessly.
      */
     bool addMPES(const Device::Identity &identity) override;
+    /**
+     * @brief Initializes the MPES on their USB ports concurrently, then adds them in order.
+     */
+    bool addMPESAll(const std::vector<Device::Identity> &identities) override;
 
     bool addPSD(const Device::Identity &identity) override;
 
@@ -246,7 +302,14 @@ private:
 
     std::array<int, NUM_ACTS_PER_PLATFORM> __step(std::array<int, NUM_ACTS_PER_PLATFORM> inputSteps) override;
 
+    bool __stepToCheckPoint(const std::array<int, NUM_ACTS_PER_PLATFORM> &stepsToTake) override;
+
+    // Returns the steps taken by each actuator, fewer than asked if the motion was stopped.
+    std::array<int, NUM_ACTS_PER_PLATFORM> __stepDrives(const std::array<int, NUM_ACTS_PER_PLATFORM> &stepsToTake);
+
     void __probeEndStopAll(int direction) override;
+
+    void __abortMotion() override { m_pCBC->driver.abort(); }
 };
 
 #endif
@@ -296,8 +359,6 @@ public:
 
     bool addRangefinder(const Device::Identity &identity) override;
 
-    void emergencyStop() override;
-
     void turnOn() override;
 
     void turnOff() override;
@@ -305,6 +366,8 @@ public:
 private:
     std::array<int, NUM_ACTS_PER_PLATFORM> __step(std::array<int, NUM_ACTS_PER_PLATFORM> inputSteps) override;
 
+    bool __stepToCheckPoint(const std::array<int, NUM_ACTS_PER_PLATFORM> &stepsToTake) override;
+
     void __probeEndStopAll(int direction) override;
 };
 
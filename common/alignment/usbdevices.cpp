@@ -0,0 +1,276 @@
+#include "common/alignment/usbdevices.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <vector>
+
+#include "common/utilities/spdlog/spdlog.h"
+#include "common/utilities/spdlog/fmt/ostr.h"
+
+
+const std::string USBDeviceRegistry::TOPOLOGY_FILEPATH = "/home/root/usbTopology.txt";
+const int USBDeviceRegistry::DEVICE_APPEAR_TIMEOUT = 10000;
+const int USBDeviceRegistry::DEVICE_REMOVE_TIMEOUT = 2000;
+
+std::mutex USBDeviceRegistry::m_Mutex;
+std::mutex USBDeviceRegistry::m_ToggleMutex;
+bool USBDeviceRegistry::m_Loaded = false;
+std::map<int, std::string> USBDeviceRegistry::m_PortTopology;
+
+std::set<int> USBDeviceRegistry::getDevices(const std::string &prefix) {
+    std::set<int> devices;
+
+    DIR *dir;
+    struct dirent *ent;
+
+    if ((dir = opendir("/dev")) != nullptr) {
+        while ((ent = readdir(dir)) != nullptr) {
+            std::string currentEntry = ent->d_name;
+            // only exact <prefix><number> nodes -- skips e.g. /dev/v4l-subdev0 or /dev/video0-foo
+            if (currentEntry.compare(0, prefix.length(), prefix) != 0 || currentEntry.length() == prefix.length()) {
+                continue;
+            }
+            std::string number = currentEntry.substr(prefix.length());
+            if (number.find_first_not_of("0123456789") == std::string::npos) {
+                devices.insert(std::stoi(number));
+            }
+        }
+        closedir(dir);
+    }
+
+    return devices;
+}
+
+std::string USBDeviceRegistry::getTopologyPath(const std::string &prefix, int deviceNumber) {
+    std::string sysClass = (prefix == "video") ? "video4linux" : "tty";
+    std::string link = "/sys/class/" + sysClass + "/" + prefix + std::to_string(deviceNumber) + "/device";
+
+    char resolved[PATH_MAX];
+    if (realpath(link.c_str(), resolved) == nullptr) {
+        return "";
+    }
+
+    // walk up to the USB interface directory, named <bus>-<port.port...>:<config>.<interface>
+    std::string path(resolved);
+    while (!path.empty() && path != "/") {
+        size_t slash = path.find_last_of('/');
+        std::string component = path.substr(slash + 1);
+        size_t colon = component.find(':');
+        if (colon != std::string::npos && component.find('-') < colon && isdigit(component[0])) {
+            return component.substr(0, colon);
+        }
+        path = path.substr(0, slash);
+    }
+
+    return "";
+}
+
+int USBDeviceRegistry::findDevice(int usbPort, const std::string &prefix) {
+    std::string topologyPath;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        __loadTopology();
+        auto it = m_PortTopology.find(usbPort);
+        if (it == m_PortTopology.end()) {
+            return -1;
+        }
+        topologyPath = it->second;
+    }
+
+    for (int device : getDevices(prefix)) {
+        if (getTopologyPath(prefix, device) == topologyPath) {
+            return device;
+        }
+    }
+    return -1;
+}
+
+int USBDeviceRegistry::findPort(const std::string &prefix, int deviceNumber) {
+    std::string topologyPath = getTopologyPath(prefix, deviceNumber);
+    if (topologyPath.empty()) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    __loadTopology();
+    for (const auto &port : m_PortTopology) {
+        if (port.second == topologyPath) {
+            return port.first;
+        }
+    }
+    return -1;
+}
+
+int USBDeviceRegistry::waitForNewDevice(const std::string &prefix, const std::set<int> &existingDevices,
+                                        int timeoutMs) {
+    // watch before looking, so a node created between the check and the poll still wakes us up
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0 && inotify_add_watch(fd, "/dev", IN_CREATE | IN_ATTRIB) < 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    int newDevice = -1;
+    while (true) {
+        for (int device : getDevices(prefix)) {
+            if (existingDevices.find(device) == existingDevices.end()) {
+                newDevice = device; // sets are ordered, so this is the lowest new node
+                break;
+            }
+        }
+        if (newDevice >= 0) {
+            break;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            break;
+        }
+        if (fd >= 0) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, (int) remaining) > 0) {
+                char events[4096];
+                while (read(fd, events, sizeof(events)) > 0) {} // drain, we rescan /dev anyway
+            }
+        } else {
+            usleep(100000); // no inotify, fall back to polling /dev
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    return newDevice;
+}
+
+bool USBDeviceRegistry::waitForRemovedDevice(const std::string &prefix, const std::set<int> &existingDevices,
+                                             int timeoutMs) {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0 && inotify_add_watch(fd, "/dev", IN_DELETE) < 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    bool removed = false;
+    while (true) {
+        std::set<int> devices = getDevices(prefix);
+        for (int device : existingDevices) {
+            if (devices.find(device) == devices.end()) {
+                removed = true;
+                break;
+            }
+        }
+        if (removed) {
+            break;
+        }
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            break;
+        }
+        if (fd >= 0) {
+            struct pollfd pfd = {fd, POLLIN, 0};
+            if (poll(&pfd, 1, (int) remaining) > 0) {
+                char events[4096];
+                while (read(fd, events, sizeof(events)) > 0) {}
+            }
+        } else {
+            usleep(100000);
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    return removed;
+}
+
+void USBDeviceRegistry::__loadTopology() {
+    if (m_Loaded) {
+        return;
+    }
+    m_Loaded = true;
+
+    std::ifstream topologyFile(TOPOLOGY_FILEPATH);
+    int usbPort;
+    std::string topologyPath;
+    while (topologyFile >> usbPort >> topologyPath) {
+        m_PortTopology[usbPort] = topologyPath;
+    }
+    spdlog::debug("USBDeviceRegistry : Loaded {} known USB ports from {}.", m_PortTopology.size(), TOPOLOGY_FILEPATH);
+}
+
+void USBDeviceRegistry::__learnTopology(int usbPort, const std::string &topologyPath) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    __loadTopology();
+    if (m_PortTopology[usbPort] == topologyPath) {
+        return;
+    }
+
+    spdlog::info("USBDeviceRegistry : USB port {} is {}.", usbPort, topologyPath);
+    m_PortTopology[usbPort] = topologyPath;
+
+    std::ofstream topologyFile(TOPOLOGY_FILEPATH, std::ofstream::trunc);
+    if (!topologyFile.good()) {
+        spdlog::warn("USBDeviceRegistry : Could not write {}, USB ports will be toggled again on restart.",
+                     TOPOLOGY_FILEPATH);
+        return;
+    }
+    for (const auto &port : m_PortTopology) {
+        topologyFile << port.first << " " << port.second << std::endl;
+    }
+}
+
+#ifndef SIMMODE
+
+#include "common/cbccode/cbc.hpp"
+
+int USBDeviceRegistry::toggleAndFind(const std::shared_ptr<CBC> &pCBC, int usbPort, const std::string &prefix,
+                                     int timeoutMs) {
+    std::lock_guard<std::mutex> toggleLock(m_ToggleMutex);
+
+    std::set<int> devices = getDevices(prefix);
+    if (pCBC->usb.isEnabled(usbPort)) {
+        // wait for the port's own node to go away, so one re-created under the same number counts as new
+        std::set<int> portDevices;
+        int knownDevice = findDevice(usbPort, prefix);
+        if (knownDevice >= 0) {
+            portDevices.insert(knownDevice);
+        } else {
+            portDevices = devices;
+        }
+
+        pCBC->usb.disable(usbPort);
+        if (!portDevices.empty()) {
+            waitForRemovedDevice(prefix, portDevices, DEVICE_REMOVE_TIMEOUT);
+        }
+        devices = getDevices(prefix);
+    }
+
+    pCBC->usb.enable(usbPort);
+    int newDevice = waitForNewDevice(prefix, devices, timeoutMs);
+    if (newDevice < 0) {
+        spdlog::warn("USBDeviceRegistry : No new /dev/{}* device appeared on USB port {} within {} ms.", prefix,
+                     usbPort, timeoutMs);
+        return -1;
+    }
+
+    std::string topologyPath = getTopologyPath(prefix, newDevice);
+    if (!topologyPath.empty()) {
+        __learnTopology(usbPort, topologyPath);
+    }
+    return newDevice;
+}
+
+#endif
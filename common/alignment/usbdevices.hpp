@@ -0,0 +1,73 @@
+/**
+ * @file usbdevices.hpp
+ * @brief Header file for the registry mapping CBC USB ports to device nodes.
+ */
+
+#ifndef ALIGNMENT_USBDEVICES_HPP
+#define ALIGNMENT_USBDEVICES_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+class CBC;
+
+/**
+ * Resolves device nodes (/dev/videoN, /dev/ttyACMN, /dev/ttyUSBN) to the physical USB port they hang off,
+ * using the sysfs topology (e.g. /sys/class/video4linux/video3/device -> .../usb1/1-1/1-1.4/1-1.4:1.0).
+ *
+ * Which topology path sits behind which CBC USB port (1-6) is learned the first time a port is toggled,
+ * and stored in TOPOLOGY_FILEPATH so later initializations find their device without power cycling.
+ * When a toggle is needed, we wait on inotify events in /dev instead of sleeping a fixed time.
+ */
+class USBDeviceRegistry
+{
+public:
+    static const std::string TOPOLOGY_FILEPATH;
+    static const int DEVICE_APPEAR_TIMEOUT; // ms
+    static const int DEVICE_REMOVE_TIMEOUT; // ms
+
+    /// @brief Device numbers of all /dev/<prefix>N nodes, e.g. prefix "video" or "ttyACM".
+    static std::set<int> getDevices(const std::string &prefix);
+
+    /// @brief Topology path (e.g. "1-1.4") of the USB device behind /dev/<prefix><deviceNumber>, empty if unknown.
+    static std::string getTopologyPath(const std::string &prefix, int deviceNumber);
+
+    /// @brief Lowest-numbered /dev/<prefix>N node behind a CBC USB port with a known topology path, -1 if none.
+    static int findDevice(int usbPort, const std::string &prefix);
+
+    /// @brief CBC USB port whose learned topology path matches that of /dev/<prefix><deviceNumber>, -1 if unknown.
+    static int findPort(const std::string &prefix, int deviceNumber);
+
+    /**
+     * @brief Wait until a /dev/<prefix>N node not in existingDevices shows up.
+     * @return the new device number, or -1 on timeout.
+     */
+    static int waitForNewDevice(const std::string &prefix, const std::set<int> &existingDevices, int timeoutMs);
+
+    /// @brief Wait until any of the given /dev/<prefix>N nodes disappears. Returns false on timeout.
+    static bool waitForRemovedDevice(const std::string &prefix, const std::set<int> &existingDevices, int timeoutMs);
+
+#ifndef SIMMODE
+    /**
+     * @brief Power cycle a CBC USB port and return the /dev/<prefix>N node that appears behind it, -1 on failure.
+     * Toggles are serialized so that concurrent initializations on different ports cannot mistake each other's
+     * devices. The topology path of the new device is recorded for the port.
+     */
+    static int toggleAndFind(const std::shared_ptr<CBC> &pCBC, int usbPort, const std::string &prefix,
+                             int timeoutMs = DEVICE_APPEAR_TIMEOUT);
+#endif
+
+private:
+    static std::mutex m_Mutex; // guards the topology map
+    static std::mutex m_ToggleMutex; // serializes port toggles
+    static bool m_Loaded;
+    static std::map<int, std::string> m_PortTopology; // CBC USB port -> sysfs topology path
+
+    static void __loadTopology();
+    static void __learnTopology(int usbPort, const std::string &topologyPath);
+};
+
+#endif //ALIGNMENT_USBDEVICES_HPP
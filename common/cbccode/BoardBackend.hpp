@@ -0,0 +1,59 @@
+/*
+ * Register-level access to the mirror control board: the GPIO pins and the
+ * SPI bus to the ADCs. MirrorControlBoard does all of its IO through one of
+ * these, so the board can be swapped for an emulation of it (see
+ * BoardEmulator.hpp).
+ */
+
+#ifndef BOARDBACKEND_HPP
+#define BOARDBACKEND_HPP
+
+#include <stdint.h>
+
+#include "common/cbccode/GPIOInterface.hpp"
+#include "common/cbccode/mcspiInterface.hpp"
+
+class BoardBackend
+{
+public:
+    virtual ~BoardBackend() = default;
+
+    // Read GPIO by ipin (0-191)
+    virtual bool ReadLevel(int ipin) = 0;
+
+    // Write GPIO by ipin (0-191)
+    virtual void WriteLevel(int ipin, bool level) = 0;
+
+    // Get GPIO Direction In/Out
+    virtual bool GetDirection(int ipin) = 0;
+
+    // Set GPIO Direction In/Out (0-191)
+    virtual void SetDirection(int ipin, bool dir) = 0;
+
+    // Write a 16 bit word to the selected ADC, returning the word clocked back
+    virtual uint32_t WriteRead(uint32_t data) = 0;
+
+    // Whether the delays between IO operations must be kept, i.e. whether
+    // there is real hardware on the other side that needs them
+    virtual bool IsRealTime() const { return true; }
+};
+
+/*
+ * The board itself: GPIO registers mapped from /dev/mem and the McSPI
+ * controller of the AM3703.
+ */
+class HardwareBoardBackend : public BoardBackend
+{
+public:
+    bool ReadLevel(int ipin) override { return m_gpio.ReadLevel(ipin); }
+    void WriteLevel(int ipin, bool level) override { m_gpio.WriteLevel(ipin, level); }
+    bool GetDirection(int ipin) override { return m_gpio.GetDirection(ipin); }
+    void SetDirection(int ipin, bool dir) override { m_gpio.SetDirection(ipin, dir); }
+    uint32_t WriteRead(uint32_t data) override { return m_spi.WriteRead(static_cast<uint16_t>(data)); }
+
+private:
+    GPIOInterface  m_gpio;
+    mcspiInterface m_spi;
+};
+
+#endif
@@ -0,0 +1,218 @@
+#include <cmath>
+#include <algorithm>
+
+#include "common/cbccode/BoardEmulator.hpp"
+#include "common/cbccode/Layout.hpp"
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+
+BoardEmulator::BoardEmulator(const Config &config) :
+    m_config(config),
+    m_rng(config.seed ? config.seed : std::random_device()()),
+    m_noise(0., 1.),
+    m_conversion(),
+    m_stepCount(0)
+{
+    std::fill(std::begin(m_level), std::end(m_level), false);
+    std::fill(std::begin(m_direction), std::end(m_direction), false);
+    std::fill(std::begin(m_stepDrive), std::end(m_stepDrive), -1);
+
+    for (unsigned idrive=0; idrive<NDRIVES; idrive++) {
+        m_stepDrive[Layout::igpioStep(idrive)] = idrive;
+        m_position[idrive] = int64_t(config.startPosition) * EIGHTHS;
+
+        // active low: drives start disabled
+        m_level[Layout::igpioEnable(idrive)] = true;
+    }
+
+    // active low: USBs off, normal current, no synchronous rectification, out of reset
+    for (unsigned iusb=0; iusb<7; iusb++)
+        m_level[Layout::igpioUSBOff(iusb)] = true;
+    m_level[Layout::igpioPwrIncBar] = true;
+    m_level[Layout::igpioSR]        = true;
+    m_level[Layout::igpioReset]     = true;
+}
+
+//------------------------------------------------------------------------------
+// GPIO
+//------------------------------------------------------------------------------
+
+bool BoardEmulator::ReadLevel(int ipin)
+{
+    if (ipin<0 || ipin>=NGPIO)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_level[ipin];
+}
+
+void BoardEmulator::WriteLevel(int ipin, bool level)
+{
+    if (ipin<0 || ipin>=NGPIO)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool rising = level && !m_level[ipin];
+    m_level[ipin] = level;
+    if (rising && m_stepDrive[ipin] >= 0)
+        step(m_stepDrive[ipin]);
+}
+
+bool BoardEmulator::GetDirection(int ipin)
+{
+    if (ipin<0 || ipin>=NGPIO)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_direction[ipin];
+}
+
+void BoardEmulator::SetDirection(int ipin, bool dir)
+{
+    if (ipin<0 || ipin>=NGPIO)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_direction[ipin] = dir;
+}
+
+// called with the mutex held
+void BoardEmulator::step(unsigned idrive)
+{
+    // the pins only reach the drivers through the level shifters, and an
+    // A3977 ignores STEP while asleep, in reset or disabled
+    if (!m_level[Layout::igpioEN_IO] || !m_level[Layout::igpioSleep] || !m_level[Layout::igpioReset] ||
+        m_level[Layout::igpioEnable(idrive)])
+        return;
+
+    unsigned mslog2 = (m_level[Layout::igpioMS1] ? 0x1 : 0x0) | (m_level[Layout::igpioMS2] ? 0x2 : 0x0);
+    int64_t eighths = EIGHTHS >> mslog2;
+
+    // DIR high is retraction, which counts up from the extend stop
+    int64_t position = m_position[idrive] + (m_level[Layout::igpioDir(idrive)] ? eighths : -eighths);
+    position = std::max<int64_t>(0, std::min<int64_t>(position, int64_t(m_config.retractStop) * EIGHTHS));
+    if (position != m_position[idrive]) {
+        m_position[idrive] = position;
+        m_stepCount++;
+    }
+}
+
+//------------------------------------------------------------------------------
+// ADCs
+//------------------------------------------------------------------------------
+
+// called with the mutex held
+int BoardEmulator::selectedADC()
+{
+    bool sel1 = m_level[Layout::igpioADCSel1];
+    bool sel2 = m_level[Layout::igpioADCSel2];
+    if (sel1 && !sel2)
+        return 0;
+    if (sel2 && !sel1)
+        return 1;
+    return -1;
+}
+
+/*
+ * A TLC3548 converts the channel selected by one word and returns the result
+ * while the next word is clocked in; reading the FIFO returns it without
+ * starting another conversion.
+ */
+uint32_t BoardEmulator::WriteRead(uint32_t data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int iadc = selectedADC();
+    if (iadc < 0)
+        return 0;
+
+    uint32_t result = m_conversion[iadc];
+
+    int ichan = -1;
+    unsigned cmd = (data >> 12) & 0xF;
+    if (cmd <= 0x7)
+        ichan = cmd;
+    else if (cmd == 0xD)
+        ichan = 8;  // REFP
+    else if (cmd == 0xB)
+        ichan = 9;  // (REFP+REFM)/2
+    else if (cmd == 0xC)
+        ichan = 10; // REFM
+
+    if (ichan >= 0) {
+        float volts = channelVoltage(iadc, ichan);
+        if (m_config.adcNoise > 0)
+            volts += m_config.adcNoise * m_noise(m_rng);
+        long code = std::lround(volts / 5. * 0x3FFF);
+        code = std::max(0L, std::min(code, 0x3FFFL));
+        m_conversion[iadc] = uint32_t(code) << 2;
+    }
+
+    return result;
+}
+
+// called with the mutex held
+float BoardEmulator::channelVoltage(unsigned iadc, unsigned ichan)
+{
+    if (ichan == 8)
+        return 5.;
+    if (ichan == 9)
+        return 2.5;
+    if (ichan == 10 || iadc != 0)
+        return 0.;
+
+    if (ichan < NDRIVES)
+        return m_level[Layout::igpioEncoderEnable] ? encoderVoltage(ichan) : 0.;
+    if (ichan == 6)
+        return (m_config.internalTemperature + 50.) / 100.;
+    return (m_config.externalTemperature + 61.111) / 44.444;
+}
+
+//------------------------------------------------------------------------------
+// State
+//------------------------------------------------------------------------------
+
+// called with the mutex held
+float BoardEmulator::encoderVoltage(unsigned idrive)
+{
+    int spr = m_config.stepsPerRevolution;
+    double angle = std::fmod(double(m_position[idrive]) / EIGHTHS + m_config.encoderAngleAtExtendStop, spr);
+    if (angle < 0)
+        angle += spr;
+    return m_config.encoderVMin + angle * (m_config.encoderVMax - m_config.encoderVMin) / (spr - 1);
+}
+
+float BoardEmulator::EncoderVoltage(unsigned idrive)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return encoderVoltage(idrive);
+}
+
+double BoardEmulator::GetPosition(unsigned idrive)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return double(m_position[idrive]) / EIGHTHS;
+}
+
+void BoardEmulator::SetPosition(unsigned idrive, double steps)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t position = std::llround(steps * EIGHTHS);
+    m_position[idrive] = std::max<int64_t>(0, std::min<int64_t>(position, int64_t(m_config.retractStop) * EIGHTHS));
+}
+
+void BoardEmulator::SetTemperatures(float internalTemperature, float externalTemperature)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.internalTemperature = internalTemperature;
+    m_config.externalTemperature = externalTemperature;
+}
+
+void BoardEmulator::SetADCNoise(float noise)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.adcNoise = noise;
+}
+
+uint64_t BoardEmulator::GetStepCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stepCount;
+}
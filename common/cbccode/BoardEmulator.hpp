@@ -0,0 +1,108 @@
+/*
+ * In-memory emulation of the mirror control board, at the level of its GPIO
+ * pins and ADC words, so that MirrorControlBoard, CBC and everything above
+ * them run unchanged (and without delays) off the board.
+ *
+ * Modelled:
+ *  - GPIO levels and directions; active-low pins start high
+ *  - A3977 drives: a rising STEP edge moves the motor by 1/1, 1/2, 1/4 or 1/8
+ *    of a step (MS1/MS2) in the direction of DIR, if IO is enabled, the
+ *    drivers are awake and out of reset and the drive is enabled
+ *  - End stops: the motor stops at the extend and retract stops
+ *  - Encoders: a sawtooth voltage over one revolution, rising by one step of
+ *    the calibration scale per step of retraction, while the encoders are
+ *    powered
+ *  - TLC3548 ADCs: a conversion per channel select, returned with the next
+ *    word as on the real part, with gaussian noise, 14 bit quantization and
+ *    the reference channels
+ *  - Internal and external temperatures, through the default conversions of
+ *    Platform
+ */
+
+#ifndef BOARDEMULATOR_HPP
+#define BOARDEMULATOR_HPP
+
+#include <mutex>
+#include <random>
+#include <stdint.h>
+
+#include "common/cbccode/BoardBackend.hpp"
+
+class BoardEmulator : public BoardBackend
+{
+public:
+    static const unsigned NDRIVES = 6;
+    static const int NGPIO = 192;
+
+    struct Config
+    {
+        int   stepsPerRevolution;
+        float encoderVMin;          // encoder voltage at angle 0
+        float encoderVMax;          // encoder voltage at angle stepsPerRevolution-1
+        int   encoderAngleAtExtendStop;
+        int   retractStop;          // steps from the extend stop
+        int   startPosition;        // steps from the extend stop
+        float adcNoise;             // rms, in volts
+        float internalTemperature;  // C
+        float externalTemperature;  // C
+        unsigned seed;              // 0 for a random seed
+
+        // matches the defaults of ActuatorBase and Platform
+        Config() :
+            stepsPerRevolution       (200),
+            encoderVMin              (0.593),
+            encoderVMax              (3.06),
+            encoderAngleAtExtendStop (100),
+            retractStop              (100*200),
+            startPosition            (50*200),
+            adcNoise                 (0.001),
+            internalTemperature      (20.),
+            externalTemperature      (10.),
+            seed                     (0)
+        {}
+    };
+
+    explicit BoardEmulator(const Config &config = Config());
+
+    bool ReadLevel(int ipin) override;
+    void WriteLevel(int ipin, bool level) override;
+    bool GetDirection(int ipin) override;
+    void SetDirection(int ipin, bool dir) override;
+    uint32_t WriteRead(uint32_t data) override;
+    bool IsRealTime() const override { return false; }
+
+    // Motor position of drive 0-5, in steps from the extend stop (positive is retraction)
+    double GetPosition(unsigned idrive);
+    void   SetPosition(unsigned idrive, double steps);
+
+    // Voltage the encoder of drive 0-5 puts out at its current position
+    float  EncoderVoltage(unsigned idrive);
+
+    void SetTemperatures(float internalTemperature, float externalTemperature);
+    void SetADCNoise(float noise);
+
+    // Number of STEP edges that moved a motor, for benchmarks
+    uint64_t GetStepCount();
+
+private:
+    static const int EIGHTHS = 8; // positions are kept in 1/8 steps
+
+    void  step(unsigned idrive);
+    float channelVoltage(unsigned iadc, unsigned ichan);
+    float encoderVoltage(unsigned idrive);
+    int   selectedADC();
+
+    Config   m_config;
+    std::mutex m_mutex;
+    std::mt19937 m_rng;
+    std::normal_distribution<float> m_noise;
+
+    bool     m_level[NGPIO];
+    bool     m_direction[NGPIO];
+    int      m_stepDrive[NGPIO];  // drive whose STEP pin this is, or -1
+    int64_t  m_position[NDRIVES]; // in 1/8 steps
+    uint32_t m_conversion[2];     // last conversion of each ADC, as returned on the bus
+    uint64_t m_stepCount;
+};
+
+#endif
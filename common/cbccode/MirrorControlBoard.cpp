@@ -4,6 +4,7 @@
  */
 
 #include <cassert>
+#include <cerrno>
 #include <unistd.h>
 #include <time.h>
 #include <math.h>
@@ -12,28 +13,71 @@
 #include <stdio.h>
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <mutex>
 
 // local includes
 #include "common/cbccode/MirrorControlBoard.hpp"
-#include "common/cbccode/SpiInterface.hpp"
+#include "common/cbccode/BoardBackend.hpp"
 #include "common/cbccode/TLC3548_ADC.hpp"
-#include "common/cbccode/GPIOInterface.hpp"
-#include "common/cbccode/mcspiInterface.hpp"
 #include "common/cbccode/Layout.hpp"
 
-GPIOInterface gpio;
-mcspiInterface spi;
+namespace
+{
+    // the board is opened on first use, so that a program can choose another backend before then
+    std::mutex                    backendMutex;
+    std::shared_ptr<BoardBackend> backendOwner;
+    std::atomic<BoardBackend*>    backendInstance(nullptr);
+}
 
 namespace MirrorControlBoard
 {
+    bool setBackend(std::shared_ptr<BoardBackend> backend)
+    {
+        std::lock_guard<std::mutex> lock(backendMutex);
+        if (backendOwner) {
+            fprintf(stderr, "MirrorControlBoard::setBackend(): board already in use, backend not changed\n");
+            return false;
+        }
+        backendOwner = std::move(backend);
+        backendInstance.store(backendOwner.get(), std::memory_order_release);
+        return true;
+    }
+
+    BoardBackend &backend()
+    {
+        BoardBackend *instance = backendInstance.load(std::memory_order_acquire);
+        if (!instance) {
+            std::lock_guard<std::mutex> lock(backendMutex);
+            if (!backendOwner) {
+                backendOwner = std::make_shared<HardwareBoardBackend>();
+                backendInstance.store(backendOwner.get(), std::memory_order_release);
+            }
+            instance = backendOwner.get();
+        }
+        return *instance;
+    }
+
+    // Real-time priority for the calling thread, to improve timing stability. Not
+    // for an emulated board, where it would only starve the other threads.
+    static void raiseThreadPriority()
+    {
+        if (!backend().IsRealTime())
+            return;
+        pthread_t this_thread = pthread_self();
+        struct sched_param params;
+        params.sched_priority = sched_get_priority_max(SCHED_FIFO);
+        pthread_setschedparam(this_thread, SCHED_FIFO, &params);
+    }
+
     void enableIO ()
     {
-        gpio.WriteLevel(Layout::igpioEN_IO, 1);
+        backend().WriteLevel(Layout::igpioEN_IO, 1);
     }
 
     void disableIO ()
     {
-        gpio.WriteLevel(Layout::igpioEN_IO, 0);
+        backend().WriteLevel(Layout::igpioEN_IO, 0);
     }
 
     void adcSleep (int iadc)
@@ -41,76 +85,76 @@ namespace MirrorControlBoard
         // Set on-board ADC into sleep mode
         selectADC(iadc);
         //spi.Configure();
-        spi.WriteRead(TLC3548::codeSWPowerDown());
+        backend().WriteRead(TLC3548::codeSWPowerDown());
 
         selectADC(iadc);
         //spi.Configure();
-        spi.WriteRead(TLC3548::codeSWPowerDown());
+        backend().WriteRead(TLC3548::codeSWPowerDown());
     }
 
     void powerDownUSB(unsigned iusb)
     {
-        gpio.WriteLevel(Layout::igpioUSBOff(iusb),1);
+        backend().WriteLevel(Layout::igpioUSBOff(iusb),1);
     }
 
     void powerUpUSB(unsigned iusb)
     {
-        gpio.WriteLevel(Layout::igpioUSBOff(iusb),0);
+        backend().WriteLevel(Layout::igpioUSBOff(iusb),0);
     }
 
     bool isUSBPoweredUp(unsigned iusb)
     {
-        return gpio.ReadLevel(Layout::igpioUSBOff(iusb))?false:true;
+        return backend().ReadLevel(Layout::igpioUSBOff(iusb))?false:true;
     }
 
     void powerDownDriveControllers()
     {
-        gpio.WriteLevel(Layout::igpioSleep,0);
+        backend().WriteLevel(Layout::igpioSleep,0);
     }
 
     void powerUpDriveControllers()
     {
-        gpio.WriteLevel(Layout::igpioSleep,1);
+        backend().WriteLevel(Layout::igpioSleep,1);
     }
 
     bool isDriveControllersPoweredUp()
     {
-        return gpio.ReadLevel(Layout::igpioSleep)?true:false;
+        return backend().ReadLevel(Layout::igpioSleep)?true:false;
     }
 
     void powerDownEncoders()
     {
-        gpio.WriteLevel(Layout::igpioEncoderEnable,0);
+        backend().WriteLevel(Layout::igpioEncoderEnable,0);
     }
 
     void powerUpEncoders()
     {
-        gpio.WriteLevel(Layout::igpioEncoderEnable,1);
+        backend().WriteLevel(Layout::igpioEncoderEnable,1);
     }
 
     bool isEncodersPoweredUp()
     {
-        return gpio.ReadLevel(Layout::igpioEncoderEnable)?true:false;
+        return backend().ReadLevel(Layout::igpioEncoderEnable)?true:false;
     }
 
     void powerUpSensors()
     {
-        gpio.WriteLevel(Layout::igpioPowerADC,1);
+        backend().WriteLevel(Layout::igpioPowerADC,1);
     }
 
     void powerDownSensors()
     {
-        gpio.WriteLevel(Layout::igpioPowerADC,0);
+        backend().WriteLevel(Layout::igpioPowerADC,0);
     }
 
     bool isSensorsPoweredUp()
     {
-        return gpio.ReadLevel(Layout::igpioPowerADC)?true:false;
+        return backend().ReadLevel(Layout::igpioPowerADC)?true:false;
     }
 
     void enableDriveSR(bool enable)
     {
-        gpio.WriteLevel(Layout::igpioSR, enable?0:1);
+        backend().WriteLevel(Layout::igpioSR, enable?0:1);
     }
 
 
@@ -121,7 +165,7 @@ namespace MirrorControlBoard
 
     bool isDriveSREnabled()
     {
-        return gpio.ReadLevel(Layout::igpioSR)?false:true;
+        return backend().ReadLevel(Layout::igpioSR)?false:true;
     }
 
     void setUStep(UStep ustep)
@@ -141,38 +185,66 @@ namespace MirrorControlBoard
                 mslog2 = 0x3;
                 break;
         }
-        gpio.WriteLevel(Layout::igpioMS1, mslog2 & 0x1);
-        gpio.WriteLevel(Layout::igpioMS2, mslog2 & 0x2);
+        backend().WriteLevel(Layout::igpioMS1, mslog2 & 0x1);
+        backend().WriteLevel(Layout::igpioMS2, mslog2 & 0x2);
     }
 
     UStep getUStep()
     {
-        if(gpio.ReadLevel(Layout::igpioMS2))
-            return gpio.ReadLevel(Layout::igpioMS1)?USTEP_8:USTEP_4;
+        if(backend().ReadLevel(Layout::igpioMS2))
+            return backend().ReadLevel(Layout::igpioMS1)?USTEP_8:USTEP_4;
         else
-            return gpio.ReadLevel(Layout::igpioMS1)?USTEP_2:USTEP_1;
+            return backend().ReadLevel(Layout::igpioMS1)?USTEP_2:USTEP_1;
     }
 
     void  stepOneDrive(unsigned idrive, Dir dir, unsigned frequency)
     {
         /* Give this thread higher priority to improve timing stability */
-        pthread_t this_thread = pthread_self();
-        struct sched_param params;
-        params.sched_priority = sched_get_priority_max(SCHED_FIFO);
-        pthread_setschedparam(this_thread, SCHED_FIFO, &params);
+        raiseThreadPriority();
 
         /* Write Direction to the DIR pin */
-        gpio.WriteLevel(Layout::igpioDir(idrive),(dir==DIR_RETRACT)?1:0);
+        backend().WriteLevel(Layout::igpioDir(idrive),(dir==DIR_RETRACT)?1:0);
 
         /* Writes one step to STEP pin */
         unsigned igpio = Layout::igpioStep(idrive);
-        gpio.WriteLevel(igpio,(dir==DIR_NONE)?0:1);
+        backend().WriteLevel(igpio,(dir==DIR_NONE)?0:1);
 
         /* a delay */
         waitHalfPeriod(frequency);
 
         /* Toggle pin back to low */
-        gpio.WriteLevel(igpio,0);
+        backend().WriteLevel(igpio,0);
+
+        /* a delay */
+        waitHalfPeriod(frequency);
+        sched_yield();
+    }
+
+    void stepDrives(const Dir dirs[], unsigned ndrives, unsigned frequency)
+    {
+        /* Give this thread higher priority to improve timing stability */
+        raiseThreadPriority();
+
+        /* Write Direction to the DIR pins of all drives taking part in this step */
+        for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+            if (dirs[idrive] != DIR_NONE)
+                backend().WriteLevel(Layout::igpioDir(idrive), (dirs[idrive] == DIR_RETRACT) ? 1 : 0);
+        }
+
+        /* Raise all STEP pins together */
+        for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+            if (dirs[idrive] != DIR_NONE)
+                backend().WriteLevel(Layout::igpioStep(idrive), 1);
+        }
+
+        /* a delay */
+        waitHalfPeriod(frequency);
+
+        /* Toggle pins back to low */
+        for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+            if (dirs[idrive] != DIR_NONE)
+                backend().WriteLevel(Layout::igpioStep(idrive), 0);
+        }
 
         /* a delay */
         waitHalfPeriod(frequency);
@@ -181,14 +253,14 @@ namespace MirrorControlBoard
 
     void setPhaseZeroOnAllDrives()
     {
-        gpio.WriteLevel(Layout::igpioReset,0);
+        backend().WriteLevel(Layout::igpioReset,0);
         waitHalfPeriod(400);
-        gpio.WriteLevel(Layout::igpioReset,1);
+        backend().WriteLevel(Layout::igpioReset,1);
     }
 
     void enableDrive(unsigned idrive, bool enable)
     {
-        gpio.WriteLevel(Layout::igpioEnable(idrive), enable?0:1);
+        backend().WriteLevel(Layout::igpioEnable(idrive), enable?0:1);
     }
 
     void disableDrive(unsigned idrive)
@@ -198,12 +270,12 @@ namespace MirrorControlBoard
 
     bool isDriveEnabled(unsigned idrive)
     {
-        return gpio.ReadLevel(Layout::igpioEnable(idrive))?false:true;
+        return backend().ReadLevel(Layout::igpioEnable(idrive))?false:true;
     }
 
     void enableDriveHiCurrent(bool enable)
     {
-        gpio.WriteLevel(Layout::igpioPwrIncBar, enable?0:1);
+        backend().WriteLevel(Layout::igpioPwrIncBar, enable?0:1);
     }
 
     void disableDriveHiCurrent()
@@ -214,7 +286,7 @@ namespace MirrorControlBoard
 
     bool isDriveHiCurrentEnabled()
     {
-        return gpio.ReadLevel(Layout::igpioPwrIncBar)?false:true;
+        return backend().ReadLevel(Layout::igpioPwrIncBar)?false:true;
     }
 
     //------------------------------------------------------------------------------
@@ -224,14 +296,14 @@ namespace MirrorControlBoard
     void initializeADC(unsigned iadc)
     {
         selectADC(iadc);                                        // Assert Chip Select for ADC in question
-        spi.WriteRead(TLC3548::codeInitialize());
-        spi.WriteRead(TLC3548::codeConfig());
+        backend().WriteRead(TLC3548::codeInitialize());
+        backend().WriteRead(TLC3548::codeConfig());
     }
 
     void selectADC(unsigned iadc)
     {
-        gpio.WriteLevel(Layout::igpioADCSel1, iadc==0?1:0);
-        gpio.WriteLevel(Layout::igpioADCSel2, iadc==1?1:0);
+        backend().WriteLevel(Layout::igpioADCSel1, iadc==0?1:0);
+        backend().WriteLevel(Layout::igpioADCSel2, iadc==1?1:0);
     }
 
     uint32_t measureADC(unsigned iadc, unsigned ichan)
@@ -244,10 +316,10 @@ namespace MirrorControlBoard
 
         // ADC Channel Select
         uint32_t code = TLC3548::codeSelect(ichan);
-        spi.WriteRead(code);
+        backend().WriteRead(code);
 
         // Read ADC
-        uint32_t datum = spi.WriteRead(TLC3548::codeReadFIFO());
+        uint32_t datum = backend().WriteRead(TLC3548::codeReadFIFO());
 
         return TLC3548::decodeUSB(datum);
     }
@@ -268,17 +340,14 @@ namespace MirrorControlBoard
         uint32_t measurement [nmeas];
 
         /* Increase Thread Priority */
-        pthread_t this_thread = pthread_self();
-        struct sched_param params;
-        params.sched_priority = sched_get_priority_max(SCHED_FIFO);
-        pthread_setschedparam(this_thread, SCHED_FIFO, &params);
+        raiseThreadPriority();
 
         uint32_t datum;
 
         /* Loop over number of measurements */
         for(unsigned iloop=0; iloop < nloop; iloop++) {
             // Read data
-            datum = spi.WriteRead(code);
+            datum = backend().WriteRead(code);
             /* Decode data and accumulate statistics*/
             if (iloop >= nburn) {
                 datum = TLC3548::decodeUSB(datum);
@@ -293,7 +362,7 @@ namespace MirrorControlBoard
         }
 
         /* Read last FIFO, Clear Buffer */
-        datum = spi.WriteRead(TLC3548::codeReadFIFO());
+        datum = backend().WriteRead(TLC3548::codeReadFIFO());
 
         float voltage_range = TLC3548::voltData((max-min));
 
@@ -357,8 +426,11 @@ namespace MirrorControlBoard
 
     void waitHalfPeriod(unsigned frequency)
     {
+        if (!backend().IsRealTime())
+            return;
+
 
-        static const int NANOS = 1000000000LL;
+        static const long long NANOS = 1000000000LL;
         /*
          * Method 1: Sleep Method
          */
@@ -402,21 +474,56 @@ namespace MirrorControlBoard
         /*
          * Method 3: std::chrono (note! requires C++11)
          */
-        using std::chrono::nanoseconds;
-        using std::chrono::duration_cast;
-        long int halfperiod = (NANOS / ( 2*frequency));
-        auto start = duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-        while (true) {
-            /* Give this thread higher priority to improve timing stability */
-            pthread_t this_thread = pthread_self();
-            struct sched_param params;
-            params.sched_priority = sched_get_priority_max(SCHED_FIFO);
-            pthread_setschedparam(this_thread, SCHED_FIFO, &params);
-
-            auto now = duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
-            auto diff = now-start;
-            if (diff > halfperiod)
-                break;
+        //using std::chrono::nanoseconds;
+        //using std::chrono::duration_cast;
+        //long int halfperiod = (NANOS / ( 2*frequency));
+        //auto start = duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+
+        //while (true) {
+        //    auto now = duration_cast<nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        //    auto diff = now-start;
+        //    if (diff > halfperiod)
+        //        break;
+        //}
+
+        /*
+         * Method 4: Sleep to an absolute deadline, then spin through its end
+         *
+         * The stepping thread runs at SCHED_FIFO priority, so while it spins no
+         * normal thread (e.g. the one delivering a stop) gets the CPU of a
+         * single-core board. Sleeping through all but SPIN_NANOS of the half
+         * period hands the CPU over; the short spin covers the wake-up latency.
+         * Consecutive half periods chain their deadlines, so a late wake-up
+         * shortens the next wait instead of adding up over a motion.
+         */
+        static const long long SPIN_NANOS = 50000;
+        static thread_local long long deadline = 0;
+        long long halfperiod = NANOS / (2*frequency);
+
+        /* Give this thread higher priority to improve timing stability */
+        raiseThreadPriority();
+
+        struct timespec current{};
+        if (clock_gettime(CLOCK_MONOTONIC, &current))
+            return;
+        long long now = current.tv_sec*NANOS + current.tv_nsec;
+
+        /* a new motion (or one that fell a whole half period behind) starts from now */
+        if (now - deadline > halfperiod)
+            deadline = now;
+        deadline += halfperiod;
+
+        if (deadline - now > SPIN_NANOS) {
+            struct timespec wake{};
+            wake.tv_sec = (deadline - SPIN_NANOS) / NANOS;
+            wake.tv_nsec = (deadline - SPIN_NANOS) % NANOS;
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) == EINTR) {}
+        }
+
+        while (now < deadline) {
+            if (clock_gettime(CLOCK_MONOTONIC, &current))
+                return;
+            now = current.tv_sec*NANOS + current.tv_nsec;
         }
         sched_yield();
     }
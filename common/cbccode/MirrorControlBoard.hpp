@@ -6,15 +6,27 @@
 #ifndef MIRRORCONTROLBOARD_HPP
 #define MIRRORCONTROLBOARD_HPP
 
+#include <memory>
 #include <vector>
 #include <stdint.h>
 
+class BoardBackend;
+
 namespace MirrorControlBoard
 {
         enum UStep { USTEP_1, USTEP_2, USTEP_4, USTEP_8 };
         enum Dir { DIR_EXTEND, DIR_RETRACT, DIR_NONE };
         enum GPIODir { DIR_OUTPUT, DIR_INPUT};
 
+        /*
+         * Selects what the functions below talk to, e.g. a BoardEmulator.
+         * Must be called before any of them is; by default the board's own
+         * GPIO and SPI registers are opened on first use. Returns false if
+         * the board is already in use.
+         */
+        bool setBackend(std::shared_ptr<BoardBackend> backend);
+        BoardBackend &backend();
+
         void enableIO();
         void disableIO();
 
@@ -54,6 +66,13 @@ namespace MirrorControlBoard
          */
         void stepOneDrive(unsigned idrive, Dir dir, unsigned frequency = 1000);
 
+        /*
+         * Steps several motors a single step each within one STEP pulse period.
+         * dirs holds one entry per drive (counting from zero); drives set to
+         * DIR_NONE are left untouched.
+         */
+        void stepDrives(const Dir dirs[], unsigned ndrives, unsigned frequency = 1000);
+
         void setPhaseZeroOnAllDrives();
 
         void enableDriveSR(bool enable = true);
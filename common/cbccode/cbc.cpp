@@ -14,11 +14,14 @@
 
 
 #include "common/cbccode/cbc.hpp"
+#include "common/cbccode/BoardBackend.hpp"
 #include "common/cbccode/MirrorControlBoard.hpp"
 #include "common/cbccode/TLC3548_ADC.hpp"
 
 void usleep2 (int usdelay)
 {
+    if (!MirrorControlBoard::backend().IsRealTime())
+        return;
     static const int NANOS =  1000000000LL;
     static const int MICROS = 1000000LL;
     int nanodelay = usdelay * NANOS / MICROS;
@@ -197,7 +200,7 @@ void usleep2 (int usdelay)
 // Motor Driver Control
 //----------------------------------------------------------------------------------------------------------------------
 
-CBC::Driver::Driver(CBC *thiscbc) : cbc(thiscbc), m_steppingFrequency()
+CBC::Driver::Driver(CBC *thiscbc) : cbc(thiscbc), m_steppingFrequency(), m_abortCount(0)
     {
     }
 
@@ -340,12 +343,12 @@ CBC::Driver::Driver(CBC *thiscbc) : cbc(thiscbc), m_steppingFrequency()
         MirrorControlBoard::setPhaseZeroOnAllDrives();
     }
 
-    void CBC::Driver::step(int drive, int nsteps)
+    int CBC::Driver::step(int drive, int nsteps)
     {
-        step(drive, nsteps, m_steppingFrequency);
+        return step(drive, nsteps, m_steppingFrequency);
     }
 
-    void CBC::Driver::step(int drive, int nsteps, int frequency)
+    int CBC::Driver::step(int drive, int nsteps, int frequency)
     {
         /* Check frequency limits */
         if (frequency > maximumSteppingFrequency)
@@ -355,7 +358,10 @@ CBC::Driver::Driver(CBC *thiscbc) : cbc(thiscbc), m_steppingFrequency()
 
         /* whine if invalid actuator number is used */
         if ((drive<1)||(drive>6))
-            return;
+            return 0;
+
+        /* only aborts from here on stop this motion */
+        unsigned abortCount = m_abortCount.load();
 
         usleep2(cbc->getDelayTime());
         if (isEnabled(drive)) {
@@ -364,26 +370,113 @@ CBC::Driver::Driver(CBC *thiscbc) : cbc(thiscbc), m_steppingFrequency()
 
             /* if nstep > 0, extend. If nstep < 0, retract */
             MirrorControlBoard::Dir dir = MirrorControlBoard::DIR_EXTEND;
+            int sign = 1;
             if (nsteps<0)
-                dir = MirrorControlBoard::DIR_RETRACT, nsteps=-nsteps;
+                dir = MirrorControlBoard::DIR_RETRACT, nsteps=-nsteps, sign=-1;
 
             /* Convert from microsteps to macrosteps */
-            unsigned microsteps = nsteps * getMicrosteps();
+            unsigned microstepsPerStep = getMicrosteps();
+            unsigned microsteps = nsteps * microstepsPerStep;
 
             /* loop over number of micro Steps */
-            for (unsigned istep=0; istep<microsteps; istep++) {
-                /* Give this thread higher priority to improve timing stability */
-                pthread_t this_thread = pthread_self();
-                struct sched_param params{};
-                params.sched_priority = sched_get_priority_max(SCHED_FIFO);
-                pthread_setschedparam(this_thread, SCHED_FIFO, &params);
-
-                /* Step the drive */
-                MirrorControlBoard::stepOneDrive(drive, dir, frequency * getMicrosteps());
+            unsigned istep;
+            for (istep=0; istep<microsteps; istep++) {
+                /* on abort, stop at the end of the full step in progress */
+                if (istep % microstepsPerStep == 0 && m_abortCount.load(std::memory_order_relaxed) != abortCount)
+                    break;
+
+                /* Step the drive (at real-time priority) */
+                MirrorControlBoard::stepOneDrive(drive, dir, frequency * microstepsPerStep);
             }
             sched_yield();
-            return;
+            return sign * int(istep / microstepsPerStep);
         }
+        return 0;
+    }
+
+    std::vector<int> CBC::Driver::step(const std::vector<int> &nsteps)
+    {
+        return step(nsteps, m_steppingFrequency);
+    }
+
+    std::vector<int> CBC::Driver::step(const std::vector<int> &nsteps, int frequency)
+    {
+        /* Check frequency limits */
+        if (frequency > maximumSteppingFrequency)
+            frequency = maximumSteppingFrequency;
+        else if (frequency < minimumSteppingFrequency)
+            frequency = minimumSteppingFrequency;
+
+        const unsigned ndrives = 6;
+        MirrorControlBoard::Dir dirs[ndrives];
+        MirrorControlBoard::Dir moveDirs[ndrives];
+        unsigned microsteps[ndrives];
+        unsigned done[ndrives];
+        unsigned maxMicrosteps = 0;
+        unsigned microstepsPerStep = getMicrosteps();
+
+        /* only aborts from here on stop this motion */
+        unsigned abortCount = m_abortCount.load();
+
+        usleep2(cbc->getDelayTime());
+        for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+            microsteps[idrive] = 0;
+            done[idrive] = 0;
+            moveDirs[idrive] = MirrorControlBoard::DIR_NONE;
+            /* whine if invalid actuator number is used, skip disabled drives (MCB counts from 0) */
+            if (idrive >= nsteps.size() || nsteps[idrive] == 0 || !isEnabled(idrive + 1))
+                continue;
+            /* if nstep > 0, extend. If nstep < 0, retract */
+            moveDirs[idrive] = (nsteps[idrive] < 0) ? MirrorControlBoard::DIR_RETRACT : MirrorControlBoard::DIR_EXTEND;
+            microsteps[idrive] = std::abs(nsteps[idrive]) * microstepsPerStep;
+            if (microsteps[idrive] > maxMicrosteps)
+                maxMicrosteps = microsteps[idrive];
+        }
+
+        /* loop over micro steps of the longest move, spreading the shorter moves evenly across it */
+        bool aborted = false;
+        for (unsigned istep = 0; istep < maxMicrosteps; istep++) {
+            if (m_abortCount.load(std::memory_order_relaxed) != abortCount) {
+                aborted = true;
+                break;
+            }
+            for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+                unsigned long long after = (unsigned long long) (istep + 1) * microsteps[idrive] / maxMicrosteps;
+                dirs[idrive] = (after > done[idrive]) ? moveDirs[idrive] : MirrorControlBoard::DIR_NONE;
+                done[idrive] = after;
+            }
+            /* Step the drives */
+            MirrorControlBoard::stepDrives(dirs, ndrives, frequency * microstepsPerStep);
+        }
+
+        /* on abort, bring every drive to the end of the full step it is in (at most microstepsPerStep-1 more) */
+        bool finishing = aborted;
+        while (finishing) {
+            finishing = false;
+            for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+                dirs[idrive] = MirrorControlBoard::DIR_NONE;
+                if (done[idrive] % microstepsPerStep) {
+                    dirs[idrive] = moveDirs[idrive];
+                    done[idrive]++;
+                    finishing = true;
+                }
+            }
+            if (finishing)
+                MirrorControlBoard::stepDrives(dirs, ndrives, frequency * microstepsPerStep);
+        }
+        sched_yield();
+
+        std::vector<int> stepsTaken(ndrives, 0);
+        for (unsigned idrive = 0; idrive < ndrives; idrive++) {
+            int sign = (moveDirs[idrive] == MirrorControlBoard::DIR_RETRACT) ? -1 : 1;
+            stepsTaken[idrive] = sign * int(done[idrive] / microstepsPerStep);
+        }
+        return stepsTaken;
+    }
+
+    void CBC::Driver::abort()
+    {
+        m_abortCount++;
     }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #ifndef CBCCODE_CBC_HPP
 #define CBCCODE_CBC_HPP
 
+#include <atomic>
 #include <vector>
 #include <climits>
 
@@ -265,16 +266,53 @@ class CBC
                 /*! @brief Step drive using global frequency
                  * @param drive  Motor drive 1-6
                  * @param nsteps Number of MACRO-steps
+                 * @return Number of MACRO-steps taken, fewer than nsteps if aborted
                  */
-                void step (int drive, int nsteps);
+                int step (int drive, int nsteps);
 
                 /*! @brief Step drive with configurable frequency
                  *
                  * @param drive  Motor drive 1-6
                  * @param nsteps Number of MACRO-steps
                  * @param frequency OPTIONAL argument to specify a stepping frequency, otherwise the global default will be assumed.
+                 * @return Number of MACRO-steps taken, fewer than nsteps if aborted
                  */
-                void step (int drive, int nsteps, int frequency);
+                int step (int drive, int nsteps, int frequency);
+
+                /*! @brief Step several drives simultaneously using global frequency
+                 *
+                 * @param nsteps Number of MACRO-steps for each of drives 1-6 (index 0 is drive 1)
+                 * @return Number of MACRO-steps taken by each of drives 1-6
+                 */
+                std::vector<int> step (const std::vector<int> &nsteps);
+
+                /*! @brief Step several drives simultaneously with configurable frequency
+                 *
+                 * Microsteps of all drives are interleaved so that every drive starts and
+                 * finishes together, with the largest move set by the stepping frequency.
+                 * Disabled drives are skipped.
+                 *
+                 * @param nsteps Number of MACRO-steps for each of drives 1-6 (index 0 is drive 1)
+                 * @param frequency Stepping frequency of the drive with the largest move.
+                 * @return Number of MACRO-steps taken by each of drives 1-6, fewer than nsteps if aborted
+                 */
+                std::vector<int> step (const std::vector<int> &nsteps, int frequency);
+                ///@}
+
+                ///@{
+                /*! @name Abort
+                 */
+
+                /*! @brief Stop all stepping in progress, from any thread
+                 *
+                 * Takes no lock, and the stepping loops test it before every microstep: each
+                 * drive only finishes the full step it is in, so the motors stop within one
+                 * step period (2.5 ms at 400 Hz) and on a full step. Calls to step() made
+                 * after this one are not affected.
+                 */
+                void abort();
+                /*! @brief Number of calls to abort() so far, to tell whether one came after a given point */
+                unsigned getAbortCount() const { return m_abortCount.load(); }
                 ///@}
 
 
@@ -301,6 +339,9 @@ class CBC
                  */
                 int  m_steppingFrequency;
 
+                /*! Incremented by abort(), read by the stepping loops */
+                std::atomic<unsigned> m_abortCount;
+
                 ///@{
                 /*!
                  * Some parameters to set a maximum and minimum
@@ -3,9 +3,10 @@
 using std::string;
 using std::vector;
 
+const int AravisCamera::STREAM_POLL_TIMEOUT = 100000;
 
 AravisCamera::AravisCamera(const char *device_id) :
-        cameraIsReady(false), imgWidth(2592), imgHeight(1944), nBuffers(10) {
+        cameraIsReady(false), imgWidth(2592), imgHeight(1944), nBuffers(10), streaming(false), latestFresh(false) {
 
     spdlog::trace("New Camera from constructor");
     // initialize glib
@@ -39,6 +40,7 @@ AravisCamera::AravisCamera(const char *device_id) :
 }
 
 AravisCamera::~AravisCamera() {
+    stopStreaming();
     cameraIsReady = false;
     if (camera != NULL && stream != NULL) {
         arv_camera_stop_acquisition(camera);
@@ -50,7 +52,8 @@ AravisCamera::~AravisCamera() {
     spdlog::trace("stream and camera destroyed");
 }
 
-AravisCamera::AravisCamera(const AravisCamera& that) : imgWidth(2592), imgHeight(1944), nBuffers(10) {
+AravisCamera::AravisCamera(const AravisCamera& that) : imgWidth(2592), imgHeight(1944), nBuffers(10),
+                                                        streaming(false), latestFresh(false) {
     spdlog::trace("New Camera from copy");
     cameraIsReady = that.cameraIsReady;
     stream = that.stream;
@@ -72,10 +75,9 @@ bool AravisCamera::isReady() {
     return cameraIsReady;
 }
 
-vector<unsigned char> AravisCamera::captureFrame() {
-    // create vector which will hold image
-    vector<unsigned char> image;
-    image.reserve(payload);
+Frame AravisCamera::captureFrame() {
+    if (streaming)
+        return waitForFrame(2000);
 
     // send a trigger to the camera
     arv_camera_software_trigger(camera);
@@ -86,6 +88,19 @@ vector<unsigned char> AravisCamera::captureFrame() {
     if (buffer == NULL)
         spdlog::warn("IMAGE BUFFER IS NULL");
 
+    Frame frame = wrapBuffer(buffer);
+    if (!frame.empty()) {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        stats.received++;
+        stats.delivered++;
+    }
+    return frame;
+}
+
+Frame AravisCamera::wrapBuffer(ArvBuffer *buffer) {
+    if (buffer == NULL)
+        return Frame();
+
     /*
      * ArvBufferStatus:
      * @ARV_BUFFER_STATUS_UNKNOWN: unknown status
@@ -122,23 +137,111 @@ vector<unsigned char> AravisCamera::captureFrame() {
     if (buffer != NULL && arv_buffer_get_status(buffer) == ARV_BUFFER_STATUS_SUCCESS) {
         size_t thesize;
         const void *thedata = arv_buffer_get_data(buffer, &thesize);
-        //image.get_allocator().allocate(thesize);
-        //write image - make sure to use -fpermissive flag!!!
-        //image.assign(thesize,thedata);
-        //image = *(vector<unsigned char> *)thedata;
-        //for(int i = 0; i < thesize; i++)
-        //	image[i] = *(const char *)thedata[i];
-        //if(buffer != NULL && buffer->status == ARV_BUFFER_STATUS_SUCCESS)
-        image.assign((guint8 *) thedata, (guint8 *) thedata + thesize);
+        // hand out the buffer itself -- it is pushed back into the stream once the last user lets go.
+        // keep a reference on the stream so the buffer has somewhere to go back to.
+        ArvStream *theStream = ARV_STREAM(g_object_ref(stream));
+        std::shared_ptr<unsigned char> data((unsigned char *) thedata, [theStream, buffer](unsigned char *) {
+            arv_stream_push_buffer(theStream, buffer);
+            g_object_unref(theStream);
+        });
+        return Frame(data, thesize);
     } else {
         spdlog::debug("AravisCamera: Buffer cleared");
-        image.clear();
-        return image;
+        // push the unusable buffer back into the stream so it is not lost
+        if (buffer != NULL)
+            arv_stream_push_buffer(stream, buffer);
+        return Frame();
+    }
+}
+
+bool AravisCamera::startStreaming(double rate_hz) {
+    if (streaming)
+        return true;
+    if (!cameraIsReady)
+        return false;
+
+    arv_camera_stop_acquisition(camera);
+    arv_camera_clear_triggers(camera);
+    if (rate_hz > 0 && !setFrameRate(rate_hz))
+        spdlog::warn("AravisCamera: could not set frame rate to {} Hz, streaming at {} Hz", rate_hz, getFrameRate());
+    arv_camera_start_acquisition(camera);
+
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        latestFrame = Frame();
+        latestFresh = false;
     }
+    streaming = true;
+    streamThread = std::thread(&AravisCamera::readStream, this);
+    spdlog::info("AravisCamera: streaming at {} Hz", getFrameRate());
+    return true;
+}
+
+void AravisCamera::stopStreaming() {
+    if (!streaming)
+        return;
+    streaming = false;
+    frameCondition.notify_all();
+    if (streamThread.joinable())
+        streamThread.join();
+
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        latestFrame = Frame(); // give the buffer back to the stream
+        latestFresh = false;
+    }
+
+    arv_camera_stop_acquisition(camera);
+    arv_camera_set_trigger(camera, "Software");
+    arv_camera_start_acquisition(camera);
+    StreamStatistics s = getStreamStatistics();
+    spdlog::info("AravisCamera: stopped streaming. {} frames received, {} used, {} dropped, {} failed, {} underruns",
+                 s.received, s.delivered, s.dropped, s.failed, s.underruns);
+}
+
+void AravisCamera::readStream() {
+    while (streaming) {
+        ArvBuffer *buffer = arv_stream_timeout_pop_buffer(stream, STREAM_POLL_TIMEOUT);
+        if (buffer == NULL)
+            continue;
+        Frame frame = wrapBuffer(buffer);
+
+        std::lock_guard<std::mutex> lock(frameMutex);
+        if (frame.empty()) {
+            stats.failed++;
+            continue;
+        }
+        stats.received++;
+        if (latestFresh)
+            stats.dropped++;
+        // the frame this replaces goes back into the stream
+        latestFrame = frame;
+        latestFresh = true;
+        frameCondition.notify_all();
+    }
+}
+
+Frame AravisCamera::waitForFrame(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(frameMutex);
+    if (!frameCondition.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                 [this]() { return latestFresh || !streaming; }) || !latestFresh)
+        return Frame();
+    latestFresh = false;
+    stats.delivered++;
+    // hand over our reference, so the buffer goes back to the stream as soon as the consumer is done with it
+    Frame frame = latestFrame;
+    latestFrame = Frame();
+    return frame;
+}
 
-    // push buffer back into stream and return
-    arv_stream_push_buffer(stream, buffer);
-    return image;
+AravisCamera::StreamStatistics AravisCamera::getStreamStatistics() {
+    guint64 completed = 0, failures = 0, underruns = 0;
+    if (stream != NULL)
+        arv_stream_get_statistics(stream, &completed, &failures, &underruns);
+    std::lock_guard<std::mutex> lock(frameMutex);
+    StreamStatistics s = stats;
+    s.underruns = underruns;
+    return s;
 }
 
 string AravisCamera::getID() {
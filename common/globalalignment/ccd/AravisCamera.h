@@ -1,6 +1,9 @@
 #pragma once
 
 #include <arv.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstddef>
 #include <string>
@@ -8,6 +11,10 @@
 #include <stdint.h>
 #include <iostream>
 #include <iterator>
+#include <mutex>
+#include <thread>
+
+#include "common/globalalignment/ccd/Frame.h"
 
 //spdlog
 #include "common/utilities/spdlog/spdlog.h"
@@ -15,6 +22,14 @@
 
 class AravisCamera {
 public:
+    struct StreamStatistics {
+        uint64_t received = 0; // complete frames from the camera
+        uint64_t delivered = 0; // frames handed out by captureFrame()/waitForFrame()
+        uint64_t dropped = 0; // complete frames replaced by a newer one before anyone took them
+        uint64_t failed = 0; // incomplete/corrupt frames
+        uint64_t underruns = 0; // frames lost because no buffer was free, as counted by aravis
+    };
+
     AravisCamera(const char *device_id = NULL);
 
     AravisCamera(const AravisCamera& that);
@@ -25,7 +40,23 @@ public:
 
     bool isReady();
 
-    std::vector<unsigned char> captureFrame();
+    // returned frames hold one of the stream's nBuffers buffers until released
+    // when streaming, this is the newest frame not handed out before
+    Frame captureFrame();
+
+    // free-running acquisition: the camera runs untriggered at its frame rate (rate_hz, if given) into the
+    // nBuffers ring, and a reader thread keeps just the newest complete frame
+    bool startStreaming(double rate_hz = 0);
+
+    // back to one software-triggered frame per captureFrame()
+    void stopStreaming();
+
+    bool isStreaming() { return streaming; }
+
+    // newest streamed frame not handed out before, waiting up to timeout_ms for one; empty on timeout
+    Frame waitForFrame(int timeout_ms);
+
+    StreamStatistics getStreamStatistics();
 
     // getters
     int px() { return imgWidth; }
@@ -64,4 +95,19 @@ private:
     std::string cameraID;
     const int imgWidth, imgHeight, nBuffers;
     int payload, pixelDepth;
+
+    std::atomic<bool> streaming;
+    std::thread streamThread;
+    std::mutex frameMutex;
+    std::condition_variable frameCondition;
+    Frame latestFrame;
+    bool latestFresh; // latestFrame hasn't been handed out yet
+    StreamStatistics stats;
+
+    static const int STREAM_POLL_TIMEOUT; // us
+
+    // wrap a popped buffer as a Frame, or push it back and return an empty Frame if it is unusable
+    Frame wrapBuffer(ArvBuffer *buffer);
+
+    void readStream();
 };
@@ -23,23 +23,31 @@ CamOutThread::CamOutThread(AravisCamera *camera, const LEDinputs *li) :
         pfCamera(camera),
         imgWidth(li->CCDWIDTH),
         imgHeight(li->CCDHEIGHT),
-        pfLEDsin(li) {
+        pfLEDsin(li),
+        hasLastSpace(false),
+        consuming(false),
+        pLatestResult(nullptr),
+        latestSuccess(false),
+        resultCount(0),
+        lastReturned(0) {
 }
 
-CamOutThread::~CamOutThread() = default;
+const int CamOutThread::STREAM_FRAME_TIMEOUT = 500;
+const int CamOutThread::STREAM_RESULT_TIMEOUT = 5000;
+
+CamOutThread::~CamOutThread() {
+    stopStreaming();
+}
 
 bool CamOutThread::cycle(LEDoutputs *pLEDsout) {
-//Timestamp
-    time_t t = time(nullptr);
-    struct tm *theTime = gmtime(&t);
-    char strTime[16];
-    strftime(strTime, 16, "%Y%m%d%H%M%S", theTime);
+    if (consuming)
+        return latestResult(pLEDsout);
 
 //Take and save picture
 //
     // save the current camera frame to a vector
     spdlog::trace("Status of stream: {}",pfCamera->isReady());
-    vector<unsigned char> theFrame = pfCamera->captureFrame();
+    Frame theFrame = pfCamera->captureFrame();
     spdlog::trace("Frame captured");
     int troubleshoot_tries(0);
     //troubleshoot a missing frame
@@ -56,17 +64,34 @@ bool CamOutThread::cycle(LEDoutputs *pLEDsout) {
             }
         }
     } // end if empty frame
+    return analyze(theFrame, pLEDsout);
+}
+
+bool CamOutThread::analyze(Frame theFrame, LEDoutputs *pLEDsout) {
+//Timestamp
+    time_t t = time(nullptr);
+    struct tm *theTime = gmtime(&t);
+    char strTime[16];
+    strftime(strTime, 16, "%Y%m%d%H%M%S", theTime);
+
     spdlog::trace("Frame not empty, moving to create Image.");
-    //save the frame to the Image class
+    //wrap the frame in the Image class -- no copy, the image shares the camera buffer
     Image theImage(theFrame);
+    theFrame = Frame();
+    if (theImage.empty()) {
+        spdlog::error("Frame too small for a full image. Ending cycle.");
+        return false;
+    }
 
     //save to disk
     //save to disk
     if (pfLEDsin->SAVEIMAGE) {
+        // the star detection below erases pixels in place, so the raw save needs its own copy
+        Image rawImage = pfLEDsin->CAPTUREONLY ? theImage : theImage.clone();
         if (pfLEDsin->SAVEFORMAT == "fits")
-            theImage.saveFITSImage(pfLEDsin, strTime);
+            rawImage.saveFITSImage(pfLEDsin, strTime);
         if (pfLEDsin->SAVEFORMAT == "raw")
-            theImage.saveRawImage(strTime);
+            rawImage.saveRawImage(strTime);
     }
 
 //
@@ -94,8 +119,75 @@ bool CamOutThread::cycle(LEDoutputs *pLEDsout) {
     }
 
     // attempt solid body fit
-    FitLED fittheleds(pLEDsout);
+    FitLED fittheleds(pLEDsout, hasLastSpace ? lastSpace : nullptr);
+    hasLastSpace = fittheleds.converged();
+    if (hasLastSpace)
+        copy(pLEDsout->SPACE, pLEDsout->SPACE + FitLED::NSPACEPARAM, lastSpace);
 
     return true;
     //End image analysis
 }
+
+bool CamOutThread::startStreaming(double rate_hz) {
+    if (consuming)
+        return true;
+    if (!pfCamera->startStreaming(rate_hz))
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        resultCount = lastReturned = 0;
+    }
+    consuming = true;
+    consumerThread = std::thread(&CamOutThread::consume, this);
+    return true;
+}
+
+void CamOutThread::stopStreaming() {
+    if (!consuming)
+        return;
+    consuming = false;
+    if (consumerThread.joinable())
+        consumerThread.join();
+    pfCamera->stopStreaming();
+}
+
+void CamOutThread::consume() {
+    while (consuming) {
+        // always the newest frame: whatever arrived while the last one was being analysed is skipped
+        Frame theFrame = pfCamera->waitForFrame(STREAM_FRAME_TIMEOUT);
+        if (theFrame.empty())
+            continue;
+
+        LEDoutputs result(pfLEDsin);
+        bool success = analyze(theFrame, &result);
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!pLatestResult)
+            pLatestResult = std::unique_ptr<LEDoutputs>(new LEDoutputs(pfLEDsin));
+        *pLatestResult = result;
+        latestSuccess = success;
+        resultCount++;
+        resultCondition.notify_all();
+    }
+}
+
+bool CamOutThread::latestResult(LEDoutputs *pLEDsout) {
+    std::unique_lock<std::mutex> lock(resultMutex);
+    if (!resultCondition.wait_for(lock, std::chrono::milliseconds(STREAM_RESULT_TIMEOUT),
+                                  [this]() { return resultCount > lastReturned; })) {
+        spdlog::warn("CamOutThread: no new frame analysed in {} ms.", STREAM_RESULT_TIMEOUT);
+        return false;
+    }
+    if (resultCount > lastReturned + 1)
+        spdlog::debug("CamOutThread: {} analysed frames since last cycle, returning the newest",
+                      resultCount - lastReturned);
+    lastReturned = resultCount;
+    *pLEDsout = *pLatestResult;
+    bool success = latestSuccess;
+    lock.unlock();
+
+    AravisCamera::StreamStatistics stats = pfCamera->getStreamStatistics();
+    spdlog::debug("CamOutThread: {} frames received, {} analysed, {} dropped, {} failed, {} underruns",
+                  stats.received, stats.delivered, stats.dropped, stats.failed, stats.underruns);
+    return success;
+}
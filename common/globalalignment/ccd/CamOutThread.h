@@ -15,7 +15,11 @@
 #include <time.h>
 
 // needed for waiting
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 //spdlog
@@ -24,18 +28,50 @@
 
 class CamOutThread {
 public:
-    CamOutThread() : pfCamera(nullptr), imgWidth(0), imgHeight(0), pfLEDsin(nullptr) {}
+    CamOutThread() : pfCamera(nullptr), imgWidth(0), imgHeight(0), pfLEDsin(nullptr), hasLastSpace(false),
+                     consuming(false), pLatestResult(nullptr), latestSuccess(false), resultCount(0),
+                     lastReturned(0) {}
 
     CamOutThread(AravisCamera *camera, const LEDinputs *li);
 
     ~CamOutThread();
 
+    // take a frame, find the LEDs and fit the panel position
+    // when streaming, the newest result of the consumer thread instead (waiting for one newer than the last)
     bool cycle(LEDoutputs *pLEDsout);
 
+    // continuous mode: the camera free-runs and a consumer thread analyses the newest frame as soon as it is done
+    // with the previous one, so capture and analysis overlap
+    bool startStreaming(double rate_hz = 0);
+
+    void stopStreaming();
+
+    bool isStreaming() { return consuming; }
+
 private:
     AravisCamera *pfCamera;
     int imgWidth, imgHeight;
     const LEDinputs *pfLEDsin;
+    // last converged panel position, to warm-start the next fit from
+    double lastSpace[FitLED::NSPACEPARAM];
+    bool hasLastSpace;
+
+    std::atomic<bool> consuming;
+    std::thread consumerThread;
+    std::mutex resultMutex;
+    std::condition_variable resultCondition;
+    std::unique_ptr<LEDoutputs> pLatestResult;
+    bool latestSuccess;
+    uint64_t resultCount, lastReturned;
+
+    static const int STREAM_FRAME_TIMEOUT; // ms
+    static const int STREAM_RESULT_TIMEOUT; // ms
+
+    bool analyze(Frame theFrame, LEDoutputs *pLEDsout);
+
+    void consume();
+
+    bool latestResult(LEDoutputs *pLEDsout);
     const double PI = 3.141592653589793238463;
 
 };
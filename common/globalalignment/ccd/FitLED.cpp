@@ -1,8 +1,14 @@
 #include "common/globalalignment/ccd/FitLED.h"
+#include <cmath>
 
 using namespace std;
 
-FitLED::FitLED(LEDoutputs *lo) : ledsin(lo->inleds), ledsout(lo) {
+const int FitLED::NSPACEPARAM;
+const int FitLED::MAXLED;
+const int FitLED::MAX_ITERATIONS = 100;
+const double FitLED::MAX_WARM_RESIDUAL = 5.0;
+
+FitLED::FitLED(LEDoutputs *lo, const double *pstart) : ledsin(lo->inleds), ledsout(lo), fitConverged(false) {
 
 
     pixscale = ledsin->PIXSIZE / (ledsin->LENSFL * ledsin->LENSSCALE); // radians/pixel calibrated to the given scale
@@ -10,116 +16,214 @@ FitLED::FitLED(LEDoutputs *lo) : ledsin(lo->inleds), ledsout(lo) {
     cx0 = ledsin->CCDWIDTH / 2.0; // camera center pixel in x
     cy0 = ledsin->CCDHEIGHT / 2.0; // camera center pixel in y
 
-    ledsbuilt = new double *[ledsin->NLED];
-    for (int i = 0; i < ledsin->NLED; i++) {
-        ledsbuilt[i] = new double[2];
-    }
     for (int i = 0; i < ledsin->NLED; i++) {
         ledsbuilt[i][0] = ledsin->LEDCCD[i][0] - cx0;
         ledsbuilt[i][1] = ledsin->LEDCCD[i][1] + cy0;
     }
-    ledsfound = new double *[ledsin->NLED];
-    for (int i = 0; i < ledsin->NLED; i++) {
-        ledsfound[i] = new double[2];
-    }
     for (int i = 0; i < ledsin->NLED; i++) {
         ledsfound[i][0] = ledsout->LEDPOS[i][0] - cx0;
         ledsfound[i][1] = ledsout->LEDPOS[i][1] + cy0;
     }
 
-    // create optimization object using non-derivative BOBYQA with NSPACEPARAM number of free parameters
-    nlopt::opt opt(nlopt::LN_BOBYQA, NSPACEPARAM);
-    //populate upper and lower bounds
-    vector<double> lb(NSPACEPARAM);
-    vector<double> ub(NSPACEPARAM);
+    // initial guess populated by expected panel position in space
+    double nominal[NSPACEPARAM] = {0, 0, 8500, 0, 0, PI / 2.0}; //position in mm and rotation in rads
+    double x[NSPACEPARAM];
+    bool warm = (pstart != nullptr);
     for (int i = 0; i < NSPACEPARAM; i++) {
-        lb[i] = ledsin->LEDLB[i];
-        ub[i] = ledsin->LEDUB[i];
+        x[i] = warm ? pstart[i] : nominal[i];
+        if (x[i] < ledsin->LEDLB[i] || x[i] > ledsin->LEDUB[i])
+            warm = false;
+    }
+    if (!warm)
+        copy(nominal, nominal + NSPACEPARAM, x);
+
+    double minf = fit(x);
+    // the panel moved too far for the previous solution to be a good start (or it lost track) -- start over
+    if (warm && (!fitConverged || minf > MAX_WARM_RESIDUAL * MAX_WARM_RESIDUAL * npresent())) {
+        spdlog::debug("FitLED: warm start ended at offset {}, refitting from nominal position", minf);
+        copy(nominal, nominal + NSPACEPARAM, x);
+        minf = fit(x);
     }
-    opt.set_lower_bounds(lb);
-    opt.set_upper_bounds(ub);
-    //define objective
-    opt.set_min_objective(f_ledfit, this);
-    //define end condition
-    opt.set_xtol_rel(1e-6);
-    // initial guess populated by expected panel position in space
-    std::vector<double> x(NSPACEPARAM); //position in mm and rotation in rads
-    x[0] = 0;
-    x[1] = 0;
-    x[2] = 8500;
-    x[3] = 0;
-    x[4] = 0;
-    x[5] = PI / 2.0;
-    double minf;
-    opt.optimize(x, minf);
-
-//	nlopt::result result = opt.optimize(x, minf);
 
-    double **c = moveled(x);
+    moveled(x);
 
     spdlog::info("min offset: {}", minf);
     spdlog::info("led offsets (ledpos - best guess)");
 
     for (int i = 0; i < ledsin->NLED; i++)
         if (ledsout->LEDSPRESENT[i]) {
-            spdlog::info("LED # {}: {}, {}", i + 1, ledsfound[i][0] - c[i][0], ledsfound[i][1] - c[i][1]);
+            spdlog::info("LED # {}: {}, {}", i + 1, ledsfound[i][0] - ledsbuilt[i][0],
+                         ledsfound[i][1] - ledsbuilt[i][1]);
         }
     for (int i = 0; i < NSPACEPARAM; i++)
         ledsout->SPACE[i] = x[i];
 }
 
-double **FitLED::moveled(vector<double> p) {
-
-    double psi = p[3];
-    double theta = p[4];
-    double phi = p[5];
-    double rot[3][3] = {{cos(theta) * cos(phi),
-                                sin(psi) * sin(theta) * cos(phi) - cos(psi) * sin(phi),
-                                cos(psi) * sin(theta) * cos(phi) + sin(psi) * sin(phi)},
-                        {cos(theta) * sin(phi),
-                                sin(psi) * sin(theta) * sin(phi) + cos(psi) * cos(phi),
-                                cos(psi) * sin(theta) * sin(phi) - sin(psi) * cos(phi)},
-                        {-1.0 * sin(theta),
-                                sin(psi) * cos(theta),
-                                cos(psi) * cos(theta)}};
-
-    double w[ledsin->NLED][3]; // store the rotated spatial guess
+void FitLED::moveled(const double p[NSPACEPARAM], double J[MAXLED][2][NSPACEPARAM]) {
+
+    double cps = cos(p[3]), sps = sin(p[3]); // psi
+    double cth = cos(p[4]), sth = sin(p[4]); // theta
+    double cph = cos(p[5]), sph = sin(p[5]); // phi
+    double rot[3][3] = {{cth * cph, sps * sth * cph - cps * sph, cps * sth * cph + sps * sph},
+                        {cth * sph, sps * sth * sph + cps * cph, cps * sth * sph - sps * cph},
+                        {-1.0 * sth, sps * cth, cps * cth}};
+    // derivatives of the rotation w.r.t. psi, theta, phi
+    double drot[3][3][3] = {{{0, cps * sth * cph + sps * sph, -sps * sth * cph + cps * sph},
+                                    {0, cps * sth * sph - sps * cph, -sps * sth * sph - cps * cph},
+                                    {0, cps * cth, -sps * cth}},
+                            {{-sth * cph, sps * cth * cph, cps * cth * cph},
+                                    {-sth * sph, sps * cth * sph, cps * cth * sph},
+                                    {-cth, -sps * sth, -cps * sth}},
+                            {{-cth * sph, -sps * sth * sph - cps * cph, -cps * sth * sph + sps * cph},
+                                    {cth * cph, sps * sth * cph - cps * sph, cps * sth * cph + sps * sph},
+                                    {0, 0, 0}}};
 
     for (int i = 0; i < ledsin->NLED; i++) {
-        for (int j = 0; j < 3; j++) {
-            //rotate and translate the original spatial coords to guess at the new position
-            w[i][j] = p[j] +
-                      (rot[j][0] * ledsin->LED[i][0] + rot[j][1] * ledsin->LED[i][1] + rot[j][2] * ledsin->LED[i][2]);
+        if (!ledsout->LEDSPRESENT[i])
+            continue;
+        const double *led = ledsin->LED[i];
+
+        //rotate and translate the original spatial coords to guess at the new position
+        double w[3];
+        for (int j = 0; j < 3; j++)
+            w[j] = p[j] + rot[j][0] * led[0] + rot[j][1] * led[1] + rot[j][2] * led[2];
+
+        // output the coordinates as LED positions
+        ledsbuilt[i][0] = w[0] / w[2] * ipixscale;
+        ledsbuilt[i][1] = w[1] / w[2] * ipixscale;
+
+        if (J == nullptr)
+            continue;
+        // d(w_k/w_z) = (dw_k * w_z - w_k * dw_z) / w_z^2
+        double iz = ipixscale / w[2], iz2 = ipixscale / (w[2] * w[2]);
+        J[i][0][0] = iz;
+        J[i][0][1] = 0;
+        J[i][0][2] = -w[0] * iz2;
+        J[i][1][0] = 0;
+        J[i][1][1] = iz;
+        J[i][1][2] = -w[1] * iz2;
+        for (int a = 0; a < 3; a++) {
+            double dw[3];
+            for (int j = 0; j < 3; j++)
+                dw[j] = drot[a][j][0] * led[0] + drot[a][j][1] * led[1] + drot[a][j][2] * led[2];
+            J[i][0][3 + a] = dw[0] * iz - w[0] * dw[2] * iz2;
+            J[i][1][3 + a] = dw[1] * iz - w[1] * dw[2] * iz2;
         }
     }
+}
 
-    // initialize 2d array to store the new led positions
-    double **c = new double *[ledsin->NLED];
+double FitLED::offset(const double x[NSPACEPARAM]) {
+    moveled(x);
+    double offset = 0.0;
     for (int i = 0; i < ledsin->NLED; i++) {
-        c[i] = new double[2];
+        if (ledsout->LEDSPRESENT[i]) offset += pow(ledsfound[i][0] - ledsbuilt[i][0], 2) +
+                                               pow(ledsfound[i][1] - ledsbuilt[i][1], 2);
     }
+    return offset;
+}
 
-    // output the coordinates as LED positions
-    for (int i = 0; i < ledsin->NLED; i++) {
-        if (ledsout->LEDSPRESENT[i]) {
-            c[i][0] = w[i][0] / w[i][2] * ipixscale;
-            c[i][1] = w[i][1] / w[i][2] * ipixscale;
+double FitLED::fit(double x[NSPACEPARAM]) {
+    double J[MAXLED][2][NSPACEPARAM];
+    double lambda = 1e-3;
+    double f = offset(x);
+    fitConverged = false;
+
+    for (int iter = 0; iter < MAX_ITERATIONS; iter++) {
+        // normal equations J^T J dx = J^T r
+        moveled(x, J);
+        double A[NSPACEPARAM][NSPACEPARAM] = {{0}};
+        double g[NSPACEPARAM] = {0};
+        for (int i = 0; i < ledsin->NLED; i++) {
+            if (!ledsout->LEDSPRESENT[i])
+                continue;
+            for (int k = 0; k < 2; k++) {
+                double r = ledsfound[i][k] - ledsbuilt[i][k];
+                for (int a = 0; a < NSPACEPARAM; a++) {
+                    g[a] += J[i][k][a] * r;
+                    for (int b = 0; b <= a; b++)
+                        A[a][b] += J[i][k][a] * J[i][k][b];
+                }
+            }
         }
-    }
 
-    return c;
-}
-
-double f_ledfit(const std::vector<double> &x, std::vector<double> &grad, void *f_data) {
+        // damp until a step lowers the offset
+        bool improved = false;
+        double step[NSPACEPARAM], xnew[NSPACEPARAM], fnew = f;
+        while (lambda < 1e10) {
+            // Cholesky solve of (A + lambda diag(A)) step = g, A symmetric positive (semi)definite
+            double L[NSPACEPARAM][NSPACEPARAM] = {{0}};
+            bool ok = true;
+            for (int a = 0; a < NSPACEPARAM && ok; a++) {
+                for (int b = 0; b <= a; b++) {
+                    double s = A[a][b] + (a == b ? lambda * (A[a][a] + 1e-12) : 0.0);
+                    for (int c = 0; c < b; c++)
+                        s -= L[a][c] * L[b][c];
+                    if (a == b) {
+                        if (s <= 0) {
+                            ok = false;
+                            break;
+                        }
+                        L[a][a] = sqrt(s);
+                    } else {
+                        L[a][b] = s / L[b][b];
+                    }
+                }
+            }
+            if (!ok) {
+                lambda *= 10;
+                continue;
+            }
+            double z[NSPACEPARAM];
+            for (int a = 0; a < NSPACEPARAM; a++) {
+                double s = g[a];
+                for (int c = 0; c < a; c++)
+                    s -= L[a][c] * z[c];
+                z[a] = s / L[a][a];
+            }
+            for (int a = NSPACEPARAM - 1; a >= 0; a--) {
+                double s = z[a];
+                for (int c = a + 1; c < NSPACEPARAM; c++)
+                    s -= L[c][a] * step[c];
+                step[a] = s / L[a][a];
+            }
+
+            // keep within the bounds of the panel position
+            for (int a = 0; a < NSPACEPARAM; a++)
+                xnew[a] = max(ledsin->LEDLB[a], min(ledsin->LEDUB[a], x[a] + step[a]));
+            fnew = offset(xnew);
+            if (fnew < f) {
+                improved = true;
+                lambda = max(lambda / 10, 1e-12);
+                break;
+            }
+            lambda *= 10;
+        }
+        if (!improved) {
+            // no step lowers the offset: at the minimum (to within numerical precision)
+            fitConverged = true;
+            break;
+        }
 
-    FitLED *thetest = (FitLED *) f_data;
-    double **y = thetest->moveled(x);
-    double **ledsf = thetest->getledsfound();
-    double offset = 0.0;
-    for (int i = 0; i < thetest->getLEDinputs()->NLED; i++) {
-        if (thetest->getLEDoutputs()->LEDSPRESENT[i]) offset += pow(ledsf[i][0] - y[i][0], 2) +
-                                                                pow(ledsf[i][1] - y[i][1], 2);
+        double change = 0.0;
+        for (int a = 0; a < NSPACEPARAM; a++) {
+            change = max(change, fabs(xnew[a] - x[a]) / max(fabs(x[a]), 1.0));
+            x[a] = xnew[a];
+        }
+        double df = f - fnew;
+        f = fnew;
+        if (change < 1e-10 || df < 1e-12 * (f + 1e-12)) {
+            fitConverged = true;
+            break;
+        }
     }
-    return offset;
 
+    moveled(x);
+    return f;
+}
+
+int FitLED::npresent() const {
+    int n = 0;
+    for (int i = 0; i < ledsin->NLED; i++)
+        n += ledsout->LEDSPRESENT[i];
+    return n;
 }
@@ -1,36 +1,41 @@
 #include "common/globalalignment/ccd/LEDoutputs.h"
-#include <nlopt.hpp>
 #include <iostream>
 
 //spdlog
 #include "common/utilities/spdlog/spdlog.h"
 #include "common/utilities/spdlog/fmt/ostr.h"
 
-// universal scope objective function for the optimization of LED detection
-double f_ledfit(const std::vector<double> &x, std::vector<double> &grad, void *f_data);
-
+// Solid body fit of the panel position (x, y, z, xrot, yrot, zrot) to the detected LED positions.
+// Levenberg-Marquardt on the analytic Jacobian of the LED projection, on fixed-size buffers.
 class FitLED {
 public:
-    FitLED(LEDoutputs *lo);
+    static const int NSPACEPARAM = 6;
+    static const int MAXLED = 8; // size of the LED arrays in LEDinputs/LEDoutputs
+
+    // pstart: solution of the previous frame to warm-start from, nullptr to start from the nominal panel position
+    FitLED(LEDoutputs *lo, const double *pstart = nullptr);
 
     const LEDinputs *getLEDinputs() { return ledsin; }
 
     LEDoutputs *getLEDoutputs() { return ledsout; }
 
-    double **moveled(std::vector<double> p);
+    // project the LEDs for the panel position p into ledsbuilt (CCD pixels, relative to the center);
+    // if J is given, also fill in the derivatives of each projected coordinate w.r.t. p
+    void moveled(const double p[NSPACEPARAM], double J[MAXLED][2][NSPACEPARAM] = nullptr);
+
+    const double (*getledsbuilt())[2] { return ledsbuilt; }
 
-    double **getledsbuilt() { return ledsbuilt; }
+    const double (*getledsfound())[2] { return ledsfound; }
 
-    double **getledsfound() { return ledsfound; }
+    bool converged() const { return fitConverged; }
 
 private:
-    std::vector<double> pinit;
     const LEDinputs *ledsin;
     LEDoutputs *ledsout;
-    double **ledsbuilt;
-    double **ledsfound;
+    double ledsbuilt[MAXLED][2];
+    double ledsfound[MAXLED][2];
+    bool fitConverged;
     const double PI = 3.141592653589793238463;
-    const int NSPACEPARAM = 6;
     // camera plate scale
     // pixscale = 2.2E-6/12.5E-3 # radians/pixel 12.5 mm lens
     // default values to be overwritten during constructor
@@ -39,4 +44,14 @@ private:
     double cx0 = 2592.0 / 2.0; // camera center pixel in x
     double cy0 = 1944.0 / 2.0; // camera center pixel in y
 
+    static const int MAX_ITERATIONS;
+    static const double MAX_WARM_RESIDUAL; // rms px; a warm start worse than this is redone from the nominal position
+
+    // sum of squared offsets between found and projected LEDs at x
+    double offset(const double x[NSPACEPARAM]);
+
+    // fit starting from x, leaving the result in x. Returns the final offset.
+    double fit(double x[NSPACEPARAM]);
+
+    int npresent() const;
 };
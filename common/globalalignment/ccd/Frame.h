@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/*
+ * A camera frame that shares, rather than owns a copy of, the buffer it was captured into.
+ *
+ * Copies of a Frame (and Images made from it) all point at the same pixels. The buffer is released --
+ * for Aravis frames, pushed back into the camera stream -- when the last of them goes away.
+ * Note that the stream only has a fixed number of buffers, so frames should not be held on to for long.
+ */
+class Frame {
+public:
+    Frame() : fSize(0) {}
+
+    Frame(std::shared_ptr<unsigned char> data, size_t size) : fData(std::move(data)), fSize(size) {}
+
+    bool empty() const { return !fData || fSize == 0; }
+
+    size_t size() const { return fSize; }
+
+    unsigned char *data() const { return fData.get(); }
+
+    const std::shared_ptr<unsigned char> &buffer() const { return fData; }
+
+private:
+    std::shared_ptr<unsigned char> fData;
+    size_t fSize;
+};
@@ -1,35 +1,107 @@
 #include "common/globalalignment/ccd/Image.h"
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 using namespace std;
 
+namespace
+{
+    // Copies of the pixels handed to the image sink. A writer must not hold on to the frame itself, which may be a
+    // camera stream buffer, so the pixels are copied into a pooled buffer that goes back to the pool once written.
+    // The sink holds at most its queue plus the image being written.
+    struct BufferPool {
+        mutex poolMutex;
+        vector<unsigned char *> buffers; // free buffers of bufferSize bytes
+        size_t bufferSize = 0;
+    };
+
+    // never destroyed, as the image sinks may still release buffers at exit
+    BufferPool &bufferPool() {
+        static BufferPool *pool = new BufferPool;
+        return *pool;
+    }
+
+    shared_ptr<unsigned char> copyPixels(const unsigned char *pixels, size_t size) {
+        BufferPool &pool = bufferPool();
+        unsigned char *buffer = nullptr;
+        {
+            lock_guard<mutex> lock(pool.poolMutex);
+            if (size != pool.bufferSize) {
+                for (unsigned char *p : pool.buffers)
+                    delete[] p;
+                pool.buffers.clear();
+                pool.bufferSize = size;
+            }
+            if (!pool.buffers.empty()) {
+                buffer = pool.buffers.back();
+                pool.buffers.pop_back();
+            }
+        }
+        if (!buffer)
+            buffer = new unsigned char[size];
+        copy(pixels, pixels + size, buffer);
+        return shared_ptr<unsigned char>(buffer, [&pool, size](unsigned char *p) {
+            lock_guard<mutex> lock(pool.poolMutex);
+            if (size == pool.bufferSize && pool.buffers.size() <= ImageSink::DEFAULT_QUEUE_CAPACITY)
+                pool.buffers.push_back(p);
+            else
+                delete[] p;
+        });
+    }
+}
+
 // Constructor
 Image::Image(unsigned char *frame) : imgWidth(2592), imgHeight(1944) {
     spdlog::trace("New Image from constructor");
-    pixel_array = new unsigned char[imgWidth * imgHeight];
-    for (int i = 0; i < imgWidth * imgHeight; i++)
-        pixel_array[i] = frame[i];
+    pixel_array = shared_ptr<unsigned char>(new unsigned char[imgWidth * imgHeight], default_delete<unsigned char[]>());
+    copy(frame, frame + imgWidth * imgHeight, pixel_array.get());
 }
 
-Image::Image(std::vector<unsigned char> frame) : imgWidth(2592), imgHeight(1944) {
-    spdlog::trace("New Image from constructor");
-    pixel_array = new unsigned char[imgWidth * imgHeight];
-    for (int i = 0; i < imgWidth * imgHeight; i++)
-        pixel_array[i] = frame[i];
+Image::Image(std::vector<unsigned char> frame) : Image(frame.data()) {
 }
 
-void Image::saveRawImage(const char strTime[16]) {
-    string fileName = fImageDir + strTime;
-    fileName += ".raw";
+Image::Image(const Frame &frame) : Image() {
+    spdlog::trace("New Image from frame");
+    const int width = 2592, height = 1944;
+    if (frame.size() < (size_t) (width * height)) {
+        // reading a full image out of it would run past the buffer -- leave the image empty
+        spdlog::error("Image: frame of {} bytes is smaller than {}x{}, discarding it", frame.size(), width, height);
+        return;
+    }
+    pixel_array = frame.buffer();
+    imgWidth = width;
+    imgHeight = height;
+}
 
-    // just dump the pixel array into file
-    ofstream rawdump(fileName.c_str(), ofstream::out);
-    for (int i = 0; i < imgWidth * imgHeight; i++)
-        rawdump << pixel_array[i];
+Image Image::clone() const {
+    Image copyImage;
+    copyImage.imgWidth = imgWidth;
+    copyImage.imgHeight = imgHeight;
+    if (pixel_array) {
+        copyImage.pixel_array = shared_ptr<unsigned char>(new unsigned char[imgWidth * imgHeight],
+                                                          default_delete<unsigned char[]>());
+        copy(pixel_array.get(), pixel_array.get() + imgWidth * imgHeight, copyImage.pixel_array.get());
+    }
+    return copyImage;
+}
 
-    rawdump.close();
+void Image::saveRawImage(const char strTime[16]) {
+    string fileName = strTime;
+    fileName += ".raw";
 
+    // just dump the pixel array into file -- in the background, from a copy of the pixels
+    if (!pixel_array)
+        return;
+    size_t npix = imgWidth * imgHeight;
+    shared_ptr<unsigned char> pixels = copyPixels(pixel_array.get(), npix);
+    imageSink()->submit(fileName, [pixels, npix](const string &path, int) {
+        ofstream rawdump(path.c_str(), ofstream::out | ofstream::binary);
+        rawdump.write(reinterpret_cast<const char *>(pixels.get()), npix);
+        return rawdump.good();
+    }, "raw");
 }
 
 void Image::saveFITSImage() {
@@ -38,34 +110,12 @@ void Image::saveFITSImage() {
     struct tm *theTime = gmtime(&t);
     char strTime[16];
     strftime(strTime, 16, "%Y%m%d%H%M%S", theTime);
-    string fileName = fImageDir + strTime;
+    string fileName = strTime;
     fileName += ".fits";
     //save image for diagnostics
-    // use auto-pointer for automatic garbage collection
-    unique_ptr<CCfits::FITS> pFits(nullptr);
-
-    // attempt to create a FITS file
-    try {
-        long naxes[2] = {imgWidth, imgHeight};
-        pFits.reset(new CCfits::FITS(fileName, BYTE_IMG, 2, naxes));
-    } catch (CCfits::FITS::CantCreate) {
-        spdlog::warn("Error saving FITS image! A FITS file could not be opened for writing.");
-        return;
-    }
-
-    valarray<unsigned char> *rawImage;
-    rawImage = new valarray<unsigned char>(imgWidth * imgHeight);
-    //pFits->pHDU().addKey("OBSDATE", strTime, "date and time when image was taken (UTC)");
-    for (int i = 0; i < imgWidth * imgHeight; i++) {
-        (*rawImage)[i] = pixel_array[i];
-    }
-
-
-    pFits->pHDU().addKey("INFORMATION", 0, "No information provided");
-    pFits->pHDU().write(1, imgWidth * imgHeight, *rawImage);
-
-    delete rawImage;
-
+    submitFITSImage(fileName, [](CCfits::PHDU &hdu) {
+        hdu.addKey("INFORMATION", 0, "No information provided");
+    }, "raw");
 }
 
 /*
@@ -114,42 +164,25 @@ void Image::saveFITSImage(const LEDinputs* li) {
 */
 void Image::saveFITSImage(const LEDinputs *li, const char strTime[16]) {
 
-    string fileName = fImageDir + strTime;
+    string fileName = strTime;
     fileName += "_" + li->CCDNAME + "_raw.fits";
     //save image for diagnostics
-    // use auto-pointer for automatic garbage collection
-    unique_ptr<CCfits::FITS> pFits(nullptr);
-
-    // attempt to create a FITS file
-    try {
-        long naxes[2] = {imgWidth, imgHeight};
-        pFits.reset(new CCfits::FITS(fileName, BYTE_IMG, 2, naxes));
-    } catch (CCfits::FITS::CantCreate) {
-        spdlog::warn("Error saving FITS image! A FITS file could not be opened for writing.");
-        return;
-    }
-
-    valarray<unsigned char> *rawImage;
-    rawImage = new valarray<unsigned char>(imgWidth * imgHeight);
-    //pFits->pHDU().addKey("OBSDATE", strTime, "date and time when image was taken (UTC)");
-    for (int i = 0; i < imgWidth * imgHeight; i++) {
-        (*rawImage)[i] = pixel_array[i];
-    }
-
-    pFits->pHDU().addKey("DATETIME", std::string(strTime), "YYYYMMDDHHMMSS(.)ss");
-    pFits->pHDU().addKey("CCDNAME", li->CCDNAME, "The common name of the CCD");
-    pFits->pHDU().addKey("CCDEXP", li->CCDEXP, "CCD Exposure (us)");
-    pFits->pHDU().addKey("CCDGAIN", li->CCDGAIN, "CCD Gain");
-    pFits->pHDU().addKey("PIXSIZE", li->PIXSIZE, "Pixel size of the CCD (m)");
-    pFits->pHDU().addKey("CCDSN", li->CCDSN, "Serial Number of the CCD");
-    pFits->pHDU().addKey("LENSFL", li->LENSFL, "Uncorrected Focal Length (m)");
-    pFits->pHDU().addKey("LENSSCALE", li->LENSSCALE, "Correction to focal length");
-    pFits->pHDU().addKey("LENSSN", li->LENSSN, "Serial Number of the Lens used");
-    pFits->pHDU().addKey("NLED", li->NLED, "Number of LEDs expected");
-    pFits->pHDU().addKey("ANALYSIS", "0", "Was the analysis completed?");
-    pFits->pHDU().write(1, imgWidth * imgHeight, *rawImage);
-
-    delete rawImage;
+    // the header is written later, so take a copy of the inputs
+    LEDinputs inputs = *li;
+    string dateTime(strTime);
+    submitFITSImage(fileName, [inputs, dateTime](CCfits::PHDU &hdu) {
+        hdu.addKey("DATETIME", dateTime, "YYYYMMDDHHMMSS(.)ss");
+        hdu.addKey("CCDNAME", inputs.CCDNAME, "The common name of the CCD");
+        hdu.addKey("CCDEXP", inputs.CCDEXP, "CCD Exposure (us)");
+        hdu.addKey("CCDGAIN", inputs.CCDGAIN, "CCD Gain");
+        hdu.addKey("PIXSIZE", inputs.PIXSIZE, "Pixel size of the CCD (m)");
+        hdu.addKey("CCDSN", inputs.CCDSN, "Serial Number of the CCD");
+        hdu.addKey("LENSFL", inputs.LENSFL, "Uncorrected Focal Length (m)");
+        hdu.addKey("LENSSCALE", inputs.LENSSCALE, "Correction to focal length");
+        hdu.addKey("LENSSN", inputs.LENSSN, "Serial Number of the Lens used");
+        hdu.addKey("NLED", inputs.NLED, "Number of LEDs expected");
+        hdu.addKey("ANALYSIS", "0", "Was the analysis completed?");
+    }, inputs.CCDNAME);
 }
 
 void Image::savefilteredFITSImage() {
@@ -158,105 +191,83 @@ void Image::savefilteredFITSImage() {
     struct tm *theTime = gmtime(&t);
     char strTime[16];
     strftime(strTime, 16, "%Y%m%d%H%M%S", theTime);
-    string fileName = fImageDir + strTime;
+    string fileName = strTime;
     fileName += "_filtered.fits";
     //save image for diagnostics
-    // use auto-pointer for automatic garbage collection
-    unique_ptr<CCfits::FITS> pFits(nullptr);
-
-    // attempt to create a FITS file
-    try {
-        long naxes[2] = {imgWidth, imgHeight};
-        pFits.reset(new CCfits::FITS(fileName, BYTE_IMG, 2, naxes));
-    } catch (CCfits::FITS::CantCreate) {
-        spdlog::warn("Error saving FITS image! A FITS file could not be opened for writing.");
-        return;
-    }
-
-    valarray<unsigned char> *rawImage;
-    rawImage = new valarray<unsigned char>(imgWidth * imgHeight);
-    //pFits->pHDU().addKey("OBSDATE", strTime, "date and time when image was taken (UTC)");
-    for (int i = 0; i < imgWidth * imgHeight; i++) {
-        (*rawImage)[i] = pixel_array[i];
-    }
-
-    pFits->pHDU().addKey("INFORMATION", 0, "No information provided");
-    pFits->pHDU().write(1, imgWidth * imgHeight, *rawImage);
-
-    delete rawImage;
+    submitFITSImage(fileName, [](CCfits::PHDU &hdu) {
+        hdu.addKey("INFORMATION", 0, "No information provided");
+    }, "filtered");
 }
 
 void Image::savefilteredFITSImage(const LEDoutputs *lo, const char strTime[16]) {
 
-    string fileName = fImageDir + strTime;
+    string fileName = strTime;
     fileName += "_" + lo->inleds->CCDNAME + "_filtered.fits";
     //save image for diagnostics
-    // use auto-pointer for automatic garbage collection
-    unique_ptr<CCfits::FITS> pFits(nullptr);
-
-    // attempt to create a FITS file
-    try {
-        long naxes[2] = {imgWidth, imgHeight};
-        pFits.reset(new CCfits::FITS(fileName, BYTE_IMG, 2, naxes));
-    } catch (CCfits::FITS::CantCreate) {
-        spdlog::warn("Error saving FITS image! A FITS file could not be opened for writing.");
-        return;
-    }
-
-    valarray<unsigned char> *rawImage;
-    rawImage = new valarray<unsigned char>(imgWidth * imgHeight);
-    //pFits->pHDU().addKey("OBSDATE", strTime, "date and time when image was taken (UTC)");
-    for (int i = 0; i < imgWidth * imgHeight; i++) {
-        (*rawImage)[i] = pixel_array[i];
-    }
-
-
-    pFits->pHDU().addKey("DATETIME", std::string(strTime), "YYYYMMDDHHMMSS(.)ss");
-    pFits->pHDU().addKey("CCDNAME", lo->inleds->CCDNAME, "The common name of the CCD");
-    pFits->pHDU().addKey("CCDEXP", lo->inleds->CCDEXP, "CCD Exposure (us)");
-    pFits->pHDU().addKey("CCDGAIN", lo->inleds->CCDGAIN, "CCD Gain");
-    pFits->pHDU().addKey("PIXSIZE", lo->inleds->PIXSIZE, "Pixel size of the CCD (m)");
-    pFits->pHDU().addKey("CCDSN", lo->inleds->CCDSN, "Serial Number of the CCD");
-    pFits->pHDU().addKey("LENSFL", lo->inleds->LENSFL, "Uncorrected Focal Length (m)");
-    pFits->pHDU().addKey("LENSSCALE", lo->inleds->LENSSCALE, "Correction to focal length");
-    pFits->pHDU().addKey("LENSSN", lo->inleds->LENSSN, "Serial Number of the Lens used");
-    pFits->pHDU().addKey("NLED", lo->inleds->NLED, "Number of LEDs expected");
-    pFits->pHDU().addKey("ANALYSIS", 1, "What stage of the analysis was completed?");
-    pFits->pHDU().addKey("LEDSCOUNT", lo->LEDSCOUNT, "How many LEDs were found");
-    for (int i = 0; i < lo->inleds->NLED; i++) {
-        if (lo->LEDSPRESENT[i]) {
-            pFits->pHDU().addKey("LEDPOS" + to_string(i) + "X", lo->LEDPOS[i][0],
-                                 "X Pixel location of LED " + to_string(i));
-            pFits->pHDU().addKey("LEDPOS" + to_string(i) + "Y", lo->LEDPOS[i][1],
-                                 "Y Pixel location of LED " + to_string(i));
+    // the header is written later, so take a copy of the inputs and outputs
+    LEDinputs inputs = *lo->inleds;
+    LEDoutputs outputs = *lo;
+    string dateTime(strTime);
+    submitFITSImage(fileName, [inputs, outputs, dateTime](CCfits::PHDU &hdu) {
+        hdu.addKey("DATETIME", dateTime, "YYYYMMDDHHMMSS(.)ss");
+        hdu.addKey("CCDNAME", inputs.CCDNAME, "The common name of the CCD");
+        hdu.addKey("CCDEXP", inputs.CCDEXP, "CCD Exposure (us)");
+        hdu.addKey("CCDGAIN", inputs.CCDGAIN, "CCD Gain");
+        hdu.addKey("PIXSIZE", inputs.PIXSIZE, "Pixel size of the CCD (m)");
+        hdu.addKey("CCDSN", inputs.CCDSN, "Serial Number of the CCD");
+        hdu.addKey("LENSFL", inputs.LENSFL, "Uncorrected Focal Length (m)");
+        hdu.addKey("LENSSCALE", inputs.LENSSCALE, "Correction to focal length");
+        hdu.addKey("LENSSN", inputs.LENSSN, "Serial Number of the Lens used");
+        hdu.addKey("NLED", inputs.NLED, "Number of LEDs expected");
+        hdu.addKey("ANALYSIS", 1, "What stage of the analysis was completed?");
+        hdu.addKey("LEDSCOUNT", outputs.LEDSCOUNT, "How many LEDs were found");
+        for (int i = 0; i < inputs.NLED; i++) {
+            if (outputs.LEDSPRESENT[i]) {
+                hdu.addKey("LEDPOS" + to_string(i) + "X", outputs.LEDPOS[i][0],
+                           "X Pixel location of LED " + to_string(i));
+                hdu.addKey("LEDPOS" + to_string(i) + "Y", outputs.LEDPOS[i][1],
+                           "Y Pixel location of LED " + to_string(i));
+            }
         }
-    }
-    pFits->pHDU().addKey("POS0", lo->SPACE[0], "X translation of panel");
-    pFits->pHDU().addKey("POS1", lo->SPACE[1], "Y translation of panel");
-    pFits->pHDU().addKey("POS2", lo->SPACE[2], "Z translation of panel");
-    pFits->pHDU().addKey("ROT0", lo->SPACE[3], "X-axis rotation of panel");
-    pFits->pHDU().addKey("ROT1", lo->SPACE[4], "Y-axis rotation of panel");
-    pFits->pHDU().addKey("ROT2", lo->SPACE[5], "Z-axis rotation of panel");
-    pFits->pHDU().write(1, imgWidth * imgHeight, *rawImage);
-
-    delete rawImage;
+        hdu.addKey("POS0", outputs.SPACE[0], "X translation of panel");
+        hdu.addKey("POS1", outputs.SPACE[1], "Y translation of panel");
+        hdu.addKey("POS2", outputs.SPACE[2], "Z translation of panel");
+        hdu.addKey("ROT0", outputs.SPACE[3], "X-axis rotation of panel");
+        hdu.addKey("ROT1", outputs.SPACE[4], "Y-axis rotation of panel");
+        hdu.addKey("ROT2", outputs.SPACE[5], "Z-axis rotation of panel");
+    }, inputs.CCDNAME);
 }
 
-Image::~Image() {
-    delete[] pixel_array;
-    pixel_array = nullptr;
-    spdlog::trace("pixel_array destroyed");
+shared_ptr<ImageSink> Image::imageSink() const {
+    return ImageSink::forDirectory(fImageDir);
 }
 
-Image::Image(const Image& that):imgWidth(2592), imgHeight(1944){
-    spdlog::trace("New Image from copy");
-    pixel_array = that.pixel_array;
-}
+void Image::submitFITSImage(string fileName, function<void(CCfits::PHDU &)> addKeys, const string &tag) {
+    shared_ptr<ImageSink> sink = imageSink();
+    // cfitsio gzips the file on close when the name ends in .gz
+    if (sink->getCompressionLevel() > 0)
+        fileName += ".gz";
 
-Image& Image::operator =(const Image& that){
-    spdlog::trace("New Image from assignment");
-    if(this != &that){
-        this->pixel_array = that.pixel_array;
-    }
-    return * this;
-}
\ No newline at end of file
+    if (!pixel_array)
+        return;
+    long width = imgWidth, height = imgHeight;
+    shared_ptr<unsigned char> pixels = copyPixels(pixel_array.get(), width * height);
+    sink->submit(fileName, [pixels, width, height, addKeys](const string &path, int) {
+        // use auto-pointer for automatic garbage collection
+        unique_ptr<CCfits::FITS> pFits(nullptr);
+
+        // attempt to create a FITS file
+        try {
+            long naxes[2] = {width, height};
+            pFits.reset(new CCfits::FITS(path, BYTE_IMG, 2, naxes));
+        } catch (CCfits::FITS::CantCreate) {
+            spdlog::warn("Error saving FITS image! A FITS file could not be opened for writing.");
+            return false;
+        }
+
+        valarray<unsigned char> rawImage(pixels.get(), width * height);
+        addKeys(pFits->pHDU());
+        pFits->pHDU().write(1, width * height, rawImage);
+        return true;
+    }, tag);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <vector>
 #include <CCfits/PHDU.h>
 #include <CCfits/FITSUtilT.h>
@@ -9,6 +11,8 @@
 #include <time.h>
 #include "common/globalalignment/ccd/LEDinputs.h"
 #include "common/globalalignment/ccd/LEDoutputs.h"
+#include "common/globalalignment/ccd/Frame.h"
+#include "common/utilities/imagesink.hpp"
 
 //spdlog
 #include "common/utilities/spdlog/spdlog.h"
@@ -23,6 +27,11 @@ public:
 
     Image(std::vector<unsigned char>);
 
+    // shares the frame's buffer, no copy. A frame smaller than a full image leaves the image empty().
+    Image(const Frame &frame);
+
+    // saves are written in the background from the image's own buffer: clone() first if the pixels
+    // are going to be modified before the write has happened
     void saveRawImage(const char strTime[16]);
 
     void saveFITSImage();
@@ -33,21 +42,32 @@ public:
 
     void savefilteredFITSImage(const LEDoutputs *lo, const char strTime[16]);
 
-    ~Image();
+    ~Image() = default;
+
+    // copies share the pixels
+    Image(const Image& that) = default;
 
-    Image(const Image& that);
+    Image &operator=(const Image& that) = default;
 
-    Image &operator=(const Image& that);
+    // deep copy
+    Image clone() const;
 
     // Accessor methods
     int width() { return imgWidth; }
 
     int height() { return imgHeight; }
 
-    unsigned char *pixels() { return pixel_array; }
+    unsigned char *pixels() { return pixel_array.get(); }
+
+    bool empty() const { return !pixel_array; }
 
 private:
-    unsigned char *pixel_array;
+    std::shared_ptr<unsigned char> pixel_array;
     int imgWidth, imgHeight;
     std::string fImageDir = "/home/ctauser/Pictures/GAS_CCD/";
+
+    // images are written in the background by the sink for fImageDir
+    std::shared_ptr<ImageSink> imageSink() const;
+
+    void submitFITSImage(std::string fileName, std::function<void(CCfits::PHDU &)> addKeys, const std::string &tag);
 };
@@ -43,26 +43,16 @@ long double ImageStar::angular_sep(ImageStar *other) {
 }
 
 void ImageStar::add_pixel(int px, int py, int pmag) {
-    StarPixels.push_back({px, -py, pmag});
+    StarMoments.add_pixel(px, py, pmag);
 }
 
 double ImageStar::total_flux() {
-    int flux = 0;
-    for (unsigned int i = 0; i < StarPixels.size(); i++)
-        flux += StarPixels[i][2];
-    return flux;
+    return StarMoments.flux;
 }
 
 void ImageStar::centroid() {
-    double weight, flux_norm = 0.0;
-    for (unsigned int i = 0; i < StarPixels.size(); i++)
-        flux_norm += StarPixels[i][2];
-
-    for (unsigned int i = 0; i < StarPixels.size(); i++) {
-        weight = StarPixels[i][2] / flux_norm;
-        PixelX += weight * StarPixels[i][0];
-        PixelY += weight * StarPixels[i][1];
-    }
+    PixelX = StarMoments.fx / StarMoments.flux;
+    PixelY = StarMoments.fy / StarMoments.flux;
 
     double x = PixelX - xImageCenter;
     double y = PixelY + yImageCenter;
@@ -80,17 +70,12 @@ void ImageStar::centroid() {
 
 double ImageStar::ellipticity() {
     // compute moment of inertia tensor [[yy, -xy], [-xy, xx]]
-    double xx = 0.0, yy = 0.0, xy = 0.0;
-    for (unsigned int i = 0; i < StarPixels.size(); i++) {
-        double dx = StarPixels[i][0] - PixelX;
-        double dy = StarPixels[i][1] - PixelY;
-        xx += dx * dx;
-        yy += dy * dy;
-        xy += dx * dy;
-    }
-    xx /= (double) StarPixels.size();
-    yy /= (double) StarPixels.size();
-    xy /= -(double) StarPixels.size();
+    // from the pixel sums: <(x - X)^2> = <x^2> - 2 X <x> + X^2 etc.
+    const ImageStar::Moments &m = StarMoments;
+    double n = (double) m.npix;
+    double xx = m.sxx / n - 2.0 * PixelX * m.sx / n + PixelX * PixelX;
+    double yy = m.syy / n - 2.0 * PixelY * m.sy / n + PixelY * PixelY;
+    double xy = -(m.sxy / n - PixelX * m.sy / n - PixelY * m.sx / n + PixelX * PixelY);
 
     // Find eigenvalues
     double trace = xx + yy;
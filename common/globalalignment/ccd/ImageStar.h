@@ -16,6 +16,42 @@ using std::vector;
 
 class ImageStar {
 public:
+    // Running sums over the pixels of a star, enough for its centroid and second moments.
+    // Sums are additive, so the moments of a star can be built up from pieces and merged.
+    struct Moments {
+        Moments() : npix(0), flux(0), fx(0), fy(0), sx(0), sy(0), sxx(0), syy(0), sxy(0) {}
+
+        // pixel at image coordinates px, py (origin upper-left); y is flipped as in PixelY
+        void add_pixel(int px, int py, int pmag) {
+            double x = px, y = -py;
+            npix++;
+            flux += pmag;
+            fx += pmag * x;
+            fy += pmag * y;
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            syy += y * y;
+            sxy += x * y;
+        }
+
+        void merge(const Moments &other) {
+            npix += other.npix;
+            flux += other.flux;
+            fx += other.fx;
+            fy += other.fy;
+            sx += other.sx;
+            sy += other.sy;
+            sxx += other.sxx;
+            syy += other.syy;
+            sxy += other.sxy;
+        }
+
+        long npix;
+        double flux, fx, fy;            // flux-weighted sums
+        double sx, sy, sxx, syy, sxy;   // unweighted sums
+    };
+
     // Constructor
     ImageStar(Image &image, const LEDinputs *li);
 
@@ -54,14 +90,15 @@ protected:
     // Methods used by StarDetect
     void add_pixel(int px, int py, int pmag);
 
+    void add_moments(const Moments &moments) { StarMoments.merge(moments); }
+
     void centroid();
 
     double ellipticity();
 
     double total_flux();
 
-    // Method used by GUI
-    vector<vector<int> > StarPixels;        // container with all pixels associated with star
+    Moments StarMoments;                    // sums over all pixels associated with star
 
 private:
     double PixelX, PixelY;                    // image coordinates
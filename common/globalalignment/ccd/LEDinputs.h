@@ -74,6 +74,7 @@ struct LEDinputs {
     bool VERBOSE = false;
     bool SAVEIMAGE = false;
     bool CAPTUREONLY = false;
+    bool STREAM = false; // free-running acquisition, each cycle returns the newest analysed frame
     std::string SAVEFORMAT = "fits";
 
     void printall(std::ofstream &fout) {
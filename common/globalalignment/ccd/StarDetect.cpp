@@ -1,8 +1,13 @@
 #include "common/globalalignment/ccd/StarDetect.h"
+#include <algorithm>
+#include <cstdint>
 #include <set>
+#include <thread>
 
 using namespace std;
 
+const int StarDetect::MIN_BAND_ROWS = 256;
+
 void StarDetect::process() {
     find_threshold();
     ed_filter();
@@ -13,55 +18,109 @@ void StarDetect::ed_filter() {
     // find sources in the image by finding isolated regions of pixels above
     // threshold via 'morphological opening', http://en.wikipedia.org/wiki/Opening_%28morphology%29
     // use a 3x3 square as the 'structuring element'
+    //
+    // erosion, dilation and the background erase are done in a single row-major sweep with rolling row
+    // buffers, instead of two full-size masks. The image is cut into bands of rows processed in parallel;
+    // each band erases its own rows in place, so the two raw rows on either side that it reads but
+    // doesn't own are copied out beforehand.
 
 //Save some local variables
     int nxpix = image.width();
     int nypix = image.height();
-    int npix = nxpix * nypix;
-    int t = threshold; // just to save on typing
-
-// perform morphological erosion on pixels above threshold
-// this removes small groups (less than 3x3) of hit pixels
-    vector<unsigned char> eimg(npix, 0); // eroded image, initial to False
-    for (int x = 1; x < nxpix; x++) { // loop over x coordinate, not including edges
-        for (int y = 1; y < nypix; y++) { // loop over y coordinate, not including edges
-            int i = x + y * nxpix; // location of element x, y of image
-            if ((image.pixels()[i] >= t) && (image.pixels()[i + 1] >= t) && (image.pixels()[i - 1] >= t) &&
-                (image.pixels()[i + nxpix] >= t) && (image.pixels()[i + 1 + nxpix] >= t) &&
-                (image.pixels()[i - 1 + nxpix] >= t) &&
-                (image.pixels()[i - nxpix] >= t) && (image.pixels()[i + 1 - nxpix] >= t) &&
-                (image.pixels()[i - 1 - nxpix] >= t))
-                eimg[i] = 1; // set to True
-        } // end y for loop
-    } // end x for loop
-
-// perform morphological dilation on eroded map
-// this puts back the pixels on the edges of surviving groups
-    spdlog::trace("npix: {}",npix);
-    vector<unsigned char> dimg(npix, 0); // eroded image, initial to False
-    spdlog::trace("dimg empty?: {}",dimg.empty());
-    for (int x = 1; x < nxpix; x++) { // loop over x coordinate, not including edges
-        for (int y = 1; y < nypix; y++) { // loop over y coordinate, not including edges
-            int i = x + y * nxpix; // location of element x, y of image
-            if (eimg[i] || eimg[i + 1] || eimg[i - 1] ||
-                eimg[i + nxpix] || eimg[i + 1 + nxpix] || eimg[i - 1 + nxpix] ||
-                eimg[i - nxpix] || eimg[i + 1 - nxpix] || eimg[i - 1 - nxpix])
-                dimg[i] = 1; // mark pixel as in a group
-        }
-    }
-    spdlog::trace("Finished dimg loop");
-
-//save just stars from the original image (set all non-saved pixels to 0)
-    for (int x = 0; x < nxpix; x++) { // loop over x coordinate, including edges
-        for (int y = 0; y < nypix; y++) { // loop over y coordinate, including edges
-            int i = x + y * nxpix; // location of element x, y of image
-            if (dimg[i] == 0)
-                image.pixels()[i] = 0; // erase background pixels
+    int nbands = __num_bands();
+    spdlog::trace("npix: {}, bands: {}", nxpix * nypix, nbands);
+
+    vector<int> bounds(nbands + 1);
+    for (int b = 0; b <= nbands; b++)
+        bounds[b] = (int) ((long) nypix * b / nbands);
+
+    vector<vector<unsigned char>> halos(nbands, vector<unsigned char>(4 * nxpix, 0));
+    for (int b = 0; b < nbands; b++) {
+        int rows[4] = {bounds[b] - 2, bounds[b] - 1, bounds[b + 1], bounds[b + 1] + 1};
+        for (int k = 0; k < 4; k++) {
+            if (rows[k] >= 0 && rows[k] < nypix)
+                copy(image.pixels() + (long) rows[k] * nxpix, image.pixels() + (long) (rows[k] + 1) * nxpix,
+                     halos[b].begin() + k * nxpix);
         }
     }
+
+    vector<thread> workers;
+    for (int b = 1; b < nbands; b++)
+        workers.emplace_back(&StarDetect::__filter_rows, this, bounds[b], bounds[b + 1], halos[b].data());
+    __filter_rows(bounds[0], bounds[1], halos[0].data());
+    for (thread &worker : workers)
+        worker.join();
+
     spdlog::trace("End ed_filter");
 } // end ed_filter()
 
+void StarDetect::__filter_rows(int y0, int y1, const unsigned char *halo) {
+    const int nxpix = image.width();
+    const int nypix = image.height();
+    const int t = threshold; // just to save on typing
+
+    // the loops below are plain byte loops over contiguous rows without branches, so they vectorize
+    vector<unsigned char> above(nxpix); // pixel >= threshold, for the row being read
+    vector<unsigned char> hrun(3 * nxpix, 0); // ring of 3 rows: pixel and both horizontal neighbours above threshold
+    vector<unsigned char> eroded(nxpix);
+    vector<unsigned char> grown(3 * nxpix, 0); // ring of 3 rows: eroded map dilated horizontally
+    vector<unsigned char> keep(nxpix);
+
+    // read raw rows y0-2 .. y1+1: row r completes the erosion of r-1, which completes the dilation of r-2
+    for (int r = y0 - 2; r < y1 + 2; r++) {
+        unsigned char *h = &hrun[((r + 3) % 3) * nxpix];
+        const unsigned char *row = nullptr;
+        if (r >= 0 && r < nypix)
+            row = (r < y0) ? halo + (r - y0 + 2) * nxpix : (r >= y1) ? halo + (r - y1 + 2) * nxpix
+                                                                      : image.pixels() + (long) r * nxpix;
+        if (row) {
+            for (int x = 0; x < nxpix; x++)
+                above[x] = row[x] >= t;
+            h[0] = h[nxpix - 1] = 0;
+            for (int x = 1; x < nxpix - 1; x++)
+                h[x] = above[x - 1] & above[x] & above[x + 1];
+        } else {
+            fill(h, h + nxpix, 0); // outside the image
+        }
+
+        // morphological erosion of row c = r-1: removes small groups (less than 3x3) of hit pixels
+        int c = r - 1;
+        if (c < y0 - 1)
+            continue;
+        const unsigned char *hup = &hrun[((c + 2) % 3) * nxpix];
+        const unsigned char *hmid = &hrun[((c + 3) % 3) * nxpix];
+        for (int x = 0; x < nxpix; x++)
+            eroded[x] = hup[x] & hmid[x] & h[x];
+        unsigned char *g = &grown[((c + 3) % 3) * nxpix];
+        g[0] = g[nxpix - 1] = 0;
+        for (int x = 1; x < nxpix - 1; x++)
+            g[x] = eroded[x - 1] | eroded[x] | eroded[x + 1];
+
+        // morphological dilation of row y = r-2: puts back the pixels on the edges of surviving groups,
+        // then save just stars from the original image (set all non-saved pixels to 0)
+        int y = r - 2;
+        if (y < y0)
+            continue;
+        unsigned char *pix = image.pixels() + (long) y * nxpix;
+        if (y == 0 || y == nypix - 1) {
+            fill(pix, pix + nxpix, 0); // edges are never part of a group
+            continue;
+        }
+        const unsigned char *gup = &grown[((y + 2) % 3) * nxpix];
+        const unsigned char *gmid = &grown[((y + 3) % 3) * nxpix];
+        for (int x = 0; x < nxpix; x++)
+            keep[x] = gup[x] | gmid[x] | g[x];
+        for (int x = 0; x < nxpix; x++)
+            pix[x] *= keep[x]; // erase background pixels
+    }
+}
+
+int StarDetect::__num_bands() const {
+    int nbands = (int) thread::hardware_concurrency();
+    nbands = min(nbands, image.height() / MIN_BAND_ROWS);
+    return max(nbands, 1);
+}
+
 void StarDetect::__get_neighbors(int pixnum, int neighbors[8]) {
     int tmp[8] = {pixnum - image.width() - 1, pixnum - image.width(), pixnum - image.width() + 1,
                   pixnum - 1, pixnum + 1,
@@ -72,53 +131,144 @@ void StarDetect::__get_neighbors(int pixnum, int neighbors[8]) {
 
 void StarDetect::__add_pixel(ImageStar *CurrentStar, int pixel) {
     CurrentStar->add_pixel(pixel % image.width(), pixel / image.width(), (int) image.pixels()[pixel]);
-    image.pixels()[pixel] = 0;
+    visited[pixel] = true;
 }
 
 // Add clustered pixels to a star
 void StarDetect::add_star_pixels(ImageStar *CurrentStar, int pixnum) {
+    // depth-first flood fill over non-zero pixels; pixels are marked when pushed, so each is visited once
     vector<int> pix_to_add;
     pix_to_add.push_back(pixnum);
+    __add_pixel(CurrentStar, pixnum);
 
     while (!pix_to_add.empty()) {
-        // add all the currently stored pixels
-        for (int pixel : pix_to_add)
-            __add_pixel(CurrentStar, pixel);
-
-        // don't want to pass twice over the same pixel -- use set
-        set<int> new_neighbors;
-        // find all the new neighbors of the currently stored pixels, while
-        // removing the current pixels from the vector
-        while (!pix_to_add.empty()) {
-            int pixel = pix_to_add.back();
-            pix_to_add.pop_back();
-
-            // get neighbors of the pixel we just removed
-            int neighbors[8];
-            __get_neighbors(pixel, neighbors);
-
-            // put all of the non-zero ones in the non-added pixels set
-            for (int val : neighbors) {
-                if (image.pixels()[val] > 0)
-                    new_neighbors.insert(val);
+        int pixel = pix_to_add.back();
+        pix_to_add.pop_back();
+
+        int neighbors[8];
+        __get_neighbors(pixel, neighbors);
+
+        for (int val : neighbors) {
+            if (image.pixels()[val] > 0 && !visited[val]) {
+                __add_pixel(CurrentStar, val);
+                pix_to_add.push_back(val);
             }
         }
+    }
+}
+
+void StarDetect::label_components() {
+    // two-pass union-find labelling, but only the previous row of labels is kept: the moments of each
+    // provisional label are accumulated during the sweep and summed per connected set at the end
+    const int nxpix = image.width();
+    const int nypix = image.height();
+
+    vector<int> parent; // union-find forest over provisional labels
+    vector<ImageStar::Moments> moments;
+    vector<long> seed; // first pixel above threshold in raster order, -1 if none
+
+    auto find = [&parent](int label) {
+        int root = label;
+        while (parent[root] != root)
+            root = parent[root];
+        while (parent[label] != root) { // path compression
+            int next = parent[label];
+            parent[label] = root;
+            label = next;
+        }
+        return root;
+    };
+    auto unite = [&parent, &find](int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a < b) parent[b] = a;
+        else if (b < a) parent[a] = b;
+    };
+
+    vector<int> prev(nxpix + 2, -1), cur(nxpix + 2, -1); // padded by one on each side, -1 = background
+    for (int y = 0; y < nypix; y++) {
+        const unsigned char *row = image.pixels() + (long) y * nxpix;
+        for (int x = 0; x < nxpix; x++) {
+            int *here = &cur[x + 1];
+            if (row[x] == 0) {
+                *here = -1;
+                continue;
+            }
+
+            // already labelled 8-neighbours: W, NW, N, NE
+            const int candidates[4] = {here[-1], prev[x], prev[x + 1], prev[x + 2]};
+            int label = -1;
+            for (int c : candidates) {
+                if (c < 0) continue;
+                if (label < 0) label = c;
+                else if (c != label) unite(label, c);
+            }
+            if (label < 0) {
+                label = (int) parent.size();
+                parent.push_back(label);
+                moments.push_back(ImageStar::Moments());
+                seed.push_back(-1);
+            }
 
-        // repopulate the vector of pixels to add with new neighbors
-        for (int pixel : new_neighbors)
-            pix_to_add.push_back(pixel);
+            *here = label;
+            moments[label].add_pixel(x, y, (int) row[x]);
+            if (row[x] > threshold && seed[label] < 0)
+                seed[label] = (long) y * nxpix + x;
+        }
+        swap(prev, cur);
+    }
+
+    // fold every provisional label into its root
+    for (int label = 0; label < (int) parent.size(); label++) {
+        int root = find(label);
+        if (root == label) continue;
+        moments[root].merge(moments[label]);
+        if (seed[label] >= 0 && (seed[root] < 0 || seed[label] < seed[root]))
+            seed[root] = seed[label];
+    }
+
+    vector<pair<long, int>> stars; // (seed pixel, root label)
+    for (int label = 0; label < (int) parent.size(); label++) {
+        if (parent[label] == label && seed[label] >= 0)
+            stars.push_back(make_pair(seed[label], label));
+    }
+    sort(stars.begin(), stars.end());
+    for (const auto &star : stars) {
+        StarList.push_back(ImageStar(image, ledsin));
+        StarList.back().add_moments(moments[star.second]);
     }
 }
 
 void StarDetect::find_threshold() {
 //use a multiplicity of mean to find hotspots
-    threshold = 0;
-    const int npix = image.width() * image.height();
-    for (int i = 0; i < npix; i++)
-        threshold += image.pixels()[i];
+    const int nxpix = image.width();
+    const int nypix = image.height();
+    const long npix = (long) nxpix * nypix;
+    int nbands = __num_bands();
+
+    // sum the image in row bands, one per thread
+    vector<uint64_t> sums(nbands, 0);
+    auto sumRows = [this, nxpix, nypix, nbands, &sums](int b) {
+        const unsigned char *first = image.pixels() + (long) nypix * b / nbands * nxpix;
+        const unsigned char *last = image.pixels() + (long) nypix * (b + 1) / nbands * nxpix;
+        uint64_t sum = 0;
+        for (const unsigned char *p = first; p < last; p++)
+            sum += *p;
+        sums[b] = sum;
+    };
+    vector<thread> workers;
+    for (int b = 1; b < nbands; b++)
+        workers.emplace_back(sumRows, b);
+    sumRows(0);
+    for (thread &worker : workers)
+        worker.join();
+
+    uint64_t total = 0;
+    for (uint64_t sum : sums)
+        total += sum;
     // ledsin->THRESHOLD indicates how many times the mean to look for px. THRESHOLD=1 means that (almost) all pixels would be considered part of an led.
     // nominally this is 3-5ish
-    threshold *= ledsin->THRESHOLD / (1.0 * npix);
+    threshold = (int) (total * (ledsin->THRESHOLD / (1.0 * npix)));
 }
 
 // Method to automatically detect stars in an image
@@ -126,6 +276,7 @@ void StarDetect::detect_stars() {
     // add stars using known nearby positions if there are known LEDs
     spdlog::trace("Began detect_stars()");
     if (ledsin->NLED > 0) {
+        visited.assign(image.width() * image.height(), false);
         for (int i = 0; i < ledsin->NLED; i++) {
             //make cursor the known point
             int cx = abs(ledsin->LEDCCD[i][0]);
@@ -142,7 +293,7 @@ void StarDetect::detect_stars() {
                 if (ledsin->VERBOSE == true) {
                     spdlog::debug("StarDetect: Searching for LED# {} at ({}, {})", i, cx, cy);
                 }
-                if (image.pixels()[image.width() * cy + cx] > threshold) {
+                if (image.pixels()[image.width() * cy + cx] > threshold && !visited[image.width() * cy + cx]) {
                     StarList.push_back(ImageStar(image, ledsin));
                     add_star_pixels(&StarList.back(), image.width() * cy + cx);
                     ledsout->LEDSPRESENT[i] = true;
@@ -180,13 +331,8 @@ void StarDetect::detect_stars() {
             } // end foundit while loop
         } // end per LED for loop
     } else {
-        // add stars using the add_star_pixels clustered pixels method across whole image if no known stars
-        for (int i = 0; i < image.width() * image.height(); i++) {
-            if (image.pixels()[i] > threshold) {
-                StarList.push_back(ImageStar(image, ledsin));
-                add_star_pixels(&StarList.back(), i);
-            }
-        }
+        // add stars from the connected groups of pixels across whole image if no known stars
+        label_components();
     }
 
     // centroid stars and apply cuts
@@ -26,17 +26,29 @@ private:
 
     void ed_filter();
 
+    // fused erosion/dilation/background erase over rows [y0, y1), halo holds the raw rows y0-2, y0-1, y1, y1+1
+    void __filter_rows(int y0, int y1, const unsigned char *halo);
+
+    // number of row bands to split a full-image pass into, one per thread
+    int __num_bands() const;
+
     void detect_stars();
 
     //int calculate_noise(int nPairs);
     void add_star_pixels(ImageStar *CurrentStar, int pixnum);
 
+    // one raster sweep labelling the 8-connected groups of non-zero pixels, adds one star per group that
+    // has a pixel above threshold, in the order the old per-pixel flood fill found them
+    void label_components();
+
     // two helpers for the above
     void __get_neighbors(int pixnum, int neighbors[8]);
 
     void __add_pixel(ImageStar *CurrentStar, int pixel);
 
     int threshold;
+    std::vector<bool> visited; // pixels already added to a star, for the flood fill around known LEDs
+    static const int MIN_BAND_ROWS; // don't spawn a thread for fewer rows than this
     const LEDinputs *ledsin;
     LEDoutputs *ledsout;
 };
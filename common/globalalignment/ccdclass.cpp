@@ -109,6 +109,8 @@ void GASCCD::setConfig(string config)
                 sin >> fLEDsIn.VERBOSE;
             else if (line.find("CAPTUREONLY") != string::npos)
                 sin >> fLEDsIn.CAPTUREONLY;
+            else if (line.find("STREAM") != string::npos)
+                sin >> fLEDsIn.STREAM;
         } //end if not a # comment
     } // end while loop
     fin.close();
@@ -120,8 +122,8 @@ void GASCCD::turnOn() {
         return;
     }
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    pfCamThread.reset(); // stops the consumer thread before its camera goes away
     pfCamera.reset();
-    pfCamThread.reset();
     initialize();
     m_On = true;
 }
@@ -129,8 +131,8 @@ void GASCCD::turnOn() {
 void GASCCD::turnOff() {
     spdlog::info("{} : GASCCD :: Turning off power to CCD...", m_Identity.name);
     Device::CustomBusyLock lock = Device::CustomBusyLock(this);
+    pfCamThread.reset(); // stops the consumer thread before its camera goes away
     pfCamera.reset();
-    pfCamThread.reset();
     m_On = false;
 }
 
@@ -220,6 +222,11 @@ bool GASCCD::initialize()
         logout << strout;
     }
 
+    if (fLEDsIn.STREAM && !pfCamThread->startStreaming()) {
+        spdlog::warn("{} : GASCCD::initialize() : Could not start streaming, capturing one frame per update.",
+                     m_Identity.name);
+    }
+
     if (fLEDsIn.VERBOSE) {
         logout.close();
     }
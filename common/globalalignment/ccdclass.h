@@ -33,7 +33,7 @@ public:
             fConfigFile(""),
             Device::Device(std::move(identity)) {}
 
-    ~GASCCD() = default;
+    ~GASCCD() { pfCamThread.reset(); } // the camera thread uses pfCamera, so it has to go first
 
     static const std::vector<Device::ErrorDefinition> ERROR_DEFINITIONS;
 
@@ -1,4 +1,5 @@
 #include "common/globalalignment/psdclass.hpp"
+#include "common/alignment/usbdevices.hpp"
 
 #include <errno.h>
 #include <termios.h>
@@ -9,8 +10,12 @@
 #include <stdio.h>
 
 #include <sys/ioctl.h>
+#include <poll.h>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <random>
+#include <vector>
 #include <chrono>
 #include <unistd.h>
 
@@ -23,7 +28,8 @@ const std::vector<Device::ErrorDefinition> GASPSDBase::ERROR_DEFINITIONS = {
         {"Error from tcgetattr.",          Device::ErrorState::FatalError},//error 1
         {"Error from tcsetattrr.",         Device::ErrorState::FatalError},//error 2
         {"Error from tggetattr.",          Device::ErrorState::FatalError},//error 3
-        {"Error setting term attributes.", Device::ErrorState::FatalError}//error 4
+        {"Error setting term attributes.", Device::ErrorState::FatalError},//error 4
+        {"Lost connection to the PSD.",    Device::ErrorState::FatalError}//error 5
 };
 
 void GASPSDBase::turnOn() {
@@ -54,38 +60,97 @@ void GASPSDBase::setNominalValues(int offset, double value) {
 
 
 #ifndef SIMMODE
+const int GASPSD::READ_CHUNK_SIZE = 4096;
+const int GASPSD::MAX_LINE_LENGTH = 256;
+const int GASPSD::POLL_TIMEOUT = 200;
+const int GASPSD::LOG_FLUSH_INTERVAL = 5;
+const size_t GASPSD::LOG_BUFFER_SIZE = 64 * 1024;
+
+namespace {
+// strtod without locale lookups or NUL termination; enough for the PSD's plain decimal output.
+// Returns false (and leaves p alone) if there is no number at p.
+bool parseDouble(const char *&p, const char *end, double &value) {
+    const char *c = p;
+    while (c < end && (*c == ' ' || *c == '\t'))
+        c++;
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = (*c++ == '-');
+
+    double result = 0.0;
+    bool digits = false;
+    while (c < end && *c >= '0' && *c <= '9') {
+        result = result * 10.0 + (*c++ - '0');
+        digits = true;
+    }
+    if (c < end && *c == '.') {
+        c++;
+        double scale = 0.1;
+        while (c < end && *c >= '0' && *c <= '9') {
+            result += (*c++ - '0') * scale;
+            scale *= 0.1;
+            digits = true;
+        }
+    }
+    if (!digits)
+        return false;
+    if (c < end && (*c == 'e' || *c == 'E')) {
+        const char *e = c + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+            negativeExponent = (*e++ == '-');
+        if (e < end && *e >= '0' && *e <= '9') {
+            int exponent = 0;
+            while (e < end && *e >= '0' && *e <= '9')
+                exponent = exponent * 10 + (*e++ - '0');
+            result *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+            c = e;
+        }
+    }
+
+    value = negative ? -result : result;
+    p = c;
+    return true;
+}
+}
+
 GASPSD::~GASPSD()
 {
+    __stopReader();
     m_logOutputStream.close();
 }
 
 bool GASPSD::initialize()
 {
-    int newACMDeviceId = 0;
+    int newACMDeviceId = -1;
     spdlog::info("{} : GASPSD::initialize() : Initializing...", m_Identity);
-    // we toggle the usb port, checking the ACM devices when it's off and again when it's on.
+    // if the PSD is already enumerated we take it as is. Otherwise we toggle the usb ports and wait
+    // for the ACM device to show up.
 
     m_Errors.assign(getNumErrors(), false);
-
-    m_pCBC->usb.disableAll(); // make sure all USBs are off
-    std::set<int> oldACMDevices = getACMDevices(); // count ACM devices
-
-    m_pCBC->usb.enableAll(); // switch the usb back on and wait for the ACM device to show up
-    sleep(4);
-
-    std::set<int> newACMDevices = getACMDevices(); // check all ACM devices again
-
-    std::set<int> toggledDevices;
-    std::set_difference(newACMDevices.begin(), newACMDevices.end(), oldACMDevices.begin(), oldACMDevices.end(),
-                    std::inserter(toggledDevices, toggledDevices.begin()));
-
-    if (!toggledDevices.empty()) {
-        newACMDeviceId = *toggledDevices.begin(); // get the only element in the set -- this is the new device ID
-        m_usb_port = 1;
+    __stopReader();
+
+    std::set<int> oldACMDevices = USBDeviceRegistry::getDevices("ttyACM");
+    if (oldACMDevices.size() == 1) {
+        newACMDeviceId = *oldACMDevices.begin(); // get the only element in the set -- this is the device ID
+        m_usb_port = USBDeviceRegistry::findPort("ttyACM", newACMDeviceId);
+        if (m_usb_port == -1) {
+            m_usb_port = newACMDeviceId + 1;
+        }
     }
-    else if (newACMDevices.size()==1) {
-        newACMDeviceId = *newACMDevices.begin(); // get the only element in the set -- this is the new device ID
-        m_usb_port = newACMDeviceId + 1;
+    else {
+        m_pCBC->usb.disableAll(); // make sure all USBs are off
+        if (!oldACMDevices.empty()) {
+            USBDeviceRegistry::waitForRemovedDevice("ttyACM", oldACMDevices, USBDeviceRegistry::DEVICE_REMOVE_TIMEOUT);
+        }
+        oldACMDevices = USBDeviceRegistry::getDevices("ttyACM"); // count ACM devices
+
+        m_pCBC->usb.enableAll(); // switch the usb back on and wait for the ACM device to show up
+        newACMDeviceId = USBDeviceRegistry::waitForNewDevice("ttyACM", oldACMDevices,
+                                                             USBDeviceRegistry::DEVICE_APPEAR_TIMEOUT);
+        if (newACMDeviceId >= 0) {
+            m_usb_port = 1;
+        }
     }
 
     if (m_usb_port == -1){
@@ -115,73 +180,173 @@ bool GASPSD::initialize()
     // write(m_fd, "s", 1); // std dev output enabled by default
     write(m_fd, "m", 1); // psd readings
 
-    m_logOutputStream.open(m_logFilename);
+    if (!m_logOutputStream.is_open())
+        m_logOutputStream.open(m_logFilename);
+
+    m_Reading = true;
+    m_ReaderThread = std::thread(&GASPSD::__readLoop, this);
 
     return true;
 }
 
 void GASPSD::update() {
     spdlog::debug("GASPSD::update()");
-    if (m_fd >= 0) {
-        char buf[110];
-        char tmp = '\0';
-        int new_bytes = 0;
-
-        // align on opening
-        int count = 0;
-
-        int lines_read = 0 ;
-        int max_lines_read_during_update = 1;
-        bool did_not_read = false;
-
-        // skip lines that start with '#'
-        do {
-            memset(buf, '\0', sizeof buf);
-            // read one byte until hit newline
-            do {
-                new_bytes = read(m_fd, &tmp, 1);
-            } while (tmp != '\n');
-
-            while (tmp != '\r') {
-                new_bytes = read(m_fd, &tmp, 1);
-                buf[count] = tmp;
-                count += new_bytes;
-            }
-            spdlog::debug("{}\n", buf);
-            count = 0;
-            lines_read++;
-            if (lines_read == 2 * max_lines_read_during_update) {
-                did_not_read = true;
-                break;
+    if (!m_Reading) {
+        spdlog::error("{} : GASPSD::update() : PSD is not being read, no current sample.", m_Identity);
+        return;
+    }
+    double sample[9];
+    unsigned long count = __readLatest(sample);
+    if (count == m_LastSampleRead) {
+        spdlog::debug("{} : GASPSD::update() : No new PSD sample since last update.", m_Identity);
+        return;
+    }
+    m_LastSampleRead = count;
+    std::copy(sample, sample + 9, m_data);
+}
+
+void GASPSD::__readLoop() {
+    // don't let a read ever wait for VTIME -- poll() does the waiting
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+
+    std::vector<char> buffer(READ_CHUNK_SIZE + MAX_LINE_LENGTH);
+    size_t pending = 0; // bytes of an incomplete line at the start of buffer
+    auto lastFlush = std::chrono::steady_clock::now();
+    m_LogBuffer.reserve(LOG_BUFFER_SIZE + MAX_LINE_LENGTH);
+
+    while (m_Reading) {
+        struct pollfd pfd = {m_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, POLL_TIMEOUT);
+        if (ready < 0 && errno != EINTR) {
+            spdlog::error("{} : GASPSD::__readLoop() : poll failed: {}", m_Identity, strerror(errno));
+            setError(5);
+            break;
+        }
+        if (ready > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+            spdlog::error("{} : GASPSD::__readLoop() : PSD device went away, stopping reads.", m_Identity);
+            setError(5);
+            break;
+        }
+
+        if (ready > 0) {
+            ssize_t new_bytes;
+            while ((new_bytes = read(m_fd, buffer.data() + pending, READ_CHUNK_SIZE)) > 0) {
+                // frame lines on either line ending; the PSD sends \r\n
+                const char *begin = buffer.data();
+                const char *end = buffer.data() + pending + new_bytes;
+                const char *lineStart = begin;
+                for (const char *c = begin + pending; c < end; c++) {
+                    if (*c == '\n' || *c == '\r') {
+                        __handleLine(lineStart, c);
+                        lineStart = c + 1;
+                    }
+                }
+                pending = end - lineStart;
+                if (pending > (size_t) MAX_LINE_LENGTH) {
+                    spdlog::warn("{} : GASPSD::__readLoop() : Discarding {} bytes without a line ending.", m_Identity,
+                                 pending);
+                    pending = 0;
+                }
+                memmove(buffer.data(), lineStart, pending);
             }
-        } while (buf[0] == '#');
-        if (did_not_read){
-            return;
         }
 
-        new_bytes = sscanf(buf, "%lf %lf %lf %lf %lf %lf %lf %lf %lf",
-                           &m_data[0], &m_data[1], &m_data[2], &m_data[3],
-                           &m_data[4], &m_data[5], &m_data[6], &m_data[7],
-                           &m_data[8]);
+        // write the log in batches rather than flushing every sample
+        auto now = std::chrono::steady_clock::now();
+        if (!m_LogBuffer.empty() && (m_LogBuffer.size() >= LOG_BUFFER_SIZE ||
+                                     now - lastFlush >= std::chrono::seconds(LOG_FLUSH_INTERVAL))) {
+            m_logOutputStream.write(m_LogBuffer.data(), m_LogBuffer.size());
+            m_logOutputStream.flush();
+            m_LogBuffer.clear();
+            lastFlush = now;
+        }
+    }
 
-        for (int i = 0; i < 4; i++) {
-            if (m_data[i] < 0) {
-                m_data[i] = (m_data[i]*m_AlphaNeg[i]) - m_Beta[i];
-                m_data[i + 4] = m_data[i + 4]*m_AlphaNeg[i];
-            }
-            else {
-                m_data[i] = (m_data[i]*m_AlphaPos[i]) - m_Beta[i];
-                m_data[i + 4] = m_data[i + 4]*m_AlphaPos[i];
-            }
+    if (!m_LogBuffer.empty()) {
+        m_logOutputStream.write(m_LogBuffer.data(), m_LogBuffer.size());
+        m_logOutputStream.flush();
+        m_LogBuffer.clear();
+    }
+    // no more samples are coming -- update() stops treating the last one as current
+    m_Reading = false;
+}
+
+void GASPSD::__handleLine(const char *begin, const char *end) {
+    // skip empty lines and comment lines that start with '#'
+    if (begin == end || *begin == '#')
+        return;
+
+    // fields missing from the line keep their previous value
+    double sample[9];
+    if (__readLatest(sample) == 0)
+        std::fill(sample, sample + 9, 0.0);
+    const char *p = begin;
+    int nFields = 0;
+    while (nFields < 9 && parseDouble(p, end, sample[nFields]))
+        nFields++;
+    if (nFields < 4) {
+        spdlog::debug("{} : GASPSD : Skipping unparseable line '{}'", m_Identity, std::string(begin, end));
+        return;
     }
 
-        // log locally
-        for (int i = 0; i < 8; i++) {
-            m_logOutputStream.precision(5);
-            m_logOutputStream << m_data[i] << " ";
+    for (int i = 0; i < 4; i++) {
+        if (sample[i] < 0) {
+            sample[i] = (sample[i]*m_AlphaNeg[i]) - m_Beta[i];
+            sample[i + 4] = sample[i + 4]*m_AlphaNeg[i];
+        }
+        else {
+            sample[i] = (sample[i]*m_AlphaPos[i]) - m_Beta[i];
+            sample[i + 4] = sample[i + 4]*m_AlphaPos[i];
         }
-        m_logOutputStream.precision(2);
-        m_logOutputStream << m_data[8] << std::endl;
+    }
+    __publish(sample);
+
+    // log locally
+    char line[MAX_LINE_LENGTH];
+    int length = snprintf(line, sizeof line, "%.5g %.5g %.5g %.5g %.5g %.5g %.5g %.5g %.2g\n",
+                          sample[0], sample[1], sample[2], sample[3], sample[4], sample[5], sample[6], sample[7],
+                          sample[8]);
+    if (length > 0)
+        m_LogBuffer.append(line, std::min(length, (int) sizeof line - 1));
+}
+
+void GASPSD::__publish(const double sample[9]) {
+    // only the reader thread writes, so the count can't change under us
+    unsigned long count = m_SampleCount.load(std::memory_order_relaxed);
+    SampleSlot &slot = m_Samples[count % 2];
+    unsigned sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed); // odd: being written
+    std::atomic_thread_fence(std::memory_order_release);
+    std::copy(sample, sample + 9, slot.data);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_SampleCount.store(count + 1, std::memory_order_release);
+}
+
+unsigned long GASPSD::__readLatest(double sample[9]) {
+    while (true) {
+        unsigned long count = m_SampleCount.load(std::memory_order_acquire);
+        if (count == 0)
+            return 0;
+        const SampleSlot &slot = m_Samples[(count - 1) % 2];
+        unsigned before = slot.sequence.load(std::memory_order_acquire);
+        if (before % 2)
+            continue; // the reader lapped us and is rewriting this slot
+        std::copy(slot.data, slot.data + 9, sample);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before)
+            return count;
+    }
+}
+
+void GASPSD::__stopReader() {
+    if (!m_Reading && !m_ReaderThread.joinable())
+        return;
+    m_Reading = false;
+    if (m_ReaderThread.joinable())
+        m_ReaderThread.join();
+    if (m_fd > 0) {
+        close(m_fd);
+        m_fd = -1;
     }
 }
 
@@ -264,34 +429,6 @@ void GASPSD::setCalibration() {
 }
 
 
-std::set<int> GASPSD::getACMDevices() {
-    std::set<int> ACMDevices;
-
-    DIR *dir;
-    struct dirent *ent;
-
-    if ((dir = opendir("/dev")) != nullptr) { // Open /dev device directory in filesystem
-        /* print all the files and directories within directory */
-        while ((ent = readdir(dir)) != nullptr) {
-            std::string currentEntry = ent->d_name;
-            size_t pos;
-            std::string substringToFind = "ttyACM"; // Locate ACM devices (name including the string "ttyACM")
-            if ((pos = currentEntry.find(substringToFind)) != std::string::npos) { // Found ACM device
-                pos += substringToFind.length(); // go to immediately after the substring "ACM"
-                int deviceNumber = std::stoi(
-                        currentEntry.substr(pos)); // grab remaining part of device name to get the device number
-                ACMDevices.insert(deviceNumber);
-            }
-        }
-        closedir(dir);
-    } else {
-        ACMDevices = {-1}; // output signalling failure
-    }
-
-    return ACMDevices;
-}
-
-
 void GASPSD::turnOn() {
     spdlog::info("{}: Turning on" ,m_Identity);
     m_On = true;
@@ -307,6 +444,7 @@ void GASPSD::turnOn() {
 
 void GASPSD::turnOff() {
     spdlog::info("{}: Turning off", m_Identity);
+    __stopReader();
     m_pCBC->usb.disableAll();
     m_On = false;
 }
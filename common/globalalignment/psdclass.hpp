@@ -1,8 +1,10 @@
 #ifndef _PSDCLASS_HPP_
 #define _PSDCLASS_HPP_
 
+#include <atomic>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <set>
 #include <dirent.h>
 #include <iostream>
@@ -65,6 +67,8 @@ protected:
 #ifndef SIMMODE
 #include "common/cbccode/cbc.hpp"
 
+// The PSD streams samples continuously over its tty. A reader thread reads it in chunks as data arrives, parses
+// and calibrates each line and publishes the newest sample; update() just picks that sample up.
 class GASPSD : public GASPSDBase
 {
 public:
@@ -87,8 +91,6 @@ protected:
 
     void setCalibration() override;
 
-    static std::set<int> getACMDevices();
-
     std::shared_ptr<CBC> m_pCBC;
 
     int m_usb_port = -1;
@@ -97,6 +99,32 @@ protected:
     std::string m_logFilename = std::string(getenv("HOME")) + std::string("/logs/") + "PSD-measurements.log"; // file to log into
     std::ofstream m_logOutputStream;
 
+    static const int READ_CHUNK_SIZE; // bytes per read()
+    static const int MAX_LINE_LENGTH;
+    static const int POLL_TIMEOUT; // ms
+    static const int LOG_FLUSH_INTERVAL; // s
+    static const size_t LOG_BUFFER_SIZE; // bytes of log lines collected before a write
+
+    // newest sample, double buffered: the reader writes the slot the last sample is not in. Each slot is a
+    // seqlock (odd sequence = being written), so update() never blocks and never sees a half-written sample
+    struct SampleSlot {
+        std::atomic<unsigned> sequence{0};
+        double data[9];
+    };
+    SampleSlot m_Samples[2];
+    std::atomic<unsigned long> m_SampleCount{0}; // samples published so far; the newest is in slot (count - 1) % 2
+    unsigned long m_LastSampleRead = 0;
+
+    std::thread m_ReaderThread;
+    std::atomic<bool> m_Reading{false};
+    std::string m_LogBuffer; // only touched by the reader thread
+
+    void __readLoop();
+    void __handleLine(const char *begin, const char *end);
+    void __publish(const double sample[9]);
+    unsigned long __readLatest(double sample[9]); // sample count, 0 if there is no sample yet
+    void __stopReader();
+
 };
 #endif
 
@@ -1,5 +1,7 @@
 #include "rangefinderclass.hpp"
 
+#include "common/alignment/usbdevices.hpp"
+
 const std::vector<Device::ErrorDefinition> GASRangeFinderBase::ERROR_DEFINITIONS{
         {"Rangefinder Operable Error", Device::ErrorState::OperableError},
         {"Rangefinder Fatal Error", Device::ErrorState::FatalError}
@@ -14,31 +16,32 @@ void GASRangeFinderBase::turnOn() {
 }
 
 #ifndef SIMMODE
+const int GASRangeFinder::PORT_PROBE_TIMEOUT = 4000;
+
 bool GASRangeFinder::initialize() {
-    int newUSBDeviceId = 0;
+    int newUSBDeviceId = -1;
     spdlog::info("{} : GASRangeFinder::initialize() : Initializing...", m_Identity);
-    // we toggle the usb port, checking the USB devices when it's off and again when it's on.
+    // look for an enumerated USB serial device on a port we already know. Otherwise we toggle the usb
+    // ports one by one, skipping ports known to hold a webcam, until the USB device shows up.
 
     m_Errors.assign(getNumErrors(), false);
 
-    for (int test_usb_port = 1; test_usb_port < 7; ++test_usb_port) {
-
-        m_pCBC->usb.disable(test_usb_port); // make sure our USB is off
-        std::set<int> oldUSBDevices = getUSBDevices(); // count USB devices
-
-        m_pCBC->usb.enable(test_usb_port); // switch the usb back on and wait for the USB device to show up
-        sleep(4);
-
-        std::set<int> newUSBDevices = getUSBDevices(); // check all USB devices again
-
-        std::set<int> toggledDevices;
-        std::set_difference(newUSBDevices.begin(), newUSBDevices.end(), oldUSBDevices.begin(), oldUSBDevices.end(),
-                            std::inserter(toggledDevices, toggledDevices.begin()));
+    for (int device : USBDeviceRegistry::getDevices("ttyUSB")) {
+        int port = USBDeviceRegistry::findPort("ttyUSB", device);
+        if (port != -1) {
+            newUSBDeviceId = device;
+            m_usb_port = port;
+            break;
+        }
+    }
 
-        if (toggledDevices.size() == 1) {
-            newUSBDeviceId = *toggledDevices.begin(); // get the only element in the set -- this is the new device ID
+    for (int test_usb_port = 1; m_usb_port == -1 && test_usb_port < 7; ++test_usb_port) {
+        if (USBDeviceRegistry::findDevice(test_usb_port, "video") >= 0) {
+            continue;
+        }
+        newUSBDeviceId = USBDeviceRegistry::toggleAndFind(m_pCBC, test_usb_port, "ttyUSB", PORT_PROBE_TIMEOUT);
+        if (newUSBDeviceId >= 0) {
             m_usb_port = test_usb_port;
-            break;
         }
     }
     if (m_usb_port == -1){
@@ -57,33 +60,6 @@ bool GASRangeFinder::initialize() {
     return true;
 }
 
-std::set<int> GASRangeFinder::getUSBDevices() {
-    std::set<int> USBDevices;
-
-    DIR *dir;
-    struct dirent *ent;
-
-    if ((dir = opendir("/dev")) != nullptr) { // Open /dev device directory in filesystem
-        /* print all the files and directories within directory */
-        while ((ent = readdir(dir)) != nullptr) {
-            std::string currentEntry = ent->d_name;
-            size_t pos;
-            std::string substringToFind = "ttyUSB"; // Locate USB devices (name including the string "USB")
-            if ((pos = currentEntry.find(substringToFind)) != std::string::npos) { // Found USB device
-                pos += substringToFind.length(); // go to immediately after the substring "USB"
-                int deviceNumber = std::stoi(
-                        currentEntry.substr(pos)); // grab remaining part of device name to get the device number
-                USBDevices.insert(deviceNumber);
-            }
-        }
-        closedir(dir);
-    } else {
-        USBDevices = {-1}; // output signalling failure
-    }
-
-    return USBDevices;
-}
-
 void GASRangeFinder::turnOff() {
     spdlog::info("GASRangeFinder::turnOff() - no effect");
 }
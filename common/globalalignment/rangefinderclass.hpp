@@ -59,7 +59,7 @@ protected:
 
     int m_usb_port;
 
-    static std::set<int> getUSBDevices();
+    static const int PORT_PROBE_TIMEOUT; // ms to wait for a device on each port we toggle
 };
 #endif
 
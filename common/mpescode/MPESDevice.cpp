@@ -10,7 +10,7 @@
 MPESDevice::MPESDevice() :
     m_id {0},
     m_on {false}, m_calLoaded {false}, m_matLoaded {false},
-    m_resolution {320},
+    m_resolution {kDEFAULT_RESOLUTION},
     m_exposure {500},
     m_imgLapse {0},
     m_targetIntensity {kNOMINAL_INTENSITY},
@@ -21,7 +21,7 @@ MPESDevice::MPESDevice() :
 MPESDevice::MPESDevice(int ID) :
     m_id {ID},
     m_on {false}, m_calLoaded {false}, m_matLoaded {false},
-    m_resolution {320},
+    m_resolution {kDEFAULT_RESOLUTION},
     m_exposure {500},
     m_imgLapse {0},
     m_targetIntensity {kNOMINAL_INTENSITY},
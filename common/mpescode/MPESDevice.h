@@ -3,6 +3,7 @@
 
 static constexpr float kNOMINAL_INTENSITY = 100000.0; // default was 150,000.
 static constexpr float kNOMINAL_SPOT_WIDTH = 10.0;
+static constexpr int kDEFAULT_RESOLUTION = 320; // frame width, px; frames are 4:3
 static constexpr int kMAX_EXPOSURE = 5000-1;
 static constexpr int kMIN_EXPOSURE = 50;
 static constexpr float kINTENSITY_RATIO_TOLERANCE = 0.258;
@@ -22,6 +22,12 @@ MPESImage& MPESImage::operator=(const MPESImage& img)
 }
 
 void MPESImage::analyze(int thresh)
+{
+    analyze(thresh, Rect(0, 0, this->cols, this->rows));
+}
+
+// sums run over the pixels of roi, indexed from its corner; only the centroids are moved back to image coordinates
+void MPESImage::analyze(int thresh, const Rect &roi)
 {
     MPESImageData data;
     data.cleaningThreshold = thresh;
@@ -45,12 +51,12 @@ void MPESImage::analyze(int thresh)
 
     bool working_image = false;
 
-    for(int i = 0; i < this->rows; i++)
+    for(int i = 0; i < roi.height; i++)
     {
 		rowvalue = 0;
-		for(int j = 0; j < this->cols; j++)
+		for(int j = 0; j < roi.width; j++)
 		{
-			pixel = this->at<Vec3b>(i, j);
+			pixel = this->at<Vec3b>(roi.y + i, roi.x + j);
 			pixelintensity = (pixel.val[0] + pixel.val[1] + pixel.val[2]) / 3.;
 			if (pixelintensity != 0){
 			    working_image = true;
@@ -72,12 +78,12 @@ void MPESImage::analyze(int thresh)
         b += (rowvalue * (i+1));
     }
 
-    for(int i = 0; i < this->cols; i++)
+    for(int i = 0; i < roi.width; i++)
     {
         columnvalue = 0;
-        for(int j = 0; j < this->rows; j++)
+        for(int j = 0; j < roi.height; j++)
         {
-            pixel = this->at<Vec3b>(j, i);
+            pixel = this->at<Vec3b>(roi.y + j, roi.x + i);
 			pixelintensity = (pixel.val[0] + pixel.val[1] + pixel.val[2]) / 3.;
 			if ((int)pixelintensity > thresh)
 			{
@@ -106,8 +112,8 @@ void MPESImage::analyze(int thresh)
     data.xSpotSD = sqrt(abs(c-d));
     if(!(data.xSpotSD>0)) data.xSpotSD = -1;
 
-    data.xCentroid = (isum / cleanedIntensity);
-    data.yCentroid = (jsum / cleanedIntensity);
+    data.xCentroid = (isum / cleanedIntensity) + roi.x;
+    data.yCentroid = (jsum / cleanedIntensity) + roi.y;
     if(!(data.xCentroid>0)) data.xCentroid = -1;
     if(!(data.yCentroid>0)) data.yCentroid = -1;
 
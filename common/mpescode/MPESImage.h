@@ -2,7 +2,7 @@
 #define __MPESIMAGE_H__
 
 #include <vector>
-#include <opencv2/core/core.hpp> // cv::Mat, cv::Size
+#include <opencv2/core/core.hpp> // cv::Mat, cv::Size, cv::Rect
 
 struct MPESImageData
 {
@@ -57,6 +57,9 @@ X Spot width:
         @return datavec vector element with MPESImageData populated.
         */
 	void analyze(int thresh);
+        /// As analyze(int), but only over the pixels in roi. Centroids are still in the coordinates of the full image; intensities
+        /// and pixel counts are those of roi only.
+	void analyze(int thresh, const cv::Rect &roi);
         ///Populates parameter results for a specific instance of Threshold value, appends data to a vector of MPESImageData elements.
 	MPESImageData *dataForThresh(int thresh);
 };
@@ -1,5 +1,6 @@
 #include "MPESImageSet.h"
 #include <opencv2/opencv.hpp> // all opencv includes
+#include <algorithm> // max
 #include <cstdio>  // fprintf() etc
 #include <ctime>   // time_t, time()
 #include <cstdlib> // abs
@@ -11,6 +12,7 @@
 #ifdef WITH_OPENCV3
 #define CV_CAP_PROP_FRAME_WIDTH CAP_PROP_FRAME_WIDTH
 #define CV_CAP_PROP_FRAME_HEIGHT CAP_PROP_FRAME_HEIGHT
+#define CV_IMWRITE_JPEG_QUALITY IMWRITE_JPEG_QUALITY
 #endif
 
 
@@ -40,14 +42,42 @@ MPESImageSet::MPESImageSet(MPESDevice* in_device, int N, const char *in_dir, int
     verbosity(in_verbosity)
 {
     device->switchOn();
+    if (dir) {
+        imageSink = ImageSink::forDirectory(dir);
+    }
+}
+
+void MPESImageSet::saveJpeg(const string &fileName, const Mat &frame)
+{
+    // written in the background -- the sink owns its own copy of the frame
+    imageSink->submit(fileName, [frame](const string &path, int compressionLevel) {
+        vector<int> params = {CV_IMWRITE_JPEG_QUALITY, 95 - 5 * compressionLevel};
+        return imwrite(path, frame, params);
+    }, "cam" + to_string(device->GetID()));
+    lastImage = imageSink->getDirectory() + "/" + fileName;
+}
+
+void MPESImageSet::FlushImages()
+{
+    if (imageSink)
+        imageSink->flush();
 }
 
 // returns the number of images captured.
 // check the value to test if everything is working fine.
-int MPESImageSet::Capture()
+int MPESImageSet::Capture(int nImages, bool saveImages)
+{
+    Grab(nImages, saveImages);
+    return Analyze();
+}
+
+// returns the number of frames grabbed (not counting the warm-up frames).
+int MPESImageSet::Grab(int nImages, bool saveImages, const std::function<bool(const MPESImageData &)> &enough)
 {
-    // clean up the datasetvector
+    // clean up the datasetvec
     datasetvec.clear();
+    frames.clear();
+    lastImage.clear();
 
     SetData.cleaningThreshold = iThresh;
     int reject_img = 0;
@@ -56,7 +86,7 @@ int MPESImageSet::Capture()
         DIR * path = opendir(dir); 
         if(!path) {
             fprintf(stderr, "directory not found \n ");
-            return capturedImages;
+            return 0;
         }
 
         dirent *entry;
@@ -71,11 +101,11 @@ int MPESImageSet::Capture()
                 char fullpath[500];
                 sprintf(fullpath,"%s/%s",dir, entry->d_name);
                 MPESImage singleimage = imread(fullpath,1);
-                singleimage.analyze(iThresh);
                 device->SetResolution(singleimage.cols);
-                datasetvec.push_back(singleimage.datavec);
+                frames.push_back(singleimage);
             }
         }
+        closedir(path);
     }
     else { // read from camera
         reject_img = 3;   //number to capture at start, but ignore from calculation
@@ -94,7 +124,7 @@ int MPESImageSet::Capture()
         if(!capture.isOpened())
         {
             fprintf(stderr, "Could not open camera\n");
-            return capturedImages;
+            return 0;
         }
         if (verbosity)
             fprintf(stderr,"adjusting resolution...\n");
@@ -123,7 +153,10 @@ int MPESImageSet::Capture()
             fprintf(stderr, "taking picture...\n");
         }
 
-        for(int img = 0; img < imagesToCapture + reject_img + 1 ; img++)
+        int grabbed = 0;
+        Mat lastFrame;
+        string lastName;
+        for(int img = 0; img < nImages + reject_img + 1 ; img++)
         {
             MPESImage capturedimage;
             capture >> capturedimage;
@@ -138,33 +171,65 @@ int MPESImageSet::Capture()
             }
             time_t t = time(0);
             struct tm *now = localtime(&t);
-            char imagefile[200];
-            sprintf(imagefile,
-                    "%s/edge_cam%i_pic%i_%04d-%02d-%02d_%02d-%02d-%02d.jpg",
-                    dir, device->GetID(), img, now->tm_year+1900,
+            char imagename[200];
+            sprintf(imagename,
+                    "edge_cam%i_pic%i_%04d-%02d-%02d_%02d-%02d-%02d.jpg",
+                    device->GetID(), img, now->tm_year+1900,
                     now->tm_mon+1, now->tm_mday, now->tm_hour, now->tm_min,
                     now->tm_sec);
-            if(img>reject_img)
+            if(img>reject_img && enough)
             {
-                if (img > imagesToCapture + reject_img - save_img){
-                    imwrite(imagefile, capturedimage);
-                    last_img = imagefile;
-                }
-                capturedimage.analyze(iThresh);
-                if (int(capturedimage.datavec.data()->CleanedIntensity) == -2) {
-                    spdlog::warn("Cam_{}: CleanedIntensity == -2",device->GetID() );
-                    datasetvec.push_back(capturedimage.datavec);
+                grabbed++;
+                MPESImage frame = capturedimage.clone();
+                analyzeFrame(frame);
+                datasetvec.push_back(frame.datavec);
+                lastFrame = frame;
+                lastName = imagename;
+                if (int(frame.datavec.data()->CleanedIntensity) == -2) {
+                    spdlog::warn("Cam_{}: CleanedIntensity == -2", device->GetID());
                     break;
                 }
-                else{
-                    datasetvec.push_back(capturedimage.datavec);
-                    sleep(device->GetLapse());
+                if (enough(frame.datavec.at(0)))
+                    break;
+                sleep(device->GetLapse());
+            }
+            else if(img>reject_img)
+            {
+                grabbed++;
+                if (saveImages && imageSink && img > nImages + reject_img - save_img){
+                    saveJpeg(imagename, capturedimage.clone());
                 }
+                // analyzed once the webcam is released -- the driver may reuse the buffer, so keep a copy
+                frames.push_back(capturedimage.clone());
+                sleep(device->GetLapse());
             }
         }
         capture.release();
+
+        if (enough && saveImages && imageSink && !lastFrame.empty()) {
+            saveJpeg(lastName, lastFrame);
+        }
+        return grabbed;
     }
 
+    return frames.size();
+}
+
+// returns the number of images analyzed.
+int MPESImageSet::Analyze()
+{
+    for (vector<MPESImage>::iterator it = frames.begin(); it != frames.end(); ++it)
+    {
+        analyzeFrame(*it);
+        datasetvec.push_back(it->datavec);
+        if (int(it->datavec.data()->CleanedIntensity) == -2) {
+            spdlog::warn("Cam_{}: CleanedIntensity == -2", device->GetID());
+            break;
+        }
+    }
+    frames.clear();
+
+    int nImages = datasetvec.size();
     int ignored;
     ignored = 0;
     for (vector<vector<MPESImageData> >::iterator it = datasetvec.begin(); it != datasetvec.end();)
@@ -181,7 +246,7 @@ int MPESImageSet::Capture()
     if(ignored)
     {
         fprintf(stderr,"%i images ignored because of unphysical results.",ignored);
-        if(ignored == imagesToCapture) 
+        if(ignored == nImages) 
             fprintf(stderr," \n All of your images were ignored, check your device!! \nMaybe the laser is not bright enough, or pointed away from the FOV.\n");
     }
     
@@ -195,6 +260,45 @@ int MPESImageSet::Capture()
 
 }
 
+void MPESImageSet::analyzeFrame(MPESImage &frame)
+{
+    Rect full(0, 0, frame.cols, frame.rows);
+    Rect window = roi & full;
+
+    bool found = false;
+    if (roiEnabled && window.area() > 0 && window != full)
+    {
+        frame.analyze(iThresh, window);
+        const MPESImageData &data = frame.datavec.back();
+        if (data.CleanedIntensity > 0 && data.xCentroid > 0 && data.yCentroid > 0)
+        {
+            // the window may end at the frame edge, where clipping is not the window's doing
+            float marginX = kROI_SPOT_MARGIN * data.xSpotSD, marginY = kROI_SPOT_MARGIN * data.ySpotSD;
+            found = (window.x == 0 || data.xCentroid - marginX >= window.x) &&
+                    (window.x + window.width == full.width || data.xCentroid + marginX <= window.x + window.width) &&
+                    (window.y == 0 || data.yCentroid - marginY >= window.y) &&
+                    (window.y + window.height == full.height || data.yCentroid + marginY <= window.y + window.height);
+        }
+        if (!found)
+        {
+            spdlog::debug("Cam_{}: Spot lost in window {}x{}+{}+{}, analyzing full frame.", device ? device->GetID() : -1,
+                          window.width, window.height, window.x, window.y);
+            frame.datavec.clear();
+        }
+    }
+    if (!found)
+        frame.analyze(iThresh);
+
+    const MPESImageData &data = frame.datavec.back();
+    if (roiEnabled && data.CleanedIntensity > 0 && data.xCentroid > 0 && data.yCentroid > 0)
+    {
+        int half = std::max(kROI_MIN_HALF_WIDTH, int(kROI_SPOT_WIDTHS * std::max(data.xSpotSD, data.ySpotSD) + 0.5));
+        roi = Rect(int(data.xCentroid + 0.5) - half, int(data.yCentroid + 0.5) - half, 2 * half, 2 * half) & full;
+    }
+    else
+        roi = Rect();
+}
+
 void MPESImageSet::ImageProperties(FILE * file)
 {
     for(vector<vector<MPESImageData> >::iterator it = datasetvec.begin(); it != datasetvec.end(); ++it)
@@ -306,6 +410,18 @@ void MPESImageSet::simpleAverage()
 	}
 }
 
+void MPESImageSet::filteredAverage(const MPESSpotFilter &filter)
+{
+    simpleAverage();
+    if(capturedImages && filter.isValid())
+    {
+        SetData.xCentroid = filter.GetX();
+        SetData.yCentroid = filter.GetY();
+        SetData.xCentroidSD = filter.GetFrameSigmaX();
+        SetData.yCentroidSD = filter.GetFrameSigmaY();
+    }
+}
+
 void MPESImageSet::printSetProperties(FILE * file) { /**
     fprintf(stderr, "Device ID: %i \n",device->GetID());
     fprintf(stderr, "Width: %i \n",device->GetResolution());
@@ -3,10 +3,18 @@
 
 #include "MPESImage.h"
 #include "MPESDevice.h"
+#include "MPESSpotFilter.h"
+#include "common/utilities/imagesink.hpp"
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <unistd.h>
 
+static constexpr int kROI_MIN_HALF_WIDTH = 32; ///< Smallest half width of the analysis window, px.
+static constexpr float kROI_SPOT_WIDTHS = 5.0; ///< Half width of the analysis window, in spot widths.
+static constexpr float kROI_SPOT_MARGIN = 3.0; ///< A spot closer than this many spot widths to the window edge is clipped.
+
 struct MPESSetData: MPESImageData
 {
     float IntensitySD; 
@@ -38,7 +46,16 @@ class MPESImageSet
         float nsat[200];
         void makeArrays();
         const char * dir;
-        std::string last_img;
+        std::shared_ptr<ImageSink> imageSink; // writes the saved images in the background
+        std::vector<MPESImage> frames; // grabbed but not yet analyzed
+        std::string lastImage; ///< Path of the last image of the last Grab() queued for saving, empty if none.
+        /// Queues frame to be saved as a JPEG named fileName, and records it as lastImage.
+        void saveJpeg(const std::string &fileName, const cv::Mat &frame);
+        cv::Rect roi; ///< Analysis window around the last spot found; empty for the full frame.
+        bool roiEnabled = true;
+        /// Analyzes frame within the window, falling back to the full frame if the spot is not found well inside it, and
+        /// re-centres the window on the spot.
+        void analyzeFrame(MPESImage &frame);
         bool m_Calibrated;
         bool verbosity; /// Bool to print all results to stderr.
 
@@ -81,7 +98,26 @@ DEPRECATED!
         MPESImageSet(MPESDevice* in_device, int N, const char *dir = NULL, int thresh=50, bool verbosity=0);
 
         ///  Captures the images for this set
-        int Capture();
+        int Capture() { return Capture(imagesToCapture, true); }
+        /// Captures a set of nImages images, optionally without writing any of them to disk.
+        /*!
+         Used for quick probes (e.g. exposure search) where a single frame is enough and the full set is not needed.
+         @param nImages - number of images to analyze, not counting the rejected warm-up frames.
+         @param saveImages - write the last images of the set to the image directory.
+         */
+        int Capture(int nImages, bool saveImages);
+        /// Grabs the frames of a set from the camera (or directory) without analyzing them. Returns the number of frames grabbed.
+        /*!
+         Together with Analyze(), splits Capture() so that the webcam is only held while frames are read off it; several webcams
+         sharing a USB bus can then take turns grabbing while the frames already grabbed are analyzed.
+         */
+        int Grab() { return Grab(imagesToCapture, true); }
+        int Grab(int nImages, bool saveImages) { return Grab(nImages, saveImages, nullptr); }
+        /// As above, but analyzes each frame from the camera as soon as it is grabbed and passes its data to enough(); stops
+        /// grabbing once enough() returns true. Only the last frame is saved.
+        int Grab(int nImages, bool saveImages, const std::function<bool(const MPESImageData &)> &enough);
+        /// Analyzes the frames grabbed by Grab(). Returns the number of images in the set, as Capture() does.
+        int Analyze();
         /*! 
          Run this after constructing the ImageSet object to capture images. Creates new images from camera and writes to a directory or simply reads images from a directory, depending on the constructor used. Then analyzes each image, populating a vector of objects for each image. Returns the number of images captured.
          */
@@ -93,6 +129,23 @@ This method calculates Averages and Standard deviations for the multiple paramet
 
 */
         void simpleAverage();
+        /// As simpleAverage(), but with the centroids (and their frame-to-frame scatter) from filter, which has been fed the
+        /// frames of this set.
+        void filteredAverage(const MPESSpotFilter &filter);
+        /// Restricts the analysis of each frame to a window tracked around the last spot found. On by default.
+        /*!
+         The window is re-centred on every frame; a spot that is lost or clipped by the window is looked for in the whole
+         frame, which then starts a new window. Saved images are always full frames.
+         */
+        void SetROIEnabled(bool enabled) { roiEnabled = enabled; roi = cv::Rect(); }
+        /// Analyzes the next frame in full.
+        void ResetROI() { roi = cv::Rect(); }
+        cv::Rect GetROI() const { return roi; }
+        /// Path of the last image saved by the last capture, empty if it saved none. The image is written in the
+        /// background, so it may not be on disk yet -- FlushImages() waits for it.
+        std::string GetLastImage() const { return lastImage; }
+        /// Blocks until the images queued so far are on disk.
+        void FlushImages();
         /// Prints properties for set of images.
         void printSetProperties(FILE * file);
 	
@@ -0,0 +1,106 @@
+#include "MPESSpotFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float MPESSpotFilter::DEFAULT_FRAME_VARIANCE = 0.04;
+const float MPESSpotFilter::MIN_FRAME_VARIANCE = 1e-4;
+const float MPESSpotFilter::FRAME_VARIANCE_GAIN = 0.05;
+const float MPESSpotFilter::DRIFT_RATE = 5e-5;
+const float MPESSpotFilter::SHIFT_UNCERTAINTY = 0.2;
+const float MPESSpotFilter::GATE = 4.;
+const double MPESSpotFilter::MAX_AGE = 1800.;
+
+void MPESSpotFilter::reset()
+{
+    valid = false;
+    mx = my = -1.;
+    vx = vy = -1.;
+    lastTime = 0.;
+    pending = false;
+    ox = oy = -1.;
+}
+
+void MPESSpotFilter::predict(float dx, float dy)
+{
+    if (!valid)
+        return;
+    mx += dx;
+    my += dy;
+    // the response matrices are only as good as their calibration -- widen the estimate along with the shift
+    float sigma = SHIFT_UNCERTAINTY * std::sqrt(dx * dx + dy * dy);
+    vx += sigma * sigma;
+    vy += sigma * sigma;
+    pending = false;
+}
+
+bool MPESSpotFilter::update(float x, float y, double t)
+{
+    if (valid && t - lastTime > MAX_AGE)
+        reset();
+
+    if (!valid) {
+        mx = x;
+        my = y;
+        vx = rx;
+        vy = ry;
+        lastTime = t;
+        valid = true;
+        return true;
+    }
+
+    // the spot may have drifted since the last frame
+    float dt = std::max(0., t - lastTime);
+    vx += DRIFT_RATE * dt;
+    vy += DRIFT_RATE * dt;
+    lastTime = t;
+
+    float ex = x - mx, ey = y - my;
+    float sx = vx + rx, sy = vy + ry;
+    if (ex * ex > GATE * GATE * sx || ey * ey > GATE * GATE * sy) {
+        // two frames that agree with each other but not with the estimate -- the spot has moved
+        if (pending && (x - ox) * (x - ox) <= GATE * GATE * 2 * rx && (y - oy) * (y - oy) <= GATE * GATE * 2 * ry) {
+            mx = (x + ox) / 2;
+            my = (y + oy) / 2;
+            vx = rx / 2;
+            vy = ry / 2;
+            pending = false;
+            return true;
+        }
+        pending = true;
+        ox = x;
+        oy = y;
+        return false;
+    }
+    pending = false;
+
+    // E[e^2] = v + r, which gives the per-frame variance to learn -- but only once the estimate is good enough for
+    // the frame scatter to dominate the innovations
+    if (vx < rx)
+        rx = std::max(MIN_FRAME_VARIANCE, rx + FRAME_VARIANCE_GAIN * (ex * ex - vx - rx));
+    if (vy < ry)
+        ry = std::max(MIN_FRAME_VARIANCE, ry + FRAME_VARIANCE_GAIN * (ey * ey - vy - ry));
+
+    float kx = vx / sx, ky = vy / sy;
+    mx += kx * ex;
+    my += ky * ey;
+    vx *= (1 - kx);
+    vy *= (1 - ky);
+
+    return true;
+}
+
+float MPESSpotFilter::GetSigma() const
+{
+    return valid ? std::sqrt(std::max(vx, vy)) : -1.;
+}
+
+float MPESSpotFilter::GetFrameSigmaX() const
+{
+    return std::sqrt(rx);
+}
+
+float MPESSpotFilter::GetFrameSigmaY() const
+{
+    return std::sqrt(ry);
+}
@@ -0,0 +1,57 @@
+#ifndef __MPESSPOTFILTER_H__
+#define __MPESSPOTFILTER_H__
+
+/// Recursive (Kalman) estimate of the spot centroid of one sensor, carried from read to read.
+/*!
+Each frame is fused with the estimate left by the previous frames, so a sensor whose spot has not moved needs only the
+few frames it takes to cover the drift since its last read. The estimate is shifted by the motions of the panels that
+are known (see predict()). A frame that is inconsistent with the estimate is held back; if the next frame agrees with it
+rather than with the estimate, the spot is taken to have moved and the estimate restarts from the two of them.
+
+The x and y centroids are treated as independent, and the frame-to-frame scatter is learned from the innovations.
+*/
+class MPESSpotFilter
+{
+    public:
+        static const float DEFAULT_FRAME_VARIANCE;  ///< Initial per-frame centroid variance, px^2.
+        static const float MIN_FRAME_VARIANCE;      ///< Floor of the learned per-frame variance, px^2.
+        static const float FRAME_VARIANCE_GAIN;     ///< Weight of each innovation in the learned per-frame variance.
+        static const float DRIFT_RATE;              ///< Growth of the variance of a resting spot, px^2/s.
+        static const float SHIFT_UNCERTAINTY;       ///< Uncertainty of a predicted shift, as a fraction of the shift.
+        static const float GATE;                    ///< Innovations beyond this many standard deviations are outliers.
+        static const double MAX_AGE;                ///< Seconds after which the estimate is dropped.
+
+        MPESSpotFilter() : rx(DEFAULT_FRAME_VARIANCE), ry(DEFAULT_FRAME_VARIANCE) { reset(); }
+
+        /// Forgets the estimate (but not the learned frame scatter); the next frame starts a new one.
+        void reset();
+
+        /// Moves the estimate by a predicted shift of the spot (px), e.g. from a commanded panel motion.
+        void predict(float dx, float dy);
+
+        /// Fuses the centroid of one frame taken at time t (s).
+        /*!
+        @return false if the frame was held back as an outlier.
+        */
+        bool update(float x, float y, double t);
+
+        bool isValid() const { return valid; }
+        float GetX() const { return mx; }
+        float GetY() const { return my; }
+        /// Posterior standard deviation of the centroid (the larger of x and y), px.
+        float GetSigma() const;
+        /// Learned per-frame scatter of the centroid, px.
+        float GetFrameSigmaX() const;
+        float GetFrameSigmaY() const;
+
+    private:
+        bool valid;
+        float mx, my;      // estimate
+        float vx, vy;      // its variance
+        float rx, ry;      // per-frame variance
+        double lastTime;
+        bool pending;      // an outlier frame held back
+        float ox, oy;
+};
+
+#endif
@@ -117,6 +117,13 @@ MethodManager* PasObject::getMethodManager(UaMethod* pMethod) const
 }
 
 
+const std::set<OpcUa_UInt32> PasObject::IMMEDIATE_METHODS = {
+    PAS_MirrorType_Stop,
+    PAS_EdgeType_Stop,
+    PAS_PanelType_Stop,
+    PAS_ACTType_Stop
+};
+
 // generic begin call -- calls worker thread that needs to be implemented for device;
 // that is, only <ObjectType>::call() method needs to be implemented for asynchronous calls
 // to work through UaSession::beginCall() on the client side
@@ -129,6 +136,22 @@ UaStatus PasObject::beginCall(
 {
     UaStatus ret;
 
+    // stops skip the thread pool, where they could wait behind the very motions they are meant to stop
+    auto pMethodHandleUaNode = dynamic_cast<MethodHandleUaNode *>(pMethodHandle);
+    if (pMethodHandleUaNode) {
+        auto it = m_MethodMap.find(pMethodHandleUaNode->pUaMethod()->nodeId());
+        if (it != m_MethodMap.end() && IMMEDIATE_METHODS.count(it->second.second)) {
+            UaVariantArray outputArguments;
+            UaStatusCodeArray inputArgumentResults;
+            UaDiagnosticInfos inputArgumentDiag;
+            UaStatus callStatus = call(serviceContext, pMethodHandle, inputArguments, outputArguments,
+                                       inputArgumentResults, inputArgumentDiag);
+            pCallback->finishCall(callbackHandle, inputArgumentResults, inputArgumentDiag, outputArguments,
+                                  callStatus);
+            return ret;
+        }
+    }
+
     auto pCallJob = new OpcUa::MethodCallJob;
     pCallJob->initialize(this, pCallback, serviceContext, callbackHandle, pMethodHandle, inputArguments);
     ret = NodeManagerRoot::CreateRootNodeManager()->pServerManager()->getThreadPool()->addJob(pCallJob);
@@ -248,6 +271,8 @@ const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean, O
                                                         Ua_AccessLevel_CurrentRead)},
     {PAS_MPESType_ImagePath,       std::make_tuple("ImagePath", UaVariant("somePath") , OpcUa_False,
                                                     Ua_AccessLevel_CurrentRead)},
+    {PAS_MPESType_TargetCentroidSigma, std::make_tuple("TargetCentroidSigma", UaVariant(0.0), OpcUa_False,
+                                                        Ua_AccessLevel_CurrentRead | Ua_AccessLevel_CurrentWrite)},
 };
 
 const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean>> MPESObject::ERRORS = {
@@ -273,7 +298,11 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
     {PAS_MPESType_SetExposure,    {"SetExposure",    {}}},
     {PAS_MPESType_ClearError,     {"ClearError",     {std::make_tuple("ErrorNum", UaNodeId(OpcUaId_Int32),
                                                                       "Number of error to clear")}}},
-    {PAS_MPESType_ClearAllErrors, {"ClearAllErrors", {}}}
+    {PAS_MPESType_ClearAllErrors, {"ClearAllErrors", {}}},
+    {PAS_MPESType_PredictShift,   {"PredictShift",   {std::make_tuple("xShift", UaNodeId(OpcUaId_Double),
+                                                                      "Expected shift of the spot in x (px)"),
+                                                      std::make_tuple("yShift", UaNodeId(OpcUaId_Double),
+                                                                      "Expected shift of the spot in y (px)")}}}
 };
 
 const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean, OpcUa_Byte>> ACTObject::VARIABLES = {
@@ -286,6 +315,8 @@ const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean, O
                                                     Ua_AccessLevel_CurrentRead)},
     {PAS_ACTType_CurrentLength, std::make_tuple("CurrentLength", UaVariant(0.0), OpcUa_False,
                                                    Ua_AccessLevel_CurrentRead)},
+    {PAS_ACTType_MeasuredLength, std::make_tuple("MeasuredLength", UaVariant(0.0), OpcUa_False,
+                                                   Ua_AccessLevel_CurrentRead)},
     {PAS_ACTType_ErrorState, std::make_tuple("ErrorState", UaVariant(0), OpcUa_False,
                                                    Ua_AccessLevel_CurrentRead)}
 
@@ -364,6 +395,7 @@ const std::map<OpcUa_UInt32, std::tuple<std::string, UaVariant, OpcUa_Boolean>>
         {PAS_PSDType_Error2,  std::make_tuple("[0] [Fatal] Error from tcsetattrr.", UaVariant(false), OpcUa_False)},
         {PAS_PSDType_Error3,  std::make_tuple("[0] [Fatal] Error from tggetattr.", UaVariant(false), OpcUa_False)},
         {PAS_PSDType_Error4,  std::make_tuple("[0] [Fatal] Error setting term attributes.", UaVariant(false), OpcUa_False)},
+        {PAS_PSDType_Error5,  std::make_tuple("[5] [Fatal] Lost connection to the PSD.", UaVariant(false), OpcUa_False)},
 
 };
 
@@ -1,6 +1,8 @@
 #ifndef COMMON_PASOBJECT_HPP
 #define COMMON_PASOBJECT_HPP
 
+#include <set>
+
 #include "uaserver/uaobjecttypes.h"
 #include "uaserver/methodmanager.h"
 #include "uaserver/opcua_offnormalalarmtype.h"
@@ -68,6 +70,10 @@ public:
 
     Device::Identity getIdentity() { return m_Identity; }
 
+    /// @brief Method types that are called on the thread that received the request instead of being queued on the
+    /// server's thread pool, so that long calls in progress cannot hold them up. They must return quickly.
+    static const std::set<OpcUa_UInt32> IMMEDIATE_METHODS;
+
 protected: 
     // a function that's used very often
     OpcUa::DataItemType* addVariable(PasNodeManagerCommon *pNodeManager, OpcUa_UInt32 ParentType, OpcUa_UInt32 VarType, OpcUa_Boolean isState = OpcUa_False, OpcUa_Boolean addReference = OpcUa_True);
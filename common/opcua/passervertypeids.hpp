@@ -68,6 +68,11 @@
 #define PAS_MirrorType_SaveMPESPositions             150
 #define PAS_MirrorType_LoadMPESPositions             151
 #define PAS_MirrorType_SavePanelTemperatures         152
+#define PAS_MirrorType_SaveSnapshot                  153
+#define PAS_MirrorType_LoadSnapshot                  154
+#define PAS_MirrorType_AlignWavefront                155
+#define PAS_MirrorType_FindMatrices                  156
+#define PAS_MirrorType_LoadElevationModel            157
 
 //----------------------------------------------------------//
 // Edge Type
@@ -80,6 +85,7 @@
 #define PAS_EdgeType_Align                          1012
 #define PAS_EdgeType_Read                           1013
 #define PAS_EdgeType_Stop                           1014
+#define PAS_EdgeType_FindMatrixDesigned             1015
 //----------------------------------------------------------//
 // MPES Type
 #define PAS_MPESType                                1100
@@ -100,12 +106,14 @@
 #define PAS_MPESType_RawTimestamp                   1114
 #define PAS_MPESType_ImagePath                      1115
 #define PAS_MPESType_nSat                           1116
+#define PAS_MPESType_TargetCentroidSigma            1117
 #define PAS_MPESType_TurnOn                         1151
 #define PAS_MPESType_TurnOff                        1152
 #define PAS_MPESType_Read                           1153
 #define PAS_MPESType_SetExposure                    1154
 #define PAS_MPESType_ClearError                     1155
 #define PAS_MPESType_ClearAllErrors                 1156
+#define PAS_MPESType_PredictShift                   1157
 #define PAS_MPESType_StateCondition                 1161
 // Error variable declarations
 #define PAS_MPESType_Error0                          1191
@@ -147,6 +155,7 @@
 #define PAS_PanelType_ClearPlatformErrors           2030
 #define PAS_PanelType_TurnOn                        2031
 #define PAS_PanelType_TurnOff                       2032
+#define PAS_PanelType_ReadSensors                   2033
 
 // Error variable declarations
 #define PAS_PanelType_Error0                          2800
@@ -175,6 +184,7 @@
 #define PAS_ACTType_Position                        2105
 #define PAS_ACTType_Serial                          2106
 #define PAS_ACTType_ErrorState                      2107
+#define PAS_ACTType_MeasuredLength                  2108
 #define PAS_ACTType_TurnOn                          2111
 #define PAS_ACTType_TurnOff                         2112
 #define PAS_ACTType_MoveDeltaLength                 2113
@@ -256,6 +266,7 @@
 #define PAS_PSDType_Error2                          3253
 #define PAS_PSDType_Error3                          3254
 #define PAS_PSDType_Error4                          3255
+#define PAS_PSDType_Error5                          3256
 
 //----------------------------------------------------------//
 //
@@ -290,6 +301,7 @@
 #define PAS_FocalPlaneType_Exposure                   3328
 #define PAS_FocalPlaneType_FrameRate                  3329
 #define PAS_FocalPlaneType_Gain                       3330
+#define PAS_FocalPlaneType_RingDirection              3331
 //----------------------------------------------------------//
 //
 // Global Alignment Type
@@ -317,6 +329,7 @@
 #define PAS_OpticalAlignmentType_StopProcess                3509
 #define PAS_OpticalAlignmentType_SelectAll                  3510
 #define PAS_OpticalAlignmentType_SelectedPanels             3511
+#define PAS_OpticalAlignmentType_CalibrateFirstOrderCorrBatch 3512
 //----------------------------------------------------------//
 //
 
@@ -5,6 +5,7 @@
 #include "TDecompLU.h"
 
 const double StewartPlatform::kMirrorDistance = 8701.56;
+const int StewartPlatform::kMaxWarmIterations = 20;
 
 StewartPlatform::StewartPlatform()
 {
@@ -23,7 +24,7 @@ StewartPlatform::StewartPlatform()
 /*
  * STEWART PLATFORM NEWTON-RAPHSON
  */
-void StewartPlatform::ComputeStewart(const double *actL, double eps)
+void StewartPlatform::ComputeStewart(const double *actL, double eps, bool warmStart)
 // *actL is an array of the wanted actuator lengths, needs to be supplied.
 // *platA is the platform orientation vector: {x, y, z, alpha, beta, gamma}
 // the angles are the RPY angles in the Z-Y-X (5->4->3) convention
@@ -31,16 +32,32 @@ void StewartPlatform::ComputeStewart(const double *actL, double eps)
 // (*act)[3] is the array of coords of actuator ends on the payload platform:
 //                      {{x0,y0,z0}, ..., {x5,y5,z5}}
 // eps is the required tolerance
+// warmStart starts the iteration from the previous solution (for the same panel type) instead of the
+// nominal position -- a few iterations when the lengths changed little since the last call
 {
 
     // the collection of actuator lengths is set by the caller.
     // this is stored in actL
 
     double axisL[6];
-    double a[6] = {5., 0., 0., 0.1, 0.1, 0.1}; // a = (x,y,z,phi,theta,psi)
-    for (int i = 0; i < 6; i++) {
+    double a[6]; // a = (x,y,z,phi,theta,psi)
+    for (int i = 0; i < 6; i++)
         axisL[i] = actL[i] + 2*bracketT; // this is the axis-to-axis distance we actually use
-        a[2] += axisL[i]/6.;
+
+    auto coldStart = [&a, &axisL]() {
+        const double a0[6] = {5., 0., 0., 0.1, 0.1, 0.1};
+        for (int i = 0; i < 6; i++) {
+            a[i] = a0[i];
+        }
+        for (int i = 0; i < 6; i++)
+            a[2] += axisL[i]/6.;
+    };
+    bool warm = warmStart && fHasSolution && fSolutionPanel == fPanel;
+    if (warm) {
+        for (int i = 0; i < 6; i++) a[i] = fSolution[i];
+    }
+    else {
+        coldStart();
     }
     //a[0] = (actL[2] + actL[3] - actL[0] - actL[5])/2.;
     //a[1] = (actL[3] + actL[4] + actL[5] - actL[0] - actL[1] - actL[2])/3.;
@@ -222,7 +239,17 @@ void StewartPlatform::ComputeStewart(const double *actL, double eps)
         for (int i = 0; i < 6; i++) a[i] += f[i];
 
         ++iter;
+        // the previous solution was too far off to converge quickly -- start over from the nominal position
+        if (warm && iter > kMaxWarmIterations) {
+            coldStart();
+            warm = false;
+            iter = 0;
+        }
     }
+    for (int i = 0; i < 6; i++) fSolution[i] = a[i];
+    fSolutionPanel = fPanel;
+    fHasSolution = true;
+
     // store the results
     for (int i = 0; i < 6; i++) {
         fPanelCoords[i] = a[i];
@@ -18,8 +18,8 @@ class StewartPlatform
         const unsigned fRotOrder[3] = {1,3,2};
         const double kRp = 320.; // payload radius in mm
         // the actual iterative Newton-Raphson computation -- find the platform position
-        // given actuator lengths
-        void ComputeStewart(const double *actL, double eps = 1e-12);
+        // given actuator lengths; warmStart starts from the previous solution
+        void ComputeStewart(const double *actL, double eps = 1e-12, bool warmStart = false);
         // the inverse of the above -- compute actuator lengths based on a known platform
         // position and a given order of rotations
         void ComputeActsFromPanel(const double *panelCoords);
@@ -33,6 +33,8 @@ class StewartPlatform
         enum PanelType {P1, P2, S1, S2, OPT, PANELNUM};
         void SetPanelType(PanelType P) {fPanel = P;};
         static const double kMirrorDistance; // mm
+        // iterations allowed from a warm start before falling back to the nominal start
+        static const int kMaxWarmIterations;
 
     private:
 
@@ -61,6 +63,10 @@ class StewartPlatform
         // variables with coords and such
         double fPanelCoords[6];
         double fPanelCoords_external[6];
+        // last Newton-Raphson solution (internal parameters), for warm starts
+        double fSolution[6];
+        bool fHasSolution = false;
+        PanelType fSolutionPanel;
         // pad ordering convention: looking from the base towards the panel
         // and counting COUNTER-CLOCKWISE, with SP1 being the bottom pad
         double fPadCoords[3][3];
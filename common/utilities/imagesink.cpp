@@ -0,0 +1,194 @@
+#include "common/utilities/imagesink.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <utility>
+
+#include "common/utilities/spdlog/spdlog.h"
+#include "common/utilities/spdlog/fmt/ostr.h"
+
+
+const std::string ImageSink::INDEX_FILENAME = "index.txt";
+const size_t ImageSink::DEFAULT_QUEUE_CAPACITY = 8;
+const ImageSink::RetentionPolicy ImageSink::DEFAULT_RETENTION_POLICY = ImageSink::RetentionPolicy(
+    5000, 4ULL * 1024 * 1024 * 1024, 30 * 24 * 3600); // 5000 images, 4 GiB, 30 days
+
+std::mutex ImageSink::m_SinksMutex;
+std::map<std::string, std::shared_ptr<ImageSink>> ImageSink::m_Sinks;
+
+ImageSink::ImageSink(std::string directory, size_t queueCapacity, RetentionPolicy policy) :
+    m_Directory(std::move(directory)),
+    m_QueueCapacity(std::max<size_t>(queueCapacity, 1)),
+    m_Policy(policy),
+    m_CompressionLevel(0),
+    m_Dropped(0),
+    m_Writing(false),
+    m_Stop(false),
+    m_IndexBytes(0)
+{
+    __loadIndex();
+    m_Thread = std::thread(&ImageSink::__run, this);
+}
+
+ImageSink::~ImageSink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_QueueCondition.notify_all();
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+std::shared_ptr<ImageSink> ImageSink::forDirectory(const std::string &directory)
+{
+    std::lock_guard<std::mutex> lock(m_SinksMutex);
+    auto it = m_Sinks.find(directory);
+    if (it != m_Sinks.end()) {
+        return it->second;
+    }
+    std::shared_ptr<ImageSink> sink = std::make_shared<ImageSink>(directory, DEFAULT_QUEUE_CAPACITY,
+                                                                  DEFAULT_RETENTION_POLICY);
+    m_Sinks[directory] = sink;
+    return sink;
+}
+
+void ImageSink::submit(const std::string &fileName, Writer writer, const std::string &tag)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Queue.size() >= m_QueueCapacity) {
+            spdlog::warn("ImageSink : Queue for {} full, dropping {}.", m_Directory, m_Queue.front().fileName);
+            m_Queue.pop_front();
+            m_Dropped++;
+        }
+        Job job;
+        job.fileName = fileName;
+        job.tag = tag;
+        job.writer = std::move(writer);
+        m_Queue.push_back(std::move(job));
+    }
+    m_QueueCondition.notify_one();
+}
+
+void ImageSink::flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IdleCondition.wait(lock, [this]() { return m_Queue.empty() && !m_Writing; });
+}
+
+void ImageSink::setCompressionLevel(int level)
+{
+    m_CompressionLevel = std::max(0, std::min(9, level));
+}
+
+void ImageSink::setRetentionPolicy(const RetentionPolicy &policy)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Policy = policy;
+}
+
+ImageSink::RetentionPolicy ImageSink::getRetentionPolicy()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Policy;
+}
+
+void ImageSink::__run()
+{
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_QueueCondition.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            if (m_Queue.empty()) {
+                break; // stopping, and everything has been written
+            }
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_Writing = true;
+        }
+
+        std::string path = m_Directory + "/" + job.fileName;
+        if (job.writer(path, m_CompressionLevel)) {
+            IndexEntry entry;
+            entry.timestamp = std::time(0);
+            entry.fileName = job.fileName;
+            entry.tag = job.tag.empty() ? "-" : job.tag;
+            struct stat st;
+            entry.bytes = (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+
+            m_Index.push_back(entry);
+            m_IndexBytes += entry.bytes;
+            __appendIndex(entry);
+            __applyRetention();
+        } else {
+            spdlog::warn("ImageSink : Failed to write {}.", path);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Writing = false;
+        }
+        m_IdleCondition.notify_all();
+    }
+    m_IdleCondition.notify_all();
+}
+
+void ImageSink::__loadIndex()
+{
+    std::ifstream indexFile(m_Directory + "/" + INDEX_FILENAME);
+    IndexEntry entry;
+    while (indexFile >> entry.timestamp >> entry.bytes >> entry.fileName >> entry.tag) {
+        m_Index.push_back(entry);
+        m_IndexBytes += entry.bytes;
+    }
+}
+
+void ImageSink::__appendIndex(const IndexEntry &entry)
+{
+    std::ofstream indexFile(m_Directory + "/" + INDEX_FILENAME, std::ofstream::app);
+    indexFile << entry.timestamp << " " << entry.bytes << " " << entry.fileName << " " << entry.tag << std::endl;
+}
+
+void ImageSink::__saveIndex()
+{
+    std::string indexPath = m_Directory + "/" + INDEX_FILENAME;
+    std::string tmpPath = indexPath + ".tmp";
+    {
+        std::ofstream indexFile(tmpPath, std::ofstream::trunc);
+        for (const auto &entry : m_Index) {
+            indexFile << entry.timestamp << " " << entry.bytes << " " << entry.fileName << " " << entry.tag << std::endl;
+        }
+    }
+    std::rename(tmpPath.c_str(), indexPath.c_str());
+}
+
+void ImageSink::__applyRetention()
+{
+    RetentionPolicy policy = getRetentionPolicy();
+    std::time_t now = std::time(0);
+
+    bool removed = false;
+    while (!m_Index.empty() &&
+           ((policy.maxFiles > 0 && m_Index.size() > policy.maxFiles) ||
+            (policy.maxBytes > 0 && m_IndexBytes > policy.maxBytes) ||
+            (policy.maxAge > 0 && (now - m_Index.front().timestamp) > policy.maxAge))) {
+        const IndexEntry &oldest = m_Index.front();
+        std::string path = m_Directory + "/" + oldest.fileName;
+        if (std::remove(path.c_str()) != 0) {
+            spdlog::debug("ImageSink : Could not remove {} (already gone?).", path);
+        }
+        m_IndexBytes -= std::min(m_IndexBytes, oldest.bytes);
+        m_Index.pop_front();
+        removed = true;
+    }
+
+    if (removed) {
+        __saveIndex();
+    }
+}
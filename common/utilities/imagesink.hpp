@@ -0,0 +1,111 @@
+#ifndef ALIGNMENT_IMAGESINK_HPP
+#define ALIGNMENT_IMAGESINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * Writes images to disk on a background thread, so acquisition does not wait on the SD card/flash.
+ *
+ * Images are handed over as writer functions that own a copy of the pixels. The queue is bounded:
+ * when it is full the oldest pending image is dropped. Every written file is recorded in an index
+ * (INDEX_FILENAME in the image directory: timestamp, size, file name, tag), and the retention policy
+ * deletes the oldest indexed files once the count, total size or age limits are exceeded.
+ */
+class ImageSink
+{
+public:
+    /// Limits on the images kept in the directory. 0 means unlimited.
+    struct RetentionPolicy {
+        RetentionPolicy() : maxFiles(0), maxBytes(0), maxAge(0) {}
+        RetentionPolicy(size_t files, uint64_t bytes, int ageSeconds) : maxFiles(files), maxBytes(bytes), maxAge(ageSeconds) {}
+
+        size_t maxFiles;
+        uint64_t maxBytes;
+        int maxAge; // seconds
+    };
+
+    /// Writes the image to the given path with the given compression level (0 = none .. 9 = max). Returns success.
+    typedef std::function<bool(const std::string &path, int compressionLevel)> Writer;
+
+    static const std::string INDEX_FILENAME;
+    static const size_t DEFAULT_QUEUE_CAPACITY;
+    static const RetentionPolicy DEFAULT_RETENTION_POLICY;
+
+    ImageSink(std::string directory, size_t queueCapacity = DEFAULT_QUEUE_CAPACITY,
+              RetentionPolicy policy = RetentionPolicy());
+    ~ImageSink(); // writes out whatever is still queued
+
+    ImageSink(const ImageSink &) = delete;
+    ImageSink &operator=(const ImageSink &) = delete;
+
+    /// Shared sink for a directory, created on first use with the default queue capacity and retention policy.
+    static std::shared_ptr<ImageSink> forDirectory(const std::string &directory);
+
+    /// Queue an image for writing to <directory>/<fileName>. Never blocks on I/O.
+    void submit(const std::string &fileName, Writer writer, const std::string &tag = "");
+
+    /// Block until everything queued so far is on disk.
+    void flush();
+
+    void setCompressionLevel(int level);
+    int getCompressionLevel() const { return m_CompressionLevel; }
+
+    void setRetentionPolicy(const RetentionPolicy &policy);
+    RetentionPolicy getRetentionPolicy();
+
+    const std::string &getDirectory() const { return m_Directory; }
+    size_t getDroppedCount() const { return m_Dropped; }
+
+private:
+    struct Job {
+        std::string fileName;
+        std::string tag;
+        Writer writer;
+    };
+
+    struct IndexEntry {
+        std::time_t timestamp;
+        uint64_t bytes;
+        std::string fileName;
+        std::string tag;
+    };
+
+    std::string m_Directory;
+    size_t m_QueueCapacity;
+    RetentionPolicy m_Policy;
+    std::atomic<int> m_CompressionLevel;
+    std::atomic<size_t> m_Dropped;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_QueueCondition; // wakes the writer
+    std::condition_variable m_IdleCondition; // wakes flush()
+    std::deque<Job> m_Queue;
+    bool m_Writing;
+    bool m_Stop;
+
+    std::deque<IndexEntry> m_Index; // oldest first, only touched by the writer thread after construction
+    uint64_t m_IndexBytes;
+
+    std::thread m_Thread;
+
+    static std::mutex m_SinksMutex;
+    static std::map<std::string, std::shared_ptr<ImageSink>> m_Sinks;
+
+    void __run();
+    void __loadIndex();
+    void __appendIndex(const IndexEntry &entry);
+    void __saveIndex();
+    void __applyRetention();
+};
+
+#endif //ALIGNMENT_IMAGESINK_HPP
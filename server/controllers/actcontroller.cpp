@@ -40,8 +40,28 @@ UaStatus ActController::getData(OpcUa_UInt32 offset, UaVariant &value) {
                 value.setFloat(m_DeltaLength);
                 break;
             case PAS_ACTType_CurrentLength: {
-                float length = m_pPlatform->getActuatorbyIdentity(m_Identity)->measureLength();
-                spdlog::trace("{} : Read CurrentLength value => ({})", m_Identity, length);
+                // the length published after the last motion or measurement -- reading the encoder here would
+                // mark the actuator busy under whatever motion is running, and subscriptions sample this node
+                float lastLength = m_pPlatform->getActuatorbyIdentity(m_Identity)->getLastLength();
+                if (lastLength < 0) {
+                    spdlog::trace("{} : Read CurrentLength value => (not measured yet)", m_Identity);
+                    status = OpcUa_BadWaitingForInitialData;
+                    break;
+                }
+                spdlog::trace("{} : Read CurrentLength value => ({})", m_Identity, lastLength);
+                value.setFloat(lastLength);
+                break;
+            }
+            case PAS_ACTType_MeasuredLength: {
+                // measuring reads the encoder and marks the actuator busy, so don't do it in the middle of a motion
+                auto &pActuator = m_pPlatform->getActuatorbyIdentity(m_Identity);
+                if (pActuator->isBusy() || m_pPlatform->isBusy()) {
+                    spdlog::error("{} : Actuator is busy, cannot measure its length. Wait and try again.", m_Identity);
+                    status = OpcUa_BadInvalidState;
+                    break;
+                }
+                float length = pActuator->measureLength();
+                spdlog::trace("{} : Read MeasuredLength value => ({})", m_Identity, length);
                 value.setFloat(length);
                 break;
             }
@@ -182,8 +202,8 @@ UaStatus ActController::operate(OpcUa_UInt32 offset, const UaVariantArray &args)
             }
             break;
         case PAS_ACTType_Stop:
-            spdlog::info("{} : ActuatorController calling stop()...", m_Identity);
-            m_pPlatform->getActuatorbyIdentity(m_Identity)->emergencyStop();
+            m_pPlatform->getActuatorbyIdentity(m_Identity)->emergencyStop(); // before logging, which flushes to disk
+            spdlog::info("{} : ActuatorController called stop()", m_Identity);
             break;
         default:
             status = OpcUa_BadInvalidArgument;
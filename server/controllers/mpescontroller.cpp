@@ -185,9 +185,17 @@ UaStatus MPESController::getData(OpcUa_UInt32 offset, UaVariant &value) {
                 value.setString(UaString(std::ctime(&position.timestamp)));
                 break;
             case PAS_MPESType_ImagePath:
+                // the path is that of this reading's image, which may still be queued for writing
+                m_pPlatform->getMPESbyIdentity(m_Identity)->flushImages();
                 spdlog::trace("{} : Read ImagePath value => ({})", m_Identity, position.last_img);
                 value.setString(UaString(position.last_img.c_str()));
                 break;
+            case PAS_MPESType_TargetCentroidSigma: {
+                float sigma = m_pPlatform->getMPESbyIdentity(m_Identity)->getTargetCentroidSigma();
+                spdlog::trace("{} : Read TargetCentroidSigma value => ({})", m_Identity, sigma);
+                value.setFloat(sigma);
+                break;
+            }
             case PAS_MPESType_ErrorState: {
                 Device::ErrorState errorState = _getErrorState();
                 spdlog::trace("{} : Read ErrorState value => ({})", m_Identity, Device::errorStateNames.at(errorState));
@@ -239,6 +247,10 @@ UaStatus MPESController::setData(OpcUa_UInt32 offset, UaVariant value) {
             spdlog::trace("{} : Setting yCentroidNominal to {}.", m_Identity, v);
             m_pPlatform->getMPESbyIdentity(m_Identity)->setyNominalPosition(v);
             break;
+        case PAS_MPESType_TargetCentroidSigma:
+            spdlog::trace("{} : Setting TargetCentroidSigma to {}.", m_Identity, v);
+            m_pPlatform->getMPESbyIdentity(m_Identity)->setTargetCentroidSigma(v);
+            break;
         default:
             status = OpcUa_BadNotWritable;
     }
@@ -302,6 +314,14 @@ UaStatus MPESController::operate(OpcUa_UInt32 offset, const UaVariantArray &args
             spdlog::info("{} : MPESController calling clearErrors()", m_Identity);
             m_pPlatform->getMPESbyIdentity(m_Identity)->clearErrors();
             break;
+        case PAS_MPESType_PredictShift: {
+            double dx, dy;
+            UaVariant(args[0]).toDouble(dx);
+            UaVariant(args[1]).toDouble(dy);
+            spdlog::debug("{} : MPESController calling predictSpotShift() with ({}, {})", m_Identity, dx, dy);
+            m_pPlatform->getMPESbyIdentity(m_Identity)->predictSpotShift(dx, dy);
+            break;
+        }
         default:
             status = OpcUa_BadInvalidArgument;
     }
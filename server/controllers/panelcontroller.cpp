@@ -1,6 +1,8 @@
 #include "server/controllers/panelcontroller.hpp"
 
 #include <array>
+#include <map>
+#include <set>
 #include <sstream>
 #include <memory>
 
@@ -92,7 +94,7 @@ UaStatus PanelController::setData(OpcUa_UInt32 offset, UaVariant value) {
 }
 
 /// @details Updates the state and then checks it before attempting to call any methods. When the state is FatalError or Busy, prevents panel operation.
-/// If the stop method is called, sets the platform state to off in order to halt any motion.
+/// The stop method is let through while busy, and signals the platform to halt the motion in progress.
 UaStatus PanelController::operate(OpcUa_UInt32 offset, const UaVariantArray &args) {
     UaStatus status;
 
@@ -168,8 +170,8 @@ UaStatus PanelController::operate(OpcUa_UInt32 offset, const UaVariantArray &arg
             "{} : Lengths after moveToLengths (Remaining distance to target):\n{}",
             m_Identity, os.str());
     } else if (offset == PAS_PanelType_Stop) {
-        spdlog::info("{} : PanelController calling stop()", m_Identity);
-        m_pPlatform->emergencyStop();
+        m_pPlatform->emergencyStop(); // before logging, which flushes to disk
+        spdlog::info("{} : PanelController called stop()", m_Identity);
     } else if (offset == PAS_PanelType_TurnOn) {
         spdlog::info("{} : PanelController calling turnOn()", m_Identity);
         if (_getDeviceState() == Device::DeviceState::Off) {
@@ -194,6 +196,35 @@ UaStatus PanelController::operate(OpcUa_UInt32 offset, const UaVariantArray &arg
         UaVariant(args[0]).toInt32(errorCode);
         spdlog::info("{} : PanelController calling clearError() for error {}", m_Identity, errorCode);
         m_pPlatform->unsetError(errorCode);
+    } else if (offset == PAS_PanelType_ReadSensors) {
+        int maxConcurrentCaptures;
+        UaVariant(args[0]).toInt32(maxConcurrentCaptures);
+        std::set<int> serials;
+        std::istringstream serialList(UaString(args[1].Value.String).toUtf8());
+        int serial;
+        while (serialList >> serial) {
+            serials.insert(serial);
+        }
+        spdlog::info("{} : PanelController calling readMPESAll() for {} MPES with at most {} concurrent captures",
+                     m_Identity, serials.empty() ? "all" : std::to_string(serials.size()), maxConcurrentCaptures);
+        std::map<Device::Identity, MPESBase::Position> positions = m_pPlatform->readMPESAll(maxConcurrentCaptures,
+                                                                                            serials);
+
+        std::ostringstream os;
+        for (const auto &pair : positions) {
+            os << pair.first << " : " << pair.second.xCentroid << " +/- " << pair.second.xSpotWidth << ", "
+               << pair.second.yCentroid << " +/- " << pair.second.ySpotWidth << " (intensity "
+               << pair.second.cleanedIntensity << ")" << std::endl;
+        }
+        // a selected serial that is not on this panel counts as a failed read
+        unsigned nSelected = serials.empty() ? m_pMPES.size() : serials.size();
+        spdlog::info("{} : Read {} of {} MPES:\n{}", m_Identity, positions.size(), nSelected, os.str());
+        if (positions.empty()) {
+            status = OpcUa_Bad;
+        } else if (positions.size() < nSelected) {
+            spdlog::error("{} : Failed to read {} of {} MPES.", m_Identity, nSelected - positions.size(), nSelected);
+            status = OpcUa_Uncertain;
+        }
     } else if (offset == PAS_PanelType_ClearAllErrors) {
         spdlog::info("{} : PanelController calling clearAllErrors()", m_Identity);
         m_pPlatform->clearActuatorErrors();
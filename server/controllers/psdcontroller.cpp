@@ -65,6 +65,8 @@ UaStatus PSDController::getData(OpcUa_UInt32 offset, UaVariant &value)
     if (PSDObject::VARIABLES.find(offset) != PSDObject::VARIABLES.end()) {
         if (__expired()) { // if cached value expired, update it
             status = read();
+            if (status.isBad()) // e.g. the PSD went away -- don't serve its last sample as current
+                return status;
         }
         switch (offset) {
             double tmp;
@@ -103,6 +103,15 @@ const std::map<OpcUa_UInt32, std::pair<std::string, std::vector<std::tuple<std::
                                                                                     "Number of the error to clear")
                                                                 }}
     },
+    {PAS_PanelType_ReadSensors,         {"ReadSensors",         {
+                                                                    std::make_tuple("Max Concurrent Captures",
+                                                                                    UaNodeId(OpcUaId_Int32),
+                                                                                    "Number of webcams allowed to stream at once (0 for no limit)"),
+                                                                    std::make_tuple("MPES",
+                                                                                    UaNodeId(OpcUaId_String),
+                                                                                    "Serial numbers of the MPES to read, separated by spaces (empty for all)")
+                                                                }}
+    },
     {PAS_PanelType_ClearAllErrors,      {"ClearAllErrors",      {}}},
     {PAS_PanelType_ClearActuatorErrors, {"ClearActuatorErrors", {}}},
     {PAS_PanelType_ClearPlatformErrors, {"ClearPlatformErrors", {}}},
@@ -166,8 +166,8 @@ UaStatus PasCommunicationInterface::initialize() {
     // addMPES(port, serial)
     for (const auto &mpesId : mpesIdentities) {
         spdlog::info("Adding MPES hardware interface with identity {} as child of Platform ...", mpesId);
-        m_platform->addMPES(mpesId);
     }
+    m_platform->addMPESAll(mpesIdentities);
 
     if ((panelId.position==1001) || (panelId.position==2001)) {
         Device::Identity psdId;
@@ -38,6 +38,11 @@
 #include "server/pascommunicationinterface.hpp"
 #include "server/pasnodemanager.hpp"
 
+#ifndef SIMMODE
+#include "common/cbccode/BoardEmulator.hpp"
+#include "common/cbccode/MirrorControlBoard.hpp"
+#endif
+
 
 /// @brief Check the available disk space on the system.
 /// @param size Double to store the retrieved file system size (in GB).
@@ -145,7 +150,7 @@ int WINAPI WinMain( HINSTANCE, HINSTANCE, LPWSTR, int)
 int main(int argc, char* argv[])
 #endif
 {
-    std::string usage = "<PANEL POSITION NUMBER> -c <CONFIG FILE PATH (optional)> -u <ENDPOINT URL (optional)> -l <LOGGER LEVEL (optional)>";
+    std::string usage = "<PANEL POSITION NUMBER> -c <CONFIG FILE PATH (optional)> -u <ENDPOINT URL (optional)> -l <LOGGER LEVEL (optional)> -e (optional, emulate the mirror control board)";
 
     if (argc == 1) {
         std::cout << "Usage: " << argv[0] << " " << usage << std::endl;
@@ -155,8 +160,9 @@ int main(int argc, char* argv[])
     int c;
     std::string panelNumber, configFilePath, endpointUrl;
     std::string logLevel("info");
+    bool emulateBoard = false;
 
-    while ((c = getopt(argc, argv, "c:u:l:")) != -1) {
+    while ((c = getopt(argc, argv, "c:u:l:e")) != -1) {
         switch(c)
         {
             case 'c':
@@ -168,6 +174,9 @@ int main(int argc, char* argv[])
             case 'l':
                 logLevel = optarg;
                 break;
+            case 'e':
+                emulateBoard = true;
+                break;
             case '?':
                 if (optopt == 'c')
                     std::cout << "Must provide a config file path with option c\n";
@@ -226,6 +235,17 @@ int main(int argc, char* argv[])
     logger->flush_on(spdlog::level::info);
     spdlog::set_default_logger(logger);
 
+#ifndef SIMMODE
+    if (emulateBoard) {
+        // must be in place before the Platform opens the board
+        logger->warn("Emulating the mirror control board in memory. No hardware will be accessed.");
+        MirrorControlBoard::setBackend(std::make_shared<BoardEmulator>());
+    }
+#else
+    if (emulateBoard)
+        logger->warn("Option -e ignored: SIMMODE builds use a DummyPlatform, which does not access the board.");
+#endif
+
     // NOTE: This method returns a pointer to heap-allocated memory, must be freed manually
     char *pszAppPath = getAppPath(); // Extract application path
 